@@ -0,0 +1,969 @@
+/**
+ * @brief   This document is the benchmark of the ADC data path (frame locate, CRC check, frame decode, parse).
+ * @version 1.0
+ * @author  Shixuan Liu, Tongji University
+ * @date    2026-10
+ */
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <functional>
+#include <thread>
+
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/utsname.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#include "nlohmann/json.hpp"
+#include "fpga_config.h"
+#include "fpga_data_parse.h"
+#include "adc_frame_sync.h"
+#include "adc_frame_crc.h"
+#include "adc_stream_parser.h"
+#include "adc_channel_scaling.h"
+#include "cpu_dispatch.h"
+#include "dma_stream.h"
+
+#define VUPRS_BENCH_DEFAULT_FRAMES            (1U << 20)
+#define VUPRS_BENCH_DEFAULT_CRC_ERROR_RATE    0.01  /* Broken CRC per data word */
+#define VUPRS_BENCH_DEFAULT_GARBAGE_RATE      (1.0 / 64)  /* Garbage word in front of a frame */
+#define VUPRS_BENCH_CORRUPT_BURST_RATE        (1.0 / 256)  /* Garbage burst in front of a word (corrupted locate) */
+#define VUPRS_BENCH_CORRUPT_BURST_WORDS       1024U
+#define VUPRS_BENCH_CORRUPT_DROP_RATE         (1.0 / 1024)  /* Dropped word (corrupted locate) */
+#define VUPRS_BENCH_REPEAT                    5U  /* Best of N runs */
+#define VUPRS_BENCH_SEED                      20261018U
+
+#define VUPRS_BENCH_CYCLES__PERF              "perf"  /* Core cycles of the process (perf_event_open) */
+#define VUPRS_BENCH_CYCLES__CPUFREQ           "cpufreq"  /* Time * maximum CPU frequency (estimate) */
+#define VUPRS_BENCH_CYCLES__NONE              "none"
+
+typedef struct VUPRS_BENCH__Config
+{
+    uint64_t frames;
+    double crcErrorRate;
+    double garbageRate;
+    std::string reportFilename;  /* JSON report, empty = no report */
+};
+
+typedef struct VUPRS_BENCH__Result
+{
+    std::string kernel;
+    std::string variant;
+    uint64_t frames;  /* Frames processed per run */
+    uint64_t bytes;  /* Input bytes processed per run */
+    double time_s;  /* Best run */
+    double cycles;  /* Cycles of the best run, 0 = not available */
+    int match;  /* 1: equals the reference, 0: mismatch, -1: no reference */
+};
+
+/**
+ * @brief Core cycles of the process, perf_event_open when the kernel allows it, time * cpufreq otherwise.
+ * @note Threads created after Start() are counted too (inherit), so the multi-threaded parse reports
+ *       the cycles of all cores.
+ */
+class VUPRS_BENCH__CycleCounter
+{
+    private:
+
+        int perf_fd;
+        double maxFrequency_Hz;
+        std::chrono::steady_clock::time_point startTime;
+
+    public:
+
+        VUPRS_BENCH__CycleCounter() : perf_fd(-1), maxFrequency_Hz(0)
+        {
+
+#ifdef __linux__
+
+            struct perf_event_attr attribute;
+
+            memset(&attribute, 0, sizeof(attribute));
+            attribute.type = PERF_TYPE_HARDWARE;
+            attribute.size = sizeof(attribute);
+            attribute.config = PERF_COUNT_HW_CPU_CYCLES;
+            attribute.disabled = 1;
+            attribute.inherit = 1;
+            attribute.exclude_kernel = 1;
+            attribute.exclude_hv = 1;
+
+            this->perf_fd = static_cast<int>(syscall(__NR_perf_event_open, &attribute, 0, -1, -1, 0));
+
+#endif
+
+            std::ifstream frequencyFile("/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_max_freq");
+            std::ifstream cpuInfoFile("/proc/cpuinfo");
+            std::string cpuInfoLine;
+            uint64_t frequency_kHz = 0;
+
+            if (frequencyFile >> frequency_kHz)
+            {
+                this->maxFrequency_Hz = frequency_kHz * 1e3;
+            }
+
+            /* No cpufreq (VMs): clock of /proc/cpuinfo (x86 only) */
+
+            while (this->maxFrequency_Hz == 0 && std::getline(cpuInfoFile, cpuInfoLine))
+            {
+                if (cpuInfoLine.compare(0, 7, "cpu MHz") == 0 && cpuInfoLine.find(':') != std::string::npos)
+                {
+                    this->maxFrequency_Hz = atof(cpuInfoLine.c_str() + cpuInfoLine.find(':') + 1) * 1e6;
+                }
+            }
+        }
+
+        ~VUPRS_BENCH__CycleCounter()
+        {
+            if (this->perf_fd >= 0)
+            {
+                close(this->perf_fd);
+            }
+        }
+
+        const char *Source() const
+        {
+            return this->perf_fd >= 0 ? VUPRS_BENCH_CYCLES__PERF : (this->maxFrequency_Hz > 0 ? VUPRS_BENCH_CYCLES__CPUFREQ : VUPRS_BENCH_CYCLES__NONE);
+        }
+
+        void Start()
+        {
+
+#ifdef __linux__
+
+            if (this->perf_fd >= 0)
+            {
+                ioctl(this->perf_fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(this->perf_fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+
+#endif
+
+            this->startTime = std::chrono::steady_clock::now();
+        }
+
+        /**
+         * @brief Cycles since Start(), 0 when not available.
+         */
+        double Stop()
+        {
+            double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - this->startTime).count();
+            uint64_t cycles = 0;
+
+#ifdef __linux__
+
+            if (this->perf_fd >= 0)
+            {
+                ioctl(this->perf_fd, PERF_EVENT_IOC_DISABLE, 0);
+
+                if (read(this->perf_fd, &cycles, sizeof(cycles)) == sizeof(cycles))
+                {
+                    return static_cast<double>(cycles);
+                }
+            }
+
+#endif
+
+            return elapsed_s * this->maxFrequency_Hz;
+        }
+};
+
+static VUPRS_BENCH__CycleCounter VUPRS_BENCH__Cycles;
+static std::vector<VUPRS_BENCH__Result> VUPRS_BENCH__Results;
+
+/**
+ * @brief Generate frames with valid CRC, broken CRC (crcErrorRate per data word) and garbage words between frames.
+ */
+std::vector<uint32_t> VUPRS_BENCH__GenerateFrames(const VUPRS_BENCH__Config &benchConfig)
+{
+    std::vector<uint32_t> words;
+    std::mt19937 random(VUPRS_BENCH_SEED);
+    std::bernoulli_distribution crcError(benchConfig.crcErrorRate), garbage(benchConfig.garbageRate);
+    vuprs::CRC8List crcList(CRC8_POLYNOMIAL_CDMA2000);
+    uint16_t value = 0;
+
+    words.reserve(benchConfig.frames * (ADC_FRAME_WORD_LENGTH + 1));
+
+    for (uint64_t f = 0; f < benchConfig.frames; f++)
+    {
+        if (garbage(random))
+        {
+            words.push_back(random() | 0x00010000U);  /* Garbage word, never a header */
+        }
+
+        words.push_back(ADC_DATA_HEADER);
+
+        for (uint32_t c = 0; c < ADC_CHANNELS; c++)
+        {
+            value = static_cast<uint16_t>(random());
+            words.push_back((static_cast<uint32_t>(value) << 16) |
+                            (static_cast<uint32_t>(crcList.CRCValue(value >> 8)) << 8) |
+                            crcList.CRCValue(value & 0xFF));
+
+            if (crcError(random))
+            {
+                words.back() ^= 1U << (random() % 16);  /* Broken CRC */
+            }
+        }
+
+        words.push_back(ADC_DATA_TAILER);
+    }
+
+    return words;
+}
+
+/**
+ * @brief Generate frames of any layout (header, frameFeatures.channels data words with CRC, tailer), a broken CRC per
+ *        crcErrorRate data words and garbage words between frames.
+ */
+std::vector<uint32_t> VUPRS_BENCH__GenerateLayoutFrames(const VUPRS_BENCH__Config &benchConfig, const vuprs::FPGAhardwareConfigFrame &frameFeatures)
+{
+    std::vector<uint32_t> words;
+    std::mt19937 random(VUPRS_BENCH_SEED + 2);
+    std::bernoulli_distribution crcError(benchConfig.crcErrorRate), garbage(benchConfig.garbageRate);
+
+    words.reserve(benchConfig.frames * (frameFeatures.channels + 3));
+
+    for (uint64_t f = 0; f < benchConfig.frames; f++)
+    {
+        if (garbage(random))
+        {
+            words.push_back(static_cast<uint32_t>(frameFeatures.header) ^ (random() | 1U));  /* Garbage word, never a header */
+        }
+
+        words.push_back(static_cast<uint32_t>(frameFeatures.header));
+
+        for (uint64_t c = 0; c < frameFeatures.channels; c++)
+        {
+            words.push_back(vuprs::EncodeADCDataWord(static_cast<int32_t>(random()), frameFeatures.dataWidth_bits));
+
+            if (crcError(random))
+            {
+                words.back() ^= 1U << (31 - random() % 16);  /* Broken CRC */
+            }
+        }
+
+        words.push_back(static_cast<uint32_t>(frameFeatures.tailer));
+    }
+
+    return words;
+}
+
+/**
+ * @brief Corrupt a frame stream like a link that loses sync: bursts of random words (up to
+ *        VUPRS_BENCH_CORRUPT_BURST_WORDS, with fake headers) and dropped words (frames cut short).
+ */
+std::vector<uint32_t> VUPRS_BENCH__CorruptFrames(const std::vector<uint32_t> &words)
+{
+    std::vector<uint32_t> corrupted;
+    std::mt19937 random(VUPRS_BENCH_SEED + 1);
+    std::bernoulli_distribution burst(VUPRS_BENCH_CORRUPT_BURST_RATE), drop(VUPRS_BENCH_CORRUPT_DROP_RATE), fakeHeader(1.0 / 256);
+    std::uniform_int_distribution<uint32_t> burstWords(1, VUPRS_BENCH_CORRUPT_BURST_WORDS);
+
+    corrupted.reserve(words.size() + words.size() / 8);
+
+    for (const uint32_t &word : words)
+    {
+        if (burst(random))
+        {
+            for (uint32_t i = burstWords(random); i > 0; i--)
+            {
+                corrupted.push_back(fakeHeader(random) ? ADC_DATA_HEADER : (random() | 0x00010000U));
+            }
+        }
+        if (!drop(random))
+        {
+            corrupted.push_back(word);
+        }
+    }
+
+    return corrupted;
+}
+
+/**
+ * @brief ADCFrame as it was before (three vectors per frame), kept to compare the per-frame cost.
+ */
+class VUPRS_BENCH__LegacyADCFrame
+{
+    public:
+
+        std::vector<uint16_t> adcData;
+        std::vector<uint8_t> crcDataH, crcDataL;
+
+        VUPRS_BENCH__LegacyADCFrame() : adcData(ADC_CHANNELS), crcDataH(ADC_CHANNELS), crcDataL(ADC_CHANNELS) {}
+
+        void UpdateData(const int &index, const uint32_t &data)
+        {
+            this->adcData[index] = (uint16_t)((data & 0xFFFF0000) >> 16);
+            this->crcDataH[index] = (uint8_t)((data & 0x0000FF00) >> 8);
+            this->crcDataL[index] = (uint8_t)((data & 0x000000FF));
+        }
+};
+
+/**
+ * @brief Best time (s) of VUPRS_BENCH_REPEAT runs.
+ * @param cycles cycles of the best run (optional).
+ */
+double VUPRS_BENCH__BestTime(const std::function<void()> &function, double *cycles = nullptr)
+{
+    double best = 1e30, runCycles = 0;
+
+    for (uint32_t r = 0; r < VUPRS_BENCH_REPEAT; r++)
+    {
+        VUPRS_BENCH__Cycles.Start();
+        std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+        function();
+        double runTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        runCycles = VUPRS_BENCH__Cycles.Stop();
+
+        if (runTime < best)
+        {
+            best = runTime;
+            if (cycles != nullptr) *cycles = runCycles;
+        }
+    }
+
+    return best;
+}
+
+/**
+ * @brief Print a result row (ns/frame, MB/s, cycles/byte) and keep it for the JSON report.
+ */
+void VUPRS_BENCH__Report(const std::string &kernel, const std::string &variant, const uint64_t &frames, const uint64_t &bytes,
+                         const double &time_s, const double &cycles, const int &match, const std::string &note = "")
+{
+    VUPRS_BENCH__Result result = {kernel, variant, frames, bytes, time_s, cycles, match};
+
+    VUPRS_BENCH__Results.push_back(result);
+
+    char cyclesPerByte[16] = "-";
+
+    if (cycles > 0)
+    {
+        snprintf(cyclesPerByte, sizeof(cyclesPerByte), "%.2f", cycles / bytes);
+    }
+
+printf("   %-7s %-8s %9.1f %10.1f %9s  %-14s %s\n", kernel.c_str(), variant.c_str(),
+       frames > 0 ? time_s / frames * 1e9 : 0.0, bytes / time_s / 1e6, cyclesPerByte, note.c_str(),
+       match < 0 ? "" : (match ? "\033[92mMATCH\033[0m" : "\033[31mMISMATCH\033[0m"));
+}
+
+/**
+ * @brief Save all results as JSON (x86 & board runs are compared on these files).
+ */
+bool VUPRS_BENCH__SaveReport(const VUPRS_BENCH__Config &benchConfig, const uint64_t &bufferBytes, const bool &allMatch)
+{
+    nlohmann::json reportJsonData, kernelsJsonData = nlohmann::json::object(), resultsJsonData = nlohmann::json::array();
+    std::ofstream reportFile(benchConfig.reportFilename, std::ios::trunc);
+    struct utsname systemName;
+
+    if (!reportFile.is_open())
+    {
+        return false;
+    }
+
+    reportJsonData["description"] = "VUPRS Kernel Benchmark Report";
+    reportJsonData["kernel-release"] = uname(&systemName) == 0 ? systemName.release : "unknown";
+    reportJsonData["machine"] = uname(&systemName) == 0 ? systemName.machine : "unknown";
+    reportJsonData["cpu-features"] = vuprs::CPUFeaturesString(vuprs::DetectCPUFeatures());
+    reportJsonData["force-scalar"] = vuprs::CPUForceScalar();
+    reportJsonData["hardware-threads"] = std::thread::hardware_concurrency();
+
+    for (const std::pair<std::string, std::string> &kernel : vuprs::ActiveCPUKernels())
+    {
+        kernelsJsonData[kernel.first] = kernel.second;
+    }
+    reportJsonData["kernels"] = kernelsJsonData;
+
+    reportJsonData["frames"] = benchConfig.frames;
+    reportJsonData["crc-error-rate"] = benchConfig.crcErrorRate;
+    reportJsonData["garbage-rate"] = benchConfig.garbageRate;
+    reportJsonData["buffer-bytes"] = bufferBytes;
+    reportJsonData["repeat"] = VUPRS_BENCH_REPEAT;
+    reportJsonData["cycles-source"] = VUPRS_BENCH__Cycles.Source();
+
+    for (const VUPRS_BENCH__Result &result : VUPRS_BENCH__Results)
+    {
+        resultsJsonData.push_back({
+            {"kernel", result.kernel},
+            {"variant", result.variant},
+            {"frames", result.frames},
+            {"bytes", result.bytes},
+            {"time-s", result.time_s},
+            {"ns-per-frame", result.frames > 0 ? result.time_s / result.frames * 1e9 : 0.0},
+            {"bytes-per-second", result.bytes / result.time_s},
+            {"cycles-per-byte", result.cycles > 0 ? nlohmann::json(result.cycles / result.bytes) : nlohmann::json(nullptr)},
+            {"match", result.match < 0 ? nlohmann::json(nullptr) : nlohmann::json(result.match == 1)}
+        });
+    }
+    reportJsonData["results"] = resultsJsonData;
+    reportJsonData["all-match"] = allMatch;
+
+    reportFile << reportJsonData.dump(4) << std::endl;
+
+    return reportFile.good();
+}
+
+int main(int argc, char *argv[])
+{
+    VUPRS_BENCH__Config benchConfig = {VUPRS_BENCH_DEFAULT_FRAMES, VUPRS_BENCH_DEFAULT_CRC_ERROR_RATE, VUPRS_BENCH_DEFAULT_GARBAGE_RATE, ""};
+    bool parseStatus = true, allMatch = true;
+
+    /* vuprs_bench [--frames <n>] [--crc-error-rate <r>] [--garbage-rate <r>] [--report <json>] */
+
+    for (int i = 1; i < argc && parseStatus; i += 2)
+    {
+        std::string option(argv[i]);
+
+        if (i + 1 >= argc)
+        {
+            parseStatus = false;
+        }
+        else if (option == "--frames")
+        {
+            benchConfig.frames = vuprs::ParseNumberFromString(argv[i + 1], &parseStatus);
+        }
+        else if (option == "--crc-error-rate")
+        {
+            benchConfig.crcErrorRate = vuprs::ParseDecimalFromString(argv[i + 1], &parseStatus);
+        }
+        else if (option == "--garbage-rate")
+        {
+            benchConfig.garbageRate = vuprs::ParseDecimalFromString(argv[i + 1], &parseStatus);
+        }
+        else if (option == "--report")
+        {
+            benchConfig.reportFilename = argv[i + 1];
+        }
+        else
+        {
+            parseStatus = false;
+        }
+    }
+
+    if (!parseStatus || benchConfig.frames == 0 ||
+        !(benchConfig.crcErrorRate >= 0 && benchConfig.crcErrorRate <= 1) ||
+        !(benchConfig.garbageRate >= 0 && benchConfig.garbageRate <= 1))
+    {
+std::cout << " Usage: vuprs_bench [--frames <n>] [--crc-error-rate <0~1>] [--garbage-rate <0~1>] [--report <json>]" << std::endl;
+        return 0;
+    }
+
+    const uint64_t frameCount = benchConfig.frames;
+    std::vector<uint32_t> words = VUPRS_BENCH__GenerateFrames(benchConfig);
+    const uint64_t wordBytes = words.size() * sizeof(uint32_t);
+    std::vector<uint64_t> frameOffsetsScalar, frameOffsetsSIMD;
+    std::vector<uint16_t> passMasksScalar, passMasksSIMD;
+    double scalarTime = 0, simdTime = 0, scalarCycles = 0, simdCycles = 0;
+    char note[64] = {0};
+
+    frameOffsetsScalar.reserve(frameCount);
+    frameOffsetsSIMD.reserve(frameCount);
+
+printf(" | --------------------------------------------------------------------- |\n");
+printf("                           [\033[92mVUPRS BENCHMARK\033[0m]\n");
+printf("\n");
+printf("   <frames>     \033[33m%lu\033[0m (%.1f MB), crc errors %g, garbage %g\n", static_cast<unsigned long>(frameCount), wordBytes / 1e6,
+       benchConfig.crcErrorRate, benchConfig.garbageRate);
+printf("   <cpu>        %s%s\n", vuprs::CPUFeaturesString(vuprs::DetectCPUFeatures()).c_str(),
+       vuprs::CPUForceScalar() ? " (" CPU_DISPATCH_FORCE_SCALAR_ENV ")" : "");
+for (const std::pair<std::string, std::string> &kernel : vuprs::ActiveCPUKernels())
+{
+printf("   <kernel>     %-20s %s\n", kernel.first.c_str(), kernel.second.c_str());
+}
+printf("   <cycles>     %s\n", VUPRS_BENCH__Cycles.Source());
+printf("\n");
+printf("   %-7s %-8s %9s %10s %9s\n", "kernel", "variant", "ns/frame", "MB/s", "cyc/B");
+
+    /* Frame locate */
+
+    scalarTime = VUPRS_BENCH__BestTime([&]()
+    {
+        frameOffsetsScalar.clear();
+        vuprs::LocateADCFramesScalar(words.data(), words.size(), &frameOffsetsScalar);
+    }, &scalarCycles);
+    simdTime = VUPRS_BENCH__BestTime([&]()
+    {
+        frameOffsetsSIMD.clear();
+        vuprs::LocateADCFrames(words.data(), words.size(), &frameOffsetsSIMD);
+    }, &simdCycles);
+
+    allMatch = allMatch && (frameOffsetsScalar == frameOffsetsSIMD);
+
+    VUPRS_BENCH__Report("locate", "scalar", frameOffsetsScalar.size(), wordBytes, scalarTime, scalarCycles, -1);
+    VUPRS_BENCH__Report("locate", "simd", frameOffsetsSIMD.size(), wordBytes, simdTime, simdCycles, frameOffsetsScalar == frameOffsetsSIMD);
+
+    /* Frame locate, corrupted stream (differential check of the resync paths) */
+
+    {
+        const std::vector<uint32_t> corruptedWords = VUPRS_BENCH__CorruptFrames(words);
+        const uint64_t corruptedBytes = corruptedWords.size() * sizeof(uint32_t);
+        std::vector<uint64_t> corruptedScalar, corruptedSIMD;
+        uint64_t stopScalar = 0, stopSIMD = 0;
+
+        corruptedScalar.reserve(frameCount);
+        corruptedSIMD.reserve(frameCount);
+
+        scalarTime = VUPRS_BENCH__BestTime([&]()
+        {
+            corruptedScalar.clear();
+            stopScalar = vuprs::LocateADCFramesScalar(corruptedWords.data(), corruptedWords.size(), &corruptedScalar);
+        }, &scalarCycles);
+        simdTime = VUPRS_BENCH__BestTime([&]()
+        {
+            corruptedSIMD.clear();
+            stopSIMD = vuprs::LocateADCFrames(corruptedWords.data(), corruptedWords.size(), &corruptedSIMD);
+        }, &simdCycles);
+
+        const bool corruptedMatch = (corruptedScalar == corruptedSIMD) && (stopScalar == stopSIMD);
+
+        allMatch = allMatch && corruptedMatch;
+
+        VUPRS_BENCH__Report("locate", "scalar", corruptedScalar.size(), corruptedBytes, scalarTime, scalarCycles, -1, "corrupted");
+        VUPRS_BENCH__Report("locate", "simd", corruptedSIMD.size(), corruptedBytes, simdTime, simdCycles, corruptedMatch, "corrupted");
+    }
+
+    /* CRC check */
+
+    const uint64_t dataBytes = frameOffsetsScalar.size() * ADC_CHANNELS * sizeof(uint32_t);  /* Data words of the located frames */
+
+    passMasksScalar.resize(frameOffsetsScalar.size());
+    passMasksSIMD.resize(frameOffsetsScalar.size());
+
+    scalarTime = VUPRS_BENCH__BestTime([&]()
+    {
+        for (uint64_t i = 0; i < frameOffsetsScalar.size(); i++)
+        {
+            passMasksScalar[i] = vuprs::CheckADCFrameCRCScalar(words.data() + frameOffsetsScalar[i] + 1);
+        }
+    }, &scalarCycles);
+    simdTime = VUPRS_BENCH__BestTime([&]()
+    {
+        vuprs::CheckADCFramesCRC(words.data(), frameOffsetsScalar.data(), frameOffsetsScalar.size(), passMasksSIMD.data());
+    }, &simdCycles);
+
+    allMatch = allMatch && (passMasksScalar == passMasksSIMD);
+
+    VUPRS_BENCH__Report("crc", "scalar", passMasksScalar.size(), dataBytes, scalarTime, scalarCycles, -1);
+    VUPRS_BENCH__Report("crc", "simd", passMasksSIMD.size(), dataBytes, simdTime, simdCycles, passMasksScalar == passMasksSIMD);
+
+    /* CRC8List: table lookup of every value byte (how the frames are encoded), pass masks must match */
+
+    vuprs::CRC8List crcList(CRC8_POLYNOMIAL_CDMA2000);
+    std::vector<uint16_t> passMasksTable(frameOffsetsScalar.size());
+
+    scalarTime = VUPRS_BENCH__BestTime([&]()
+    {
+        for (uint64_t i = 0; i < frameOffsetsScalar.size(); i++)
+        {
+            const uint32_t *data = words.data() + frameOffsetsScalar[i] + 1;
+            uint16_t passMask = 0;
+
+            for (uint32_t c = 0; c < ADC_CHANNELS; c++)
+            {
+                const uint8_t valueHigh = static_cast<uint8_t>(data[c] >> 24), valueLow = static_cast<uint8_t>(data[c] >> 16);
+
+                if (crcList.CRCValue(valueHigh) == static_cast<uint8_t>(data[c] >> 8) && crcList.CRCValue(valueLow) == static_cast<uint8_t>(data[c]))
+                {
+                    passMask |= static_cast<uint16_t>(1U << c);
+                }
+            }
+
+            passMasksTable[i] = passMask;
+        }
+    }, &scalarCycles);
+
+    allMatch = allMatch && (passMasksTable == passMasksScalar);
+
+    VUPRS_BENCH__Report("crc", "crc8list", passMasksTable.size(), dataBytes, scalarTime, scalarCycles, passMasksTable == passMasksScalar);
+
+    /* Frame decode: legacy frame objects vs POD frame vs in place (checksum of all values must match) */
+
+    std::vector<VUPRS_BENCH__LegacyADCFrame> legacyFrames;
+    std::vector<vuprs::ADCFrame> podFrames;
+    uint64_t legacySum = 0, podSum = 0, inPlaceSum = 0;
+    double inPlaceTime = 0, inPlaceCycles = 0;
+
+    podFrames.reserve(frameOffsetsScalar.size());
+
+    scalarTime = VUPRS_BENCH__BestTime([&]()
+    {
+        legacyFrames.clear();
+        for (uint64_t i = 0; i < frameOffsetsScalar.size(); i++)
+        {
+            VUPRS_BENCH__LegacyADCFrame oneADCFrame;
+            for (int c = 0; c < static_cast<int>(ADC_CHANNELS); c++)
+            {
+                oneADCFrame.UpdateData(c, words[frameOffsetsScalar[i] + 1 + c]);
+            }
+            legacyFrames.push_back(oneADCFrame);
+        }
+    }, &scalarCycles);
+    simdTime = VUPRS_BENCH__BestTime([&]()
+    {
+        podFrames.clear();
+        for (uint64_t i = 0; i < frameOffsetsScalar.size(); i++)
+        {
+            vuprs::ADCFrame oneADCFrame;
+            oneADCFrame.UpdateFrame(words.data() + frameOffsetsScalar[i] + 1);
+            podFrames.push_back(oneADCFrame);
+        }
+    }, &simdCycles);
+    inPlaceTime = VUPRS_BENCH__BestTime([&]()
+    {
+        inPlaceSum = 0;
+        for (uint64_t i = 0; i < frameOffsetsScalar.size(); i++)
+        {
+            const vuprs::ADCFrameWords *frame = reinterpret_cast<const vuprs::ADCFrameWords*>(words.data() + frameOffsetsScalar[i]);
+            for (uint32_t c = 0; c < ADC_CHANNELS; c++)
+            {
+                inPlaceSum += static_cast<uint16_t>(frame->Value(c));
+            }
+        }
+    }, &inPlaceCycles);
+
+    for (uint64_t i = 0; i < frameOffsetsScalar.size(); i++)
+    {
+        for (int c = 0; c < static_cast<int>(ADC_CHANNELS); c++)
+        {
+            legacySum += legacyFrames[i].adcData[c];
+            podSum += podFrames[i].GetChannelValue(c);
+        }
+    }
+
+    allMatch = allMatch && (legacySum == podSum) && (podSum == inPlaceSum);
+
+    VUPRS_BENCH__Report("frame", "legacy", frameOffsetsScalar.size(), dataBytes, scalarTime, scalarCycles, -1);
+    VUPRS_BENCH__Report("frame", "pod", frameOffsetsScalar.size(), dataBytes, simdTime, simdCycles, legacySum == podSum);
+    VUPRS_BENCH__Report("frame", "inplace", frameOffsetsScalar.size(), dataBytes, inPlaceTime, inPlaceCycles, podSum == inPlaceSum);
+
+    legacyFrames.clear();
+    legacyFrames.shrink_to_fit();
+
+    /* Parse to channels, vector<vector> vs channel-major buffer (reused) */
+
+    vuprs::AlignedBufferDMA buffer(words.size() * sizeof(uint32_t));
+    vuprs::FPGAhardwareConfigADC adcFeatures;
+    std::vector<std::vector<double>> channelsVector;
+    vuprs::ADCChannelBuffer<double> channelsBuffer;
+    bool parseMatch = true;
+
+    memcpy(buffer.data(), words.data(), words.size() * sizeof(uint32_t));
+    adcFeatures.configdown = true;
+    adcFeatures.adcVoltageRangeRadius = 10.0;
+
+    scalarTime = VUPRS_BENCH__BestTime([&]()
+    {
+        vuprs::BufferData2ADCChannels(&buffer, &channelsVector, adcFeatures);
+    }, &scalarCycles);
+    simdTime = VUPRS_BENCH__BestTime([&]()
+    {
+        vuprs::BufferData2ADCChannels(&buffer, &channelsBuffer, adcFeatures);
+    }, &simdCycles);
+
+    for (uint64_t c = 0; c < ADC_CHANNELS && parseMatch; c++)
+    {
+        parseMatch = channelsVector[c].size() == channelsBuffer.samples() &&
+                     memcmp(channelsVector[c].data(), channelsBuffer.channel(c), channelsBuffer.samples() * sizeof(double)) == 0;
+    }
+
+    allMatch = allMatch && parseMatch;
+
+    VUPRS_BENCH__Report("parse", "vector", channelsVector[0].size(), wordBytes, scalarTime, scalarCycles, -1);
+    VUPRS_BENCH__Report("parse", "soa", channelsBuffer.samples(), wordBytes, simdTime, simdCycles, parseMatch);
+
+    /* Parse with the frame layout of the config (default layout), the layout kernel must cost nothing */
+
+    vuprs::ADCChannelBuffer<double> channelsLayout;
+    vuprs::FPGAhardwareConfigFrame frameFeatures = vuprs::DefaultFrameFeatures();
+    bool layoutMatch = true;
+
+    simdTime = VUPRS_BENCH__BestTime([&]()
+    {
+        vuprs::BufferData2ADCChannels(&buffer, &channelsLayout, adcFeatures, frameFeatures);
+    }, &simdCycles);
+
+    for (uint64_t c = 0; c < ADC_CHANNELS && layoutMatch; c++)
+    {
+        layoutMatch = channelsLayout.samples() == channelsBuffer.samples() &&
+                      memcmp(channelsLayout.channel(c), channelsBuffer.channel(c), channelsBuffer.samples() * sizeof(double)) == 0;
+    }
+
+    allMatch = allMatch && layoutMatch;
+
+    VUPRS_BENCH__Report("parse", "layout", channelsLayout.samples(), wordBytes, simdTime, simdCycles, layoutMatch);
+
+    /* Parse with all cores, must equal the single thread parse */
+
+    vuprs::ADCChannelBuffer<double> channelsParallel;
+    bool parallelMatch = true;
+
+    simdTime = VUPRS_BENCH__BestTime([&]()
+    {
+        vuprs::BufferData2ADCChannels(&buffer, &channelsParallel, adcFeatures, 0);
+    }, &simdCycles);
+
+    for (uint64_t c = 0; c < ADC_CHANNELS && parallelMatch; c++)
+    {
+        parallelMatch = channelsParallel.samples() == channelsBuffer.samples() &&
+                        memcmp(channelsParallel.channel(c), channelsBuffer.channel(c), channelsBuffer.samples() * sizeof(double)) == 0;
+    }
+
+    allMatch = allMatch && parallelMatch;
+
+    VUPRS_BENCH__Report("parse", "soa x" + std::to_string(std::thread::hardware_concurrency()), channelsParallel.samples(), wordBytes, simdTime, simdCycles, parallelMatch);
+
+    /* Parse chunk by chunk (StreamDDRToADCChannels() without DMA), the first samples are ready after one chunk */
+
+    vuprs::ADCChannelBuffer<double> channelsChunk;
+    const uint64_t chunkWords = DMA_STREAM_PARSE_CHUNK_BYTES / sizeof(uint32_t);
+    double firstChunkTime = 1e30;
+    bool chunkMatch = true;
+
+    simdTime = VUPRS_BENCH__BestTime([&]()
+    {
+        std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+        uint64_t position = 0, stopPosition = 0, wordCount = 0, sample = 0;
+
+        chunkMatch = true;
+
+        while (true)
+        {
+            wordCount = std::min(chunkWords, static_cast<uint64_t>(words.size()) - position);
+
+            vuprs::WordsData2ADCChannels(words.data() + position, wordCount, &channelsChunk, adcFeatures, frameFeatures, &stopPosition);
+
+            if (position == 0)
+            {
+                firstChunkTime = std::min(firstChunkTime, std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count());
+            }
+
+            for (uint64_t c = 0; c < ADC_CHANNELS && chunkMatch; c++)
+            {
+                chunkMatch = sample + channelsChunk.samples() <= channelsBuffer.samples() &&
+                             memcmp(channelsChunk.channel(c), channelsBuffer.channel(c) + sample, channelsChunk.samples() * sizeof(double)) == 0;
+            }
+
+            sample += channelsChunk.samples();
+
+            if (position + wordCount == words.size())
+            {
+                break;
+            }
+            position += stopPosition;  /* Next chunk starts at the cut frame */
+        }
+
+        chunkMatch = chunkMatch && sample == channelsBuffer.samples();
+    }, &simdCycles);
+
+    allMatch = allMatch && chunkMatch;
+
+    snprintf(note, sizeof(note), "first %.1f us", firstChunkTime * 1e6);
+    VUPRS_BENCH__Report("parse", "chunked", channelsBuffer.samples(), wordBytes, simdTime, simdCycles, chunkMatch, note);
+
+    /* Parse a stream cut at random byte sizes (ADCStreamParser, frames & words cut by the chunks), the default layout and a
+       32-channel 24-bit layout in reversed storage order must equal the parse of the whole stream */
+
+    vuprs::FPGAhardwareConfigFrame wideFeatures = frameFeatures;
+    bool streamMatch = true;
+    uint64_t streamChunks = 0;
+
+    wideFeatures.channels = 32;
+    wideFeatures.dataWidth_bits = 24;
+    wideFeatures.header = 0xA5A5C3C3;
+    wideFeatures.tailer = 0x5A5A3C3C;
+    wideFeatures.storageOrder.resize(wideFeatures.channels);
+    for (uint64_t c = 0; c < wideFeatures.channels; c++)
+    {
+        wideFeatures.storageOrder[c] = wideFeatures.channels - 1 - c;
+    }
+
+    VUPRS_BENCH__Config wideConfig = benchConfig;
+    wideConfig.frames = std::min<uint64_t>(benchConfig.frames, 1U << 16);
+    const std::vector<uint32_t> wideWords = VUPRS_BENCH__GenerateLayoutFrames(wideConfig, wideFeatures);
+
+    auto streamParse = [&](const std::vector<uint32_t> &streamWords, const vuprs::FPGAhardwareConfigFrame &features, vuprs::ADCChannelBuffer<double> *result)
+    {
+        vuprs::ADCStreamParser streamParser(features);
+        std::mt19937 random(VUPRS_BENCH_SEED + 3);
+        std::uniform_int_distribution<uint64_t> chunkBytes(1, 2 * DMA_STREAM_PARSE_CHUNK_BYTES);
+        const uint8_t *bytes = reinterpret_cast<const uint8_t*>(streamWords.data());
+        const uint64_t byteCount = streamWords.size() * sizeof(uint32_t);
+        uint64_t position = 0, size = 0;
+
+        result->set_channels(features.channels);
+        result->clear();
+        streamChunks = 0;
+
+        while (position < byteCount)
+        {
+            size = std::min(byteCount - position, (streamChunks % 4 == 0) ? random() % 97 + 1 : chunkBytes(random));
+
+            streamParser.Feed(bytes + position, size, [&](const uint32_t *frameWords, const uint64_t *frameOffsets, const uint64_t &count)
+            {
+                vuprs::FramesData2ADCChannels(frameWords, frameOffsets, count, result, adcFeatures, features);
+            });
+
+            position += size;
+            streamChunks++;
+        }
+    };
+
+    auto sameChannels = [](const vuprs::ADCChannelBuffer<double> &a, const vuprs::ADCChannelBuffer<double> &b)
+    {
+        bool same = a.channels() == b.channels() && a.samples() == b.samples() && a.samples() > 0;
+
+        for (uint64_t c = 0; c < a.channels() && same; c++)
+        {
+            same = memcmp(a.channel(c), b.channel(c), a.samples() * sizeof(double)) == 0;
+        }
+
+        return same;
+    };
+
+    vuprs::ADCChannelBuffer<double> channelsStream, channelsWide, channelsWideExpected;
+    uint64_t wideStop = 0;
+
+    simdTime = VUPRS_BENCH__BestTime([&]()
+    {
+        streamParse(words, frameFeatures, &channelsStream);
+    }, &simdCycles);
+
+    streamMatch = sameChannels(channelsStream, channelsLayout);
+    snprintf(note, sizeof(note), "%lu cuts, 32ch", streamChunks);
+
+    vuprs::WordsData2ADCChannels(wideWords.data(), wideWords.size(), &channelsWideExpected, adcFeatures, wideFeatures, &wideStop);
+    streamParse(wideWords, wideFeatures, &channelsWide);
+
+    streamMatch = streamMatch && sameChannels(channelsWide, channelsWideExpected);
+
+    allMatch = allMatch && streamMatch;
+
+    VUPRS_BENCH__Report("parse", "stream", channelsStream.samples(), wordBytes, simdTime, simdCycles, streamMatch, note);
+
+    /* Raw codes (int16), volts at the edge must equal the direct double parse */
+
+    vuprs::ADCChannelBuffer<int16_t> codesBuffer;
+    vuprs::ADCChannelBuffer<double> voltageBuffer;
+    std::vector<uint16_t> crcPassMasks;
+    vuprs::ADCChannelScaling scaling = vuprs::ADCChannelScalingFromFeatures(adcFeatures);
+    bool voltageMatch = true;
+
+    scalarTime = VUPRS_BENCH__BestTime([&]()
+    {
+        vuprs::BufferData2ADCChannels(&buffer, &codesBuffer, &crcPassMasks);
+    }, &scalarCycles);
+    simdTime = VUPRS_BENCH__BestTime([&]()
+    {
+        vuprs::ADCChannelsToVoltage(codesBuffer, crcPassMasks, scaling, &voltageBuffer);
+    }, &simdCycles);
+
+    for (uint64_t c = 0; c < ADC_CHANNELS && voltageMatch; c++)
+    {
+        voltageMatch = voltageBuffer.samples() == channelsBuffer.samples() &&
+                       memcmp(voltageBuffer.channel(c), channelsBuffer.channel(c), channelsBuffer.samples() * sizeof(double)) == 0;
+    }
+
+    allMatch = allMatch && voltageMatch;
+
+    snprintf(note, sizeof(note), "%.1f MB out", codesBuffer.samples() * ADC_CHANNELS * sizeof(int16_t) / 1e6);
+    VUPRS_BENCH__Report("parse", "int16", codesBuffer.samples(), wordBytes, scalarTime, scalarCycles, -1, note);
+    snprintf(note, sizeof(note), "%.1f MB out", voltageBuffer.samples() * ADC_CHANNELS * sizeof(double) / 1e6);
+    VUPRS_BENCH__Report("volt", "double", voltageBuffer.samples(), codesBuffer.samples() * ADC_CHANNELS * sizeof(int16_t), simdTime, simdCycles, voltageMatch, note);
+
+    /* Calibrated int16 -> float (gain, offset, sensitivity & CRC masking in one pass), checked against a plain loop */
+
+    vuprs::FPGAhardwareConfigCalibration calibration = vuprs::DefaultCalibration(ADC_CHANNELS);
+    vuprs::ADCChannelBuffer<float> physicalBuffer;
+    bool physicalMatch = true;
+
+    for (uint64_t c = 0; c < ADC_CHANNELS; c++)
+    {
+        calibration.gain[c] = 1.0 + 0.001 * c;
+        calibration.offset_v[c] = -0.002 * c;
+        calibration.sensitivity[c] = 9.81;
+    }
+
+    vuprs::ADCChannelScaling calibratedScaling = vuprs::ADCChannelScalingFromCalibration(adcFeatures, calibration);
+
+    simdTime = VUPRS_BENCH__BestTime([&]()
+    {
+        vuprs::ADCChannelsToVoltage(codesBuffer, crcPassMasks, calibratedScaling, &physicalBuffer);
+    }, &simdCycles);
+
+    for (uint64_t c = 0; c < ADC_CHANNELS && physicalMatch; c++)
+    {
+        const float scale = static_cast<float>(calibratedScaling.scale[c]), offset = static_cast<float>(calibratedScaling.offset[c]);
+
+        for (uint64_t i = 0; i < codesBuffer.samples() && physicalMatch; i++)
+        {
+            float expected = ((crcPassMasks[i] >> c) & 1U) ? static_cast<float>(codesBuffer.at(c, i)) * scale + offset
+                                                            : static_cast<float>(calibratedScaling.crcFailVoltage);
+            float physical = physicalBuffer.at(c, i);
+
+            physicalMatch = memcmp(&expected, &physical, sizeof(float)) == 0;
+        }
+    }
+
+    allMatch = allMatch && physicalMatch;
+
+    snprintf(note, sizeof(note), "%.1f MB out", physicalBuffer.samples() * ADC_CHANNELS * sizeof(float) / 1e6);
+    VUPRS_BENCH__Report("phys", "float", physicalBuffer.samples(), codesBuffer.samples() * ADC_CHANNELS * sizeof(int16_t), simdTime, simdCycles, physicalMatch, note);
+
+    /* Calibrated parse of the stream path (words -> physical values), checked against the codes & scaling above */
+
+    vuprs::ADCChannelBuffer<double> calibratedBuffer, calibratedExpected;
+    uint64_t calibratedStop = 0;
+    bool calibratedMatch = true;
+
+    simdTime = VUPRS_BENCH__BestTime([&]()
+    {
+        vuprs::WordsData2ADCChannels(words.data(), words.size(), &calibratedBuffer, adcFeatures, frameFeatures, calibration, &calibratedStop);
+    }, &simdCycles);
+
+    vuprs::ADCChannelsToVoltage(codesBuffer, crcPassMasks, calibratedScaling, &calibratedExpected);
+
+    for (uint64_t c = 0; c < ADC_CHANNELS && calibratedMatch; c++)
+    {
+        calibratedMatch = calibratedBuffer.samples() == calibratedExpected.samples();
+
+        for (uint64_t i = 0; i < calibratedBuffer.samples() && calibratedMatch; i++)
+        {
+            double expected = calibratedExpected.at(c, i), physical = calibratedBuffer.at(c, i);
+
+            calibratedMatch = (std::isnan(expected) && std::isnan(physical)) || memcmp(&expected, &physical, sizeof(double)) == 0;
+        }
+    }
+
+    allMatch = allMatch && calibratedMatch;
+
+    VUPRS_BENCH__Report("parse", "calib", calibratedBuffer.samples(), wordBytes, simdTime, simdCycles, calibratedMatch);
+
+printf("\n");
+
+    if (!benchConfig.reportFilename.empty())
+    {
+        if (VUPRS_BENCH__SaveReport(benchConfig, wordBytes, allMatch))
+        {
+printf("   <report>     %s\n", benchConfig.reportFilename.c_str());
+        }
+        else
+        {
+printf("   <report>     \033[31mCannot write %s\033[0m\n", benchConfig.reportFilename.c_str());
+            allMatch = false;
+        }
+printf("\n");
+    }
+
+printf(" | --------------------------------------------------------------------- |\n");
+
+    return allMatch ? 0 : 1;
+}
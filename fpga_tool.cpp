@@ -3,6 +3,12 @@
 #include "fpga_config.h"
 #include "fpga_control.h"
 #include "aligned_data_structure.h"
+#include "dma_capture_recorder.h"
+#include "dma_autotune.h"
+#include "dma_stream.h"
+#include "dma_benchmark.h"
+#include "dma_memtest.h"
+#include "dma_selftest.h"
 
 #define FPGA_TOOL__OPERATE__READ_AXI_LITE           0U
 #define FPGA_TOOL__OPERATE__WRITE_AXI_LITE          1U
@@ -10,6 +16,10 @@
 #define FPGA_TOOL__OPERATE__WRITE_AXI_FULL          4U
 #define FPGA_TOOL__OPERATE__ERROR                   5U
 #define FPGA_TOOL__OPERATE__FOR_HELP                6U
+#define FPGA_TOOL__OPERATE__TUNE_DMA                7U
+#define FPGA_TOOL__OPERATE__BENCH_DMA               8U
+#define FPGA_TOOL__OPERATE__MEMTEST_DDR             9U
+#define FPGA_TOOL__OPERATE__SELFTEST_DMA            10U
 
 /* Check command */
 
@@ -31,6 +41,24 @@
 #define IS__FPGA_TOOL__OPERATE__WRITE_AXI_FULL_CMD(STR_LIST) \
 (IS__FPGA_TOOL__OPERATE__READ_AXI_FULL_CMD(STR_LIST))
 
+#define IS__FPGA_TOOL__OPERATE__TUNE_DMA_CMD(STR_LIST) \
+(STR_LIST[1] == "--TUNE" && STR_LIST[2] == "--CFG")
+
+#define IS__FPGA_TOOL__OPERATE__TUNE_DMA_CACHE_CMD(STR_LIST) \
+(IS__FPGA_TOOL__OPERATE__TUNE_DMA_CMD(STR_LIST) && STR_LIST[4] == "--CACHE")
+
+#define IS__FPGA_TOOL__OPERATE__BENCH_DMA_CMD(STR_LIST) \
+(STR_LIST[1] == "--BENCH" && STR_LIST[2] == "--CFG")
+
+#define IS__FPGA_TOOL__OPERATE__BENCH_DMA_REPORT_CMD(STR_LIST) \
+(IS__FPGA_TOOL__OPERATE__BENCH_DMA_CMD(STR_LIST) && STR_LIST[4] == "--REPORT")
+
+#define IS__FPGA_TOOL__OPERATE__MEMTEST_DDR_CMD(STR_LIST) \
+(STR_LIST[1] == "--MEMTEST" && STR_LIST[2] == "--CFG")
+
+#define IS__FPGA_TOOL__OPERATE__SELFTEST_DMA_CMD(STR_LIST) \
+(STR_LIST[1] == "--SELFTEST" && STR_LIST[2] == "--CFG")
+
 /* Parse operation */
 
 #define IS__FPGA_TOOL__OPERATE__READ_AXI_LITE(STR_LIST) \
@@ -56,6 +84,8 @@ typedef struct FPGA_TOOL_AXIParameters
 
     std::string configFileName;  /* Config JSON file name */
     std::string datafileName;  /* Source data file (AXI-Full only) */
+    std::string cacheFileName;  /* DMA tuning cache file (--tune only, empty = from config) */
+    std::string reportFileName;  /* JSON report file (--bench only, empty = no report) */
 };
 
 void FPGA_TOOL__PrintHelp();
@@ -103,6 +133,64 @@ printf(" |
 printf(" | fpga-tool --rw \033[33mw\033[0m --bus \033[33mfull\033[0m --cfg \033[33m./cfg.json\033[0m --offset \033[33m0\033[0m --bytes \033[33m1024\033[0m  |\n");
 printf(" |           --io \033[33m./w_data.bin\033[0m                                           |\n");
 printf(" |                                                                       |\n");
+printf(" | ----- [ 3. Tune DMA Transfer Parameters ] --------------------------- |\n");
+printf(" |                                                                       |\n");
+printf(" | [ \033[92mCOMMAND\033[0m ]                                                           |\n");
+printf(" |                                                                       |\n");
+printf(" | fpga-tool --tune --cfg <cfg> [--cache <ca>]                           |\n");
+printf(" |                                                                       |\n");
+printf(" | [ \033[92mPARAMETERS\033[0m ]                                                        |\n");
+printf(" |                                                                       |\n");
+printf(" | <cf> config JSON file;                                                |\n");
+printf(" | <ca> tuning cache file (default: \"tuning-cache-file\" in config);      |\n");
+printf(" |                                                                       |\n");
+printf(" | [ \033[92mEXAMPLE\033[0m ]                                                           |\n");
+printf(" |                                                                       |\n");
+printf(" | fpga-tool --tune --cfg \033[33m./cfg.json\033[0m --cache \033[33m./dma_tuning_cache.json\033[0m      |\n");
+printf(" |                                                                       |\n");
+printf(" | ----- [ 4. DMA Benchmark ] ------------------------------------------ |\n");
+printf(" |                                                                       |\n");
+printf(" | [ \033[92mCOMMAND\033[0m ]                                                           |\n");
+printf(" |                                                                       |\n");
+printf(" | fpga-tool --bench --cfg <cfg> [--report <re>]                         |\n");
+printf(" |                                                                       |\n");
+printf(" | [ \033[92mPARAMETERS\033[0m ]                                                        |\n");
+printf(" |                                                                       |\n");
+printf(" | <cf> config JSON file;                                                |\n");
+printf(" | <re> JSON report file (optional);                                     |\n");
+printf(" |                                                                       |\n");
+printf(" | [ \033[92mEXAMPLE\033[0m ]                                                           |\n");
+printf(" |                                                                       |\n");
+printf(" | fpga-tool --bench --cfg \033[33m./cfg.json\033[0m --report \033[33m./dma_bench.json\033[0m           |\n");
+printf(" |                                                                       |\n");
+printf(" | ----- [ 5. DDR Memory Test ] ---------------------------------------- |\n");
+printf(" |                                                                       |\n");
+printf(" | [ \033[92mCOMMAND\033[0m ]                                                           |\n");
+printf(" |                                                                       |\n");
+printf(" | fpga-tool --memtest --cfg <cfg>                                       |\n");
+printf(" |                                                                       |\n");
+printf(" | [ \033[92mPARAMETERS\033[0m ]                                                        |\n");
+printf(" |                                                                       |\n");
+printf(" | <cf> config JSON file;                                                |\n");
+printf(" |                                                                       |\n");
+printf(" | [ \033[92mEXAMPLE\033[0m ]                                                           |\n");
+printf(" |                                                                       |\n");
+printf(" | fpga-tool --memtest --cfg \033[33m./cfg.json\033[0m                                  |\n");
+printf(" |                                                                       |\n");
+printf(" | ----- [ 6. DMA Self-Test ] ------------------------------------------ |\n");
+printf(" |                                                                       |\n");
+printf(" | [ \033[92mCOMMAND\033[0m ]                                                           |\n");
+printf(" |                                                                       |\n");
+printf(" | fpga-tool --selftest --cfg <cfg>                                      |\n");
+printf(" |                                                                       |\n");
+printf(" | [ \033[92mPARAMETERS\033[0m ]                                                        |\n");
+printf(" |                                                                       |\n");
+printf(" | <cf> config JSON file (DDR from offset 0 is overwritten);             |\n");
+printf(" |                                                                       |\n");
+printf(" | [ \033[92mEXAMPLE\033[0m ]                                                           |\n");
+printf(" |                                                                       |\n");
+printf(" | fpga-tool --selftest --cfg \033[33m./cfg.json\033[0m                                 |\n");
+printf(" |                                                                       |\n");
 printf(" |=======================================================================|\n");
 printf("\n");
 }
@@ -135,6 +223,63 @@ FPGA_TOOL_AXIParameters FPGA_TOOL__ParseCommandParameters(const std::vector<std:
             retParameters.operate = FPGA_TOOL__OPERATE__FOR_HELP;
         }
     }
+    else if (cmdSize == 4 || cmdSize == 6)
+    {
+        if ((cmdSize == 4 && IS__FPGA_TOOL__OPERATE__TUNE_DMA_CMD(cmdListUpper)) ||
+            (cmdSize == 6 && IS__FPGA_TOOL__OPERATE__TUNE_DMA_CACHE_CMD(cmdListUpper)))
+        {
+            retParameters.operate = FPGA_TOOL__OPERATE__TUNE_DMA;
+
+            /* Parse user value */
+
+            if (!cmdList[3].empty())retParameters.configFileName = cmdList[3];
+            else cmdError = true;
+
+            if (cmdSize == 6)
+            {
+                if (!cmdList[5].empty())retParameters.cacheFileName = cmdList[5];
+                else cmdError = true;
+            }
+        }
+        else if ((cmdSize == 4 && IS__FPGA_TOOL__OPERATE__BENCH_DMA_CMD(cmdListUpper)) ||
+                 (cmdSize == 6 && IS__FPGA_TOOL__OPERATE__BENCH_DMA_REPORT_CMD(cmdListUpper)))
+        {
+            retParameters.operate = FPGA_TOOL__OPERATE__BENCH_DMA;
+
+            /* Parse user value */
+
+            if (!cmdList[3].empty())retParameters.configFileName = cmdList[3];
+            else cmdError = true;
+
+            if (cmdSize == 6)
+            {
+                if (!cmdList[5].empty())retParameters.reportFileName = cmdList[5];
+                else cmdError = true;
+            }
+        }
+        else if (cmdSize == 4 && IS__FPGA_TOOL__OPERATE__MEMTEST_DDR_CMD(cmdListUpper))
+        {
+            retParameters.operate = FPGA_TOOL__OPERATE__MEMTEST_DDR;
+
+            /* Parse user value */
+
+            if (!cmdList[3].empty())retParameters.configFileName = cmdList[3];
+            else cmdError = true;
+        }
+        else if (cmdSize == 4 && IS__FPGA_TOOL__OPERATE__SELFTEST_DMA_CMD(cmdListUpper))
+        {
+            retParameters.operate = FPGA_TOOL__OPERATE__SELFTEST_DMA;
+
+            /* Parse user value */
+
+            if (!cmdList[3].empty())retParameters.configFileName = cmdList[3];
+            else cmdError = true;
+        }
+        else
+        {
+            cmdError = true;
+        }
+    }
     else if (cmdSize == 11)
     {
         if (IS__FPGA_TOOL__OPERATE__READ_AXI_LITE_CMD(cmdListUpper) && IS__FPGA_TOOL__OPERATE__READ_AXI_LITE(cmdListUpper))
@@ -249,7 +394,7 @@ int main(int argc, char *argv[])
     vuprs::FPGAConfigManager fpgaConfigManager;
     vuprs::FPGAController fpgaController;
     vuprs::AlignedBufferDMA buffer;
-    vuprs::DMATransferConfig dmaTransferConfig;
+    vuprs::DMATuningResult tuningResult;
 
     uint32_t rValue;
 
@@ -281,6 +426,22 @@ printf(" \033[31mFPGA-TOOL ERR: Error occurred when loading config.\033[0m\n");
         }
 
 std::cout << " \033[92mSuccessfully load configuration from\033[0m: \033[34m" << fpgaConfigParam.configFileName << "\033[0m" << std::endl;
+        if (fpgaController.TransportName() != FPGA_TRANSPORT__XDMA)
+        {
+std::cout << " \033[33mFPGA transport: " << fpgaController.TransportName() << " (no hardware access)\033[0m" << std::endl;
+        }
+
+        /* Tuned transfer size of the cache (written by --tune or vuprs_server), a missing or stale cache keeps the config */
+
+        if (fpgaConfigParam.operate != FPGA_TOOL__OPERATE__TUNE_DMA &&
+            !fpgaConfigManager.fpgaConfig.xdmaDriverConfig.tuningCacheFilename.empty() &&
+            vuprs::LoadDMATuningCache(fpgaConfigManager.fpgaConfig.xdmaDriverConfig.tuningCacheFilename,
+                                      vuprs::DMAAutoTuner::CacheKey(fpgaController), &tuningResult) &&
+            vuprs::ApplyDMATuning(tuningResult, &fpgaConfigManager) &&
+            fpgaController.LoadFPGAConfig(fpgaConfigManager))
+        {
+printf(" DMA tuning (cached): chunk %lu B\n", static_cast<unsigned long>(tuningResult.best.chunkSize));
+        }
     }
 
     switch (fpgaConfigParam.operate)
@@ -371,23 +532,36 @@ printf(" | ---------------------------------------------------------------------
         {
             try
             {
-                dmaTransferConfig.ddrOffset = fpgaConfigParam.offset;
-                dmaTransferConfig.transferByteSize = fpgaConfigParam.transferBytes;
-                dmaTransferConfig.transferDirectionSelection = DMA_TRANSFER_DIRECTION__FPGA_TO_HOST;
-                dmaTransferConfig.transferDmaChannel = 0;
+                vuprs::DMACaptureRecorder captureRecorder(&fpgaController);
+                vuprs::CaptureRecorderConfig recorderConfig;
+                uint64_t recordBytes = 0;
+                bool recordSuccess = false;
+
+                recorderConfig.captureFilename = fpgaConfigParam.datafileName;
+                recorderConfig.captureByteSize = fpgaConfigParam.transferBytes;
+                recorderConfig.windowByteSize = CAPTURE_RECORDER_DEFAULT_WINDOW_BYTES;
+                recorderConfig.dmaChannel = 0;
 
-                if(fpgaController.AXIFull_IO(dmaTransferConfig, &buffer))
+                /* DMA straight into the output file, one window per transfer */
+
+                if (captureRecorder.Open(recorderConfig))
+                {
+                    recordSuccess = true;
+
+                    while (recordSuccess && captureRecorder.RecordedBytes() < fpgaConfigParam.transferBytes)
+                    {
+                        recordBytes = std::min(fpgaConfigParam.transferBytes - captureRecorder.RecordedBytes(), recorderConfig.windowByteSize);
+                        recordSuccess = captureRecorder.Record(fpgaConfigParam.offset + captureRecorder.RecordedBytes(), recordBytes);
+                    }
+
+                    recordSuccess = captureRecorder.Close() && recordSuccess;
+                }
+
+                if(recordSuccess)
                 {
 printf(" | --------------------------------------------------------------------- |\n");
 printf("                           [\033[92mREAD AXI-FULL SUCCESS\033[0m]\n");
-                    if(buffer.to_file(fpgaConfigParam.datafileName, 0, fpgaConfigParam.transferBytes))
-                    {
 std::cout << "   Successfully save <" << fpgaConfigParam.transferBytes << "> bytes to file: " << fpgaConfigParam.datafileName;
-                    }
-                    else
-                    {
-printf("   Failed to save data to file.");
-                    }
                 }
                 else
                 {
@@ -407,27 +581,239 @@ printf(" | ---------------------------------------------------------------------
         {
             try
             {
-                dmaTransferConfig.ddrOffset = fpgaConfigParam.offset;
-                dmaTransferConfig.transferByteSize = fpgaConfigParam.transferBytes;
-                dmaTransferConfig.transferDirectionSelection = DMA_TRANSFER_DIRECTION__HOST_TO_FPGA;
-                dmaTransferConfig.transferDmaChannel = 0;
+                vuprs::DMAStreamConfig streamConfig;
+                vuprs::DMAStreamProgress streamSummary = vuprs::DMAStreamProgress();
+
+                /* Stream the file in aligned chunks, memory use is bounded by 2 chunks */
+
+                streamConfig.chunkByteSize = fpgaConfigManager.fpgaConfig.xdmaDriverConfig.maxTransferSize_bytes;
+                streamConfig.dmaChannel = 0;
+
+printf(" | --------------------------------------------------------------------- |\n");
+                bool uploadSuccess = vuprs::StreamFileToDDR(
+                    &fpgaController, fpgaConfigParam.datafileName, 0,
+                    fpgaConfigParam.offset, fpgaConfigParam.transferBytes, streamConfig,
+                    [](const vuprs::DMAStreamProgress &streamProgress)
+                    {
+printf("\r   %lu / %lu bytes (%.1f%%), %.2f MB/s",
+       static_cast<unsigned long>(streamProgress.transferredBytes), static_cast<unsigned long>(streamProgress.totalBytes),
+       100.0 * streamProgress.transferredBytes / streamProgress.totalBytes, streamProgress.throughput_bytesPerSecond / 1e6);
+                        fflush(stdout);
+                    },
+                    &streamSummary);
+printf("\n");
+
+                if (uploadSuccess)
+                {
+printf("                         [\033[92mWRITE AXI-FULL SUCCESS\033[0m]\n");
+printf("   <bytes>        \033[33m%lu\033[0m\n", static_cast<unsigned long>(streamSummary.transferredBytes));
+printf("   <time>         \033[33m%.3f\033[0m s\n", streamSummary.elapsed_s);
+printf("   <throughput>   \033[33m%.2f\033[0m MB/s\n", streamSummary.throughput_bytesPerSecond / 1e6);
+                }
+                else
+                {
+printf("                         [\033[31mWRITE AXI-FULL FAILED\033[0m]\n");
+std::cout << "   Failed to upload data from: " << fpgaConfigParam.datafileName << std::endl;
+                }
+printf(" | --------------------------------------------------------------------- |\n");
+            }
+            catch(const std::exception& e)
+            {
+                std::cerr << e.what() << '\n';
+                buffer.release();
+                return 0;
+            }
+            break;
+        }
+
+        /* DMA Tuning */
+
+        case FPGA_TOOL__OPERATE__TUNE_DMA:
+        {
+            try
+            {
+                vuprs::DMAAutoTuner dmaAutoTuner(&fpgaController);
+                std::string cacheFileName = fpgaConfigParam.cacheFileName;
 
+                if (cacheFileName.empty())
+                {
+                    cacheFileName = fpgaConfigManager.fpgaConfig.xdmaDriverConfig.tuningCacheFilename;
+                }
+
+printf(" | --------------------------------------------------------------------- |\n");
+printf("                           [\033[92mDMA TUNING (C2H)\033[0m]\n");
+printf("\n");
+
+                bool tuneSuccess = dmaAutoTuner.Tune(&tuningResult, [](const vuprs::DMATuningPoint &point)
+                {
+printf("   chunk \033[33m%9lu\033[0m B   %10.2f MB/s\n", static_cast<unsigned long>(point.chunkSize), point.throughput_bytesPerSecond / 1e6);
+                });
+
+printf("\n");
+                if (tuneSuccess)
+                {
+printf("   <best>       chunk \033[33m%lu\033[0m B, \033[33m%.2f\033[0m MB/s\n",
+       static_cast<unsigned long>(tuningResult.best.chunkSize), tuningResult.best.throughput_bytesPerSecond / 1e6);
+
+                    if (cacheFileName.empty())
+                    {
+printf("   No cache file given, result is not saved.\n");
+                    }
+                    else if (vuprs::SaveDMATuningCache(cacheFileName, tuningResult))
+                    {
+std::cout << "   Tuning cache saved to: " << cacheFileName << std::endl;
+                    }
+                    else
+                    {
+std::cout << "   \033[31mFailed to save tuning cache to: " << cacheFileName << "\033[0m" << std::endl;
+                    }
+                }
+                else
+                {
+printf("                           [\033[31mDMA TUNING FAILED\033[0m]\n");
+                }
+printf(" | --------------------------------------------------------------------- |\n");
+            }
+            catch(const std::exception& e)
+            {
+                std::cerr << e.what() << '\n';
                 buffer.release();
+                return 0;
+            }
+            break;
+        }
+
+        /* DMA Benchmark */
+
+        case FPGA_TOOL__OPERATE__BENCH_DMA:
+        {
+            try
+            {
+                vuprs::DMABenchmark dmaBenchmark(&fpgaController);
+                vuprs::DMABenchmarkReport benchmarkReport;
+
 printf(" | --------------------------------------------------------------------- |\n");
-                if (buffer.from_file(fpgaConfigParam.datafileName, 0, fpgaConfigParam.transferBytes))
+printf("                           [\033[92mDMA BENCHMARK\033[0m]\n");
+printf("\n");
+printf("   mode         bytes  ch       MB/s    p50 us    p99 us   p999 us    max us  usr%%  sys%%\n");
+
+                bool benchSuccess = dmaBenchmark.Run(&benchmarkReport, [](const vuprs::DMABenchmarkPoint &point)
+                {
+printf("   %-8s %9lu  %2lu %10.2f %9.1f %9.1f %9.1f %9.1f %5.1f %5.1f%s\n",
+       vuprs::DMABenchmarkModeName(point.mode), static_cast<unsigned long>(point.transferSize),
+       static_cast<unsigned long>(point.channels), point.throughput_bytesPerSecond / 1e6,
+       point.latencyP50_us, point.latencyP99_us, point.latencyP999_us, point.latencyMax_us,
+       point.cpuUser_percent, point.cpuSystem_percent,
+       point.success ? "" : (point.verifyErrors != 0 ? "  \033[31mVERIFY ERROR\033[0m" : "  \033[31mFAILED\033[0m"));
+                });
+
+printf("\n");
+                if (benchSuccess)
+                {
+printf("                           [\033[92mDMA BENCHMARK SUCCESS\033[0m]\n");
+                }
+                else
                 {
-                    if(fpgaController.AXIFull_IO(dmaTransferConfig, &buffer))
+printf("                           [\033[31mDMA BENCHMARK FAILED\033[0m]\n");
+                }
+
+                if (!fpgaConfigParam.reportFileName.empty())
+                {
+                    if (vuprs::SaveDMABenchmarkReport(fpgaConfigParam.reportFileName, benchmarkReport))
                     {
-printf("                         [\033[92mWRITE AXI-FULL SUCCESS\033[0m]\n");
+std::cout << "   Benchmark report saved to: " << fpgaConfigParam.reportFileName << std::endl;
                     }
                     else
                     {
-printf("                         [\033[31mWRITE AXI-FULL FAILED\033[0m]\n");
+std::cout << "   \033[31mFailed to save benchmark report to: " << fpgaConfigParam.reportFileName << "\033[0m" << std::endl;
+                    }
+                }
+printf(" | --------------------------------------------------------------------- |\n");
+            }
+            catch(const std::exception& e)
+            {
+                std::cerr << e.what() << '\n';
+                buffer.release();
+                return 0;
+            }
+            break;
+        }
+
+        /* DDR Memory Test */
+
+        case FPGA_TOOL__OPERATE__MEMTEST_DDR:
+        {
+            try
+            {
+                vuprs::DMAMemTest dmaMemTest(&fpgaController);
+                std::vector<vuprs::DMAMemTestResult> memTestResults;
+
+printf(" | --------------------------------------------------------------------- |\n");
+printf("                           [\033[92mDDR MEMORY TEST\033[0m]\n");
+printf("\n");
+printf("   pattern          bytes   write GB/s   verify GB/s   bad words\n");
+
+                bool memTestSuccess = dmaMemTest.Run(&memTestResults, [](const vuprs::DMAMemTestResult &result)
+                {
+printf("   %-12s %10lu %12.3f %13.3f   %s%lu\033[0m%s\n",
+       vuprs::DMAMemTestPatternName(result.pattern), static_cast<unsigned long>(result.testedBytes),
+       result.writeThroughput_bytesPerSecond / 1e9, result.readThroughput_bytesPerSecond / 1e9,
+       result.errorWords == 0 ? "\033[92m" : "\033[31m", static_cast<unsigned long>(result.errorWords),
+       result.transferSuccess ? "" : "  \033[31mDMA FAILED\033[0m");
+
+                    for (const vuprs::DMAMemTestError &error : result.firstErrors)
+                    {
+printf("       <address> \033[33m0x%08lX\033[0m  expected 0x%08X  actual 0x%08X\n",
+       static_cast<unsigned long>(error.ddrAddress), error.expected, error.actual);
                     }
+                });
+
+printf("\n");
+                if (memTestSuccess)
+                {
+printf("                           [\033[92mDDR MEMORY TEST PASSED\033[0m]\n");
+                }
+                else
+                {
+printf("                           [\033[31mDDR MEMORY TEST FAILED\033[0m]\n");
+                }
+printf(" | --------------------------------------------------------------------- |\n");
+            }
+            catch(const std::exception& e)
+            {
+                std::cerr << e.what() << '\n';
+                buffer.release();
+                return 0;
+            }
+            break;
+        }
+
+        /* DMA Self-Test */
+
+        case FPGA_TOOL__OPERATE__SELFTEST_DMA:
+        {
+            try
+            {
+                vuprs::DMASelfTest dmaSelfTest(&fpgaController);
+                std::vector<vuprs::DMASelfTestResult> selfTestResults;
+
+printf(" | --------------------------------------------------------------------- |\n");
+printf("                           [\033[92mDMA SELF-TEST\033[0m]\n");
+printf("\n");
+
+                bool selfTestSuccess = dmaSelfTest.Run(&selfTestResults, [](const vuprs::DMASelfTestResult &result)
+                {
+printf("   %-20s %s\033[0m  %s\n", result.name.c_str(), result.success ? "\033[92mPASS" : "\033[31mFAIL", result.detail.c_str());
+                });
+
+printf("\n");
+                if (selfTestSuccess)
+                {
+printf("                           [\033[92mDMA SELF-TEST PASSED\033[0m]\n");
                 }
                 else
                 {
-std::cout << "   Failed to load data from: " << fpgaConfigParam.datafileName << std::endl;
+printf("                           [\033[31mDMA SELF-TEST FAILED\033[0m]\n");
                 }
 printf(" | --------------------------------------------------------------------- |\n");
             }
@@ -0,0 +1,280 @@
+/**
+ * @brief   This document is the channel-major ADC sample buffer (one aligned allocation, fixed stride).
+ * @version 1.0
+ * @author  Shixuan Liu, Tongji University
+ * @date    2026-10
+ */
+
+#ifndef ADC_CHANNEL_BUFFER_H
+#define ADC_CHANNEL_BUFFER_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+#include <type_traits>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#define ADC_CHANNEL_BUFFER_ALIGNMENT_BYTES        64U  /* Start of every channel, cache line & widest SIMD */
+#define ADC_CHANNEL_BUFFER_MIN_CAPACITY_BYTES     4096U  /* Per channel, first reserve */
+
+namespace vuprs
+{
+    /**
+     * @brief Samples of one channel (view, does not own the memory).
+     */
+    template <typename T>
+    struct ADCChannelSpan
+    {
+        T *samples;
+        uint64_t size;
+
+        T *begin() const { return this->samples; }
+        T *end() const { return this->samples + this->size; }
+        T &operator[](const uint64_t &index) const { return this->samples[index]; }
+    };
+
+    /**
+     * @brief Samples of all channels in one allocation, channel c starts at data() + c * stride().
+     * @note Every channel starts on an ADC_CHANNEL_BUFFER_ALIGNMENT_BYTES boundary. Capacity grows
+     *       geometrically and is kept by clear()/resize(), so a reused buffer does not allocate
+     *       once it has seen the largest parse.
+     */
+    template <typename T>
+    class ADCChannelBuffer
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Samples must be trivially copyable.");
+        static_assert(ADC_CHANNEL_BUFFER_ALIGNMENT_BYTES % sizeof(T) == 0, "Sample size must divide the alignment.");
+
+        private:
+
+            T *allocated;
+            uint64_t channelCount;
+            uint64_t sampleCount;
+            uint64_t channelStride;  /* Samples between channel starts (capacity per channel) */
+
+            static T *AllocateAligned(const uint64_t &elementCount)
+            {
+                void *memory = nullptr;
+
+#ifdef _WIN32
+
+                memory = _aligned_malloc(elementCount * sizeof(T), ADC_CHANNEL_BUFFER_ALIGNMENT_BYTES);
+
+#else
+
+                if (posix_memalign(&memory, ADC_CHANNEL_BUFFER_ALIGNMENT_BYTES, elementCount * sizeof(T)) != 0)
+                {
+                    memory = nullptr;
+                }
+
+#endif
+
+                if (memory == nullptr)
+                {
+                    throw std::bad_alloc();
+                }
+
+                return static_cast<T*>(memory);
+            }
+
+            static void FreeAligned(T *memory)
+            {
+                if (memory == nullptr)
+                {
+                    return;
+                }
+
+#ifdef _WIN32
+
+                _aligned_free(memory);
+
+#else
+
+                free(memory);
+
+#endif
+            }
+
+            /**
+             * @brief Rearrange to a new stride, samples are kept.
+             */
+            void Restride(const uint64_t &newStride)
+            {
+                T *newAllocated = nullptr;
+
+                if (this->channelCount != 0 && newStride != 0)
+                {
+                    newAllocated = AllocateAligned(this->channelCount * newStride);
+
+                    for (uint64_t c = 0; c < this->channelCount && this->allocated != nullptr; c++)
+                    {
+                        memcpy(newAllocated + c * newStride, this->allocated + c * this->channelStride, this->sampleCount * sizeof(T));
+                    }
+                }
+
+                FreeAligned(this->allocated);
+
+                this->allocated = newAllocated;
+                this->channelStride = newStride;
+            }
+
+        public:
+
+            ADCChannelBuffer() : allocated(nullptr), channelCount(0), sampleCount(0), channelStride(0) {}
+
+            explicit ADCChannelBuffer(const uint64_t &channelCount, const uint64_t &reserveSamples = 0)
+                : allocated(nullptr), channelCount(channelCount), sampleCount(0), channelStride(0)
+            {
+                this->reserve(reserveSamples);
+            }
+
+            ~ADCChannelBuffer()
+            {
+                FreeAligned(this->allocated);
+            }
+
+            /* Copy is disabled */
+
+            ADCChannelBuffer(const ADCChannelBuffer&) = delete;
+            ADCChannelBuffer& operator=(const ADCChannelBuffer&) = delete;
+
+            ADCChannelBuffer(ADCChannelBuffer &&other) noexcept
+                : allocated(other.allocated), channelCount(other.channelCount), sampleCount(other.sampleCount), channelStride(other.channelStride)
+            {
+                other.allocated = nullptr;
+                other.channelCount = 0;
+                other.sampleCount = 0;
+                other.channelStride = 0;
+            }
+
+            ADCChannelBuffer& operator=(ADCChannelBuffer &&other) noexcept
+            {
+                if (this != &other)
+                {
+                    FreeAligned(this->allocated);
+
+                    this->allocated = other.allocated;
+                    this->channelCount = other.channelCount;
+                    this->sampleCount = other.sampleCount;
+                    this->channelStride = other.channelStride;
+
+                    other.allocated = nullptr;
+                    other.channelCount = 0;
+                    other.sampleCount = 0;
+                    other.channelStride = 0;
+                }
+                return *this;
+            }
+
+            /* shape */
+
+            /**
+             * @brief Set channel count, samples are dropped when the count changes.
+             */
+            void set_channels(const uint64_t &channelCount)
+            {
+                if (channelCount == this->channelCount)
+                {
+                    return;
+                }
+
+                FreeAligned(this->allocated);
+
+                this->allocated = nullptr;
+                this->channelCount = channelCount;
+                this->sampleCount = 0;
+                this->channelStride = 0;
+            }
+
+            /**
+             * @brief Make room for <samples> per channel, grows at least x2.
+             * @throw std::bad_alloc
+             */
+            void reserve(const uint64_t &samples)
+            {
+                const uint64_t alignSamples = ADC_CHANNEL_BUFFER_ALIGNMENT_BYTES / sizeof(T);
+                uint64_t newStride = 0;
+
+                if (samples <= this->channelStride)
+                {
+                    return;
+                }
+
+                newStride = std::max(samples, std::max(2 * this->channelStride, static_cast<uint64_t>(ADC_CHANNEL_BUFFER_MIN_CAPACITY_BYTES / sizeof(T))));
+                newStride = (newStride + alignSamples - 1) / alignSamples * alignSamples;
+
+                this->Restride(newStride);
+            }
+
+            /**
+             * @brief Set samples per channel (new samples are not initialized).
+             * @throw std::bad_alloc
+             */
+            void resize(const uint64_t &samples)
+            {
+                this->reserve(samples);
+                this->sampleCount = samples;
+            }
+
+            /**
+             * @brief Samples to 0, capacity is kept.
+             */
+            void clear()
+            {
+                this->sampleCount = 0;
+            }
+
+            /**
+             * @brief Free the memory.
+             */
+            void release()
+            {
+                FreeAligned(this->allocated);
+
+                this->allocated = nullptr;
+                this->sampleCount = 0;
+                this->channelStride = 0;
+            }
+
+            uint64_t channels() const { return this->channelCount; }
+            uint64_t samples() const { return this->sampleCount; }
+            uint64_t stride() const { return this->channelStride; }
+            uint64_t capacity() const { return this->channelStride; }
+
+            /* data */
+
+            T *data() const { return this->allocated; }
+
+            T *channel(const uint64_t &channel) const
+            {
+                if (channel >= this->channelCount)
+                {
+                    throw std::out_of_range("Invalid channel: " + std::to_string(channel));
+                }
+                return this->allocated + channel * this->channelStride;
+            }
+
+            vuprs::ADCChannelSpan<T> span(const uint64_t &channel) const
+            {
+                return vuprs::ADCChannelSpan<T>{this->channel(channel), this->sampleCount};
+            }
+
+            T &at(const uint64_t &channel, const uint64_t &sample) const
+            {
+                if (sample >= this->sampleCount)
+                {
+                    throw std::out_of_range("Invalid sample: " + std::to_string(sample));
+                }
+                return this->channel(channel)[sample];
+            }
+    };
+}
+
+#endif
@@ -0,0 +1,89 @@
+/**
+ * @brief   This document is the per-channel scaling of raw ADC codes (code -> volt at the edges).
+ * @version 1.0
+ * @author  Shixuan Liu, Tongji University
+ * @date    2026-10
+ */
+
+#ifndef ADC_CHANNEL_SCALING_H
+#define ADC_CHANNEL_SCALING_H
+
+#include <stdint.h>
+#include <vector>
+#include <stdexcept>
+#include <cmath>
+#include <limits>
+
+#include "fpga_config.h"
+#include "fpga_data_parse.h"
+#include "adc_channel_buffer.h"
+
+namespace vuprs
+{
+    /**
+     * @brief volt = code * scale[c] + offset[c], index is the result channel (same order as BufferData2ADCChannels()).
+     *        With a calibration the "volt" is the physical value of the channel (unit of the calibration).
+     */
+    typedef struct ADCChannelScaling
+    {
+        double scale[ADC_CHANNELS];  /* Volt per LSB */
+        double offset[ADC_CHANNELS];  /* Volt */
+        double crcFailVoltage;  /* Volt of a sample with broken CRC */
+    };
+
+    /**
+     * @brief Identity calibration of every channel: gain 1, offset 0 V, sensitivity 1, unit "V".
+     */
+    vuprs::FPGAhardwareConfigCalibration DefaultCalibration(const uint64_t &channels);
+
+    /**
+     * @brief Validate a calibration: one entry per channel, finite values, gain & sensitivity not 0.
+     * @throw std::runtime_error (reason).
+     */
+    void CheckCalibration(const vuprs::FPGAhardwareConfigCalibration &calibration, const uint64_t &channels);
+
+    /**
+     * @brief Scaling of the ADC features: scale = radius / 2^(ADC_DATAWIDTH-1), offset = 0, CRC fail = radius
+     *        (same volts as BufferData2ADCChannels() with double output).
+     * @throw std::runtime_error("Do not find ADC features, convert disabled"), when adc features are empty.
+     */
+    vuprs::ADCChannelScaling ADCChannelScalingFromFeatures(const vuprs::FPGAhardwareConfigADC &adcFeatures);
+
+    /**
+     * @brief Scaling of the ADC features & a channel calibration, folded into one multiply-add per sample:
+     *        scale = radius / 2^(ADC_DATAWIDTH-1) * gain * sensitivity, offset = offset_v * sensitivity,
+     *        CRC fail = NaN (a broken sample can not be taken for a measured value).
+     * @throw std::runtime_error, when adc features or calibration are empty or invalid (see CheckCalibration()).
+     */
+    vuprs::ADCChannelScaling ADCChannelScalingFromCalibration(const vuprs::FPGAhardwareConfigADC &adcFeatures,
+                                                              const vuprs::FPGAhardwareConfigCalibration &calibration);
+
+    /**
+     * @brief Volt of one sample.
+     */
+    inline double ADCCodeToVoltage(const double &code, const uint64_t &channel, const vuprs::ADCChannelScaling &scaling)
+    {
+        return code * scaling.scale[channel] + scaling.offset[channel];
+    }
+
+    /**
+     * @brief Convert raw ADC codes to volts (physical values with a calibrated scaling).
+     * @note Scaling & CRC masking take one pass over the output, int16 -> float has AVX2/NEON kernels
+     *       (kernel "adc-code-to-voltage", see cpu_dispatch.h).
+     * @param codes raw codes (BufferData2ADCChannels() int16_t/float version).
+     * @param crcPassMasks pass masks of the frames (codes.samples() elements), empty = all samples pass.
+     * @param scaling channel scaling.
+     * @param voltage volts, capacity is kept (reuse it across calls).
+     * @throw std::runtime_error: channel count or mask count mismatch.
+     */
+    void ADCChannelsToVoltage(const vuprs::ADCChannelBuffer<int16_t> &codes, const std::vector<uint16_t> &crcPassMasks,
+                              const vuprs::ADCChannelScaling &scaling, vuprs::ADCChannelBuffer<double> *voltage);
+    void ADCChannelsToVoltage(const vuprs::ADCChannelBuffer<int16_t> &codes, const std::vector<uint16_t> &crcPassMasks,
+                              const vuprs::ADCChannelScaling &scaling, vuprs::ADCChannelBuffer<float> *voltage);
+    void ADCChannelsToVoltage(const vuprs::ADCChannelBuffer<float> &codes, const std::vector<uint16_t> &crcPassMasks,
+                              const vuprs::ADCChannelScaling &scaling, vuprs::ADCChannelBuffer<double> *voltage);
+    void ADCChannelsToVoltage(const vuprs::ADCChannelBuffer<float> &codes, const std::vector<uint16_t> &crcPassMasks,
+                              const vuprs::ADCChannelScaling &scaling, vuprs::ADCChannelBuffer<float> *voltage);
+}
+
+#endif
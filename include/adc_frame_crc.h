@@ -0,0 +1,50 @@
+/**
+ * @brief   This document is the ADC frame CRC check (CRC8_CDMA2000 of all channels, scalar & SIMD).
+ * @version 1.0
+ * @author  Shixuan Liu, Tongji University
+ * @date    2026-10
+ */
+
+#ifndef ADC_FRAME_CRC_H
+#define ADC_FRAME_CRC_H
+
+#include <stdint.h>
+#include <stdexcept>
+
+#include "fpga_data_parse.h"
+
+/**
+ * Pass mask of a frame: bit n is set when the CRC of data word n (storage position, see ADC_CHANNEL__xxx) is correct
+ */
+
+#define ADC_FRAME_CRC_ALL_PASS           ((1U << ADC_CHANNELS) - 1U)
+
+namespace vuprs
+{
+    /**
+     * @brief Check CRC of all channels in one frame.
+     * @note Data word: [31:16] ADC value, [15:8] CRC of value[15:8], [7:0] CRC of value[7:0].
+     *       CRC8_CDMA2000 has no init/xorout, so CRC(x) = CRC(x[3:0]) ^ CRC(x[7:4] << 4),
+     *       both nibbles are looked up with byte shuffles (pshufb/vqtbl1q), 16 channels at once.
+     *       The variant (AVX2/SSSE3/NEON/scalar) is selected at start-up (kernel "adc-frame-crc", see cpu_dispatch.h).
+     * @param dataWords ADC_CHANNELS data words (word after the header).
+     * @retval Pass mask, ADC_FRAME_CRC_ALL_PASS = all channels correct.
+     */
+    uint16_t CheckADCFrameCRC(const uint32_t *dataWords);
+
+    /**
+     * @brief Scalar reference of CheckADCFrameCRC().
+     */
+    uint16_t CheckADCFrameCRCScalar(const uint32_t *dataWords);
+
+    /**
+     * @brief Check CRC of many frames.
+     * @param words word buffer.
+     * @param frameOffsets header offsets of the frames (see LocateADCFrames()).
+     * @param frameCount frames to check.
+     * @param passMasks pass mask of every frame (frameCount elements).
+     */
+    void CheckADCFramesCRC(const uint32_t *words, const uint64_t *frameOffsets, const uint64_t &frameCount, uint16_t *passMasks);
+}
+
+#endif
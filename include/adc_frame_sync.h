@@ -0,0 +1,84 @@
+/**
+ * @brief   This document is the ADC frame synchronizer (header/tailer search, scalar & SIMD).
+ * @version 1.0
+ * @author  Shixuan Liu, Tongji University
+ * @date    2026-10
+ */
+
+#ifndef ADC_FRAME_SYNC_H
+#define ADC_FRAME_SYNC_H
+
+#include <stdint.h>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <stdexcept>
+
+#include "fpga_data_parse.h"
+
+#define ADC_FRAME_SYNC_BLOCK_WORDS       64U  /* Words per header bitmask */
+#define ADC_FRAME_SYNC_SCALAR_MISSES     16U  /* Words scanned one by one after a miss before the bitmask search */
+#define ADC_FRAME_SYNC_MIN_RANGE_WORDS   (1U << 16)  /* Smallest range of one thread (parallel locate) */
+
+namespace vuprs
+{
+    typedef struct ADCFrameSyncLayout
+    {
+        uint32_t header;
+        uint32_t tailer;
+        uint64_t frameWords;  /* Header + data + tailer */
+    };
+
+    /**
+     * @brief Default layout: ADC_DATA_HEADER, ADC_DATA_TAILER, ADC_FRAME_WORD_LENGTH.
+     */
+    vuprs::ADCFrameSyncLayout DefaultADCFrameSyncLayout();
+
+    /**
+     * @brief Locate frames in a word buffer.
+     * @note Semantics of the original scan: a header at word p is a frame when word p + frameWords - 1
+     *       is the tailer, and the scan continues at p + frameWords whether the tailer matched or not.
+     *       While in sync the next header & tailer are checked directly, a short loss of sync is scanned
+     *       word by word and a longer one with SIMD compares 64 words per bitmask. The SIMD variant (AVX2/SSE2/NEON) is
+     *       selected at start-up by the CPU features (kernel "adc-frame-locate", see cpu_dispatch.h).
+     *       Same result as LocateADCFramesScalar().
+     * @param words word buffer.
+     * @param wordCount words in the buffer.
+     * @param frameOffsets word offsets of the frame headers (appended).
+     * @param layout frame layout.
+     * @retval Stop position: offset of the first header whose frame passes the end of the buffer
+     *         (the caller keeps words from here for the next buffer), or wordCount.
+     * @throw std::runtime_error: frameWords < 2.
+     */
+    uint64_t LocateADCFrames(const uint32_t *words, const uint64_t &wordCount, std::vector<uint64_t> *frameOffsets,
+                             const vuprs::ADCFrameSyncLayout &layout = vuprs::DefaultADCFrameSyncLayout());
+
+    /**
+     * @brief Locate frames with several threads.
+     * @note The words are split into ranges, every thread locates the frames of its range (resync at the
+     *       first header of the range). The seams are stitched serially: the scan is continued from the
+     *       stop of the previous range until it hits a frame that the thread also found, from there the
+     *       scans are identical and the frames of the thread are taken. Frames the thread found before
+     *       that point (wrong sync) are dropped, frames the thread missed are added. Normally a seam
+     *       costs less than one frame of scalar scan.
+     *       Concatenated ranges are the same as the output of LocateADCFrames().
+     * @param words word buffer.
+     * @param wordCount words in the buffer.
+     * @param threadCount threads, 0 = hardware concurrency (less when ranges would be < ADC_FRAME_SYNC_MIN_RANGE_WORDS).
+     * @param rangeFrameOffsets header offsets of every range (cleared, one vector per range).
+     * @param layout frame layout.
+     * @retval Stop position, same as LocateADCFrames().
+     * @throw std::runtime_error: frameWords < 2.
+     */
+    uint64_t LocateADCFramesParallel(const uint32_t *words, const uint64_t &wordCount, const uint32_t &threadCount,
+                                     std::vector<std::vector<uint64_t>> *rangeFrameOffsets,
+                                     const vuprs::ADCFrameSyncLayout &layout = vuprs::DefaultADCFrameSyncLayout());
+
+    /**
+     * @brief Scalar reference of LocateADCFrames().
+     */
+    uint64_t LocateADCFramesScalar(const uint32_t *words, const uint64_t &wordCount, std::vector<uint64_t> *frameOffsets,
+                                   const vuprs::ADCFrameSyncLayout &layout = vuprs::DefaultADCFrameSyncLayout());
+}
+
+#endif
@@ -0,0 +1,244 @@
+/**
+ * @brief   This document is the soak test of the acquisition pipeline (read, parse, analysis, output) with SLO checks.
+ * @version 1.0
+ * @author  Shixuan Liu, Tongji University
+ * @date    2026-10
+ */
+
+#ifndef ADC_SOAK_H
+#define ADC_SOAK_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+#include <stdexcept>
+
+#include <time.h>
+#include <unistd.h>
+
+#include "nlohmann/json.hpp"
+#include "fpga_config.h"
+#include "aligned_data_structure.h"
+#include "adc_channel_buffer.h"
+#include "dma_stream.h"
+#include "dma_replay_source.h"
+
+/* ------------------------------------------- Pipeline Stages ------------------------------------------- */
+
+#define ADC_SOAK_STAGE__READ                      0  /* Source -> block (C2H DMA or replay) */
+#define ADC_SOAK_STAGE__PARSE                     1  /* Block -> calibrated volts (physical values) */
+#define ADC_SOAK_STAGE__ANALYSIS                  2  /* Per-channel mean, RMS, peak & CRC failures */
+#define ADC_SOAK_STAGE__OUTPUT                    3  /* Volts -> output file */
+
+#define ADC_SOAK_STAGES                           4
+
+#define ADC_SOAK_DEFAULT_QUEUE_DEPTH              8U  /* Blocks in flight between the source & the output */
+#define ADC_SOAK_DEFAULT_OUTPUT                   "/dev/null"
+#define ADC_SOAK_MONITOR_INTERVAL_S               1.0  /* RSS sampling & progress */
+
+#define ADC_SOAK_HISTOGRAM_BUCKETS_PER_DECADE     20U  /* Latency resolution ~12 % */
+#define ADC_SOAK_HISTOGRAM_DECADES                8U  /* 1 us ~ 100 s */
+
+namespace vuprs
+{
+    typedef struct ADCSoakSLO
+    {
+        uint64_t maxDroppedFrames;  /* Frames dropped because all blocks were busy (FIFO overflow) */
+        double maxLatencyP99_ms;  /* End-to-end (read -> output written), 0 = not checked */
+        double minRateRatio;  /* Achieved / requested source rate, 0 = not checked (always unchecked unpaced) */
+        double maxRSS_megabytes;  /* Peak RSS during the run, 0 = not checked */
+        double maxThreadCPU_percent;  /* Any pipeline thread, 100 % = one core, 0 = not checked */
+    };
+
+    typedef struct ADCSoakConfig
+    {
+        double duration_s;
+        uint64_t chunkByteSize;  /* Bytes per block (multiple of 4) */
+        uint64_t queueDepth;  /* Blocks in flight, a block due while all are busy is dropped */
+        std::string outputFilename;  /* Samples written by the output stage */
+        vuprs::ADCSoakSLO slo;
+    };
+
+    typedef struct ADCSoakLatency
+    {
+        uint64_t count;
+        double p50_ms;
+        double p99_ms;
+        double p999_ms;
+        double max_ms;
+    };
+
+    typedef struct ADCSoakStageReport
+    {
+        std::string name;
+        vuprs::ADCSoakLatency queueWait;  /* Previous stage done -> this stage starts (read: none) */
+        vuprs::ADCSoakLatency service;  /* Work of this stage (read: Read() incl. the pacing wait) */
+        uint64_t maxQueueDepth;  /* Blocks waiting for this stage (read: blocks in flight) */
+        double meanQueueDepth;
+        double cpu_percent;  /* CPU time of the stage thread / duration */
+    };
+
+    typedef struct ADCSoakProgress
+    {
+        double elapsed_s;
+        uint64_t sourceBytes;
+        uint64_t droppedFrames;
+        uint64_t blocksInFlight;
+        double rss_megabytes;
+    };
+
+    typedef struct ADCSoakReport
+    {
+        double duration_s;
+        uint64_t frameBytes;
+
+        uint64_t sourceBytes;  /* Read from the source (processed + dropped) */
+        uint64_t processedBytes;
+        uint64_t droppedBlocks;
+        uint64_t droppedFrames;
+        uint64_t parsedFrames;
+        uint64_t lostFrames;  /* Processed bytes / frame bytes - parsed frames (frames cut by drops or loop seams) */
+        uint64_t crcFailedSamples;
+        uint64_t outputBytes;
+        std::vector<double> channelRMS_v;  /* Analysis result over the run (unit of the calibration, CRC failures count as 0) */
+
+        bool timed;  /* Run with a time axis, time & the sample times below are valid */
+        vuprs::ADCTimeDescriptor time;  /* Frame 0 of the source */
+        int64_t firstSampleRealtime_ns;
+        int64_t lastSampleRealtime_ns;  /* Last frame read from the source (dropped frames included) */
+
+        vuprs::ADCSoakLatency endToEnd;
+        vuprs::ADCSoakStageReport stages[ADC_SOAK_STAGES];
+
+        double startRSS_megabytes;
+        double peakRSS_megabytes;
+        double endRSS_megabytes;
+
+        vuprs::CaptureReplayReport source;
+
+        std::vector<std::string> violations;  /* SLOs not met */
+        bool passed;
+    };
+
+    /**
+     * @brief Fixed log-spaced latency histogram (bounded memory for runs of hours).
+     */
+    class ADCSoakHistogram
+    {
+        private:
+
+            std::vector<uint64_t> buckets;
+            uint64_t count;
+            int64_t max_ns;
+
+        public:
+
+            ADCSoakHistogram();
+
+            void Add(const int64_t &latency_ns);
+            vuprs::ADCSoakLatency Summary() const;
+    };
+
+    /**
+     * @brief Run the pipeline from a paced source for a fixed duration and check the SLOs.
+     * @note One thread per stage, blocks go free -> read -> parse -> analysis -> output -> free. The read stage
+     *       never waits for a block: a chunk released by the source while all blocks are busy is read into a
+     *       scratch buffer and dropped, as the stream FIFO of the card would overflow. The parser restarts its
+     *       frame search after a drop.
+     */
+    class ADCSoakTest
+    {
+        private:
+
+            typedef struct Block
+            {
+                vuprs::AlignedBufferDMA raw;  /* Chunk */
+                uint64_t bytes;
+                bool gap;  /* Blocks were dropped in front of this one */
+                vuprs::ADCChannelBuffer<double> samples;
+                int64_t readTime_ns;
+                int64_t stageDone_ns;  /* Last stage finished */
+            };
+
+            vuprs::ADCSoakConfig soakConfig;
+            vuprs::FPGAhardwareConfigADC adcFeatures;
+            vuprs::FPGAhardwareConfigFrame frameFeatures;
+            vuprs::FPGAhardwareConfigCalibration calibration;
+
+            std::vector<std::unique_ptr<Block>> blocks;
+            std::deque<Block*> queues[ADC_SOAK_STAGES];  /* [stage]: blocks waiting for the stage (READ: free blocks) */
+            bool stageFinished[ADC_SOAK_STAGES];
+            std::mutex soakMutex;
+            std::condition_variable soakCondition;
+            std::string stageError;
+
+            vuprs::ADCSoakHistogram queueWait[ADC_SOAK_STAGES], service[ADC_SOAK_STAGES], endToEnd;
+            uint64_t depthSum[ADC_SOAK_STAGES], depthMax[ADC_SOAK_STAGES], depthSamples[ADC_SOAK_STAGES];  /* READ: blocks in flight */
+            double threadCPU_s[ADC_SOAK_STAGES];
+
+            std::atomic<uint64_t> sourceBytes, droppedBlocks, droppedBytes, blocksInFlight;
+            uint64_t parsedFrames, crcFailedSamples, outputBytes;
+            std::vector<double> channelSquareSum;
+            uint64_t analysedSamples;
+
+            Block *Take(const int &stage);
+            void Pass(Block *block, const int &stage);
+            void FinishStage(const int &stage, const std::string &error);
+
+            void ReadLoop(vuprs::CaptureReplaySource *source);
+            void ParseLoop();
+            void AnalysisLoop();
+            void OutputLoop(const int &output_fd);
+
+        public:
+
+            /**
+             * @param calibration channel calibration, the parse stage converts to physical values (NaN: broken CRC).
+             * @throw std::runtime_error, when features or calibration are missing or the config is invalid.
+             */
+            ADCSoakTest(const vuprs::ADCSoakConfig &config, const vuprs::FPGAhardwareConfigADC &adcFeatures,
+                        const vuprs::FPGAhardwareConfigFrame &frameFeatures, const vuprs::FPGAhardwareConfigCalibration &calibration);
+            ~ADCSoakTest();
+
+            ADCSoakTest(const ADCSoakTest&) = delete;
+            ADCSoakTest& operator=(const ADCSoakTest&) = delete;
+
+            /**
+             * @brief Default config: 60 s, DMA_STREAM_PARSE_CHUNK_BYTES blocks, no drop, p99 <= 100 ms, rate >= 99 %.
+             */
+            static vuprs::ADCSoakConfig DefaultSoakConfig();
+
+            /**
+             * @brief Run the soak test once.
+             * @param source opened source (synthetic or replayed capture, endless), stopped after the duration.
+             * @param report result & SLO violations.
+             * @param progress called every ADC_SOAK_MONITOR_INTERVAL_S (optional).
+             * @param captureTime time axis of frame 0 of the source (optional), see report->time.
+             * @retval true: all SLOs met;
+             *         false: some SLOs violated (see report->violations).
+             * @throw std::runtime_error, when the output file cannot be opened or a stage failed.
+             */
+            bool Run(vuprs::CaptureReplaySource *source, vuprs::ADCSoakReport *report,
+                     const std::function<void(const vuprs::ADCSoakProgress&)> &progress = nullptr,
+                     const vuprs::ADCTimeDescriptor *captureTime = nullptr);
+    };
+
+    /**
+     * @brief Save soak report as JSON.
+     */
+    bool SaveADCSoakReport(const std::string &reportFilename, const vuprs::ADCSoakReport &report);
+
+    /**
+     * @brief Resident set size of the process (MB), 0 when unknown.
+     */
+    double ProcessRSS_megabytes();
+}
+
+#endif
@@ -0,0 +1,103 @@
+/**
+ * @brief   This document is the streaming ADC frame parser (arbitrary chunks, partial frames carried over).
+ * @version 1.0
+ * @author  Shixuan Liu, Tongji University
+ * @date    2026-10
+ */
+
+#ifndef ADC_STREAM_PARSER_H
+#define ADC_STREAM_PARSER_H
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <functional>
+#include <stdexcept>
+
+#include "fpga_data_parse.h"
+#include "adc_frame_sync.h"
+#include "adc_frame_crc.h"
+
+namespace vuprs
+{
+    /**
+     * @brief Complete frames of a chunk, frame f starts at words + frameOffsets[f] (header, see LocateADCFrames()).
+     * @note words is the chunk itself or, for frames cut by the last chunk, a copy in the parser. Valid during the call only.
+     */
+    typedef std::function<void(const uint32_t *words, const uint64_t *frameOffsets, const uint64_t &frameCount)> ADCStreamFrameSink;
+
+    class ADCStreamParser
+    {
+        private:
+
+            vuprs::ADCFrameSyncLayout layout;
+            uint64_t dataWords;  /* Words between header & tailer */
+
+            std::vector<uint32_t> carryWords;  /* Words from the last cut header (< frameWords) */
+            uint8_t carryBytes[sizeof(uint32_t)];  /* Bytes of an incomplete word */
+            uint32_t carryByteCount;
+
+            std::vector<uint32_t> stitchWords;  /* carryWords + head of the next chunk */
+            std::vector<uint32_t> alignedWords;  /* Copy of a chunk that is not 4-byte aligned */
+            std::vector<uint64_t> frameOffsets;
+
+            uint64_t consumedBytes;
+            uint64_t emittedFrames;
+
+            void EmitFrames(const uint32_t *words, const vuprs::ADCStreamFrameSink &onFrames);
+
+        public:
+
+            /**
+             * @param layout frame layout, 1 ~ ADC_FRAME_MAX_CHANNELS data words.
+             * @throw std::runtime_error
+             */
+            ADCStreamParser(const vuprs::ADCFrameSyncLayout &layout = vuprs::DefaultADCFrameSyncLayout());
+
+            /**
+             * @param frameFeatures frame layout of the config (header, tailer, channels + 2 words per frame).
+             * @throw std::runtime_error, when the features are missing or invalid (see CheckFrameFeatures()).
+             */
+            explicit ADCStreamParser(const vuprs::FPGAhardwareConfigFrame &frameFeatures);
+            ~ADCStreamParser();
+
+            /**
+             * @brief Drop the carried partial frame & counters.
+             */
+            void Reset();
+
+            /**
+             * @brief Parse the next chunk of the stream.
+             * @note Frames cut by the chunk boundary are completed by the next chunk, the output of all chunks
+             *       equals parsing the concatenated stream at once (LocateADCFrames()). Work per chunk only
+             *       depends on the chunk size, at most frameWords - 1 words + 3 bytes are carried. Frames are
+             *       located in place (4-byte aligned chunks), onFrames is called at most twice per chunk: the
+             *       frame completed from the carried words, then the frames of the chunk.
+             * @param chunk stream bytes, any size & alignment.
+             * @param byteCount bytes of the chunk.
+             * @param onFrames receives the complete frames (decode them there, see FramesData2ADCChannels()).
+             * @retval Frames emitted by this chunk.
+             * @throw std::runtime_error
+             */
+            uint64_t Feed(const void *chunk, const uint64_t &byteCount, const vuprs::ADCStreamFrameSink &onFrames);
+
+            /**
+             * @brief Same as above, the data words of the frames are copied out.
+             * @param frameWords data words of the complete frames, frameWords - 2 words per frame (appended).
+             * @param crcPassMasks CRC pass mask of every frame (appended, optional, frames of ADC_CHANNELS data words only).
+             * @throw std::runtime_error, also when crcPassMasks is given for another layout.
+             */
+            uint64_t Feed(const void *chunk, const uint64_t &byteCount,
+                          std::vector<uint32_t> *frameWords, std::vector<uint16_t> *crcPassMasks = nullptr);
+
+            /**
+             * @brief Bytes kept for the next chunk.
+             */
+            uint64_t PendingBytes() const;
+
+            uint64_t ConsumedBytes() const;
+            uint64_t EmittedFrames() const;
+    };
+}
+
+#endif
@@ -0,0 +1,195 @@
+/**
+ * @brief   This document is the time axis of parsed ADC blocks (time descriptor instead of per-sample timestamps).
+ * @version 1.0
+ * @author  Shixuan Liu, Tongji University
+ * @date    2026-10
+ */
+
+#ifndef ADC_TIME_H
+#define ADC_TIME_H
+
+#include <stdint.h>
+#include <time.h>
+#include <cmath>
+#include <stdexcept>
+
+#include "fpga_config.h"
+#include "fpga_control.h"
+
+#define ADC_TIME_NS_PER_S                         1000000000LL
+#define ADC_TIME_DRIFT_DEFAULT_WINDOW             64U  /* References weighted by the drift estimator (exponential window) */
+#define ADC_TIME_DRIFT_MIN_SPAN_S                 10.0  /* No drift from references closer in time (1 NGF count / 10 s = 0.8 ppm at 120 kHz) */
+
+namespace vuprs
+{
+    /**
+     * @brief Host clocks taken together with the frame counter (NGF).
+     */
+    typedef struct ADCTimeReference
+    {
+        uint64_t frameIndex;  /* NGF, unwrapped to 64 bit */
+        int64_t hostMonotonic_ns;  /* CLOCK_MONOTONIC */
+        int64_t hostRealtime_ns;  /* CLOCK_REALTIME */
+    };
+
+    /**
+     * @brief Time axis of a parsed block (48 bytes for any number of samples).
+     * @note Sample i is frame firstFrameIndex + i, its host time is
+     *       reference time + (firstFrameIndex + i - reference.frameIndex) * samplePeriod_s * clockRatio.
+     *       Frames dropped by the parser (broken tailer) shift the later samples, compare the sample count
+     *       with the NGF difference of two blocks to detect them.
+     */
+    typedef struct ADCTimeDescriptor
+    {
+        uint64_t firstFrameIndex;  /* Frame counter of sample 0 */
+        double samplePeriod_s;  /* Nominal period of the FPGA clock (SCI) */
+        double clockRatio;  /* Host seconds per FPGA second (1 + drift), see ADCClockDriftEstimator */
+        vuprs::ADCTimeReference reference;
+
+        /**
+         * @brief Host time of a sample (O(1)).
+         */
+        int64_t SampleMonotonic_ns(const int64_t &sampleIndex) const
+        {
+            return this->reference.hostMonotonic_ns + this->FrameOffset_ns(sampleIndex);
+        }
+
+        int64_t SampleRealtime_ns(const int64_t &sampleIndex) const
+        {
+            return this->reference.hostRealtime_ns + this->FrameOffset_ns(sampleIndex);
+        }
+
+        /**
+         * @brief Nearest sample of a host time (O(1)), may be < 0 or >= samples of the block.
+         */
+        int64_t MonotonicToSample(const int64_t &hostMonotonic_ns) const
+        {
+            return this->OffsetToSample(hostMonotonic_ns - this->reference.hostMonotonic_ns);
+        }
+
+        int64_t RealtimeToSample(const int64_t &hostRealtime_ns) const
+        {
+            return this->OffsetToSample(hostRealtime_ns - this->reference.hostRealtime_ns);
+        }
+
+        /**
+         * @brief Descriptor of the block that starts sampleOffset samples later (chunks of a capture).
+         */
+        ADCTimeDescriptor Advance(const uint64_t &sampleOffset) const
+        {
+            ADCTimeDescriptor descriptor = *this;
+            descriptor.firstFrameIndex += sampleOffset;
+            return descriptor;
+        }
+
+        int64_t FrameOffset_ns(const int64_t &sampleIndex) const
+        {
+            const int64_t frames = static_cast<int64_t>(this->firstFrameIndex - this->reference.frameIndex) + sampleIndex;
+            return static_cast<int64_t>(std::llround(frames * this->samplePeriod_s * this->clockRatio * ADC_TIME_NS_PER_S));
+        }
+
+        int64_t OffsetToSample(const int64_t &offset_ns) const
+        {
+            const double frames = offset_ns / (this->samplePeriod_s * this->clockRatio * ADC_TIME_NS_PER_S);
+            return std::llround(frames) - static_cast<int64_t>(this->firstFrameIndex - this->reference.frameIndex);
+        }
+    };
+
+    /**
+     * @brief Nominal sample period of an SCI value.
+     * @note sci-accumulator-bits = 0: SCI is the count of sampling clock cycles per sample, period = SCI / clock;
+     *       sci-accumulator-bits = N: SCI is the increment of an N-bit phase accumulator, period = 2^N / (SCI * clock).
+     * @throw std::runtime_error, when the sampling clock is not configured or SCI is 0.
+     */
+    double SamplePeriodFromSCI(const uint32_t &sci, const vuprs::FPGAhardwareConfigADC &adcFeatures);
+
+    /**
+     * @brief 64-bit frame counter of a 32-bit NGF value (the counter must not advance 2^32 frames between two reads).
+     */
+    inline uint64_t UnwrapFrameCounter(const uint64_t &lastFrameIndex, const uint32_t &counter)
+    {
+        return lastFrameIndex + static_cast<uint32_t>(counter - static_cast<uint32_t>(lastFrameIndex));
+    }
+
+    /**
+     * @brief Host clocks now.
+     */
+    int64_t HostMonotonic_ns();
+    int64_t HostRealtime_ns();
+
+    /**
+     * @brief Read NGF between two host clock reads, the reference takes the midpoint of the reads.
+     * @param fpgaController controller with config loaded.
+     * @param lastFrameIndex frame index of the previous reference (unwrap of NGF), 0 for the first read.
+     * @param reference result.
+     * @retval true: read success;
+     *         false: register read failed.
+     * @throw std::runtime_error
+     */
+    bool ReadADCTimeReference(vuprs::FPGAController *fpgaController, const uint64_t &lastFrameIndex, vuprs::ADCTimeReference *reference);
+
+    /**
+     * @brief Read SCI and convert it to the sample period (see SamplePeriodFromSCI()).
+     * @retval true: read success;
+     *         false: register read failed.
+     * @throw std::runtime_error
+     */
+    bool ReadADCSamplePeriod(vuprs::FPGAController *fpgaController, const vuprs::FPGAhardwareConfigADC &adcFeatures, double *samplePeriod_s);
+
+    /**
+     * @brief Drift of the FPGA sampling clock against CLOCK_MONOTONIC.
+     * @note Least squares fit of host time over frame index, exponentially weighted (the last ~window references),
+     *       so slow drift (temperature) is followed. Centered sums: no precision loss over long captures.
+     */
+    class ADCClockDriftEstimator
+    {
+        private:
+
+            double samplePeriod_s;
+            double forgetting;  /* 1 - 1 / window */
+
+            vuprs::ADCTimeReference origin;
+            int64_t span_ns;  /* Newest reference - origin */
+            uint64_t references;
+
+            double weight;
+            double meanFrames, meanTime_ns;
+            double covariance, variance;
+
+        public:
+
+            /**
+             * @param samplePeriod_s nominal sample period (SamplePeriodFromSCI()).
+             * @param window references weighted (>= 2).
+             * @throw std::runtime_error
+             */
+            ADCClockDriftEstimator(const double &samplePeriod_s, const uint32_t &window = ADC_TIME_DRIFT_DEFAULT_WINDOW);
+            ~ADCClockDriftEstimator();
+
+            void Reset();
+
+            /**
+             * @brief Add a reference (ReadADCTimeReference()), references must be in time order.
+             */
+            void AddReference(const vuprs::ADCTimeReference &reference);
+
+            uint64_t References() const;
+
+            /**
+             * @brief Host seconds per FPGA second, 1.0 until the references span ADC_TIME_DRIFT_MIN_SPAN_S (the NGF
+             *        quantisation of closer references is larger than the drift of a crystal).
+             */
+            double ClockRatio() const;
+
+            double Drift_ppm() const;
+
+            /**
+             * @brief Descriptor of a block: nominal period, estimated ratio & the newest reference.
+             * @param firstFrameIndex frame counter of sample 0 of the block.
+             * @param reference host clocks & frame counter (normally the newest reference).
+             */
+            vuprs::ADCTimeDescriptor Descriptor(const uint64_t &firstFrameIndex, const vuprs::ADCTimeReference &reference) const;
+    };
+}
+
+#endif
@@ -0,0 +1,103 @@
+/**
+ * @brief   This document is the CPU feature detection & kernel registry (runtime dispatch of SIMD kernels).
+ * @version 1.0
+ * @author  Shixuan Liu, Tongji University
+ * @date    2026-10
+ */
+
+#ifndef CPU_DISPATCH_H
+#define CPU_DISPATCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include <utility>
+
+/**
+ * CPU features (bit flags)
+ */
+
+#define CPU_FEATURE__SSE2                (1ULL << 0)
+#define CPU_FEATURE__SSSE3               (1ULL << 1)
+#define CPU_FEATURE__SSE4_1              (1ULL << 2)
+#define CPU_FEATURE__SSE4_2              (1ULL << 3)
+#define CPU_FEATURE__AVX2                (1ULL << 4)
+#define CPU_FEATURE__AVX512F             (1ULL << 5)  /* Detected & reported, no kernel has an AVX-512 variant yet */
+#define CPU_FEATURE__AVX512BW            (1ULL << 6)
+
+#define CPU_FEATURE__ASIMD               (1ULL << 16)  /* NEON */
+#define CPU_FEATURE__ASIMDDP             (1ULL << 17)  /* Dot product */
+#define CPU_FEATURE__ARM_CRC32           (1ULL << 18)
+
+/**
+ * VUPRS_FORCE_SCALAR=1: every kernel takes its scalar variant (A/B test of the SIMD kernels)
+ */
+
+#define CPU_DISPATCH_FORCE_SCALAR_ENV    "VUPRS_FORCE_SCALAR"
+
+namespace vuprs
+{
+    /**
+     * @brief Features of this CPU (detected once: __builtin_cpu_supports on x86, getauxval(AT_HWCAP) on ARM).
+     */
+    uint64_t DetectCPUFeatures();
+
+    /**
+     * @brief VUPRS_FORCE_SCALAR is set (and not "0").
+     */
+    bool CPUForceScalar();
+
+    /**
+     * @brief Names of the features, e.g. "sse2 ssse3 avx2".
+     */
+    std::string CPUFeaturesString(const uint64_t &features);
+
+    template <typename Function>
+    struct CPUKernelVariant
+    {
+        const char *name;
+        uint64_t requiredFeatures;  /* 0 = scalar, runs everywhere */
+        Function function;
+    };
+
+    /**
+     * @brief Record the variant selected for a kernel (see ActiveCPUKernels()).
+     */
+    void RegisterCPUKernel(const std::string &kernelName, const std::string &variantName);
+
+    /**
+     * @brief Select the first variant whose features are all present.
+     * @note List the fastest variant first & a scalar variant (requiredFeatures = 0) last.
+     *       With VUPRS_FORCE_SCALAR only variants without required features are taken.
+     */
+    template <typename Function, size_t N>
+    Function SelectCPUKernel(const char *kernelName, const vuprs::CPUKernelVariant<Function> (&variants)[N])
+    {
+        const uint64_t features = vuprs::CPUForceScalar() ? 0 : vuprs::DetectCPUFeatures();
+
+        for (size_t i = 0; i < N; i++)
+        {
+            if ((variants[i].requiredFeatures & features) == variants[i].requiredFeatures)
+            {
+                vuprs::RegisterCPUKernel(kernelName, variants[i].name);
+                return variants[i].function;
+            }
+        }
+
+        vuprs::RegisterCPUKernel(kernelName, variants[N - 1].name);
+        return variants[N - 1].function;
+    }
+
+    /**
+     * @brief Kernel name & selected variant of every registered kernel.
+     */
+    std::vector<std::pair<std::string, std::string>> ActiveCPUKernels();
+
+    /**
+     * @brief Features & active kernels, one line each.
+     */
+    std::string CPUDispatchReport();
+}
+
+#endif
@@ -0,0 +1,129 @@
+/**
+ * @brief   This document is the DMA auto-tuner (transfer size calibration).
+ * @version 1.0
+ * @author  Shixuan Liu, Tongji University
+ * @date    2026-10
+ */
+
+#ifndef DMA_AUTOTUNE_H
+#define DMA_AUTOTUNE_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+
+#include <sys/utsname.h>
+
+#include "nlohmann/json.hpp"
+
+#include "fpga_config.h"
+#include "fpga_control.h"
+#include "aligned_data_structure.h"
+
+#define DMA_AUTOTUNE_DEFAULT_SCRATCH_BYTES        (16 * 1024 * 1024UL)  /* 16 MB at the end of DDR */
+#define DMA_AUTOTUNE_DEFAULT_MEASURE_MS           200U
+
+namespace vuprs
+{
+    typedef struct DMATunerConfig
+    {
+        uint64_t scratchDdrOffset;  /* DDR region used for measurement (read only) */
+        uint64_t scratchByteSize;
+        uint64_t measureDuration_ms;  /* Duration of each sweep point */
+
+        std::vector<uint64_t> chunkSizes;  /* Candidate transfer sizes (bytes) */
+    };
+
+    typedef struct DMATuningPoint
+    {
+        uint64_t chunkSize;
+        double throughput_bytesPerSecond;
+    };
+
+    typedef struct DMATuningResult
+    {
+        std::string cacheKey;  /* Kernel release + device + alignment, cache is valid only for the same key */
+        vuprs::DMATuningPoint best;
+        std::vector<vuprs::DMATuningPoint> sweep;
+
+        bool configdown;
+    };
+
+    class DMAAutoTuner
+    {
+        private:
+
+            vuprs::FPGAController *fpgaController;
+            vuprs::DMATunerConfig tunerConfig;
+
+            double MeasurePoint(const uint64_t &chunkSize);
+
+        public:
+
+            /**
+             * @param fpgaController controller with config loaded, must outlive the tuner.
+             * @throw std::runtime_error
+             */
+            DMAAutoTuner(vuprs::FPGAController *fpgaController);
+            ~DMAAutoTuner();
+
+            /**
+             * @brief Default sweep: 4 kB ~ 4 MB, scratch region is the last DMA_AUTOTUNE_DEFAULT_SCRATCH_BYTES of DDR.
+             * @note Transfers are measured one after another on channel 0, as the stream, the capture recorder
+             *       and the replay issue them.
+             */
+            static vuprs::DMATunerConfig DefaultTunerConfig(const vuprs::FPGAConfigManager &configManager);
+
+            /**
+             * @brief Cache key of the current system (transport, kernel release, C2H device, alignment).
+             */
+            static std::string CacheKey(const vuprs::FPGAController &fpgaController);
+
+            void SetTunerConfig(const vuprs::DMATunerConfig &config);
+
+            /**
+             * @brief Sweep all candidates and pick the highest throughput.
+             * @param result sweep result.
+             * @param progress called after every measured point (optional).
+             * @retval true: tune success;
+             *         false: all points failed.
+             * @throw std::runtime_error
+             */
+            bool Tune(vuprs::DMATuningResult *result, const std::function<void(const vuprs::DMATuningPoint&)> &progress = nullptr);
+
+            /**
+             * @brief Load the tuning cache, tune and save it when the cache is missing or stale.
+             * @param cacheFilename cache file (empty = always tune, nothing saved).
+             * @param result tuning result.
+             * @param loadedFromCache true when no measurement was needed.
+             * @retval true: result valid;
+             *         false: tune failed.
+             */
+            bool LoadOrTune(const std::string &cacheFilename, vuprs::DMATuningResult *result, bool *loadedFromCache = nullptr, const std::function<void(const vuprs::DMATuningPoint&)> &progress = nullptr);
+    };
+
+    /**
+     * @brief Load tuning result from cache file.
+     * @retval true: load success & key matches <expectedKey>;
+     *         false: missing, broken or stale cache.
+     */
+    bool LoadDMATuningCache(const std::string &cacheFilename, const std::string &expectedKey, vuprs::DMATuningResult *result);
+
+    /**
+     * @brief Save tuning result to cache file.
+     */
+    bool SaveDMATuningCache(const std::string &cacheFilename, const vuprs::DMATuningResult &result);
+
+    /**
+     * @brief Write the tuned transfer size to the XDMA driver config (max-transfer-size-bytes).
+     */
+    bool ApplyDMATuning(const vuprs::DMATuningResult &result, vuprs::FPGAConfigManager *configManager);
+}
+
+#endif
@@ -0,0 +1,136 @@
+/**
+ * @brief   This document is the DMA benchmark (C2H, H2C and loopback throughput, latency and CPU usage).
+ * @version 1.0
+ * @author  Shixuan Liu, Tongji University
+ * @date    2026-10
+ */
+
+#ifndef DMA_BENCHMARK_H
+#define DMA_BENCHMARK_H
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/utsname.h>
+
+#include "nlohmann/json.hpp"
+
+#include "fpga_config.h"
+#include "fpga_control.h"
+#include "aligned_data_structure.h"
+
+#define DMA_BENCHMARK_MODE__C2H                   0U  /* FPGA -> Host */
+#define DMA_BENCHMARK_MODE__H2C                   1U  /* Host -> FPGA */
+#define DMA_BENCHMARK_MODE__LOOPBACK              2U  /* Host -> FPGA -> Host, verified */
+
+#define IS_DMA_BENCHMARK_MODE(VAL) \
+((VAL) == DMA_BENCHMARK_MODE__C2H || (VAL) == DMA_BENCHMARK_MODE__H2C || \
+ (VAL) == DMA_BENCHMARK_MODE__LOOPBACK)
+
+#define DMA_BENCHMARK_DEFAULT_SCRATCH_BYTES       (16 * 1024 * 1024UL)  /* 16 MB at the end of DDR (overwritten) */
+#define DMA_BENCHMARK_DEFAULT_DURATION_MS         500U
+
+namespace vuprs
+{
+    typedef struct DMABenchmarkConfig
+    {
+        uint64_t scratchDdrOffset;  /* DDR region used for the benchmark, H2C & loopback overwrite it */
+        uint64_t scratchByteSize;
+        uint64_t duration_ms;  /* Duration of each sweep point */
+
+        std::vector<uint8_t> modes;  /* DMA_BENCHMARK_MODE__xxx */
+        std::vector<uint64_t> transferSizes;  /* Bytes per transfer */
+        std::vector<uint64_t> channelCounts;  /* Concurrent channels, one worker per channel */
+    };
+
+    typedef struct DMABenchmarkPoint
+    {
+        uint8_t mode;
+        uint64_t transferSize;
+        uint64_t channels;
+
+        uint64_t transfers;  /* Completed transfers (loopback: round trips) */
+        uint64_t verifyErrors;  /* Loopback only */
+        double elapsed_s;
+        double throughput_bytesPerSecond;
+
+        double latencyP50_us;  /* Per transfer (loopback: per round trip) */
+        double latencyP99_us;
+        double latencyP999_us;
+        double latencyMax_us;
+
+        double cpuUser_percent;  /* Process CPU time / wall time, 100 % = one core */
+        double cpuSystem_percent;
+
+        bool success;
+    };
+
+    typedef struct DMABenchmarkReport
+    {
+        std::string kernelRelease;
+        std::string machine;
+        std::string deviceC2H;
+        std::string deviceH2C;
+        std::vector<vuprs::DMABenchmarkPoint> points;
+    };
+
+    class DMABenchmark
+    {
+        private:
+
+            vuprs::FPGAController *fpgaController;
+            vuprs::DMABenchmarkConfig benchmarkConfig;
+
+            vuprs::DMABenchmarkPoint MeasurePoint(const uint8_t &mode, const uint64_t &transferSize, const uint64_t &channels);
+
+        public:
+
+            /**
+             * @param fpgaController controller with config loaded, must outlive the benchmark.
+             * @throw std::runtime_error
+             */
+            DMABenchmark(vuprs::FPGAController *fpgaController);
+            ~DMABenchmark();
+
+            /**
+             * @brief Default sweep: C2H, H2C & loopback, 4 kB ~ 4 MB, 1 ~ all channels,
+             *        scratch region is the last DMA_BENCHMARK_DEFAULT_SCRATCH_BYTES of DDR.
+             */
+            static vuprs::DMABenchmarkConfig DefaultBenchmarkConfig(const vuprs::FPGAConfigManager &configManager);
+
+            void SetBenchmarkConfig(const vuprs::DMABenchmarkConfig &config);
+
+            /**
+             * @brief Run all sweep points.
+             * @param report benchmark report.
+             * @param progress called after every measured point (optional).
+             * @retval true: all points success;
+             *         false: some points failed (still in the report).
+             * @throw std::runtime_error
+             */
+            bool Run(vuprs::DMABenchmarkReport *report, const std::function<void(const vuprs::DMABenchmarkPoint&)> &progress = nullptr);
+    };
+
+    /**
+     * @brief Name of the benchmark mode ("c2h", "h2c", "loopback").
+     */
+    const char *DMABenchmarkModeName(const uint8_t &mode);
+
+    /**
+     * @brief Save benchmark report as JSON.
+     */
+    bool SaveDMABenchmarkReport(const std::string &reportFilename, const vuprs::DMABenchmarkReport &report);
+}
+
+#endif
@@ -0,0 +1,106 @@
+/**
+ * @brief   This document is the capture recorder, which transfers DDR data directly into a memory mapped file.
+ * @version 1.0
+ * @author  Shixuan Liu, Tongji University
+ * @date    2026-10
+ */
+
+#ifndef DMA_CAPTURE_RECORDER_H
+#define DMA_CAPTURE_RECORDER_H
+
+#include <stdint.h>
+#include <string>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "fpga_config.h"
+#include "fpga_control.h"
+#include "aligned_data_structure.h"
+
+#define CAPTURE_RECORDER_DEFAULT_WINDOW_BYTES     (64 * 1024 * 1024UL)  /* 64 MB mapped window */
+
+namespace vuprs
+{
+    typedef struct CaptureRecorderConfig
+    {
+        std::string captureFilename;  /* Output file */
+        uint64_t captureByteSize;  /* Bytes preallocated for the capture (maximum recorded bytes) */
+        uint64_t windowByteSize;  /* Bytes of one mapped window, multiple of __XDMA_DMA_ALIGNMENT_BYTES__ */
+        uint8_t dmaChannel;  /* C2H channel */
+    };
+
+    /**
+     * @brief Record DDR data into a capture file without intermediate buffer.
+     * @note The capture file is preallocated with fallocate() and mapped in aligned windows,
+     *       every block is transferred by C2H DMA straight into the file pages. Dirty ranges
+     *       are handed to the kernel with sync_file_range() right after the transfer, so writeback
+     *       runs in background while the next block is transferred.
+     *
+     *       Blocks are appended in order, every block except the last one must be a multiple
+     *       of __XDMA_DMA_ALIGNMENT_BYTES__ to keep the destination pages aligned.
+     */
+    class DMACaptureRecorder
+    {
+        private:
+
+            vuprs::FPGAController *fpgaController;
+            vuprs::CaptureRecorderConfig recorderConfig;
+
+            int file_fd;
+            uint8_t *window;  /* Mapped window */
+            uint64_t windowFileOffset;  /* File offset of the mapped window */
+            uint64_t windowBytes;  /* Bytes of the mapped window */
+
+            uint64_t recordedBytes;  /* Bytes written to the file */
+            uint64_t flushedBytes;  /* Bytes whose writeback has completed */
+
+            bool MapWindow(const uint64_t &fileOffset, const uint64_t &minimumBytes);
+            void UnmapWindow();
+
+        public:
+
+            /**
+             * @param fpgaController controller with config loaded, must outlive the recorder.
+             */
+            DMACaptureRecorder(vuprs::FPGAController *fpgaController);
+            ~DMACaptureRecorder();
+
+            DMACaptureRecorder(const DMACaptureRecorder&) = delete;
+            DMACaptureRecorder& operator=(const DMACaptureRecorder&) = delete;
+
+            /**
+             * @brief Create (truncate) and preallocate the capture file.
+             * @param config recorder config.
+             * @retval true: open success;
+             *         false: open/preallocate failed.
+             * @throw std::runtime_error
+             */
+            bool Open(const vuprs::CaptureRecorderConfig &config);
+
+            /**
+             * @brief Transfer a DDR block straight into the capture file (appended).
+             * @param ddrOffset DDR offset of the block.
+             * @param transferBytes bytes of the block.
+             * @retval true: record success;
+             *         false: DMA failed or capture file is full.
+             * @throw std::runtime_error
+             */
+            bool Record(const uint64_t &ddrOffset, const uint64_t &transferBytes);
+
+            /**
+             * @brief Wait for all writeback, unmap, and truncate the file to the recorded size.
+             * @retval true: close success;
+             *         false: close failed.
+             */
+            bool Close();
+
+            bool IsOpen() const;
+            uint64_t RecordedBytes() const;
+    };
+}
+
+#endif
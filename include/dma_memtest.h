@@ -0,0 +1,131 @@
+/**
+ * @brief   This document is the FPGA DDR memory test (pattern write by H2C, read back by C2H and verify).
+ * @version 1.0
+ * @author  Shixuan Liu, Tongji University
+ * @date    2026-10
+ */
+
+#ifndef DMA_MEMTEST_H
+#define DMA_MEMTEST_H
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <condition_variable>
+#include <stdexcept>
+
+#include "fpga_config.h"
+#include "fpga_control.h"
+#include "aligned_data_structure.h"
+
+#define DMA_MEMTEST_PATTERN__WALKING_ONES         0U  /* Word n = 1 << (n % 32) */
+#define DMA_MEMTEST_PATTERN__ADDRESS              1U  /* Word = its own DDR byte address */
+#define DMA_MEMTEST_PATTERN__PRBS                 2U  /* xorshift32 sequence (period 2^32 - 1), reseeded every page */
+
+#define IS_DMA_MEMTEST_PATTERN(VAL) \
+((VAL) == DMA_MEMTEST_PATTERN__WALKING_ONES || (VAL) == DMA_MEMTEST_PATTERN__ADDRESS || \
+ (VAL) == DMA_MEMTEST_PATTERN__PRBS)
+
+#define DMA_MEMTEST_PAGE_BYTES                    4096U  /* Generate & compare unit, stays in L1 */
+#define DMA_MEMTEST_DEFAULT_MAX_REPORTED_ERRORS   16U
+
+namespace vuprs
+{
+    typedef struct DMAMemTestConfig
+    {
+        uint64_t ddrOffset;  /* Tested region (default: whole DDR) */
+        uint64_t byteSize;
+        uint64_t blockByteSize;  /* Bytes per DMA transfer, multiple of DMA_MEMTEST_PAGE_BYTES */
+
+        uint64_t verifyThreads;  /* Threads comparing read-back data */
+        uint64_t maxReportedErrors;  /* Bad words kept in the result (all are counted) */
+
+        std::vector<uint8_t> patterns;  /* DMA_MEMTEST_PATTERN__xxx */
+    };
+
+    typedef struct DMAMemTestError
+    {
+        uint64_t ddrAddress;  /* DDR byte offset of the bad word */
+        uint32_t expected;
+        uint32_t actual;
+    };
+
+    typedef struct DMAMemTestResult
+    {
+        uint8_t pattern;
+        uint64_t testedBytes;
+        uint64_t errorWords;
+
+        double writeElapsed_s;
+        double readElapsed_s;  /* Read back & verify */
+        double writeThroughput_bytesPerSecond;
+        double readThroughput_bytesPerSecond;
+
+        std::vector<vuprs::DMAMemTestError> firstErrors;  /* Lowest addresses first */
+
+        bool transferSuccess;  /* false: DMA failed, errors may be incomplete */
+    };
+
+    class DMAMemTest
+    {
+        private:
+
+            vuprs::FPGAController *fpgaController;
+            vuprs::DMAMemTestConfig memTestConfig;
+
+            bool WritePattern(const uint8_t &pattern, std::vector<vuprs::AlignedBufferDMA> &bufferPool, vuprs::DMAMemTestResult *result);
+            bool VerifyPattern(const uint8_t &pattern, std::vector<vuprs::AlignedBufferDMA> &bufferPool, vuprs::DMAMemTestResult *result);
+
+        public:
+
+            /**
+             * @param fpgaController controller with config loaded, must outlive the test.
+             * @throw std::runtime_error
+             */
+            DMAMemTest(vuprs::FPGAController *fpgaController);
+            ~DMAMemTest();
+
+            /**
+             * @brief Default test: whole DDR, all patterns, block = max-transfer-size-bytes.
+             */
+            static vuprs::DMAMemTestConfig DefaultMemTestConfig(const vuprs::FPGAConfigManager &configManager);
+
+            /**
+             * @throw std::runtime_error: invalid region or block size.
+             */
+            void SetMemTestConfig(const vuprs::DMAMemTestConfig &config);
+
+            /**
+             * @brief Write & verify all patterns.
+             * @note Pattern generation, H2C/C2H transfers on all channels and verification run
+             *       in separate threads over a pool of aligned buffers.
+             * @param results one result per pattern.
+             * @param progress called after every pattern (optional).
+             * @retval true: no bad word & all transfers success;
+             *         false: DDR error or DMA failed.
+             * @throw std::runtime_error, std::bad_alloc
+             */
+            bool Run(std::vector<vuprs::DMAMemTestResult> *results, const std::function<void(const vuprs::DMAMemTestResult&)> &progress = nullptr);
+    };
+
+    /**
+     * @brief Name of the test pattern ("walking-ones", "address", "prbs").
+     */
+    const char *DMAMemTestPatternName(const uint8_t &pattern);
+
+    /**
+     * @brief Fill words with the pattern value of their DDR address.
+     * @param ddrAddress DDR byte offset of words[0], aligned to DMA_MEMTEST_PAGE_BYTES for PRBS.
+     */
+    void DMAMemTestFillPattern(const uint8_t &pattern, const uint64_t &ddrAddress, uint32_t *words, const uint64_t &wordCount);
+}
+
+#endif
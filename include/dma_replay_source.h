@@ -0,0 +1,131 @@
+/**
+ * @brief   This document is the capture replay source (a raw DDR dump streamed as if it came from C2H DMA).
+ * @version 1.0
+ * @author  Shixuan Liu, Tongji University
+ * @date    2026-10
+ */
+
+#ifndef DMA_REPLAY_SOURCE_H
+#define DMA_REPLAY_SOURCE_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifndef _WIN32
+#include <sys/timerfd.h>
+#endif
+
+#include "fpga_config.h"
+#include "dma_stream.h"
+
+#define CAPTURE_REPLAY_LATE_THRESHOLD_S           1e-3  /* A read released later than this after its deadline is late */
+
+namespace vuprs
+{
+    typedef struct CaptureReplayConfig
+    {
+        std::string captureFilename;  /* Raw DDR dump (fpga_tool --rw r --bus full) */
+        std::shared_ptr<const std::vector<uint32_t>> captureWords;  /* In-memory capture (GenerateADCCapture()), replaces the file */
+        uint64_t fileOffset;  /* First byte replayed */
+        uint64_t byteSize;  /* Bytes replayed per loop, 0 = to the end of the file (cut to a multiple of 4) */
+        double frameRate_Hz;  /* Frames per second of the capture (real time) */
+        uint64_t frameBytes;  /* Bytes per frame (header + data + tailer) */
+        double speed;  /* Multiple of real time, 0 = as fast as possible (no pacing) */
+        uint64_t loops;  /* Passes over the file, 0 = endless until Stop() */
+    };
+
+    typedef struct CaptureReplayReport
+    {
+        uint64_t deliveredBytes;
+        uint64_t completedLoops;
+        double elapsed_s;  /* First read -> last read */
+
+        double requestedRate_bytesPerSecond;  /* frameRate_Hz * frameBytes * speed, 0 = unpaced */
+        double achievedRate_bytesPerSecond;
+        double rateRatio;  /* achieved / requested, 0 when unpaced */
+
+        uint64_t reads;
+        uint64_t lateReads;  /* Reads released more than CAPTURE_REPLAY_LATE_THRESHOLD_S after their deadline */
+        double maxLag_s;  /* Largest delay of a read behind its deadline (consumer too slow) */
+    };
+
+    /**
+     * @brief Synthetic capture: frames of the layout with a sine on every channel (channel c: c + 1 periods per
+     *        1024 frames, half full scale) and broken CRCs (crcErrorRate per data word).
+     * @throw std::runtime_error, when frame features are invalid (see CheckFrameFeatures()).
+     */
+    std::vector<uint32_t> GenerateADCCapture(const vuprs::FPGAhardwareConfigFrame &frameFeatures, const uint64_t &frames,
+                                             const double &crcErrorRate, const uint64_t &seed);
+
+    /**
+     * @brief Stream a capture file as if it came from the C2H channel.
+     * @note Paced reads: the read that brings the stream to byte n is released at start + n / requested rate,
+     *       the deadline is absolute (timerfd, CLOCK_MONOTONIC, TFD_TIMER_ABSTIME), so a slow consumer is not
+     *       charged twice and the pacing never drifts. Reads behind their deadline are released at once and
+     *       counted in the report (headroom of the pipeline = rateRatio at the highest speed that keeps up).
+     *       A loop ends at the end of the replayed region, so a frame cut by the loop boundary is dropped by
+     *       the parser like a frame cut by a DMA fault.
+     */
+    class CaptureReplaySource : public vuprs::ADCByteSource
+    {
+        private:
+
+            vuprs::CaptureReplayConfig replayConfig;
+
+            int file_fd;
+            std::shared_ptr<const std::vector<uint32_t>> captureWords;
+            int timer_fd;
+            uint64_t loopBytes;  /* Bytes of the replayed region */
+            uint64_t loopOffset;  /* Read position in the current loop */
+
+            double requestedRate_bytesPerSecond;
+            int64_t startTime_ns;
+            int64_t lastReadTime_ns;
+
+            vuprs::CaptureReplayReport replayReport;
+            std::atomic<bool> stopRequested;
+
+            bool WaitUntil(const int64_t &deadline_ns);
+
+        public:
+
+            CaptureReplaySource();
+            ~CaptureReplaySource();
+
+            CaptureReplaySource(const CaptureReplaySource&) = delete;
+            CaptureReplaySource& operator=(const CaptureReplaySource&) = delete;
+
+            /**
+             * @brief Open the capture file (or take the in-memory capture) & the pacing timer.
+             * @retval true: open success;
+             *         false: file or timer cannot be opened.
+             * @throw std::runtime_error, when the config is invalid.
+             */
+            bool Open(const vuprs::CaptureReplayConfig &config);
+            void Close();
+
+            /**
+             * @brief End the stream at the next read (any thread, also wakes a paced read).
+             */
+            void Stop();
+
+            const char *Name() const override;
+            uint64_t TotalBytes() const override;
+            bool Read(void *data, const uint64_t &maxBytes, uint64_t *readBytes) override;
+
+            /**
+             * @brief Achieved against requested rate so far (call after the stream for the final figures).
+             */
+            vuprs::CaptureReplayReport Report() const;
+    };
+}
+
+#endif
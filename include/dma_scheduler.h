@@ -0,0 +1,142 @@
+/**
+ * @brief   This document is the DMA request scheduler in front of FPGA controller.
+ * @version 1.0
+ * @author  Shixuan Liu, Tongji University
+ * @date    2026-10
+ */
+
+#ifndef DMA_SCHEDULER_H
+#define DMA_SCHEDULER_H
+
+#include <stdint.h>
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <future>
+#include <chrono>
+#include <condition_variable>
+#include <stdexcept>
+
+#include "fpga_config.h"
+#include "fpga_control.h"
+#include "aligned_data_structure.h"
+
+/* ------------------------------------------ Request Classes --------------------------------------------- */
+
+#define DMA_REQUEST_CLASS__REALTIME               0  /* Live acquisition, strict priority */
+#define DMA_REQUEST_CLASS__BULK                   1  /* Downloads, self-test, bandwidth capped */
+
+#define DMA_REQUEST_CLASSES                       2
+
+#define IS_DMA_REQUEST_CLASS(VAL) \
+(VAL == DMA_REQUEST_CLASS__REALTIME               || \
+ VAL == DMA_REQUEST_CLASS__BULK)
+
+#define DMA_SCHEDULER_DEFAULT_MAX_MERGE_BYTES     (8 * 1024 * 1024UL)  /* 8 MB */
+
+namespace vuprs
+{
+    typedef struct DMASchedulerConfig
+    {
+        uint64_t bulkBandwidthLimit_bytesPerSecond;  /* Bandwidth cap of bulk class, 0 = unlimited */
+        uint64_t maxMergedTransferBytes;  /* Upper bound of a coalesced read */
+    };
+
+    typedef struct DMAClassMetrics
+    {
+        uint64_t requests;  /* Completed requests */
+        uint64_t transfers;  /* DMA transfers issued (< requests when reads are coalesced) */
+        uint64_t transferredBytes;  /* Bytes moved over PCIe */
+        uint64_t failedRequests;
+
+        uint64_t queueTimeTotal_ns;  /* Submit -> dispatch */
+        uint64_t queueTimeMax_ns;
+        uint64_t serviceTimeTotal_ns;  /* Dispatch -> complete */
+        uint64_t serviceTimeMax_ns;
+    };
+
+    typedef struct DMAScheduledRequest
+    {
+        vuprs::DMATransferConfig transferConfig;
+        void *data;
+        int requestClass;
+        std::chrono::steady_clock::time_point submitTime;
+        std::promise<bool> completion;
+    };
+
+    /**
+     * @brief Queue DMA requests per direction and serve them on all XDMA channels.
+     * @note 1. Requests of DMA_REQUEST_CLASS__REALTIME are always served before bulk requests;
+     *       2. Bulk requests are limited by a token bucket (bulkBandwidthLimit_bytesPerSecond);
+     *       3. Queued C2H reads of the same class which overlap or are adjacent in DDR are merged
+     *          into one transfer and scattered to the requesters afterwards;
+     *       4. The channel in DMATransferConfig is ignored, one worker runs per channel.
+     */
+    class DMAScheduler
+    {
+        private:
+
+            vuprs::FPGAController *fpgaController;
+            vuprs::DMASchedulerConfig schedulerConfig;
+
+            std::deque<vuprs::DMAScheduledRequest> requestQueues[2][DMA_REQUEST_CLASSES];  /* [direction][class] */
+            vuprs::DMAClassMetrics classMetrics[DMA_REQUEST_CLASSES];
+
+            double bulkTokens;  /* Bytes allowed for bulk class, may be negative after a large transfer */
+            std::chrono::steady_clock::time_point bulkTokensUpdateTime;
+
+            std::vector<std::thread> workers;
+            mutable std::mutex schedulerMutex;
+            std::condition_variable schedulerCondition;
+            bool stopRequested;
+
+            void WorkerLoop(const int direction, const uint8_t channel);
+            void RefillBulkTokens(const std::chrono::steady_clock::time_point &now);
+            bool SelectRequests(const int &direction, std::vector<vuprs::DMAScheduledRequest> *batch, std::chrono::steady_clock::time_point *wakeTime);
+            bool ExecuteBatch(const int &direction, const uint8_t &channel, std::vector<vuprs::DMAScheduledRequest> *batch, vuprs::AlignedBufferDMA *bounceBuffer, uint64_t *transferredBytes);
+
+        public:
+
+            /**
+             * @param fpgaController controller with config loaded, must outlive the scheduler.
+             * @param config scheduler config.
+             * @throw std::runtime_error
+             */
+            DMAScheduler(vuprs::FPGAController *fpgaController, const vuprs::DMASchedulerConfig &config);
+            ~DMAScheduler();
+
+            DMAScheduler(const DMAScheduler&) = delete;
+            DMAScheduler& operator=(const DMAScheduler&) = delete;
+
+            /**
+             * @brief Queue a request.
+             * @param transferConfig transfer config (channel is ignored).
+             * @param data destination (read) or source (write) memory of transferByteSize bytes,
+             *             must stay valid until the future is ready. Aligned memory avoids a bounce copy.
+             * @param requestClass DMA_REQUEST_CLASS__REALTIME or DMA_REQUEST_CLASS__BULK.
+             * @retval future of the transfer result.
+             * @throw std::runtime_error
+             */
+            std::future<bool> Submit(const vuprs::DMATransferConfig &transferConfig, void *data, const int &requestClass);
+
+            /**
+             * @brief Queue a request and wait for it.
+             */
+            bool Transfer(const vuprs::DMATransferConfig &transferConfig, void *data, const int &requestClass);
+
+            /**
+             * @brief Snapshot of the metrics of one class.
+             * @retval true: success;
+             *         false: invalid class.
+             */
+            bool GetClassMetrics(const int &requestClass, vuprs::DMAClassMetrics *metrics) const;
+
+            /**
+             * @brief Stop all workers, queued requests complete with false.
+             */
+            void Stop();
+    };
+}
+
+#endif
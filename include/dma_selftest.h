@@ -0,0 +1,89 @@
+/**
+ * @brief   This document is the self-test of the DMA layers above FPGA controller (scheduler, S2MM SG engine).
+ * @version 1.0
+ * @author  Shixuan Liu, Tongji University
+ * @date    2026-10
+ */
+
+#ifndef DMA_SELFTEST_H
+#define DMA_SELFTEST_H
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <future>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <stdexcept>
+
+#include "fpga_config.h"
+#include "fpga_control.h"
+#include "aligned_data_structure.h"
+#include "dma_scheduler.h"
+#include "dma_memtest.h"
+#include "fpga_dma_sg.h"
+#include "fpga_sim_card.h"
+#include "adc_stream_parser.h"
+
+#define DMA_SELFTEST_MERGE_REQUESTS               64U  /* Adjacent bulk reads queued at once */
+#define DMA_SELFTEST_MERGE_REQUEST_BYTES          (16 * 1024UL)
+#define DMA_SELFTEST_CAP_REQUESTS                 32U  /* Bulk reads with gaps (never merged) */
+#define DMA_SELFTEST_CAP_REQUEST_BYTES            (256 * 1024UL)
+#define DMA_SELFTEST_CAP_BANDWIDTH                (32 * 1024 * 1024UL)  /* Bulk cap of the test, bytes/s */
+#define DMA_SELFTEST_CAP_TOLERANCE                1.1  /* Achieved bulk rate <= cap * tolerance */
+#define DMA_SELFTEST_SG_DDR_OFFSET                (16 * 1024 * 1024UL)  /* Descriptors, then buffers (after the scheduler regions) */
+#define DMA_SELFTEST_SG_DESCRIPTORS               16U
+#define DMA_SELFTEST_SG_BUFFER_BYTES              (16 * 1024UL)
+#define DMA_SELFTEST_SG_LAPS                      3U  /* Blocks checked = laps * descriptors, the ring wraps */
+#define DMA_SELFTEST_SG_SAMPLE_PERIOD             10e-6  /* Simulated ADC, s (100 kframes/s) */
+#define DMA_SELFTEST_SG_TIMEOUT                   2.0  /* s */
+
+namespace vuprs
+{
+    typedef struct DMASelfTestResult
+    {
+        std::string name;  /* "scheduler-merge", "scheduler-cap", "scheduler-priority", "sg-flow-control", "sg-cyclic" */
+        bool success;
+        std::string detail;  /* Measured values, reason of a failure */
+    };
+
+    /**
+     * @brief Check the DMA scheduler on the card of the controller (any transport),
+     *        and the S2MM SG engine against the frame generator of the simulated card.
+     * @note The test regions from DDR offset 0 are overwritten (like DMAMemTest).
+     */
+    class DMASelfTest
+    {
+        private:
+
+            vuprs::FPGAController *fpgaController;
+
+            bool WriteRegion(const uint64_t &byteSize, vuprs::AlignedBufferDMA *expected);
+            vuprs::DMASelfTestResult CheckSchedulerMerge();
+            void CheckSchedulerBandwidth(vuprs::DMASelfTestResult *capResult, vuprs::DMASelfTestResult *priorityResult);
+            vuprs::DMASelfTestResult CheckScatterGather(const bool &cyclicMode);
+
+        public:
+
+            /**
+             * @param fpgaController controller with config loaded, must outlive the test.
+             * @throw std::runtime_error
+             */
+            DMASelfTest(vuprs::FPGAController *fpgaController);
+            ~DMASelfTest();
+
+            /**
+             * @brief Run all checks.
+             * @param results one result per check.
+             * @param progress called after every check (optional).
+             * @retval true: all checks passed;
+             *         false: a check failed.
+             * @throw std::runtime_error, std::bad_alloc
+             */
+            bool Run(std::vector<vuprs::DMASelfTestResult> *results, const std::function<void(const vuprs::DMASelfTestResult&)> &progress = nullptr);
+    };
+}
+
+#endif
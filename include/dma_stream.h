@@ -0,0 +1,197 @@
+/**
+ * @brief   This document is the streaming DMA transfer between files and FPGA DDR, and from DDR (or any byte source) to ADC samples.
+ * @version 1.0
+ * @author  Shixuan Liu, Tongji University
+ * @date    2026-10
+ */
+
+#ifndef DMA_STREAM_H
+#define DMA_STREAM_H
+
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <functional>
+#include <condition_variable>
+#include <stdexcept>
+
+#include "fpga_config.h"
+#include "fpga_control.h"
+#include "dma_scheduler.h"
+#include "aligned_data_structure.h"
+#include "fpga_data_parse.h"
+#include "adc_channel_buffer.h"
+#include "adc_time.h"
+
+#define DMA_STREAM_BUFFERS                        2U  /* Double buffering */
+#define DMA_STREAM_PARSE_CHUNK_BYTES              (256 * 1024UL)  /* DDR -> samples: chunk + its samples stay in L2 */
+
+namespace vuprs
+{
+    typedef struct DMAStreamConfig
+    {
+        uint64_t chunkByteSize;  /* Bytes of each aligned chunk, memory use is DMA_STREAM_BUFFERS * chunkByteSize */
+        uint8_t dmaChannel;
+    };
+
+    typedef struct DMAStreamProgress
+    {
+        uint64_t transferredBytes;
+        uint64_t totalBytes;
+        double elapsed_s;
+        double throughput_bytesPerSecond;
+    };
+
+    typedef struct ADCStreamChunk
+    {
+        uint64_t chunkIndex;
+        uint64_t ddrOffset;  /* DDR offset of the chunk (stream offset for other sources) */
+        uint64_t chunkBytes;
+        uint64_t firstSample;  /* Index of samples->channel(c)[0] in the whole capture */
+        const vuprs::ADCChannelBuffer<double> *samples;  /* Frames completed by this chunk (may be 0 samples) */
+        double elapsed_s;  /* Since the start of the stream, elapsed_s of the first chunk is the latency to the first sample */
+        const vuprs::ADCTimeDescriptor *time;  /* Time axis of the samples, nullptr when the capture has none */
+    };
+
+    /**
+     * @brief Byte stream of ADC frames (C2H DMA of a DDR capture, a replayed capture file).
+     * @note Read from one thread at a time (the reader thread of StreamSourceToADCChannels()).
+     */
+    class ADCByteSource
+    {
+        public:
+
+            virtual ~ADCByteSource() {}
+
+            virtual const char *Name() const = 0;
+
+            /**
+             * @brief Bytes of the whole stream, 0 = unknown (endless).
+             */
+            virtual uint64_t TotalBytes() const = 0;
+
+            /**
+             * @brief Read the next bytes of the stream.
+             * @param data destination, aligned to __XDMA_DMA_ALIGNMENT_BYTES__.
+             * @param maxBytes bytes wanted (multiple of 4).
+             * @param readBytes bytes read, a multiple of 4 (0 = end of stream).
+             * @retval true: read success or end of stream;
+             *         false: read failed.
+             * @throw std::runtime_error
+             */
+            virtual bool Read(void *data, const uint64_t &maxBytes, uint64_t *readBytes) = 0;
+    };
+
+    /**
+     * @brief C2H DMA of a DDR region, a read is split into transfers of max-transfer-size-bytes.
+     */
+    class DDRByteSource : public vuprs::ADCByteSource
+    {
+        private:
+
+            vuprs::FPGAController *fpgaController;
+            vuprs::DMAScheduler *scheduler;
+            vuprs::DMATransferConfig transferConfig;
+            uint64_t ddrOffset;
+            uint64_t totalBytes;
+            uint64_t readOffset;
+            uint64_t transferBytes;  /* Bytes per DMA transfer (max-transfer-size-bytes, tuned), 0 = whole read */
+
+        public:
+
+            /**
+             * @param fpgaController controller with config loaded, must outlive the source.
+             * @param scheduler queue the transfers as DMA_REQUEST_CLASS__REALTIME (optional, nullptr = direct
+             *                  AXIFull_IO() on dmaChannel), must outlive the source.
+             * @throw std::runtime_error
+             */
+            DDRByteSource(vuprs::FPGAController *fpgaController, const uint64_t &ddrOffset, const uint64_t &totalBytes, const uint8_t &dmaChannel,
+                          vuprs::DMAScheduler *scheduler = nullptr);
+            ~DDRByteSource();
+
+            const char *Name() const override;
+            uint64_t TotalBytes() const override;
+            bool Read(void *data, const uint64_t &maxBytes, uint64_t *readBytes) override;
+    };
+
+    /**
+     * @brief Upload a file region to DDR without staging the whole payload.
+     * @note A reader thread fills one aligned chunk from the file while the other chunk is
+     *       transferred by H2C DMA, so file reads and DMA overlap.
+     * @param fpgaController controller with config loaded.
+     * @param fileName source file.
+     * @param fileOffset offset in the source file.
+     * @param ddrOffset destination offset in DDR.
+     * @param totalBytes bytes to upload.
+     * @param streamConfig chunk size & channel.
+     * @param progress called after every chunk (optional).
+     * @param summary final progress (optional).
+     * @retval true: upload success;
+     *         false: file read or DMA failed.
+     * @throw std::runtime_error, std::bad_alloc
+     */
+    bool StreamFileToDDR(vuprs::FPGAController *fpgaController,
+                         const std::string &fileName, const uint64_t &fileOffset,
+                         const uint64_t &ddrOffset, const uint64_t &totalBytes,
+                         const vuprs::DMAStreamConfig &streamConfig,
+                         const std::function<void(const vuprs::DMAStreamProgress&)> &progress = nullptr,
+                         vuprs::DMAStreamProgress *summary = nullptr);
+
+    /**
+     * @brief Read a capture from DDR and convert it to volts chunk by chunk.
+     * @note One aligned chunk is transferred by C2H DMA (worker thread) while the other is parsed on the
+     *       calling thread, so the latency to the first samples is one chunk instead of the whole capture.
+     *       A frame cut by the chunk boundary is completed by the next chunk (ADCStreamParser), the samples
+     *       of all chunks equal BufferData2ADCChannels() on the whole capture. Use chunks of DMA_STREAM_PARSE_CHUNK_BYTES unless tuned otherwise.
+     * @param fpgaController controller with config loaded.
+     * @param ddrOffset source offset in DDR.
+     * @param totalBytes bytes to read (multiple of 4).
+     * @param streamConfig chunk size (multiple of 4) & channel.
+     * @param adcFeatures adc features, must be load in advance (from JSON file).
+     * @param frameFeatures frame layout.
+     * @param onChunk called after every chunk on the calling thread, samples are valid during the call.
+     * @param summary final progress (optional).
+     * @param captureTime time axis of the first sample of the capture (optional), every chunk gets it advanced
+     *                    by its first sample (ADCTimeDescriptor::Advance()).
+     * @param calibration channel calibration (optional, hardwareConfigCalibration of the config): samples are physical
+     *                    values (NaN when the CRC is broken) instead of volts, see WordsData2ADCChannels().
+     * @param scheduler DMA scheduler shared with other consumers of the card (optional): the reads are queued as
+     *                  DMA_REQUEST_CLASS__REALTIME instead of using streamConfig.dmaChannel directly.
+     * @retval true: read success;
+     *         false: DMA failed (chunks before the failure were delivered).
+     * @throw std::runtime_error, std::bad_alloc, exceptions of onChunk (the DMA is stopped first).
+     */
+    bool StreamDDRToADCChannels(vuprs::FPGAController *fpgaController,
+                                const uint64_t &ddrOffset, const uint64_t &totalBytes,
+                                const vuprs::DMAStreamConfig &streamConfig,
+                                const vuprs::FPGAhardwareConfigADC &adcFeatures,
+                                const vuprs::FPGAhardwareConfigFrame &frameFeatures,
+                                const std::function<void(const vuprs::ADCStreamChunk&)> &onChunk,
+                                vuprs::DMAStreamProgress *summary = nullptr,
+                                const vuprs::ADCTimeDescriptor *captureTime = nullptr,
+                                const vuprs::FPGAhardwareConfigCalibration *calibration = nullptr,
+                                vuprs::DMAScheduler *scheduler = nullptr);
+
+    /**
+     * @brief Read any byte source and convert it to volts chunk by chunk (StreamDDRToADCChannels() on a source).
+     * @note The source is read on a worker thread while the previous chunk is parsed on the calling thread,
+     *       the stream ends when the source returns 0 bytes. ADCStreamChunk::ddrOffset is the stream offset.
+     * @param source byte source, read until its end.
+     * @param streamConfig chunk size (multiple of 4), the channel is not used.
+     * @retval true: stream complete;
+     *         false: source read failed (chunks before the failure were delivered).
+     * @throw std::runtime_error, std::bad_alloc, exceptions of onChunk (the reader is stopped first).
+     */
+    bool StreamSourceToADCChannels(vuprs::ADCByteSource *source,
+                                   const vuprs::DMAStreamConfig &streamConfig,
+                                   const vuprs::FPGAhardwareConfigADC &adcFeatures,
+                                   const vuprs::FPGAhardwareConfigFrame &frameFeatures,
+                                   const std::function<void(const vuprs::ADCStreamChunk&)> &onChunk,
+                                   vuprs::DMAStreamProgress *summary = nullptr,
+                                   const vuprs::ADCTimeDescriptor *captureTime = nullptr,
+                                   const vuprs::FPGAhardwareConfigCalibration *calibration = nullptr);
+}
+
+#endif
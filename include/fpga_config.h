@@ -10,6 +10,7 @@
 
 #include <stdint.h>
 #include <string>
+#include <vector>
 #include <fstream>
 #include <iostream>
 
@@ -94,6 +95,32 @@ namespace vuprs
 
         uint64_t adcMaxSamplingFrequency_Hz;
         double adcVoltageRangeRadius;
+        uint64_t adcSamplingClock_Hz;  /* Clock of the sampling timer, 0 = unknown (no time axis) */
+        uint64_t adcSCIAccumulatorBits;  /* 0: SCI = clock cycles per sample, N: SCI = increment of an N-bit phase accumulator */
+
+        bool configdown;
+    };
+
+    typedef struct FPGAhardwareConfigFrame
+    {
+        uint64_t channels;  /* ADC channels per frame (data words between header & tailer) */
+        uint64_t dataWidth_bits;  /* 16: [31:16] value, [15:8] CRC of value[15:8], [7:0] CRC of value[7:0];
+                                     24: [31:8] value, [7:0] CRC of value[23:16], value[15:8], value[7:0] */
+        uint64_t header;
+        uint64_t tailer;
+        std::vector<uint64_t> storageOrder;  /* storageOrder[c]: data word of channel c */
+
+        bool configdown;
+    };
+
+    typedef struct FPGAhardwareConfigCalibration
+    {
+        /* Index is the result channel (channel order), physical = (volt * gain + offset_v) * sensitivity */
+
+        std::vector<double> gain;
+        std::vector<double> offset_v;  /* Volt */
+        std::vector<double> sensitivity;  /* Physical unit per volt */
+        std::vector<std::string> unit;  /* Physical unit, e.g. "V", "g", "Pa" */
 
         bool configdown;
     };
@@ -108,11 +135,31 @@ namespace vuprs
 
         FPGAhardwareConfigADC hardwareConfigADC;
 
+        /* ADC Frame Layout */
+
+        FPGAhardwareConfigFrame hardwareConfigFrame;
+
+        /* ADC Channel Calibration */
+
+        FPGAhardwareConfigCalibration hardwareConfigCalibration;
+
         bool configdown;
     };
     
+    typedef struct FPGASimulationConfig
+    {
+        /* Simulated card only (transport "simulated", see fpga_sim_card.h) */
+
+        double crcErrorRate;  /* Probability of a broken CRC per data word, 0 = clean frames */
+        double clockDrift_ppm;  /* Sampling clock of the card against the host clock */
+        uint64_t seed;  /* Seed of the CRC error pattern */
+    };
+
     typedef struct XDMADriverConfig
     {
+        std::string transport;  /* "xdma": XDMA device files (default); "simulated": software card, no hardware */
+        vuprs::FPGASimulationConfig simulation;
+
         std::string deviceFilename_xdma_control;
         std::string deviceFilename_xdma_user;
         std::vector<std::string> deviceFilename_xdma_h2c;
@@ -120,6 +167,7 @@ namespace vuprs
         std::vector<std::string> deviceFilename_xdma_events;
 
         uint64_t maxTransferSize_bytes;
+        std::string tuningCacheFilename;  /* DMA tuning cache, empty = no cache */
 
         bool configdown;
     };
@@ -154,9 +202,18 @@ namespace vuprs
             /* input json["hardware-features"] */
             bool ParseHardwareFeatures(const nlohmann::json &jsonData);
 
+            /* input json["hardware-features"]["adc"]["frame"] */
+            bool ParseFrameFeatures(const nlohmann::json &jsonData);
+
+            /* input json["hardware-features"]["adc"]["calibration"] */
+            bool ParseCalibration(const nlohmann::json &jsonData);
+
             /* input json["xdma-driver"] */
             bool ParseXDMADriverConfig(const nlohmann::json &jsonData);
 
+            /* input json["xdma-driver"]["simulation"] */
+            bool ParseSimulationConfig(const nlohmann::json &jsonData);
+
             /* -------------------------- Parse Digital --------------------------- */
 
         public:
@@ -185,6 +242,8 @@ namespace vuprs
     int ParseIntegerFromString(const std::string &dataString, bool *status);
 
     uint64_t ParseNumberFromString(const std::string &dataString, bool *status);
+
+    double ParseDecimalFromString(const std::string &dataString, bool *status);
 }
 
 #endif
@@ -13,16 +13,13 @@
 #include <stdint.h>
 #include <string>
 #include <vector>
+#include <memory>
 #include <fstream>
+#include <algorithm>
 #include <stdexcept>
 
-#ifndef _WIN32
-#include <sys/mman.h>
-#endif
-
-#include <fcntl.h>
-
 #include "fpga_config.h"
+#include "fpga_transport.h"
 #include "aligned_data_structure.h"
 
 /* --------------------------------------- AXI-Lite Registers --------------------------------------- */
@@ -49,6 +46,8 @@
 #define AXI_LITE_REGISTER__DMA__S2MM_DA_MSB       14
 #define AXI_LITE_REGISTER__DMA__S2MM_LENGTH       15
 
+#define AXI_LITE_REGISTER_COUNT                   16  /* AXI_LITE_REGISTER__xxx are 0 ~ AXI_LITE_REGISTER_COUNT - 1 */
+
 /* AXI-Lite User Access */
 
 #define __AXI_LITE__DMA_USER_ADDRESS              16
@@ -93,7 +92,6 @@
 /* ----------------------------------- Fixed Transfer Parameters ------------------------------------ */
 
 #define __LINUX_DMA_MAX_TRANSFER_BYTES__          0x7ffff000  /* Maximum transfer size in Linux-32bit or Linux-64bit */
-#define __XDMA_AXI_LITE_MMAP_SIZE__               (2 * 64 * 1024UL)  /* 2 * 64 kB address in VUPRS FPGA AXI-Lite bus address space */
 
 namespace vuprs
 {
@@ -113,11 +111,16 @@ namespace vuprs
     {
         private:
             vuprs::FPGAConfigManager fpgaConfigManager;
+            std::shared_ptr<vuprs::FPGATransport> transport;  /* Shared by copies of the controller (same card) */
+
+            void ConfigureTransport();
 
             uint64_t AXILite_GetRegisterOffset(const int &registerSelection, bool *status = nullptr);
             bool AXILite_FPGARegisterIO(const std::string &rd_wr, const int &registerSelection, const uint32_t &w_value, uint32_t *r_value, const uint64_t &base, const uint64_t &offset, const bool &use_mmap = false);
 
+            void AXIFull_CheckTransfer(const vuprs::DMATransferConfig &transferConfig);
             bool AXIFull_BufferIO(const vuprs::DMATransferConfig &transferConfig, vuprs::AlignedBufferDMA *buffer);
+            bool AXIFull_PointerIO(const vuprs::DMATransferConfig &transferConfig, void *alignedData);
 
         public:
 
@@ -137,6 +140,18 @@ namespace vuprs
              */
             bool LoadFPGAConfig(const vuprs::FPGAConfigManager &newFPGAConfig);
 
+            /**
+             * @brief Get the loaded FPGA configuration.
+             * @note Check ConfigDown() of the returned manager before using the data.
+             * @retval config manager of this controller.
+             */
+            const vuprs::FPGAConfigManager &GetFPGAConfig() const;
+
+            /**
+             * @brief Name of the transport in use (FPGA_TRANSPORT__xxx), empty before a config is loaded.
+             */
+            std::string TransportName() const;
+
             /**
              * @brief Write word (32 bit) to register on AXI-Lite bus of FPGA (use Simple method).
              * @param registerSelection target register.
@@ -171,6 +186,19 @@ namespace vuprs
              */
             bool AXIFull_IO(const vuprs::DMATransferConfig &transferConfig, vuprs::AlignedBufferDMA *buffer);
 
+            /**
+             * @brief Write/Read data to/from DDR on AXI-Full bus of FPGA with caller-provided memory (use DMA method).
+             * @note No buffer is allocated, data is transferred directly to/from <alignedData>
+             *       (e.g. pages of a memory mapped file).
+             * @param transferConfig transfer config parameters.
+             * @param alignedData destination (read) or source (write) memory, must hold
+             *                    transferConfig.transferByteSize bytes and be aligned to __XDMA_DMA_ALIGNMENT_BYTES__.
+             * @retval true: write/read success;
+             *         false: write/read failed.
+             * @throw std::runtime_error
+             */
+            bool AXIFull_IO(const vuprs::DMATransferConfig &transferConfig, void *alignedData);
+
             /**
              * @brief Read data on AXI-Lite bus.
              * @param base base address of the memory space (relative to AXI-Lite).
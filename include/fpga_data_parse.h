@@ -8,12 +8,15 @@
 #ifndef FPGA_DATA_PARSE_H
 #define FPGA_DATA_PARSE_H
 
+#include <array>
 #include <vector>
 #include <fstream>
 #include <stdint.h>
+#include <type_traits>
 
 #include "fpga_config.h"
 #include "aligned_data_structure.h"
+#include "adc_channel_buffer.h"
 
 /**
  * 
@@ -95,6 +98,15 @@
 #define ADC_CHANNELS                     16U
 #define ADC_DATAWIDTH                    16U
 
+/**
+ * The macros above are the default frame layout, other layouts are described in the JSON config
+ * (json["hardware-features"]["adc"]["frame"], see FPGAhardwareConfigFrame)
+ */
+
+#define ADC_FRAME_MAX_CHANNELS           64U  /* Pass masks are 64 bit */
+
+#define IS_ADC_FRAME_DATAWIDTH(VAL)      ((VAL) == 16U || (VAL) == 24U)
+
 /**
  * CRC Code (CRC8_CDMA2000)
  * CRC p(x) = 1+x^1+x^3+x^4+x^7+x^8 (9'b110011011)
@@ -124,6 +136,119 @@ namespace vuprs
      */
     bool BufferData2ADCChannels(const vuprs::AlignedBufferDMA *buffer, std::vector<std::vector<double>> *result, const vuprs::FPGAhardwareConfigADC &adcFeatures);
 
+    /**
+     * @brief Convert buffer data to ADC Channels (channel-major, no allocation once result is large enough).
+     * @param buffer data buffer, must be written in advance.
+     * @param result ADC_CHANNELS channels, result->channel(c)[d] means: channel is 'c' & data pointer is 'd',
+     *               channel order is the same as the vector version. Capacity is kept, reuse it across calls.
+     * @param adcFeatures adc features, must be load in advance (from JSON file).
+     * @param threadCount parse threads, 0 = all cores, result is the same for every count (see LocateADCFramesParallel()).
+     * @retval true: convert success;
+     *         false: convert failed (do not find data in the buffer).
+     * @throw Same as the vector version, std::bad_alloc when result can not grow.
+     */
+    bool BufferData2ADCChannels(const vuprs::AlignedBufferDMA *buffer, vuprs::ADCChannelBuffer<double> *result, const vuprs::FPGAhardwareConfigADC &adcFeatures,
+                                const uint32_t &threadCount = 1);
+
+    /**
+     * @brief Default frame features (ADC_CHANNELS, ADC_DATAWIDTH, ADC_DATA_HEADER, ADC_DATA_TAILER, ADC_CHANNEL__xxx).
+     */
+    vuprs::FPGAhardwareConfigFrame DefaultFrameFeatures();
+
+    /**
+     * @brief Validate frame features: 1 ~ ADC_FRAME_MAX_CHANNELS channels, 16 or 24 bits, header != tailer,
+     *        storage order is a permutation of the data words.
+     * @throw std::runtime_error (reason).
+     */
+    void CheckFrameFeatures(const vuprs::FPGAhardwareConfigFrame &frameFeatures);
+
+    /**
+     * @brief Data word of an ADC value with its CRC (inverse of the frame decode, used by frame generators).
+     * @param value ADC code, the low <dataWidth_bits> bits are used.
+     * @param dataWidth_bits 16: [31:16] value, [15:8] CRC of value[15:8], [7:0] CRC of value[7:0];
+     *                       24: [31:8] value, [7:0] CRC of value[23:16], value[15:8], value[7:0].
+     */
+    uint32_t EncodeADCDataWord(const int32_t &value, const uint64_t &dataWidth_bits);
+
+    /**
+     * @brief Convert buffer data to raw ADC codes (2 bytes per sample, volts are calculated later, see adc_channel_scaling.h).
+     * @param buffer data buffer, must be written in advance.
+     * @param result ADC_CHANNELS channels of signed ADC codes, channel order is the same as the vector version.
+     *               Samples with broken CRC keep the received code, check crcPassMasks.
+     * @param crcPassMasks CRC pass mask of every frame, bit c = result channel c (optional).
+     * @param threadCount parse threads, 0 = all cores.
+     * @retval true: convert success;
+     *         false: convert failed (do not find data in the buffer).
+     * @throw std::runtime_error("Buffer is empty, convert disabled"), when buffer is empty.
+     */
+    bool BufferData2ADCChannels(const vuprs::AlignedBufferDMA *buffer, vuprs::ADCChannelBuffer<int16_t> *result, std::vector<uint16_t> *crcPassMasks,
+                                const uint32_t &threadCount = 1);
+
+    /**
+     * @brief Same as the int16_t version, ADC codes as float (4 bytes per sample, ready for DSP).
+     */
+    bool BufferData2ADCChannels(const vuprs::AlignedBufferDMA *buffer, vuprs::ADCChannelBuffer<float> *result, std::vector<uint16_t> *crcPassMasks,
+                                const uint32_t &threadCount = 1);
+
+    /**
+     * @brief Convert buffer data of any frame layout (frame features from JSON).
+     * @note Layouts of 16/32 channels with 16/24 bits have their own decode kernels, others take the generic kernel.
+     * @param frameFeatures frame layout, result has frameFeatures.channels channels in channel order
+     *                      (channel c is data word frameFeatures.storageOrder[c]).
+     * @param crcPassMasks CRC pass mask of every frame, bit c = result channel c (optional).
+     * @throw Same as the default layout versions;
+     *        std::runtime_error("Do not find frame features, convert disabled"), when frame features are empty;
+     *        std::runtime_error, when frame features are invalid (see CheckFrameFeatures()).
+     */
+    bool BufferData2ADCChannels(const vuprs::AlignedBufferDMA *buffer, vuprs::ADCChannelBuffer<double> *result, const vuprs::FPGAhardwareConfigADC &adcFeatures,
+                                const vuprs::FPGAhardwareConfigFrame &frameFeatures, const uint32_t &threadCount = 1);
+    bool BufferData2ADCChannels(const vuprs::AlignedBufferDMA *buffer, vuprs::ADCChannelBuffer<int32_t> *result, std::vector<uint64_t> *crcPassMasks,
+                                const vuprs::FPGAhardwareConfigFrame &frameFeatures, const uint32_t &threadCount = 1);
+    bool BufferData2ADCChannels(const vuprs::AlignedBufferDMA *buffer, vuprs::ADCChannelBuffer<float> *result, std::vector<uint64_t> *crcPassMasks,
+                                const vuprs::FPGAhardwareConfigFrame &frameFeatures, const uint32_t &threadCount = 1);
+
+    /**
+     * @brief Convert a word range to volts (a chunk of a stream, see StreamDDRToADCChannels()).
+     * @note Only complete frames are converted, the words from stopPosition are the start of the next chunk:
+     *       parsing chunk after chunk this way gives the same frames as parsing the whole stream at once.
+     * @param words word range (no alignment needed beyond 4 bytes).
+     * @param wordCount words in the range, 0 = nothing to convert.
+     * @param result frameFeatures.channels channels in channel order. Capacity is kept, reuse it across calls.
+     * @param adcFeatures adc features, must be load in advance (from JSON file).
+     * @param frameFeatures frame layout.
+     * @param stopPosition offset of the first header whose frame passes the end of the range, or wordCount (see LocateADCFrames()).
+     * @param threadCount parse threads, 0 = all cores.
+     * @retval true: convert success;
+     *         false: no frame in the range.
+     * @throw Same as the frame features versions, std::runtime_error("*Words is nullptr.").
+     */
+    bool WordsData2ADCChannels(const uint32_t *words, const uint64_t &wordCount, vuprs::ADCChannelBuffer<double> *result,
+                               const vuprs::FPGAhardwareConfigADC &adcFeatures, const vuprs::FPGAhardwareConfigFrame &frameFeatures,
+                               uint64_t *stopPosition, const uint32_t &threadCount = 1);
+
+    /**
+     * @brief Same as above, physical values of a channel calibration (ADCChannelScalingFromCalibration() for any layout):
+     *        (volt * gain + offset_v) * sensitivity, NaN when the CRC is broken.
+     * @throw Same as above, std::runtime_error when the calibration is empty or invalid (see CheckCalibration()).
+     */
+    bool WordsData2ADCChannels(const uint32_t *words, const uint64_t &wordCount, vuprs::ADCChannelBuffer<double> *result,
+                               const vuprs::FPGAhardwareConfigADC &adcFeatures, const vuprs::FPGAhardwareConfigFrame &frameFeatures,
+                               const vuprs::FPGAhardwareConfigCalibration &calibration, uint64_t *stopPosition, const uint32_t &threadCount = 1);
+
+    /**
+     * @brief Convert frames located in advance (see ADCStreamParser) and append them to result.
+     * @note No frame search: frame f starts at words + frameOffsets[f]. The samples of result are kept when it has
+     *       frameFeatures.channels channels, so the frames of one chunk can come in several calls.
+     * @param result frameFeatures.channels channels in channel order, frameCount samples are appended.
+     * @throw Same as WordsData2ADCChannels().
+     */
+    void FramesData2ADCChannels(const uint32_t *words, const uint64_t *frameOffsets, const uint64_t &frameCount,
+                                vuprs::ADCChannelBuffer<double> *result, const vuprs::FPGAhardwareConfigADC &adcFeatures,
+                                const vuprs::FPGAhardwareConfigFrame &frameFeatures);
+    void FramesData2ADCChannels(const uint32_t *words, const uint64_t *frameOffsets, const uint64_t &frameCount,
+                                vuprs::ADCChannelBuffer<double> *result, const vuprs::FPGAhardwareConfigADC &adcFeatures,
+                                const vuprs::FPGAhardwareConfigFrame &frameFeatures, const vuprs::FPGAhardwareConfigCalibration &calibration);
+
     class CRC8List
     {
         private:
@@ -138,24 +263,48 @@ namespace vuprs
             uint8_t CRCValue(const uint8_t &source);
     };
 
+    /**
+     * @brief One frame as it is stored in the buffer (overlay of ADC_FRAME_WORD_LENGTH words, decode in place).
+     * @note const vuprs::ADCFrameWords *frame = reinterpret_cast<const vuprs::ADCFrameWords*>(words + headerOffset);
+     *       CRC of the whole frame: vuprs::CheckADCFrameCRC(frame->data).
+     */
+    typedef struct ADCFrameWords
+    {
+        uint32_t header;
+        uint32_t data[ADC_CHANNELS];  /* [31:16] ADC value, [15:8] CRC of value[15:8], [7:0] CRC of value[7:0] */
+        uint32_t tailer;
+
+        int16_t Value(const uint32_t &position) const { return static_cast<int16_t>(this->data[position] >> 16); }
+        uint8_t CRCHigh(const uint32_t &position) const { return static_cast<uint8_t>(this->data[position] >> 8); }
+        uint8_t CRCLow(const uint32_t &position) const { return static_cast<uint8_t>(this->data[position]); }
+    };
+
     class ADCFrame
     {
         private:
 
-            std::vector<uint16_t> adcData;
-            std::vector<uint8_t> crcDataH, crcDataL;
+            std::array<uint16_t, ADC_CHANNELS> adcData;
+            std::array<uint8_t, ADC_CHANNELS> crcDataH, crcDataL;
 
         public:
 
             ADCFrame();
-            ~ADCFrame();
 
             void UpdateData(const int &index, const uint32_t &data);
 
+            /**
+             * @brief Update all channels from the data words of a frame (word after the header).
+             */
+            void UpdateFrame(const uint32_t *dataWords);
+
             bool CheckCRC(const int &channel);
             uint16_t GetChannelValue(const int &channel);
 
     };
+
+    static_assert(sizeof(vuprs::ADCFrameWords) == ADC_FRAME_WORD_LENGTH * sizeof(uint32_t), "ADCFrameWords must match the frame layout.");
+    static_assert(std::is_trivially_copyable<vuprs::ADCFrameWords>::value, "ADCFrameWords must be trivially copyable.");
+    static_assert(std::is_trivially_copyable<vuprs::ADCFrame>::value, "ADCFrame must be trivially copyable.");
 }
 
 #endif
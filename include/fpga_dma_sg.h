@@ -0,0 +1,266 @@
+/**
+ * @brief   This document is the scatter-gather (SG) descriptor ring management for AXI DMA S2MM channel.
+ * @version 1.0
+ * @author  Shixuan Liu, Tongji University
+ * @date    2026-10
+ */
+
+#ifndef FPGA_DMA_SG_H
+#define FPGA_DMA_SG_H
+
+#include <stdint.h>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+#include "fpga_config.h"
+#include "fpga_control.h"
+#include "aligned_data_structure.h"
+
+/**
+ *
+ * S2MM descriptor layout (refer to Xilinx PG021 AXI DMA, Scatter Gather Descriptor).
+ *
+ * Every descriptor occupies 16 words (64 bytes) in DDR, descriptors must be 16-word aligned.
+ *
+ * -----------------------------------------------------------------
+ *      Field                            Word index
+ * -----------------------------------------------------------------
+ *
+ */
+
+#define SG_DESCRIPTOR__NXTDESC                     0U
+#define SG_DESCRIPTOR__NXTDESC_MSB                 1U
+#define SG_DESCRIPTOR__BUFFER_ADDRESS              2U
+#define SG_DESCRIPTOR__BUFFER_ADDRESS_MSB          3U
+#define SG_DESCRIPTOR__CONTROL                     6U
+#define SG_DESCRIPTOR__STATUS                      7U
+
+#define SG_DESCRIPTOR_WORDS                        16U
+#define SG_DESCRIPTOR_BYTES                        (SG_DESCRIPTOR_WORDS * 4U)  /* 64 bytes, also the required alignment */
+
+/* Descriptor control & status bits */
+
+#define SG_DESCRIPTOR_LENGTH_MASK                  0x03FFFFFFU  /* Buffer length / transferred bytes, 26 bit */
+
+#define SG_DESCRIPTOR_STATUS__RXEOF                (1U << 26)
+#define SG_DESCRIPTOR_STATUS__RXSOF                (1U << 27)
+#define SG_DESCRIPTOR_STATUS__DMA_INT_ERR          (1U << 28)
+#define SG_DESCRIPTOR_STATUS__DMA_SLV_ERR          (1U << 29)
+#define SG_DESCRIPTOR_STATUS__DMA_DEC_ERR          (1U << 30)
+#define SG_DESCRIPTOR_STATUS__CMPLT                (1U << 31)
+
+#define SG_DESCRIPTOR_STATUS__ERROR_MASK \
+(SG_DESCRIPTOR_STATUS__DMA_INT_ERR | SG_DESCRIPTOR_STATUS__DMA_SLV_ERR | SG_DESCRIPTOR_STATUS__DMA_DEC_ERR)
+
+/* S2MM_DMACR bits */
+
+#define S2MM_DMACR__RS                             (1U << 0)
+#define S2MM_DMACR__RESET                          (1U << 2)
+#define S2MM_DMACR__CYCLIC_BD_ENABLE               (1U << 4)
+
+/* S2MM_DMASR bits */
+
+#define S2MM_DMASR__HALTED                         (1U << 0)
+#define S2MM_DMASR__IDLE                           (1U << 1)
+#define S2MM_DMASR__SG_INCLD                       (1U << 3)
+#define S2MM_DMASR__DMA_INT_ERR                    (1U << 4)
+#define S2MM_DMASR__DMA_DEC_ERR                    (1U << 6)
+#define S2MM_DMASR__SG_INT_ERR                     (1U << 8)
+#define S2MM_DMASR__SG_DEC_ERR                     (1U << 10)
+#define S2MM_DMASR__IOC_IRQ                        (1U << 12)
+#define S2MM_DMASR__DLY_IRQ                        (1U << 13)
+#define S2MM_DMASR__ERR_IRQ                        (1U << 14)
+#define S2MM_DMASR__IRQ_MASK                       (S2MM_DMASR__IOC_IRQ | S2MM_DMASR__DLY_IRQ | S2MM_DMASR__ERR_IRQ)  /* Write 1 to clear */
+#define S2MM_DMASR__ERROR_MASK                     0x00000770U  /* DMAIntErr, DMASlvErr, DMADecErr, SGIntErr, SGSlvErr, SGDecErr */
+
+#define SG_REGISTER_POLL_RETRIES                   1000U
+
+namespace vuprs
+{
+    typedef struct SGRingConfigS2MM
+    {
+        uint64_t descriptorDdrOffset;  /* DDR offset of descriptor 0 (64-byte aligned) */
+        uint64_t bufferDdrOffset;  /* DDR offset of the buffer of descriptor 0, buffers are contiguous */
+        uint64_t bufferByteSize;  /* Bytes of each buffer (<= SG_DESCRIPTOR_LENGTH_MASK) */
+        uint32_t descriptorCount;  /* Number of descriptors in the ring (>= 2) */
+        uint32_t sgControl;  /* Value written to SG_CTL before start (SG cache & user) */
+        bool cyclicMode;  /* true: cyclic BD mode (never stops, TAILDESC is not used for flow control) */
+    };
+
+    typedef struct SGCompletedBlock
+    {
+        uint32_t descriptorIndex;
+        uint64_t ddrOffset;  /* DDR offset of the received data */
+        uint64_t transferredBytes;
+        uint32_t status;  /* Raw status word of the descriptor */
+    };
+
+    /**
+     * @brief Host-side state of an S2MM descriptor ring.
+     * @note This class does not access the card, it only builds descriptor images and decodes
+     *       images read back from DDR, so it can run against any memory model.
+     *
+     *       Descriptor ownership:
+     *       [harvestIndex, harvestIndex + hardwareOwned)  owned by hardware (armed);
+     *       [releaseIndex, harvestIndex)                  harvested, waiting for Release().
+     */
+    class SGDescriptorRingS2MM
+    {
+        private:
+
+            vuprs::SGRingConfigS2MM ringConfig;
+            uint64_t axiDdrBaseAddress;  /* AXI address of DDR offset 0 (as seen by the AXI DMA) */
+
+            uint32_t harvestIndex;
+            uint32_t releaseIndex;
+            uint32_t hardwareOwned;
+
+            bool configured;
+
+        public:
+
+            SGDescriptorRingS2MM();
+            ~SGDescriptorRingS2MM();
+
+            /**
+             * @brief Configure the ring, all descriptors are owned by hardware after configuration.
+             * @param config ring config.
+             * @param axiDdrBaseAddress AXI address of DDR offset 0 (as seen by the AXI DMA).
+             * @param ddrCapacityBytes DDR capacity, used for range check.
+             * @retval true: config success;
+             *         false: invalid config (alignment, size or overlap).
+             */
+            bool Configure(const vuprs::SGRingConfigS2MM &config, const uint64_t &axiDdrBaseAddress, const uint64_t &ddrCapacityBytes);
+
+            /**
+             * @brief Reset ownership, all descriptors are owned by hardware.
+             */
+            void Reset();
+
+            bool IsConfigured() const;
+            const vuprs::SGRingConfigS2MM &GetRingConfig() const;
+
+            uint64_t DescriptorDDROffset(const uint32_t &index) const;
+            uint64_t DescriptorAXIAddress(const uint32_t &index) const;
+            uint64_t BufferDDROffset(const uint32_t &index) const;
+
+            /**
+             * @brief AXI address to write to TAILDESC.
+             * @note Flow control mode: the last armed descriptor;
+             *       cyclic mode: an address outside the chain (required by PG021).
+             */
+            uint64_t TailDescriptorAXIAddress() const;
+
+            /**
+             * @brief Build the armed image of descriptors [firstIndex, firstIndex + count).
+             * @param firstIndex first descriptor, count must not wrap around the ring end.
+             * @param image output words, must hold count * SG_DESCRIPTOR_WORDS words.
+             * @throw std::out_of_range
+             */
+            void BuildDescriptors(const uint32_t &firstIndex, const uint32_t &count, uint32_t *image) const;
+
+            /**
+             * @brief Descriptor span to read back for harvesting, starting at the harvest index.
+             * @param firstIndex first descriptor owned by hardware.
+             * @param count number of descriptors (may wrap around the ring end).
+             */
+            void HarvestWindow(uint32_t *firstIndex, uint32_t *count) const;
+
+            /**
+             * @brief Decode descriptors read back from DDR and advance the harvest index.
+             * @param firstIndex index of the first descriptor in the image (must be the harvest index).
+             * @param count number of descriptors in the image.
+             * @param image descriptor words read from DDR.
+             * @param completed completed blocks are appended, in ring order.
+             * @retval number of harvested descriptors.
+             */
+            uint32_t Harvest(const uint32_t &firstIndex, const uint32_t &count, const uint32_t *image, std::vector<vuprs::SGCompletedBlock> *completed);
+
+            /**
+             * @brief Return harvested descriptors to the hardware.
+             * @param count number of descriptors to release (<= PendingRelease()).
+             * @param firstIndex first released descriptor (re-armed image must be written from here).
+             * @retval number of released descriptors.
+             */
+            uint32_t Release(const uint32_t &count, uint32_t *firstIndex);
+
+            uint32_t PendingRelease() const;
+            uint32_t HardwareOwned() const;
+    };
+
+    /**
+     * @brief Scatter-gather engine of AXI DMA S2MM channel.
+     * @note The descriptor ring is laid out in FPGA DDR through H2C writes, completed descriptors
+     *       are harvested by reading their status words through C2H.
+     */
+    class SGEngineS2MM
+    {
+        private:
+
+            vuprs::FPGAController *fpgaController;
+            vuprs::SGDescriptorRingS2MM descriptorRing;
+            vuprs::AlignedBufferDMA descriptorImage;
+            uint8_t dmaChannel;
+            bool running;
+
+            bool WriteDescriptors(const uint32_t &firstIndex, const uint32_t &count);
+            bool ReadDescriptors(const uint32_t &firstIndex, const uint32_t &count, uint32_t *image);
+            bool WriteAddressRegister(const int &registerLSB, const int &registerMSB, const uint64_t &address);
+            bool WaitRegister(const int &registerSelection, const uint32_t &mask, const bool &set);
+
+        public:
+
+            /**
+             * @param fpgaController controller with config loaded, must outlive the engine.
+             * @param dmaChannel XDMA channel used to access descriptors in DDR.
+             */
+            SGEngineS2MM(vuprs::FPGAController *fpgaController, const uint8_t &dmaChannel = 0);
+            ~SGEngineS2MM();
+
+            SGEngineS2MM(const SGEngineS2MM&) = delete;
+            SGEngineS2MM& operator=(const SGEngineS2MM&) = delete;
+
+            /**
+             * @brief Lay out the ring in DDR, reset the S2MM channel and start it in SG mode.
+             * @param ringConfig ring config.
+             * @retval true: start success;
+             *         false: start failed (invalid config or DMA does not leave halted state).
+             * @throw std::runtime_error
+             */
+            bool Start(const vuprs::SGRingConfigS2MM &ringConfig);
+
+            /**
+             * @brief Stop S2MM channel (clear RS and wait for halted).
+             */
+            bool Stop();
+
+            /**
+             * @brief Harvest completed descriptors.
+             * @param completed completed blocks are appended, in ring order.
+             * @retval number of harvested descriptors.
+             * @throw std::runtime_error
+             */
+            uint32_t Harvest(std::vector<vuprs::SGCompletedBlock> *completed);
+
+            /**
+             * @brief Give consumed buffers back to the hardware (re-arm & advance TAILDESC).
+             * @param count number of consumed blocks, in harvest order.
+             * @retval true: success;
+             *         false: failed.
+             * @throw std::runtime_error
+             */
+            bool Release(const uint32_t &count);
+
+            /**
+             * @brief Read S2MM_DMASR.
+             */
+            bool ReadStatus(uint32_t *dmasr);
+
+            bool IsRunning() const;
+            const vuprs::SGDescriptorRingS2MM &GetDescriptorRing() const;
+    };
+}
+
+#endif
@@ -0,0 +1,151 @@
+/**
+ * @brief   This document is the simulated card (AXI-Lite registers, DDR, ADC frame generator & AXI DMA S2MM in software).
+ * @version 1.0
+ * @author  Shixuan Liu, Tongji University
+ * @date    2026-10
+ */
+
+#ifndef FPGA_SIM_CARD_H
+#define FPGA_SIM_CARD_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <mutex>
+#include <algorithm>
+#include <stdexcept>
+
+#include "fpga_config.h"
+#include "fpga_transport.h"
+#include "fpga_control.h"
+
+/**
+ *
+ * Register semantics of the simulated card (json["xdma-driver"]["transport"] = "simulated").
+ *
+ * -----------------------------------------------------------------------------------------------------------------
+ *      Register     Access      Semantics
+ * -----------------------------------------------------------------------------------------------------------------
+ *      SCI          R/W         Sample period (see SamplePeriodFromSCI()), taken when a capture is triggered
+ *      SP           R/W         Sampling points (frames) of a capture, 0 = continuous until STR[0] is cleared
+ *      SF           R/W         Frames per AXI-Stream packet (TLAST), 0 = one packet per capture
+ *      STR          R/W         [0] trigger: write 1 starts a capture (NGF & ERR cleared), write 0 stops it,
+ *                                   reads 1 while sampling;
+ *                               [1] ready: capture complete (read only)
+ *      NGF          R           Frames generated since the trigger (32 bit, wraps)
+ *      ERR          R           [0] stream FIFO overflow: S2MM did not take the frames, the oldest were dropped
+ *
+ *      S2MM_xxx     -           AXI DMA S2MM (PG021): DMACR RS/Reset/Cyclic, DMASR Halted/Idle/errors/IOC (W1C),
+ *                               SG mode (CURDESC, TAILDESC starts fetching) or direct mode (DA, LENGTH starts)
+ * -----------------------------------------------------------------------------------------------------------------
+ *
+ * Other AXI-Lite addresses are plain memory. Host DMA (C2H/H2C) copies to/from the DDR model at memory speed.
+ * The card advances on every access (frames due by the host clock are generated & moved by S2MM), no thread runs.
+ *
+ */
+
+/* ADC STR & ERR bits */
+
+#define ADC_STR__TRIGGER                          (1U << 0)
+#define ADC_STR__READY                            (1U << 1)
+
+#define ADC_ERR__FIFO_OVERFLOW                    (1U << 0)
+
+#define SIM_CARD_STREAM_FIFO_FRAMES               4096U  /* Frames buffered between ADC & S2MM */
+#define SIM_CARD_WAVE_TABLE_SIZE                  1024U  /* Channel c: (c + 1) sine periods per 1024 frames, half full scale */
+
+namespace vuprs
+{
+    class SimulatedFPGACard : public vuprs::FPGATransport
+    {
+        private:
+
+            std::mutex cardMutex;
+
+            /* Config */
+
+            vuprs::FPGAConfig fpgaConfig;
+            uint64_t registerOffset[AXI_LITE_REGISTER_COUNT];  /* AXI-Lite offset of AXI_LITE_REGISTER__xxx */
+            std::vector<uint32_t> axiLiteSpace;  /* Register values & plain memory, __XDMA_AXI_LITE_MMAP_SIZE__ bytes */
+
+            uint8_t *ddr;
+            uint64_t ddrBytes;
+            uint64_t ddrAXIAddress;  /* AXI address of DDR offset 0 (descriptors & S2MM_DA) */
+
+            /* ADC frame generator */
+
+            bool sampling;
+            bool ready;
+            uint32_t adcError;
+            int64_t triggerTime_ns;
+            double samplePeriod_ns;  /* Host ns per frame (drift included) */
+            uint64_t captureFrames;  /* SP of the capture, 0 = continuous */
+            uint64_t packetFrames;  /* SF of the capture, 0 = one packet */
+            uint64_t generatedFrames;
+
+            uint64_t frameWords;
+            uint64_t streamBytes;  /* Bytes of the frame stream taken by S2MM (or dropped) */
+            std::vector<uint32_t> frameImage;
+            uint64_t frameImageIndex;
+            std::vector<int32_t> waveTable;
+            uint64_t crcErrorThreshold;  /* Data word gets a broken CRC when its hash < threshold */
+
+            /* AXI DMA S2MM */
+
+            uint32_t dmasr;
+            bool directActive;
+            uint64_t directDdrOffset;
+            uint64_t directLength;
+            uint64_t directTransferred;
+            bool sgActive;
+            uint64_t currentDescriptor;
+            uint64_t descriptorFilled;
+            bool packetStart;
+
+            int RegisterAt(const uint64_t &offset) const;
+            uint32_t &Register(const int &registerSelection);
+            uint64_t AddressRegister(const int &registerLSB, const int &registerMSB);
+            bool DDROffset(const uint64_t &axiAddress, const uint64_t &byteSize, uint64_t *ddrOffset) const;
+
+            void Trigger(const bool &start);
+            void BuildFrame(const uint64_t &frameIndex);
+            uint64_t StreamRead(uint8_t *destination, const uint64_t &maxBytes, bool *packetEnd);
+
+            void ResetS2MM();
+            void HaltS2MM(const uint32_t &errorBits);
+            void WriteDMACR(const uint32_t &value);
+            void RunDirect();
+            void RunScatterGather();
+
+            void Update();
+            void WriteRegister(const int &registerSelection, const uint32_t &w_value);
+            uint32_t ReadRegister(const int &registerSelection);
+
+        public:
+
+            SimulatedFPGACard();
+            ~SimulatedFPGACard();
+
+            SimulatedFPGACard(const SimulatedFPGACard&) = delete;
+            SimulatedFPGACard& operator=(const SimulatedFPGACard&) = delete;
+
+            const char *Name() const override;
+
+            /**
+             * @brief Take over the address map, DDR capacity, ADC & frame features and json["xdma-driver"]["simulation"].
+             * @note DDR content & a running capture are kept when the DDR capacity does not change.
+             * @throw std::runtime_error, std::bad_alloc
+             */
+            void Configure(const vuprs::FPGAConfig &fpgaConfig) override;
+
+            bool AXILiteRead(const uint64_t &offset, uint32_t *r_value, const bool &use_mmap) override;
+            bool AXILiteWrite(const uint64_t &offset, const uint32_t &w_value, const bool &use_mmap) override;
+
+            bool AXIFullRead(const uint8_t &channel, const uint64_t &busOffset, void *data, const uint64_t &byteSize) override;
+            bool AXIFullWrite(const uint8_t &channel, const uint64_t &busOffset, const void *data, const uint64_t &byteSize) override;
+    };
+}
+
+#endif
@@ -0,0 +1,119 @@
+/**
+ * @brief   This document is the transport under FPGAController (XDMA device files or a simulated card).
+ * @version 1.0
+ * @author  Shixuan Liu, Tongji University
+ * @date    2026-10
+ */
+
+#ifndef FPGA_TRANSPORT_H
+#define FPGA_TRANSPORT_H
+
+#include <stdint.h>
+#include <string>
+#include <memory>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <fcntl.h>
+
+#include "fpga_config.h"
+
+/* ------------------------------------------- Transports ------------------------------------------- */
+
+#define FPGA_TRANSPORT__XDMA                      "xdma"
+#define FPGA_TRANSPORT__SIMULATED                 "simulated"
+
+#define IS_FPGA_TRANSPORT(VAL) \
+(VAL == FPGA_TRANSPORT__XDMA                      || \
+ VAL == FPGA_TRANSPORT__SIMULATED)
+
+#define __XDMA_AXI_LITE_MMAP_SIZE__               (2 * 64 * 1024UL)  /* 2 * 64 kB address in VUPRS FPGA AXI-Lite bus address space */
+
+namespace vuprs
+{
+    /**
+     * @brief Raw bus access of the card.
+     * @note Selected by json["xdma-driver"]["transport"]. FPGAController does the register lookup and all
+     *       security checks, a transport only moves 32-bit words (AXI-Lite) and bytes (AXI-Full).
+     *       Transports must be thread safe (DMA pipelines access the card from worker threads).
+     */
+    class FPGATransport
+    {
+        public:
+
+            virtual ~FPGATransport() {}
+
+            /**
+             * @brief Transport name (FPGA_TRANSPORT__xxx).
+             */
+            virtual const char *Name() const = 0;
+
+            /**
+             * @brief Take over a loaded config (device files, address map, DDR capacity).
+             * @throw std::runtime_error
+             */
+            virtual void Configure(const vuprs::FPGAConfig &fpgaConfig) = 0;
+
+            /**
+             * @brief Read/Write a 32-bit word on AXI-Lite bus.
+             * @param offset byte offset relative to AXI-Lite base address (< __XDMA_AXI_LITE_MMAP_SIZE__).
+             * @param use_mmap XDMA: access through a memory map instead of lseek + read/write.
+             * @retval true: read/write success;
+             *         false: read/write failed.
+             * @throw std::runtime_error
+             */
+            virtual bool AXILiteRead(const uint64_t &offset, uint32_t *r_value, const bool &use_mmap) = 0;
+            virtual bool AXILiteWrite(const uint64_t &offset, const uint32_t &w_value, const bool &use_mmap) = 0;
+
+            /**
+             * @brief Read (C2H)/Write (H2C) bytes on AXI-Full bus.
+             * @param channel DMA channel (checked by FPGAController).
+             * @param busOffset byte offset relative to AXI-Full base address (DDR address offset + DDR offset).
+             * @retval true: all bytes transferred;
+             *         false: transfer failed.
+             * @throw std::runtime_error
+             */
+            virtual bool AXIFullRead(const uint8_t &channel, const uint64_t &busOffset, void *data, const uint64_t &byteSize) = 0;
+            virtual bool AXIFullWrite(const uint8_t &channel, const uint64_t &busOffset, const void *data, const uint64_t &byteSize) = 0;
+    };
+
+    /**
+     * @brief XDMA driver (device files of json["xdma-driver"]["device-files"]).
+     */
+    class XDMATransport : public vuprs::FPGATransport
+    {
+        private:
+
+            vuprs::XDMADriverConfig driverConfig;
+
+            int OpenDeviceFile(const std::string &deviceFilename);
+            bool AXILiteIO(const bool &write, const uint64_t &offset, const uint32_t &w_value, uint32_t *r_value, const bool &use_mmap);
+            bool AXIFullIO(const std::string &deviceFilename, const bool &write, const uint64_t &busOffset, void *data, const uint64_t &byteSize);
+
+        public:
+
+            XDMATransport();
+            ~XDMATransport();
+
+            const char *Name() const override;
+            void Configure(const vuprs::FPGAConfig &fpgaConfig) override;
+
+            bool AXILiteRead(const uint64_t &offset, uint32_t *r_value, const bool &use_mmap) override;
+            bool AXILiteWrite(const uint64_t &offset, const uint32_t &w_value, const bool &use_mmap) override;
+
+            bool AXIFullRead(const uint8_t &channel, const uint64_t &busOffset, void *data, const uint64_t &byteSize) override;
+            bool AXIFullWrite(const uint8_t &channel, const uint64_t &busOffset, const void *data, const uint64_t &byteSize) override;
+    };
+
+    /**
+     * @brief Create a transport by name (FPGA_TRANSPORT__xxx), not configured yet.
+     * @throw std::runtime_error, when the name is unknown.
+     */
+    std::shared_ptr<vuprs::FPGATransport> CreateFPGATransport(const std::string &transport);
+}
+
+#endif
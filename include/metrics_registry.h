@@ -0,0 +1,249 @@
+/**
+ * @brief   This document is the metrics registry (counters, gauges & histograms) and its HTTP text exposition.
+ * @version 1.0
+ * @author  Shixuan Liu, Tongji University
+ * @date    2026-10
+ */
+
+#ifndef METRICS_REGISTRY_H
+#define METRICS_REGISTRY_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <utility>
+#include <stdexcept>
+
+#define METRICS_SHARDS                            16U  /* Per-thread slots of a counter/histogram (threads share a slot beyond) */
+#define METRICS_CACHE_LINE_BYTES                  64U
+
+#define METRICS_HTTP_ADDRESS                      "127.0.0.1"  /* Local only */
+#define METRICS_HTTP_PATH                         "/metrics"
+#define METRICS_HTTP_MAX_REQUEST_BYTES            4096U
+#define METRICS_HTTP_TIMEOUT_MS                   1000  /* Client read/write timeout */
+#define METRICS_HTTP_POLL_MS                      200  /* Stop() latency */
+
+/* Metric types */
+
+#define METRICS_TYPE__COUNTER                     0
+#define METRICS_TYPE__GAUGE                       1
+#define METRICS_TYPE__HISTOGRAM                   2
+
+namespace vuprs
+{
+    typedef std::vector<std::pair<std::string, std::string>> MetricsLabels;  /* {name, value}, in exposition order */
+
+    /**
+     * @brief Slot of the calling thread, fixed at its first increment.
+     */
+    inline uint32_t MetricsShardIndex()
+    {
+        static std::atomic<uint32_t> nextShard(0);
+        thread_local const uint32_t shard = nextShard.fetch_add(1, std::memory_order_relaxed) % METRICS_SHARDS;
+
+        return shard;
+    }
+
+    /**
+     * @brief Monotonic counter, one cache line per shard: an increment is a relaxed add on the line of the thread
+     *        (no sharing between the DMA, parse & writer threads), the shards are summed on read.
+     */
+    class MetricsCounter
+    {
+        private:
+
+            struct alignas(METRICS_CACHE_LINE_BYTES) Shard
+            {
+                std::atomic<uint64_t> value;
+            };
+
+            Shard shards[METRICS_SHARDS];
+
+        public:
+
+            MetricsCounter();
+
+            MetricsCounter(const MetricsCounter&) = delete;
+            MetricsCounter& operator=(const MetricsCounter&) = delete;
+
+            inline void Add(const uint64_t &n = 1)
+            {
+                this->shards[vuprs::MetricsShardIndex()].value.fetch_add(n, std::memory_order_relaxed);
+            }
+
+            uint64_t Value() const;
+    };
+
+    /**
+     * @brief Last value (queue depth, rate...), a single atomic.
+     */
+    class MetricsGauge
+    {
+        private:
+
+            std::atomic<uint64_t> valueBits;  /* Bits of the double */
+
+        public:
+
+            MetricsGauge();
+
+            MetricsGauge(const MetricsGauge&) = delete;
+            MetricsGauge& operator=(const MetricsGauge&) = delete;
+
+            void Set(const double &value);
+            void Add(const double &delta);
+            double Value() const;
+    };
+
+    /**
+     * @brief Fixed-bucket histogram (cumulative on exposition), bucket counts & sum sharded like MetricsCounter.
+     */
+    class MetricsHistogram
+    {
+        private:
+
+            std::vector<double> upperBounds;  /* Ascending, +Inf bucket implied */
+            uint64_t shardStride;  /* Words per shard: buckets + 1 (+Inf) + sum, rounded up to cache lines */
+            std::unique_ptr<std::atomic<uint64_t>[]> words;  /* [shard * shardStride + bucket], last word: bits of the sum */
+
+        public:
+
+            /**
+             * @throw std::runtime_error, when the bounds are empty or not ascending.
+             */
+            MetricsHistogram(const std::vector<double> &upperBounds);
+
+            MetricsHistogram(const MetricsHistogram&) = delete;
+            MetricsHistogram& operator=(const MetricsHistogram&) = delete;
+
+            void Observe(const double &value);
+
+            /**
+             * @param bucketCounts per bucket (not cumulative), the last one is +Inf.
+             */
+            void Snapshot(std::vector<uint64_t> *bucketCounts, double *sum) const;
+
+            const std::vector<double> &UpperBounds() const;
+    };
+
+    /**
+     * @brief Default latency buckets (s): 1 us ~ 10 s.
+     */
+    std::vector<double> MetricsLatencyBuckets();
+
+    /**
+     * @brief Named metrics of the process, exposed in the Prometheus text format (version 0.0.4).
+     * @note Metrics are created on first use and never removed, the returned references stay valid for the
+     *       lifetime of the registry. Look them up once and keep them (file-scope static: created at startup, so
+     *       an idle endpoint already exports 0), the lookup takes a lock.
+     */
+    class MetricsRegistry
+    {
+        private:
+
+            typedef struct MetricsFamily
+            {
+                int type;  /* METRICS_TYPE__xxx */
+                std::string help;
+                std::vector<double> upperBounds;  /* Histogram */
+                std::vector<std::pair<vuprs::MetricsLabels, std::shared_ptr<void>>> series;
+            };
+
+            mutable std::mutex registryMutex;
+            std::map<std::string, MetricsFamily> families;
+
+            void *Find(const std::string &name, const std::string &help, const int &type,
+                       const vuprs::MetricsLabels &labels, const std::vector<double> &upperBounds);
+
+        public:
+
+            MetricsRegistry() = default;
+
+            MetricsRegistry(const MetricsRegistry&) = delete;
+            MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+            /**
+             * @brief Get or create a series.
+             * @throw std::runtime_error, when the name or a label is invalid, or the name is taken by another type
+             *        (histograms: other bounds).
+             */
+            vuprs::MetricsCounter &Counter(const std::string &name, const std::string &help, const vuprs::MetricsLabels &labels = {});
+            vuprs::MetricsGauge &Gauge(const std::string &name, const std::string &help, const vuprs::MetricsLabels &labels = {});
+            vuprs::MetricsHistogram &Histogram(const std::string &name, const std::string &help, const std::vector<double> &upperBounds,
+                                               const vuprs::MetricsLabels &labels = {});
+
+            /**
+             * @brief All series in the text exposition format (families sorted by name).
+             */
+            std::string Exposition() const;
+    };
+
+    /**
+     * @brief Registry of the process (all modules instrument this one).
+     */
+    vuprs::MetricsRegistry &Metrics();
+
+    /**
+     * @brief Series of an I/O path (DMA, register access, file writer): <prefix>_operations_total, <prefix>_bytes_total,
+     *        <prefix>_failures_total & <prefix>_seconds, all with the same labels.
+     */
+    class MetricsIOSeries
+    {
+        private:
+
+            vuprs::MetricsCounter *operations;
+            vuprs::MetricsCounter *bytes;  /* Successful operations only */
+            vuprs::MetricsCounter *failures;
+            vuprs::MetricsHistogram *seconds;
+
+        public:
+
+            /**
+             * @param operation plural noun of the help texts, e.g. "AXI-Full DMA transfers".
+             * @throw std::runtime_error, see MetricsRegistry::Counter().
+             */
+            MetricsIOSeries(const std::string &prefix, const std::string &operation, const vuprs::MetricsLabels &labels,
+                            vuprs::MetricsRegistry &registry = vuprs::Metrics());
+
+            void Count(const uint64_t &byteSize, const bool &success, const int64_t &duration_ns) const;
+    };
+
+    /**
+     * @brief Minimal HTTP/1.0 server: GET METRICS_HTTP_PATH returns the exposition of a registry, one client at a time.
+     */
+    class MetricsHTTPServer
+    {
+        private:
+
+            const vuprs::MetricsRegistry *registry;
+            int listen_fd;
+            std::thread serverThread;
+            std::atomic<bool> stopRequested;
+
+            void Serve();
+            void Respond(const int &client_fd);
+
+        public:
+
+            MetricsHTTPServer(const vuprs::MetricsRegistry *registry);
+            ~MetricsHTTPServer();
+
+            MetricsHTTPServer(const MetricsHTTPServer&) = delete;
+            MetricsHTTPServer& operator=(const MetricsHTTPServer&) = delete;
+
+            /**
+             * @brief Listen on METRICS_HTTP_ADDRESS:port and serve in a background thread.
+             * @retval true: listening;
+             *         false: socket cannot be bound (port in use...).
+             */
+            bool Start(const uint16_t &port);
+            void Stop();
+    };
+}
+
+#endif
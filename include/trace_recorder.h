@@ -0,0 +1,145 @@
+/**
+ * @brief   This document is the span tracer (per-thread rings, cycle counter timestamps, Chrome trace export).
+ * @version 1.0
+ * @author  Shixuan Liu, Tongji University
+ * @date    2026-10
+ */
+
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <stdexcept>
+
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#define TRACE_RING_EVENTS                         16384U  /* Spans kept per thread (power of 2), older ones are overwritten */
+#define TRACE_SIGNAL_POLL_MS                      100  /* Dump latency after the signal */
+
+/**
+ * VUPRS_TRACE_SPAN("stage.step") times the rest of the scope. Names are string literals, the part before the
+ * first '.' is the category of the Chrome trace. Compiled out with -DVUPRS_TRACE_DISABLE, otherwise a disabled
+ * tracer costs one relaxed load & branch per span.
+ */
+
+#define VUPRS_TRACE__CONCAT_INNER(A, B)           A##B
+#define VUPRS_TRACE__CONCAT(A, B)                 VUPRS_TRACE__CONCAT_INNER(A, B)
+
+#ifndef VUPRS_TRACE_DISABLE
+
+#define VUPRS_TRACE_SPAN(NAME)                    vuprs::TraceSpan VUPRS_TRACE__CONCAT(traceSpan__, __LINE__)(NAME)
+#define VUPRS_TRACE_SPAN_VALUE(NAME, VALUE)       vuprs::TraceSpan VUPRS_TRACE__CONCAT(traceSpan__, __LINE__)(NAME, VALUE)
+
+#else
+
+#define VUPRS_TRACE_SPAN(NAME)                    do {} while (0)
+#define VUPRS_TRACE_SPAN_VALUE(NAME, VALUE)       do {} while (0)
+
+#endif
+
+namespace vuprs
+{
+    extern std::atomic<bool> traceEnabled;
+
+    inline bool TraceEnabled()
+    {
+        return vuprs::traceEnabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Raw timestamp: CNTVCT_EL0 (ARMv8 generic timer), TSC (x86), CLOCK_MONOTONIC ns otherwise.
+     * @note Not serializing (no ISB / RDTSCP): a span may be off by the pipeline depth, far below the stages traced.
+     */
+    inline uint64_t TraceTicks()
+    {
+
+#if defined(__aarch64__)
+
+        uint64_t ticks = 0;
+
+        asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+        return ticks;
+
+#elif defined(__x86_64__) || defined(__i386__)
+
+        return __rdtsc();
+
+#else
+
+        struct timespec ts;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+
+#endif
+
+    }
+
+    /**
+     * @brief Store a finished span in the ring of the calling thread (lock-free, the ring is taken on the first span).
+     */
+    void RecordTraceSpan(const char *name, const uint64_t &begin_ticks, const uint64_t &end_ticks, const uint64_t &value);
+
+    /**
+     * @brief Span of a scope, recorded on destruction when the tracer was enabled at construction.
+     */
+    class TraceSpan
+    {
+        private:
+
+            const char *name;  /* nullptr: tracer disabled */
+            uint64_t begin_ticks;
+            uint64_t value;
+
+        public:
+
+            inline explicit TraceSpan(const char *name, const uint64_t &value = 0)
+            {
+                this->name = vuprs::TraceEnabled() ? name : nullptr;
+                this->begin_ticks = this->name != nullptr ? vuprs::TraceTicks() : 0;
+                this->value = value;
+            }
+
+            inline ~TraceSpan()
+            {
+                if (this->name != nullptr)
+                {
+                    vuprs::RecordTraceSpan(this->name, this->begin_ticks, vuprs::TraceTicks(), this->value);
+                }
+            }
+
+            TraceSpan(const TraceSpan&) = delete;
+            TraceSpan& operator=(const TraceSpan&) = delete;
+    };
+
+    /**
+     * @brief Start/stop recording. Enabling clears the rings and takes the time base (ticks -> ns) reference.
+     */
+    void EnableTrace(const bool &enable);
+
+    /**
+     * @brief Write the spans of all threads (the last TRACE_RING_EVENTS per thread) as Chrome/Perfetto JSON
+     *        (chrome://tracing, ui.perfetto.dev). Recording goes on, spans being written meanwhile are skipped.
+     * @retval true: dump success;
+     *         false: file cannot be written.
+     */
+    bool DumpTrace(const std::string &traceFilename);
+
+    /**
+     * @brief Dump to traceFilename every time signalNumber arrives (e.g. SIGUSR1), from a background thread.
+     * @retval true: handler installed;
+     *         false: the signal cannot be handled or a dump signal is already installed.
+     */
+    bool InstallTraceDumpSignal(const int &signalNumber, const std::string &traceFilename);
+}
+
+#endif
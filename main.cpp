@@ -3,8 +3,542 @@
 #include "fpga_config.h"
 #include "fpga_control.h"
 #include "aligned_data_structure.h"
+#include "dma_autotune.h"
+#include "cpu_dispatch.h"
+#include "dma_replay_source.h"
+#include "dma_scheduler.h"
+#include "adc_soak.h"
+#include "metrics_registry.h"
+#include "trace_recorder.h"
+
+#include <csignal>
+#include <thread>
+#include <chrono>
+
+static vuprs::CaptureReplaySource *VUPRS_SERVER__ReplaySource = nullptr;
+static volatile sig_atomic_t VUPRS_SERVER__StopRequested = 0;
+
+static void VUPRS_SERVER__StopReplay(int)
+{
+    if (VUPRS_SERVER__ReplaySource != nullptr)
+    {
+        VUPRS_SERVER__ReplaySource->Stop();
+    }
+
+    VUPRS_SERVER__StopRequested = 1;
+}
+
+static void VUPRS_SERVER__Usage()
+{
+std::cout << " Usage: vuprs_server <config.json> [--metrics <port>] [--trace <trace.json>]" << std::endl;
+std::cout << "                     [--replay <capture.bin> [--speed <x>] [--loop <n>] [--rate <frames/s>]]" << std::endl;
+std::cout << "                     [--ddr <bytes> [--ddr-offset <offset>]]" << std::endl;
+std::cout << "                     [--soak <seconds> [--replay <capture.bin>] [--speed <x>] [--rate <frames/s>] [--report <json>]" << std::endl;
+std::cout << "                      [--output <file>] [--slo-drop <frames>] [--slo-p99-ms <ms>] [--slo-rate <0~1>]" << std::endl;
+std::cout << "                      [--slo-rss-mb <MB>] [--slo-cpu <percent>]]" << std::endl;
+}
+
+/**
+ * @brief Time axis of a replayed or synthetic capture: frame 0 at the start of the run, nominal period, no drift.
+ * @note NGF/SCI are not read: they describe the live card, not a file recorded at another time (and need a board).
+ * @retval true: captureTime built;
+ *         false: no frame rate, the capture has no time axis.
+ */
+static bool VUPRS_SERVER__NominalCaptureTime(const double &frameRate_Hz, vuprs::ADCTimeDescriptor *captureTime)
+{
+    if (!(frameRate_Hz > 0))
+    {
+        return false;
+    }
+
+    captureTime->firstFrameIndex = 0;
+    captureTime->samplePeriod_s = 1.0 / frameRate_Hz;
+    captureTime->clockRatio = 1.0;
+    captureTime->reference.frameIndex = 0;
+    captureTime->reference.hostMonotonic_ns = vuprs::HostMonotonic_ns();
+    captureTime->reference.hostRealtime_ns = vuprs::HostRealtime_ns();
+
+printf(" Time axis: nominal, %.3f us/sample from the start of the run\n", captureTime->samplePeriod_s * 1e6);
+
+    return true;
+}
+
+/**
+ * @brief Push a capture file through DDR -> samples as if it came from C2H, report achieved against requested rate.
+ */
+static int VUPRS_SERVER__Replay(const vuprs::FPGAConfigManager &fpgaConfigManager, vuprs::CaptureReplayConfig replayConfig)
+{
+    const vuprs::FPGAhardwareConfig &hardwareConfig = fpgaConfigManager.fpgaConfig.hardwareConfig;
+    vuprs::CaptureReplaySource replaySource;
+    vuprs::CaptureReplayReport replayReport;
+    vuprs::DMAStreamConfig streamConfig;
+    vuprs::DMAStreamProgress streamProgress;
+    vuprs::ADCTimeDescriptor captureTime = vuprs::ADCTimeDescriptor();
+    int64_t firstSampleRealtime_ns = 0, lastSampleRealtime_ns = 0;
+    uint64_t samples = 0, chunks = 0;
+    bool timed = false, streamSuccess = false;
+
+    if (replayConfig.frameRate_Hz == 0)
+    {
+        replayConfig.frameRate_Hz = hardwareConfig.hardwareConfigADC.adcMaxSamplingFrequency_Hz;
+    }
+    replayConfig.frameBytes = (hardwareConfig.hardwareConfigFrame.channels + 2) * sizeof(uint32_t);
+
+    streamConfig.chunkByteSize = DMA_STREAM_PARSE_CHUNK_BYTES;
+    streamConfig.dmaChannel = 0;
+
+    try
+    {
+        if (!replaySource.Open(replayConfig))
+        {
+std::cout << " \033[31mVUPRS-SERVER ERR: Cannot open capture file: " << replayConfig.captureFilename << "\033[0m" << std::endl;
+            return 1;
+        }
+
+printf(" Replay %s: %.0f frames/s x %g, %lu loop(s)%s\n", replayConfig.captureFilename.c_str(), replayConfig.frameRate_Hz,
+       replayConfig.speed, static_cast<unsigned long>(replayConfig.loops), replayConfig.loops == 0 ? " (Ctrl-C to stop)" : "");
+
+        timed = VUPRS_SERVER__NominalCaptureTime(replayConfig.frameRate_Hz, &captureTime);
+
+        VUPRS_SERVER__ReplaySource = &replaySource;
+        signal(SIGINT, VUPRS_SERVER__StopReplay);
+
+        streamSuccess = vuprs::StreamSourceToADCChannels(&replaySource, streamConfig,
+                                                         hardwareConfig.hardwareConfigADC, hardwareConfig.hardwareConfigFrame,
+                                                         [&](const vuprs::ADCStreamChunk &chunk)
+                                                         {
+                                                             if (chunk.time != nullptr && chunk.samples->samples() > 0)
+                                                             {
+                                                                 firstSampleRealtime_ns = samples == 0 ? chunk.time->SampleRealtime_ns(0) : firstSampleRealtime_ns;
+                                                                 lastSampleRealtime_ns = chunk.time->SampleRealtime_ns(chunk.samples->samples() - 1);
+                                                             }
+                                                             samples += chunk.samples->samples();
+                                                             chunks++;
+                                                         },
+                                                         &streamProgress, timed ? &captureTime : nullptr, &hardwareConfig.hardwareConfigCalibration);
+
+        signal(SIGINT, SIG_DFL);
+        VUPRS_SERVER__ReplaySource = nullptr;
+    }
+    catch (const std::exception &e)
+    {
+        signal(SIGINT, SIG_DFL);
+        VUPRS_SERVER__ReplaySource = nullptr;
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    replayReport = replaySource.Report();
+
+printf(" Replay %s: %lu chunks, %lu samples, %.1f MB in %.3f s, %lu loop(s)\n", streamSuccess ? "done" : "\033[31mfailed\033[0m",
+       static_cast<unsigned long>(chunks), static_cast<unsigned long>(samples), replayReport.deliveredBytes / 1e6,
+       replayReport.elapsed_s, static_cast<unsigned long>(replayReport.completedLoops));
+    if (timed && samples > 0)
+    {
+printf(" Replay time axis: %.6f s of samples from realtime %.6f s\n", (lastSampleRealtime_ns - firstSampleRealtime_ns) / 1e9,
+       firstSampleRealtime_ns / 1e9);
+    }
+    if (replayReport.requestedRate_bytesPerSecond > 0)
+    {
+printf(" Replay rate: %.2f MB/s achieved / %.2f MB/s requested (%.1f %%), %lu/%lu reads late, max lag %.3f ms\n",
+       replayReport.achievedRate_bytesPerSecond / 1e6, replayReport.requestedRate_bytesPerSecond / 1e6, replayReport.rateRatio * 100,
+       static_cast<unsigned long>(replayReport.lateReads), static_cast<unsigned long>(replayReport.reads), replayReport.maxLag_s * 1e3);
+    }
+    else
+    {
+printf(" Replay rate: %.2f MB/s (unpaced), %.1f x real time\n", replayReport.achievedRate_bytesPerSecond / 1e6,
+       replayReport.achievedRate_bytesPerSecond / (replayConfig.frameRate_Hz * replayConfig.frameBytes));
+    }
+
+    return streamSuccess ? 0 : 1;
+}
+
+/**
+ * @brief Convert a capture in DDR to samples, the C2H reads are queued on the DMA scheduler of the server (real-time class).
+ */
+static int VUPRS_SERVER__DDR(vuprs::FPGAController *fpgaController, vuprs::DMAScheduler *dmaScheduler,
+                             const uint64_t &ddrOffset, const uint64_t &ddrBytes)
+{
+    const vuprs::FPGAhardwareConfig &hardwareConfig = fpgaController->GetFPGAConfig().fpgaConfig.hardwareConfig;
+    vuprs::DMAStreamConfig streamConfig;
+    vuprs::DMAStreamProgress streamProgress = vuprs::DMAStreamProgress();
+    vuprs::DMAClassMetrics classMetrics = vuprs::DMAClassMetrics();
+    uint64_t samples = 0, chunks = 0;
+    bool streamSuccess = false;
+
+    streamConfig.chunkByteSize = DMA_STREAM_PARSE_CHUNK_BYTES;
+    streamConfig.dmaChannel = 0;
+
+printf(" DDR 0x%lX: %lu B through the DMA scheduler\n", static_cast<unsigned long>(ddrOffset), static_cast<unsigned long>(ddrBytes));
+
+    try
+    {
+        streamSuccess = vuprs::StreamDDRToADCChannels(fpgaController, ddrOffset, ddrBytes, streamConfig,
+                                                      hardwareConfig.hardwareConfigADC, hardwareConfig.hardwareConfigFrame,
+                                                      [&](const vuprs::ADCStreamChunk &chunk)
+                                                      {
+                                                          samples += chunk.samples->samples();
+                                                          chunks++;
+                                                      },
+                                                      &streamProgress, nullptr, &hardwareConfig.hardwareConfigCalibration, dmaScheduler);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    dmaScheduler->GetClassMetrics(DMA_REQUEST_CLASS__REALTIME, &classMetrics);
+
+printf(" DDR %s: %lu chunks, %lu samples, %.1f MB in %.3f s, %.2f MB/s\n", streamSuccess ? "done" : "\033[31mfailed\033[0m",
+       static_cast<unsigned long>(chunks), static_cast<unsigned long>(samples), streamProgress.transferredBytes / 1e6,
+       streamProgress.elapsed_s, streamProgress.throughput_bytesPerSecond / 1e6);
+printf(" DMA scheduler (realtime): %lu requests in %lu transfers, queue mean %.3f / max %.3f ms, service mean %.3f / max %.3f ms\n",
+       static_cast<unsigned long>(classMetrics.requests), static_cast<unsigned long>(classMetrics.transfers),
+       classMetrics.requests > 0 ? classMetrics.queueTimeTotal_ns / 1e6 / classMetrics.requests : 0.0, classMetrics.queueTimeMax_ns / 1e6,
+       classMetrics.requests > 0 ? classMetrics.serviceTimeTotal_ns / 1e6 / classMetrics.requests : 0.0, classMetrics.serviceTimeMax_ns / 1e6);
+
+    return streamSuccess ? 0 : 1;
+}
+
+/**
+ * @brief Run the pipeline from a synthetic (no --replay) or replayed capture at N x real time and check the SLOs.
+ */
+static int VUPRS_SERVER__Soak(const vuprs::FPGAConfigManager &fpgaConfigManager, vuprs::CaptureReplayConfig replayConfig,
+                              const vuprs::ADCSoakConfig &soakConfig, const std::string &reportFilename)
+{
+    const vuprs::FPGAhardwareConfig &hardwareConfig = fpgaConfigManager.fpgaConfig.hardwareConfig;
+    const vuprs::FPGASimulationConfig &simulation = fpgaConfigManager.fpgaConfig.xdmaDriverConfig.simulation;
+    vuprs::CaptureReplaySource replaySource;
+    vuprs::ADCSoakReport soakReport;
+    vuprs::ADCTimeDescriptor captureTime = vuprs::ADCTimeDescriptor();
+    bool timed = false, soakPassed = false;
+
+    if (replayConfig.frameRate_Hz == 0)
+    {
+        replayConfig.frameRate_Hz = hardwareConfig.hardwareConfigADC.adcMaxSamplingFrequency_Hz;
+    }
+    replayConfig.frameBytes = (hardwareConfig.hardwareConfigFrame.channels + 2) * sizeof(uint32_t);
+    replayConfig.loops = 0;  /* Endless, stopped after the duration */
+
+    try
+    {
+        if (replayConfig.captureFilename.empty())
+        {
+            /* 64 periods of the slowest channel, loops without a seam; CRC errors of json["xdma-driver"]["simulation"] */
+
+            replayConfig.captureWords = std::make_shared<const std::vector<uint32_t>>(
+                vuprs::GenerateADCCapture(hardwareConfig.hardwareConfigFrame, 64 * 1024, simulation.crcErrorRate, simulation.seed));
+        }
+
+        if (!replaySource.Open(replayConfig))
+        {
+std::cout << " \033[31mVUPRS-SERVER ERR: Cannot open capture file: " << replayConfig.captureFilename << "\033[0m" << std::endl;
+            return 1;
+        }
+
+        vuprs::ADCSoakTest soakTest(soakConfig, hardwareConfig.hardwareConfigADC, hardwareConfig.hardwareConfigFrame,
+                                    hardwareConfig.hardwareConfigCalibration);
+
+printf(" Soak %.0f s: %s, %.0f frames/s x %g, %lu blocks of %lu B\n", soakConfig.duration_s,
+       replayConfig.captureFilename.empty() ? "synthetic" : replayConfig.captureFilename.c_str(), replayConfig.frameRate_Hz, replayConfig.speed,
+       static_cast<unsigned long>(soakConfig.queueDepth), static_cast<unsigned long>(soakConfig.chunkByteSize));
+
+        timed = VUPRS_SERVER__NominalCaptureTime(replayConfig.frameRate_Hz, &captureTime);
+
+        VUPRS_SERVER__ReplaySource = &replaySource;
+        signal(SIGINT, VUPRS_SERVER__StopReplay);
+
+        soakPassed = soakTest.Run(&replaySource, &soakReport, [](const vuprs::ADCSoakProgress &progress)
+        {
+printf("\r Soak %7.1f s: %9.1f MB, dropped %lu frames, %lu blocks in flight, RSS %.1f MB ", progress.elapsed_s, progress.sourceBytes / 1e6,
+       static_cast<unsigned long>(progress.droppedFrames), static_cast<unsigned long>(progress.blocksInFlight), progress.rss_megabytes);
+            fflush(stdout);
+        }, timed ? &captureTime : nullptr);
+
+        signal(SIGINT, SIG_DFL);
+        VUPRS_SERVER__ReplaySource = nullptr;
+    }
+    catch (const std::exception &e)
+    {
+        signal(SIGINT, SIG_DFL);
+        VUPRS_SERVER__ReplaySource = nullptr;
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+printf("\n");
+printf(" Soak %.1f s: %.1f MB, %lu frames parsed, %lu dropped (%lu blocks), %lu lost, %lu CRC failed samples\n", soakReport.duration_s,
+       soakReport.sourceBytes / 1e6, static_cast<unsigned long>(soakReport.parsedFrames), static_cast<unsigned long>(soakReport.droppedFrames),
+       static_cast<unsigned long>(soakReport.droppedBlocks), static_cast<unsigned long>(soakReport.lostFrames),
+       static_cast<unsigned long>(soakReport.crcFailedSamples));
+printf(" Soak rate: %.2f MB/s achieved / %.2f MB/s requested (%.1f %%), max lag %.3f ms\n",
+       soakReport.source.achievedRate_bytesPerSecond / 1e6, soakReport.source.requestedRate_bytesPerSecond / 1e6,
+       soakReport.source.rateRatio * 100, soakReport.source.maxLag_s * 1e3);
+printf(" Soak end-to-end: p50 %.3f ms, p99 %.3f ms, p99.9 %.3f ms, max %.3f ms\n",
+       soakReport.endToEnd.p50_ms, soakReport.endToEnd.p99_ms, soakReport.endToEnd.p999_ms, soakReport.endToEnd.max_ms);
+    for (const vuprs::ADCSoakStageReport &stage : soakReport.stages)
+    {
+printf(" Soak %-8s: service p50 %.3f / p99 %.3f ms, wait p99 %.3f ms, queue mean %.2f max %lu, CPU %.1f %%\n", stage.name.c_str(),
+       stage.service.p50_ms, stage.service.p99_ms, stage.queueWait.p99_ms, stage.meanQueueDepth,
+       static_cast<unsigned long>(stage.maxQueueDepth), stage.cpu_percent);
+    }
+    if (soakReport.timed)
+    {
+printf(" Soak time axis: %.6f s of samples from realtime %.6f s\n", (soakReport.lastSampleRealtime_ns - soakReport.firstSampleRealtime_ns) / 1e9,
+       soakReport.firstSampleRealtime_ns / 1e9);
+    }
+printf(" Soak RSS: %.1f MB start, %.1f MB peak, %.1f MB end\n", soakReport.startRSS_megabytes, soakReport.peakRSS_megabytes, soakReport.endRSS_megabytes);
+
+    if (!reportFilename.empty() && !vuprs::SaveADCSoakReport(reportFilename, soakReport))
+    {
+printf(" \033[31mVUPRS-SERVER ERR: Cannot write soak report: %s\033[0m\n", reportFilename.c_str());
+    }
+
+    for (const std::string &violation : soakReport.violations)
+    {
+printf(" \033[31mSLO VIOLATED: %s\033[0m\n", violation.c_str());
+    }
+printf(" Soak %s\n", soakPassed ? "\033[92mPASSED\033[0m" : "\033[31mFAILED\033[0m");
+
+    return soakPassed ? 0 : 1;
+}
 
 int main(int argc, char *argv[])
 {
-    return 0;
-}
\ No newline at end of file
+    vuprs::FPGAConfigManager fpgaConfigManager;
+    vuprs::FPGAController fpgaController;
+    vuprs::DMATuningResult tuningResult;
+    bool tuningLoadedFromCache = false;
+    vuprs::CaptureReplayConfig replayConfig = vuprs::CaptureReplayConfig();
+    vuprs::ADCSoakConfig soakConfig = vuprs::ADCSoakTest::DefaultSoakConfig();
+    std::string reportFilename, traceFilename;
+    uint64_t metricsPort = 0, ddrOffset = 0, ddrBytes = 0;
+    bool parseStatus = true, soak = false;
+    int exitCode = 0;
+
+    replayConfig.speed = 1;
+    replayConfig.loops = 1;
+
+    if (argc < 2 || argc % 2 != 0)
+    {
+        VUPRS_SERVER__Usage();
+        return 0;
+    }
+
+    /* Replay & soak options (--speed 0: as fast as possible, replay only; --loop 0: endless) */
+
+    for (int i = 2; i + 1 < argc && parseStatus; i += 2)
+    {
+        std::string option(argv[i]);
+
+        if (option == "--replay")
+        {
+            replayConfig.captureFilename = argv[i + 1];
+        }
+        else if (option == "--speed")
+        {
+            replayConfig.speed = vuprs::ParseDecimalFromString(argv[i + 1], &parseStatus);
+        }
+        else if (option == "--loop")
+        {
+            replayConfig.loops = vuprs::ParseNumberFromString(argv[i + 1], &parseStatus);
+        }
+        else if (option == "--rate")
+        {
+            replayConfig.frameRate_Hz = vuprs::ParseDecimalFromString(argv[i + 1], &parseStatus);
+        }
+        else if (option == "--ddr")
+        {
+            ddrBytes = vuprs::ParseNumberFromString(argv[i + 1], &parseStatus);
+            parseStatus = parseStatus && ddrBytes > 0;
+        }
+        else if (option == "--ddr-offset")
+        {
+            ddrOffset = vuprs::ParseNumberFromString(argv[i + 1], &parseStatus);
+        }
+        else if (option == "--soak")
+        {
+            soakConfig.duration_s = vuprs::ParseDecimalFromString(argv[i + 1], &parseStatus);
+            soak = true;
+        }
+        else if (option == "--report")
+        {
+            reportFilename = argv[i + 1];
+        }
+        else if (option == "--output")
+        {
+            soakConfig.outputFilename = argv[i + 1];
+        }
+        else if (option == "--slo-drop")
+        {
+            soakConfig.slo.maxDroppedFrames = vuprs::ParseNumberFromString(argv[i + 1], &parseStatus);
+        }
+        else if (option == "--slo-p99-ms")
+        {
+            soakConfig.slo.maxLatencyP99_ms = vuprs::ParseDecimalFromString(argv[i + 1], &parseStatus);
+        }
+        else if (option == "--slo-rate")
+        {
+            soakConfig.slo.minRateRatio = vuprs::ParseDecimalFromString(argv[i + 1], &parseStatus);
+        }
+        else if (option == "--slo-rss-mb")
+        {
+            soakConfig.slo.maxRSS_megabytes = vuprs::ParseDecimalFromString(argv[i + 1], &parseStatus);
+        }
+        else if (option == "--slo-cpu")
+        {
+            soakConfig.slo.maxThreadCPU_percent = vuprs::ParseDecimalFromString(argv[i + 1], &parseStatus);
+        }
+        else if (option == "--trace")
+        {
+            traceFilename = argv[i + 1];
+        }
+        else if (option == "--metrics")
+        {
+            metricsPort = vuprs::ParseNumberFromString(argv[i + 1], &parseStatus);
+            parseStatus = parseStatus && metricsPort > 0 && metricsPort <= UINT16_MAX;
+        }
+        else
+        {
+            parseStatus = false;
+        }
+    }
+
+    if (!parseStatus || (replayConfig.captureFilename.empty() && !soak && ddrBytes == 0 && metricsPort == 0 && traceFilename.empty() && argc > 2))
+    {
+        VUPRS_SERVER__Usage();
+        return 0;
+    }
+
+    /* Unpaced, the reader would outrun the pipeline and the soak would only measure drops */
+
+    if (soak && replayConfig.speed <= 0)
+    {
+std::cout << " \033[31mVUPRS-SERVER ERR: --soak needs --speed > 0 (multiple of real time)\033[0m" << std::endl;
+        return 1;
+    }
+
+    /* Metrics endpoint (local only: curl http://127.0.0.1:<port>/metrics) */
+
+    vuprs::MetricsHTTPServer metricsServer(&vuprs::Metrics());
+
+    if (metricsPort != 0)
+    {
+        if (!metricsServer.Start(static_cast<uint16_t>(metricsPort)))
+        {
+std::cout << " \033[31mVUPRS-SERVER ERR: Cannot listen on " METRICS_HTTP_ADDRESS ":" << metricsPort << "\033[0m" << std::endl;
+            return 1;
+        }
+printf(" Metrics: http://%s:%lu%s\n", METRICS_HTTP_ADDRESS, static_cast<unsigned long>(metricsPort), METRICS_HTTP_PATH);
+    }
+
+    /* Tracing (spans of the DMA, register, parse & write paths; dumped on SIGUSR1 and at exit) */
+
+    if (!traceFilename.empty())
+    {
+        vuprs::EnableTrace(true);
+
+        if (!vuprs::InstallTraceDumpSignal(SIGUSR1, traceFilename))
+        {
+printf(" \033[33mVUPRS-SERVER WARN: Cannot install the trace dump signal, the trace is written at exit only.\033[0m\n");
+        }
+printf(" Trace: %s (kill -USR1 %d)\n", traceFilename.c_str(), static_cast<int>(getpid()));
+    }
+
+    /* Load configuration */
+
+    try
+    {
+        if (!fpgaConfigManager.LoadFPGAConfigFromJson(argv[1]) || !fpgaController.LoadFPGAConfig(fpgaConfigManager))
+        {
+std::cout << " \033[31mVUPRS-SERVER ERR: Cannot load config data from: " << argv[1] << "\033[0m" << std::endl;
+            return 1;
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+printf(" FPGA transport: %s\n", fpgaController.TransportName().c_str());
+
+    /* SIMD kernels (selected at start-up, VUPRS_FORCE_SCALAR=1 for the scalar path) */
+
+printf(" CPU features: %s%s\n", vuprs::CPUFeaturesString(vuprs::DetectCPUFeatures()).c_str(),
+       vuprs::CPUForceScalar() ? " (" CPU_DISPATCH_FORCE_SCALAR_ENV ")" : "");
+    for (const std::pair<std::string, std::string> &kernel : vuprs::ActiveCPUKernels())
+    {
+printf(" Kernel %s: %s\n", kernel.first.c_str(), kernel.second.c_str());
+    }
+
+    /* DMA tuning (cached, measured only on the first start or after kernel/driver changes) */
+
+    try
+    {
+        vuprs::DMAAutoTuner dmaAutoTuner(&fpgaController);
+
+        if (dmaAutoTuner.LoadOrTune(fpgaConfigManager.fpgaConfig.xdmaDriverConfig.tuningCacheFilename, &tuningResult, &tuningLoadedFromCache) &&
+            vuprs::ApplyDMATuning(tuningResult, &fpgaConfigManager) &&
+            fpgaController.LoadFPGAConfig(fpgaConfigManager))
+        {
+printf(" DMA tuning (%s): chunk %lu B\n", tuningLoadedFromCache ? "cached" : "measured", static_cast<unsigned long>(tuningResult.best.chunkSize));
+        }
+        else
+        {
+printf(" \033[33mVUPRS-SERVER WARN: DMA tuning failed, use config defaults.\033[0m\n");
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << '\n';
+    }
+
+    /* Soak test, capture replay & DDR capture */
+
+    if (soak)
+    {
+        exitCode = VUPRS_SERVER__Soak(fpgaConfigManager, replayConfig, soakConfig, reportFilename);
+    }
+    else if (!replayConfig.captureFilename.empty())
+    {
+        exitCode = VUPRS_SERVER__Replay(fpgaConfigManager, replayConfig);
+    }
+    else if (ddrBytes != 0)
+    {
+        try
+        {
+            vuprs::DMASchedulerConfig schedulerConfig = vuprs::DMASchedulerConfig();
+            vuprs::DMAScheduler dmaScheduler(&fpgaController, schedulerConfig);
+
+            exitCode = VUPRS_SERVER__DDR(&fpgaController, &dmaScheduler, ddrOffset, ddrBytes);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << e.what() << '\n';
+            exitCode = 1;
+        }
+    }
+
+    /* Serve the metrics / record the trace until Ctrl-C (without a run: the DMA tuning & the register IO of the start-up) */
+
+    if ((metricsPort != 0 || !traceFilename.empty()) && !soak && replayConfig.captureFilename.empty() && ddrBytes == 0)
+    {
+        signal(SIGINT, VUPRS_SERVER__StopReplay);
+
+        while (!VUPRS_SERVER__StopRequested)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(METRICS_HTTP_POLL_MS));
+        }
+
+        signal(SIGINT, SIG_DFL);
+    }
+
+    if (!traceFilename.empty() && !vuprs::DumpTrace(traceFilename))
+    {
+printf(" \033[31mVUPRS-SERVER ERR: Cannot write trace: %s\033[0m\n", traceFilename.c_str());
+    }
+
+    return exitCode;
+}
@@ -0,0 +1,318 @@
+#include "adc_channel_scaling.h"
+#include "cpu_dispatch.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+vuprs::ADCChannelScaling vuprs::ADCChannelScalingFromFeatures(const vuprs::FPGAhardwareConfigADC &adcFeatures)
+{
+    /* ------------------------ Security Check Start ------------------------- */
+
+    if (!adcFeatures.configdown)
+    {
+        throw std::runtime_error("Do not find ADC features, convert disabled");
+    }
+
+    /* ------------------------- Security Check End -------------------------- */
+
+    vuprs::ADCChannelScaling scaling;
+    const double LSB_VALUE = pow(2, ADC_DATAWIDTH) / 2.0;
+
+    for (uint64_t c = 0; c < ADC_CHANNELS; c++)
+    {
+        scaling.scale[c] = adcFeatures.adcVoltageRangeRadius / LSB_VALUE;
+        scaling.offset[c] = 0.0;
+    }
+    scaling.crcFailVoltage = adcFeatures.adcVoltageRangeRadius;
+
+    return scaling;
+}
+
+vuprs::FPGAhardwareConfigCalibration vuprs::DefaultCalibration(const uint64_t &channels)
+{
+    vuprs::FPGAhardwareConfigCalibration calibration;
+
+    calibration.gain.assign(channels, 1.0);
+    calibration.offset_v.assign(channels, 0.0);
+    calibration.sensitivity.assign(channels, 1.0);
+    calibration.unit.assign(channels, "V");
+    calibration.configdown = true;
+
+    return calibration;
+}
+
+void vuprs::CheckCalibration(const vuprs::FPGAhardwareConfigCalibration &calibration, const uint64_t &channels)
+{
+    if (calibration.gain.size() != channels || calibration.offset_v.size() != channels ||
+        calibration.sensitivity.size() != channels || calibration.unit.size() != channels)
+    {
+        throw std::runtime_error("Calibration must have " + std::to_string(channels) + " channels.");
+    }
+
+    for (uint64_t c = 0; c < channels; c++)
+    {
+        if (!std::isfinite(calibration.gain[c]) || !std::isfinite(calibration.offset_v[c]) || !std::isfinite(calibration.sensitivity[c]))
+        {
+            throw std::runtime_error("Calibration of channel " + std::to_string(c) + " is not finite.");
+        }
+        if (calibration.gain[c] == 0.0 || calibration.sensitivity[c] == 0.0)
+        {
+            throw std::runtime_error("Gain or sensitivity of channel " + std::to_string(c) + " is 0.");
+        }
+    }
+}
+
+vuprs::ADCChannelScaling vuprs::ADCChannelScalingFromCalibration(const vuprs::FPGAhardwareConfigADC &adcFeatures,
+                                                                 const vuprs::FPGAhardwareConfigCalibration &calibration)
+{
+    /* ------------------------ Security Check Start ------------------------- */
+
+    if (!calibration.configdown)
+    {
+        throw std::runtime_error("Do not find calibration, convert disabled");
+    }
+
+    vuprs::CheckCalibration(calibration, ADC_CHANNELS);
+
+    /* ------------------------- Security Check End -------------------------- */
+
+    vuprs::ADCChannelScaling scaling = vuprs::ADCChannelScalingFromFeatures(adcFeatures);
+
+    for (uint64_t c = 0; c < ADC_CHANNELS; c++)
+    {
+        scaling.scale[c] = scaling.scale[c] * calibration.gain[c] * calibration.sensitivity[c];
+        scaling.offset[c] = calibration.offset_v[c] * calibration.sensitivity[c];
+    }
+    scaling.crcFailVoltage = std::numeric_limits<double>::quiet_NaN();
+
+    return scaling;
+}
+
+/**
+ * @brief One pass: target[i] = source[i] * scale + offset, failValue where channelBit of masks[i] is clear
+ *        (masks = nullptr: all pass). Inlined into every target so the loop is vectorised for it.
+ */
+template <typename Code, typename Volt>
+static inline __attribute__((always_inline)) void ADCChannelScaling__Scale(const Code *source, const uint16_t *masks, const uint16_t channelBit,
+                                                                          Volt *target, const uint64_t &samples,
+                                                                          const Volt scale, const Volt offset, const Volt failValue)
+{
+    if (masks == nullptr)
+    {
+        for (uint64_t i = 0; i < samples; i++)
+        {
+            target[i] = static_cast<Volt>(source[i]) * scale + offset;
+        }
+        return;
+    }
+
+    for (uint64_t i = 0; i < samples; i++)
+    {
+        const Volt volt = static_cast<Volt>(source[i]) * scale + offset;
+        target[i] = (masks[i] & channelBit) ? volt : failValue;
+    }
+}
+
+#define ADC_CHANNEL_SCALING__SCALE_ARGS(CODE, VOLT) \
+    const CODE *source, const uint16_t *masks, const uint16_t channelBit, VOLT *target, const uint64_t &samples, \
+    const VOLT scale, const VOLT offset, const VOLT failValue
+
+typedef struct ADCChannelScaling__Kernel
+{
+    void (*int16ToDouble)(ADC_CHANNEL_SCALING__SCALE_ARGS(int16_t, double));
+    void (*int16ToFloat)(ADC_CHANNEL_SCALING__SCALE_ARGS(int16_t, float));
+    void (*floatToDouble)(ADC_CHANNEL_SCALING__SCALE_ARGS(float, double));
+    void (*floatToFloat)(ADC_CHANNEL_SCALING__SCALE_ARGS(float, float));
+};
+
+/* No FMA: the volts stay bit-equal to the scalar variant */
+
+#define ADC_CHANNEL_SCALING__DEFINE_SCALE(TARGET_ATTRIBUTE, SUFFIX, CODE, VOLT) \
+    TARGET_ATTRIBUTE static void ADCChannelScaling__Scale##SUFFIX(ADC_CHANNEL_SCALING__SCALE_ARGS(CODE, VOLT)) \
+    { \
+        ADCChannelScaling__Scale<CODE, VOLT>(source, masks, channelBit, target, samples, scale, offset, failValue); \
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+
+ADC_CHANNEL_SCALING__DEFINE_SCALE(__attribute__((target("avx2"))), Int16ToDoubleAVX2, int16_t, double)
+ADC_CHANNEL_SCALING__DEFINE_SCALE(__attribute__((target("avx2"))), FloatToDoubleAVX2, float, double)
+ADC_CHANNEL_SCALING__DEFINE_SCALE(__attribute__((target("avx2"))), FloatToFloatAVX2, float, float)
+
+/**
+ * @brief int16 -> float, 8 samples per step: widen, convert, scale, select the fail value by the mask bit.
+ */
+__attribute__((target("avx2")))
+static void ADCChannelScaling__ScaleInt16ToFloatAVX2(ADC_CHANNEL_SCALING__SCALE_ARGS(int16_t, float))
+{
+    const __m256 scaleVector = _mm256_set1_ps(scale);
+    const __m256 offsetVector = _mm256_set1_ps(offset);
+    const __m256 failVector = _mm256_set1_ps(failValue);
+    const __m256i bitVector = _mm256_set1_epi32(channelBit);
+    uint64_t i = 0;
+
+    if (masks == nullptr)
+    {
+        for (; i + 8 <= samples; i += 8)
+        {
+            __m256 code = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i))));
+            _mm256_storeu_ps(target + i, _mm256_add_ps(_mm256_mul_ps(code, scaleVector), offsetVector));
+        }
+    }
+    else
+    {
+        for (; i + 8 <= samples; i += 8)
+        {
+            __m256 code = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i))));
+            __m256 volt = _mm256_add_ps(_mm256_mul_ps(code, scaleVector), offsetVector);
+            __m256i pass = _mm256_and_si256(_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(masks + i))), bitVector);
+
+            _mm256_storeu_ps(target + i, _mm256_blendv_ps(failVector, volt, _mm256_castsi256_ps(_mm256_cmpeq_epi32(pass, bitVector))));
+        }
+    }
+
+    ADCChannelScaling__Scale<int16_t, float>(source + i, masks == nullptr ? nullptr : masks + i, channelBit, target + i, samples - i,
+                                             scale, offset, failValue);
+}
+
+#elif defined(__aarch64__)
+
+/**
+ * @brief int16 -> float, 8 samples per step: widen, convert, scale, select the fail value by the mask bit.
+ */
+static void ADCChannelScaling__ScaleInt16ToFloatNEON(ADC_CHANNEL_SCALING__SCALE_ARGS(int16_t, float))
+{
+    const float32x4_t scaleVector = vdupq_n_f32(scale);
+    const float32x4_t offsetVector = vdupq_n_f32(offset);
+    const float32x4_t failVector = vdupq_n_f32(failValue);
+    const uint32x4_t bitVector = vdupq_n_u32(channelBit);
+    uint64_t i = 0;
+
+    for (; i + 8 <= samples; i += 8)
+    {
+        int16x8_t code = vld1q_s16(source + i);
+        float32x4_t voltLow = vaddq_f32(vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(code))), scaleVector), offsetVector);
+        float32x4_t voltHigh = vaddq_f32(vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(code))), scaleVector), offsetVector);
+
+        if (masks != nullptr)
+        {
+            uint16x8_t mask = vld1q_u16(masks + i);
+            voltLow = vbslq_f32(vtstq_u32(vmovl_u16(vget_low_u16(mask)), bitVector), voltLow, failVector);
+            voltHigh = vbslq_f32(vtstq_u32(vmovl_u16(vget_high_u16(mask)), bitVector), voltHigh, failVector);
+        }
+
+        vst1q_f32(target + i, voltLow);
+        vst1q_f32(target + i + 4, voltHigh);
+    }
+
+    ADCChannelScaling__Scale<int16_t, float>(source + i, masks == nullptr ? nullptr : masks + i, channelBit, target + i, samples - i,
+                                             scale, offset, failValue);
+}
+
+#endif
+
+ADC_CHANNEL_SCALING__DEFINE_SCALE(, Int16ToDouble, int16_t, double)
+ADC_CHANNEL_SCALING__DEFINE_SCALE(, Int16ToFloat, int16_t, float)
+ADC_CHANNEL_SCALING__DEFINE_SCALE(, FloatToDouble, float, double)
+ADC_CHANNEL_SCALING__DEFINE_SCALE(, FloatToFloat, float, float)
+
+static const vuprs::CPUKernelVariant<ADCChannelScaling__Kernel> ADCChannelScaling__VARIANTS[] = {
+#if defined(__x86_64__) || defined(__i386__)
+    {"avx2", CPU_FEATURE__AVX2, {&ADCChannelScaling__ScaleInt16ToDoubleAVX2, &ADCChannelScaling__ScaleInt16ToFloatAVX2,
+                                 &ADCChannelScaling__ScaleFloatToDoubleAVX2, &ADCChannelScaling__ScaleFloatToFloatAVX2}},
+#elif defined(__aarch64__)
+    {"neon", CPU_FEATURE__ASIMD, {&ADCChannelScaling__ScaleInt16ToDouble, &ADCChannelScaling__ScaleInt16ToFloatNEON,
+                                  &ADCChannelScaling__ScaleFloatToDouble, &ADCChannelScaling__ScaleFloatToFloat}},
+#endif
+    {"scalar", 0, {&ADCChannelScaling__ScaleInt16ToDouble, &ADCChannelScaling__ScaleInt16ToFloat,
+                   &ADCChannelScaling__ScaleFloatToDouble, &ADCChannelScaling__ScaleFloatToFloat}}
+};
+
+static const ADCChannelScaling__Kernel ADCChannelScaling__KERNEL = vuprs::SelectCPUKernel("adc-code-to-voltage", ADCChannelScaling__VARIANTS);
+
+static inline void ADCChannelScaling__ScaleChannel(ADC_CHANNEL_SCALING__SCALE_ARGS(int16_t, double))
+{
+    ADCChannelScaling__KERNEL.int16ToDouble(source, masks, channelBit, target, samples, scale, offset, failValue);
+}
+
+static inline void ADCChannelScaling__ScaleChannel(ADC_CHANNEL_SCALING__SCALE_ARGS(int16_t, float))
+{
+    ADCChannelScaling__KERNEL.int16ToFloat(source, masks, channelBit, target, samples, scale, offset, failValue);
+}
+
+static inline void ADCChannelScaling__ScaleChannel(ADC_CHANNEL_SCALING__SCALE_ARGS(float, double))
+{
+    ADCChannelScaling__KERNEL.floatToDouble(source, masks, channelBit, target, samples, scale, offset, failValue);
+}
+
+static inline void ADCChannelScaling__ScaleChannel(ADC_CHANNEL_SCALING__SCALE_ARGS(float, float))
+{
+    ADCChannelScaling__KERNEL.floatToFloat(source, masks, channelBit, target, samples, scale, offset, failValue);
+}
+
+/**
+ * @brief Channel by channel, scaling & CRC masking in one pass (no second pass over the output).
+ */
+template <typename Code, typename Volt>
+static void ADCChannelScaling__Convert(const vuprs::ADCChannelBuffer<Code> &codes, const std::vector<uint16_t> &crcPassMasks,
+                                       const vuprs::ADCChannelScaling &scaling, vuprs::ADCChannelBuffer<Volt> *voltage)
+{
+    /* ------------------------ Security Check Start ------------------------- */
+
+    if (voltage == nullptr)
+    {
+        throw std::runtime_error("*Voltage is nullptr.");
+    }
+
+    if (codes.channels() != ADC_CHANNELS)
+    {
+        throw std::runtime_error("Invalid channel count: " + std::to_string(codes.channels()));
+    }
+
+    if (!crcPassMasks.empty() && crcPassMasks.size() != codes.samples())
+    {
+        throw std::runtime_error("CRC masks (" + std::to_string(crcPassMasks.size()) +
+                                 ") do not match samples (" + std::to_string(codes.samples()) + ")");
+    }
+
+    /* ------------------------- Security Check End -------------------------- */
+
+    const uint64_t samples = codes.samples();
+
+    voltage->set_channels(ADC_CHANNELS);
+    voltage->resize(samples);
+
+    for (uint64_t c = 0; c < ADC_CHANNELS; c++)
+    {
+        ADCChannelScaling__ScaleChannel(codes.channel(c), crcPassMasks.empty() ? nullptr : crcPassMasks.data(), static_cast<uint16_t>(1U << c),
+                                        voltage->channel(c), samples, static_cast<Volt>(scaling.scale[c]), static_cast<Volt>(scaling.offset[c]),
+                                        static_cast<Volt>(scaling.crcFailVoltage));
+    }
+}
+
+void vuprs::ADCChannelsToVoltage(const vuprs::ADCChannelBuffer<int16_t> &codes, const std::vector<uint16_t> &crcPassMasks,
+                                 const vuprs::ADCChannelScaling &scaling, vuprs::ADCChannelBuffer<double> *voltage)
+{
+    ADCChannelScaling__Convert(codes, crcPassMasks, scaling, voltage);
+}
+
+void vuprs::ADCChannelsToVoltage(const vuprs::ADCChannelBuffer<int16_t> &codes, const std::vector<uint16_t> &crcPassMasks,
+                                 const vuprs::ADCChannelScaling &scaling, vuprs::ADCChannelBuffer<float> *voltage)
+{
+    ADCChannelScaling__Convert(codes, crcPassMasks, scaling, voltage);
+}
+
+void vuprs::ADCChannelsToVoltage(const vuprs::ADCChannelBuffer<float> &codes, const std::vector<uint16_t> &crcPassMasks,
+                                 const vuprs::ADCChannelScaling &scaling, vuprs::ADCChannelBuffer<double> *voltage)
+{
+    ADCChannelScaling__Convert(codes, crcPassMasks, scaling, voltage);
+}
+
+void vuprs::ADCChannelsToVoltage(const vuprs::ADCChannelBuffer<float> &codes, const std::vector<uint16_t> &crcPassMasks,
+                                 const vuprs::ADCChannelScaling &scaling, vuprs::ADCChannelBuffer<float> *voltage)
+{
+    ADCChannelScaling__Convert(codes, crcPassMasks, scaling, voltage);
+}
@@ -0,0 +1,244 @@
+#include "adc_frame_crc.h"
+#include "cpu_dispatch.h"
+
+/**
+ * SIMD variants of the CRC check, all built for the architecture (selected at run time)
+ */
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ADC_FRAME_CRC_SIMD_X86
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define ADC_FRAME_CRC_SIMD_NEON
+#endif
+
+static_assert(ADC_CHANNELS == 16, "CRC kernels are written for 16 data words per frame.");
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* --------------------------------------------------- Tables ---------------------------------------------------- */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+typedef struct ADCFrameCRC__Tables
+{
+    uint8_t full[256];  /* CRC(x) */
+    uint8_t lowNibble[16];  /* CRC(n) */
+    uint8_t highNibble[16];  /* CRC(n << 4) */
+};
+
+static ADCFrameCRC__Tables ADCFrameCRC__BuildTables()
+{
+    ADCFrameCRC__Tables tables;
+    vuprs::CRC8List crcList(CRC8_POLYNOMIAL_CDMA2000);
+
+    for (int i = 0; i < 256; i++)
+    {
+        tables.full[i] = crcList.CRCValue(static_cast<uint8_t>(i));
+    }
+    for (int i = 0; i < 16; i++)
+    {
+        tables.lowNibble[i] = tables.full[i];
+        tables.highNibble[i] = tables.full[i << 4];
+    }
+
+    return tables;
+}
+
+static const ADCFrameCRC__Tables &ADCFrameCRC__GetTables()
+{
+    static const ADCFrameCRC__Tables tables = ADCFrameCRC__BuildTables();
+    return tables;
+}
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* -------------------------------------------------- Scalar ----------------------------------------------------- */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+static inline uint16_t ADCFrameCRC__CheckScalar(const uint32_t *dataWords, const ADCFrameCRC__Tables &tables)
+{
+    uint16_t passMask = 0;
+
+    for (uint32_t i = 0; i < ADC_CHANNELS; i++)
+    {
+        uint32_t word = dataWords[i];
+
+        if (tables.full[(word >> 24) & 0xFF] == ((word >> 8) & 0xFF) &&
+            tables.full[(word >> 16) & 0xFF] == (word & 0xFF))
+        {
+            passMask |= static_cast<uint16_t>(1U << i);
+        }
+    }
+
+    return passMask;
+}
+
+uint16_t vuprs::CheckADCFrameCRCScalar(const uint32_t *dataWords)
+{
+    return ADCFrameCRC__CheckScalar(dataWords, ADCFrameCRC__GetTables());
+}
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* --------------------------------------------------- SIMD ------------------------------------------------------ */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Per 32-bit lane: CRC of every byte by nibble shuffles, the CRCs of bytes 2 & 3 (ADC value) are shifted
+ * down to bytes 0 & 1 and compared with the received CRC bytes.
+ */
+
+#if defined(ADC_FRAME_CRC_SIMD_X86)
+
+__attribute__((target("avx2")))
+static inline uint16_t ADCFrameCRC__CheckAVX2(const uint32_t *dataWords, const ADCFrameCRC__Tables &tables)
+{
+    const __m256i lowTable = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.lowNibble)));
+    const __m256i highTable = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.highNibble)));
+    const __m256i nibbleMask = _mm256_set1_epi8(0x0F);
+    const __m256i crcMask = _mm256_set1_epi32(0x0000FFFF);
+    uint16_t passMask = 0;
+
+    for (uint32_t i = 0; i < ADC_CHANNELS; i += 8)
+    {
+        __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dataWords + i));
+        __m256i crc = _mm256_xor_si256(_mm256_shuffle_epi8(lowTable, _mm256_and_si256(data, nibbleMask)),
+                                       _mm256_shuffle_epi8(highTable, _mm256_and_si256(_mm256_srli_epi16(data, 4), nibbleMask)));
+        __m256i pass = _mm256_cmpeq_epi32(_mm256_srli_epi32(crc, 16), _mm256_and_si256(data, crcMask));
+
+        passMask |= static_cast<uint16_t>(_mm256_movemask_ps(_mm256_castsi256_ps(pass)) << i);
+    }
+
+    return passMask;
+}
+
+__attribute__((target("ssse3")))
+static inline uint16_t ADCFrameCRC__CheckSSSE3(const uint32_t *dataWords, const ADCFrameCRC__Tables &tables)
+{
+    const __m128i lowTable = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.lowNibble));
+    const __m128i highTable = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.highNibble));
+    const __m128i nibbleMask = _mm_set1_epi8(0x0F);
+    const __m128i crcMask = _mm_set1_epi32(0x0000FFFF);
+    uint16_t passMask = 0;
+
+    for (uint32_t i = 0; i < ADC_CHANNELS; i += 4)
+    {
+        __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dataWords + i));
+        __m128i crc = _mm_xor_si128(_mm_shuffle_epi8(lowTable, _mm_and_si128(data, nibbleMask)),
+                                    _mm_shuffle_epi8(highTable, _mm_and_si128(_mm_srli_epi16(data, 4), nibbleMask)));
+        __m128i pass = _mm_cmpeq_epi32(_mm_srli_epi32(crc, 16), _mm_and_si128(data, crcMask));
+
+        passMask |= static_cast<uint16_t>(_mm_movemask_ps(_mm_castsi128_ps(pass)) << i);
+    }
+
+    return passMask;
+}
+
+#elif defined(ADC_FRAME_CRC_SIMD_NEON)
+
+static inline uint16_t ADCFrameCRC__CheckNEON(const uint32_t *dataWords, const ADCFrameCRC__Tables &tables)
+{
+    static const uint32_t LANE_BITS[4] = {1U, 2U, 4U, 8U};
+
+    const uint8x16_t lowTable = vld1q_u8(tables.lowNibble);
+    const uint8x16_t highTable = vld1q_u8(tables.highNibble);
+    const uint8x16_t nibbleMask = vdupq_n_u8(0x0F);
+    const uint32x4_t crcMask = vdupq_n_u32(0x0000FFFF);
+    const uint32x4_t laneBits = vld1q_u32(LANE_BITS);
+    uint16_t passMask = 0;
+
+    for (uint32_t i = 0; i < ADC_CHANNELS; i += 4)
+    {
+        uint32x4_t data = vld1q_u32(dataWords + i);
+        uint8x16_t bytes = vreinterpretq_u8_u32(data);
+        uint8x16_t crc = veorq_u8(vqtbl1q_u8(lowTable, vandq_u8(bytes, nibbleMask)),
+                                  vqtbl1q_u8(highTable, vshrq_n_u8(bytes, 4)));
+        uint32x4_t pass = vceqq_u32(vshrq_n_u32(vreinterpretq_u32_u8(crc), 16), vandq_u32(data, crcMask));
+
+        passMask |= static_cast<uint16_t>(vaddvq_u32(vandq_u32(pass, laneBits)) << i);
+    }
+
+    return passMask;
+}
+
+#endif
+
+/**
+ * @brief Batch loop, inlined into every target so CHECK is inlined as well.
+ */
+template <uint16_t (*CHECK)(const uint32_t *, const ADCFrameCRC__Tables &)>
+static inline __attribute__((always_inline)) void ADCFrameCRC__CheckFrames(const uint32_t *words, const uint64_t *frameOffsets, const uint64_t &frameCount,
+                                                                          uint16_t *passMasks, const ADCFrameCRC__Tables &tables)
+{
+    for (uint64_t i = 0; i < frameCount; i++)
+    {
+        passMasks[i] = CHECK(words + frameOffsets[i] + 1, tables);
+    }
+}
+
+typedef struct ADCFrameCRC__Kernel
+{
+    uint16_t (*check)(const uint32_t *, const ADCFrameCRC__Tables &);
+    void (*checkFrames)(const uint32_t *, const uint64_t *, const uint64_t &, uint16_t *, const ADCFrameCRC__Tables &);
+};
+
+#if defined(ADC_FRAME_CRC_SIMD_X86)
+
+__attribute__((target("avx2")))
+static void ADCFrameCRC__CheckFramesAVX2(const uint32_t *words, const uint64_t *frameOffsets, const uint64_t &frameCount,
+                                         uint16_t *passMasks, const ADCFrameCRC__Tables &tables)
+{
+    ADCFrameCRC__CheckFrames<ADCFrameCRC__CheckAVX2>(words, frameOffsets, frameCount, passMasks, tables);
+}
+
+__attribute__((target("ssse3")))
+static void ADCFrameCRC__CheckFramesSSSE3(const uint32_t *words, const uint64_t *frameOffsets, const uint64_t &frameCount,
+                                          uint16_t *passMasks, const ADCFrameCRC__Tables &tables)
+{
+    ADCFrameCRC__CheckFrames<ADCFrameCRC__CheckSSSE3>(words, frameOffsets, frameCount, passMasks, tables);
+}
+
+#elif defined(ADC_FRAME_CRC_SIMD_NEON)
+
+static void ADCFrameCRC__CheckFramesNEON(const uint32_t *words, const uint64_t *frameOffsets, const uint64_t &frameCount,
+                                         uint16_t *passMasks, const ADCFrameCRC__Tables &tables)
+{
+    ADCFrameCRC__CheckFrames<ADCFrameCRC__CheckNEON>(words, frameOffsets, frameCount, passMasks, tables);
+}
+
+#endif
+
+static void ADCFrameCRC__CheckFramesScalar(const uint32_t *words, const uint64_t *frameOffsets, const uint64_t &frameCount,
+                                           uint16_t *passMasks, const ADCFrameCRC__Tables &tables)
+{
+    ADCFrameCRC__CheckFrames<ADCFrameCRC__CheckScalar>(words, frameOffsets, frameCount, passMasks, tables);
+}
+
+static const vuprs::CPUKernelVariant<ADCFrameCRC__Kernel> ADCFrameCRC__VARIANTS[] = {
+#if defined(ADC_FRAME_CRC_SIMD_X86)
+    {"avx2", CPU_FEATURE__AVX2, {&ADCFrameCRC__CheckAVX2, &ADCFrameCRC__CheckFramesAVX2}},
+    {"ssse3", CPU_FEATURE__SSSE3, {&ADCFrameCRC__CheckSSSE3, &ADCFrameCRC__CheckFramesSSSE3}},
+#elif defined(ADC_FRAME_CRC_SIMD_NEON)
+    {"neon", CPU_FEATURE__ASIMD, {&ADCFrameCRC__CheckNEON, &ADCFrameCRC__CheckFramesNEON}},
+#endif
+    {"scalar", 0, {&ADCFrameCRC__CheckScalar, &ADCFrameCRC__CheckFramesScalar}}
+};
+
+static const ADCFrameCRC__Kernel ADCFrameCRC__KERNEL = vuprs::SelectCPUKernel("adc-frame-crc", ADCFrameCRC__VARIANTS);
+
+uint16_t vuprs::CheckADCFrameCRC(const uint32_t *dataWords)
+{
+    return ADCFrameCRC__KERNEL.check(dataWords, ADCFrameCRC__GetTables());
+}
+
+void vuprs::CheckADCFramesCRC(const uint32_t *words, const uint64_t *frameOffsets, const uint64_t &frameCount, uint16_t *passMasks)
+{
+    if (frameCount == 0)
+    {
+        return;
+    }
+    if (words == nullptr || frameOffsets == nullptr || passMasks == nullptr)
+    {
+        throw std::runtime_error("*Words, *FrameOffsets or *PassMasks is nullptr.");
+    }
+
+    ADCFrameCRC__KERNEL.checkFrames(words, frameOffsets, frameCount, passMasks, ADCFrameCRC__GetTables());
+}
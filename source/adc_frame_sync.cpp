@@ -0,0 +1,411 @@
+#include "adc_frame_sync.h"
+#include "cpu_dispatch.h"
+
+/**
+ * SIMD variants of the frame locator, all built for the architecture (selected at run time)
+ */
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ADC_FRAME_SYNC_SIMD_X86
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define ADC_FRAME_SYNC_SIMD_NEON
+#endif
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* -------------------------------------------------- Scalar ----------------------------------------------------- */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+vuprs::ADCFrameSyncLayout vuprs::DefaultADCFrameSyncLayout()
+{
+    vuprs::ADCFrameSyncLayout layout;
+
+    layout.header = ADC_DATA_HEADER;
+    layout.tailer = ADC_DATA_TAILER;
+    layout.frameWords = ADC_FRAME_WORD_LENGTH;
+
+    return layout;
+}
+
+static uint64_t ADCFrameSync__ScanScalar(const uint32_t *words, const uint64_t &wordCount, std::vector<uint64_t> *frameOffsets,
+                                         const vuprs::ADCFrameSyncLayout &layout, uint64_t scanPointer)
+{
+    while (scanPointer < wordCount)
+    {
+        if (words[scanPointer] == layout.header)  /* Find header */
+        {
+            if (scanPointer + layout.frameWords - 1 >= wordCount)
+            {
+                return scanPointer;  /* Frame is cut by the end of the buffer */
+            }
+            if (words[scanPointer + layout.frameWords - 1] == layout.tailer)
+            {
+                frameOffsets->push_back(scanPointer);
+            }
+
+            scanPointer += layout.frameWords;
+        }
+        else
+        {
+            scanPointer++;
+        }
+    }
+
+    return wordCount;
+}
+
+uint64_t vuprs::LocateADCFramesScalar(const uint32_t *words, const uint64_t &wordCount, std::vector<uint64_t> *frameOffsets,
+                                      const vuprs::ADCFrameSyncLayout &layout)
+{
+    /* ------------------------ Security Check Start ------------------------- */
+
+    if (layout.frameWords < 2)
+    {
+        throw std::runtime_error("Frame words must be >= 2.");
+    }
+    if (frameOffsets == nullptr || (words == nullptr && wordCount != 0))
+    {
+        throw std::runtime_error("*Words or *FrameOffsets is nullptr.");
+    }
+
+    /* ------------------------- Security Check End -------------------------- */
+
+    return ADCFrameSync__ScanScalar(words, wordCount, frameOffsets, layout, 0);
+}
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* --------------------------------------------------- SIMD ------------------------------------------------------ */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Bit i of the mask is set when block[i] is the header (ADC_FRAME_SYNC_BLOCK_WORDS words).
+ * Every variant is compiled for its own target, the variant is selected at start-up (cpu_dispatch.h).
+ */
+
+#if defined(ADC_FRAME_SYNC_SIMD_X86)
+
+__attribute__((target("avx2")))
+static inline uint64_t ADCFrameSync__HeaderMaskAVX2(const uint32_t *block, const uint32_t &header)
+{
+    const __m256i headerVector = _mm256_set1_epi32(static_cast<int>(header));
+    uint64_t mask = 0;
+
+    for (uint32_t i = 0; i < ADC_FRAME_SYNC_BLOCK_WORDS; i += 8)
+    {
+        __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + i));
+        mask |= static_cast<uint64_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(data, headerVector)))) << i;
+    }
+
+    return mask;
+}
+
+__attribute__((target("sse2")))
+static inline uint64_t ADCFrameSync__HeaderMaskSSE2(const uint32_t *block, const uint32_t &header)
+{
+    const __m128i headerVector = _mm_set1_epi32(static_cast<int>(header));
+    uint64_t mask = 0;
+
+    for (uint32_t i = 0; i < ADC_FRAME_SYNC_BLOCK_WORDS; i += 4)
+    {
+        __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i));
+        mask |= static_cast<uint64_t>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(data, headerVector)))) << i;
+    }
+
+    return mask;
+}
+
+#elif defined(ADC_FRAME_SYNC_SIMD_NEON)
+
+static inline uint64_t ADCFrameSync__HeaderMaskNEON(const uint32_t *block, const uint32_t &header)
+{
+    static const uint32_t LANE_BITS[4] = {1U, 2U, 4U, 8U};
+
+    const uint32x4_t headerVector = vdupq_n_u32(header);
+    const uint32x4_t laneBits = vld1q_u32(LANE_BITS);
+    uint64_t mask = 0;
+
+    for (uint32_t i = 0; i < ADC_FRAME_SYNC_BLOCK_WORDS; i += 4)
+    {
+        uint32x4_t data = vld1q_u32(block + i);
+        mask |= static_cast<uint64_t>(vaddvq_u32(vandq_u32(vceqq_u32(data, headerVector), laneBits))) << i;
+    }
+
+    return mask;
+}
+
+#endif
+
+/**
+ * @brief Locate loop of the SIMD variants, inlined into every target so HEADER_MASK is inlined as well.
+ *        A garbage word between frames costs less scalar than a bitmask, the bitmask search starts after
+ *        ADC_FRAME_SYNC_SCALAR_MISSES words without header and walks all candidates of a block before the next one.
+ */
+template <uint64_t (*HEADER_MASK)(const uint32_t *, const uint32_t &)>
+static inline __attribute__((always_inline)) uint64_t ADCFrameSync__LocateSIMD(const uint32_t *words, const uint64_t &wordCount,
+                                                                              std::vector<uint64_t> *frameOffsets, const vuprs::ADCFrameSyncLayout &layout)
+{
+    uint64_t scanPointer = 0, scalarEnd = 0;
+    uint64_t headerMask = 0, maskBegin = 0, maskEnd = 0;  /* Candidates of the block [maskBegin, maskEnd) */
+    uint64_t candidates = 0;
+
+    while (scanPointer + ADC_FRAME_SYNC_BLOCK_WORDS <= wordCount)
+    {
+        /* In sync: the next frame starts right here, check header & tailer directly */
+
+        if (words[scanPointer] == layout.header)
+        {
+            if (scanPointer + layout.frameWords - 1 >= wordCount)
+            {
+                return scanPointer;
+            }
+            if (words[scanPointer + layout.frameWords - 1] == layout.tailer)
+            {
+                frameOffsets->push_back(scanPointer);
+            }
+
+            scanPointer += layout.frameWords;
+            continue;
+        }
+
+        /* Short loss of sync (garbage word): scalar */
+
+        scalarEnd = scanPointer + ADC_FRAME_SYNC_SCALAR_MISSES;
+
+        do
+        {
+            scanPointer++;
+        }
+        while (scanPointer < scalarEnd && words[scanPointer] != layout.header);
+
+        if (scanPointer < scalarEnd || scanPointer + ADC_FRAME_SYNC_BLOCK_WORDS > wordCount)
+        {
+            continue;
+        }
+
+        /* Long loss of sync: remaining candidates of the last bitmask, then one bitmask per block */
+
+        candidates = (scanPointer < maskEnd) ? headerMask >> (scanPointer - maskBegin) : 0;
+
+        if (candidates == 0 && scanPointer < maskEnd)
+        {
+            scanPointer = maskEnd;
+        }
+
+        while (candidates == 0 && scanPointer + ADC_FRAME_SYNC_BLOCK_WORDS <= wordCount)
+        {
+            maskBegin = scanPointer;
+            maskEnd = scanPointer + ADC_FRAME_SYNC_BLOCK_WORDS;
+            headerMask = HEADER_MASK(words + scanPointer, layout.header);
+            candidates = headerMask;
+
+            if (candidates == 0)
+            {
+                scanPointer = maskEnd;
+            }
+        }
+
+        if (candidates != 0)
+        {
+            scanPointer += __builtin_ctzll(candidates);
+        }
+    }
+
+    /* Remaining words (< 1 block) */
+
+    return ADCFrameSync__ScanScalar(words, wordCount, frameOffsets, layout, scanPointer);
+}
+
+#if defined(ADC_FRAME_SYNC_SIMD_X86)
+
+__attribute__((target("avx2")))
+static uint64_t ADCFrameSync__LocateAVX2(const uint32_t *words, const uint64_t &wordCount, std::vector<uint64_t> *frameOffsets,
+                                         const vuprs::ADCFrameSyncLayout &layout)
+{
+    return ADCFrameSync__LocateSIMD<ADCFrameSync__HeaderMaskAVX2>(words, wordCount, frameOffsets, layout);
+}
+
+__attribute__((target("sse2")))
+static uint64_t ADCFrameSync__LocateSSE2(const uint32_t *words, const uint64_t &wordCount, std::vector<uint64_t> *frameOffsets,
+                                         const vuprs::ADCFrameSyncLayout &layout)
+{
+    return ADCFrameSync__LocateSIMD<ADCFrameSync__HeaderMaskSSE2>(words, wordCount, frameOffsets, layout);
+}
+
+#elif defined(ADC_FRAME_SYNC_SIMD_NEON)
+
+static uint64_t ADCFrameSync__LocateNEON(const uint32_t *words, const uint64_t &wordCount, std::vector<uint64_t> *frameOffsets,
+                                         const vuprs::ADCFrameSyncLayout &layout)
+{
+    return ADCFrameSync__LocateSIMD<ADCFrameSync__HeaderMaskNEON>(words, wordCount, frameOffsets, layout);
+}
+
+#endif
+
+static uint64_t ADCFrameSync__LocateScalar(const uint32_t *words, const uint64_t &wordCount, std::vector<uint64_t> *frameOffsets,
+                                           const vuprs::ADCFrameSyncLayout &layout)
+{
+    return ADCFrameSync__ScanScalar(words, wordCount, frameOffsets, layout, 0);
+}
+
+typedef uint64_t (*ADCFrameSync__Kernel)(const uint32_t *, const uint64_t &, std::vector<uint64_t> *, const vuprs::ADCFrameSyncLayout &);
+
+/* SIMD first: equal to the scalar scan in sync, faster while out of sync (vuprs_bench, locate rows) */
+
+static const vuprs::CPUKernelVariant<ADCFrameSync__Kernel> ADCFrameSync__VARIANTS[] = {
+#if defined(ADC_FRAME_SYNC_SIMD_X86)
+    {"avx2", CPU_FEATURE__AVX2, &ADCFrameSync__LocateAVX2},
+    {"sse2", CPU_FEATURE__SSE2, &ADCFrameSync__LocateSSE2},
+#elif defined(ADC_FRAME_SYNC_SIMD_NEON)
+    {"neon", CPU_FEATURE__ASIMD, &ADCFrameSync__LocateNEON},
+#endif
+    {"scalar", 0, &ADCFrameSync__LocateScalar}
+};
+
+static const ADCFrameSync__Kernel ADCFrameSync__LOCATE = vuprs::SelectCPUKernel("adc-frame-locate", ADCFrameSync__VARIANTS);
+
+uint64_t vuprs::LocateADCFrames(const uint32_t *words, const uint64_t &wordCount, std::vector<uint64_t> *frameOffsets,
+                                const vuprs::ADCFrameSyncLayout &layout)
+{
+    /* ------------------------ Security Check Start ------------------------- */
+
+    if (layout.frameWords < 2)
+    {
+        throw std::runtime_error("Frame words must be >= 2.");
+    }
+    if (frameOffsets == nullptr || (words == nullptr && wordCount != 0))
+    {
+        throw std::runtime_error("*Words or *FrameOffsets is nullptr.");
+    }
+
+    /* ------------------------- Security Check End -------------------------- */
+
+    return ADCFrameSync__LOCATE(words, wordCount, frameOffsets, layout);
+}
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* ------------------------------------------------- Parallel ---------------------------------------------------- */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+uint64_t vuprs::LocateADCFramesParallel(const uint32_t *words, const uint64_t &wordCount, const uint32_t &threadCount,
+                                        std::vector<std::vector<uint64_t>> *rangeFrameOffsets, const vuprs::ADCFrameSyncLayout &layout)
+{
+    /* ------------------------ Security Check Start ------------------------- */
+
+    if (layout.frameWords < 2)
+    {
+        throw std::runtime_error("Frame words must be >= 2.");
+    }
+    if (rangeFrameOffsets == nullptr || (words == nullptr && wordCount != 0))
+    {
+        throw std::runtime_error("*Words or *RangeFrameOffsets is nullptr.");
+    }
+
+    /* ------------------------- Security Check End -------------------------- */
+
+    uint64_t rangeCount = (threadCount == 0) ? std::max(1U, std::thread::hardware_concurrency()) : threadCount;
+    uint64_t rangeWords = 0, scanPointer = 0;
+    std::vector<uint64_t> rangeBegin, rangeEnd, threadStop;
+    std::vector<std::vector<uint64_t>> threadFrameOffsets;
+    std::vector<std::thread> threads;
+
+    rangeCount = std::max(static_cast<uint64_t>(1), std::min(rangeCount, wordCount / ADC_FRAME_SYNC_MIN_RANGE_WORDS));
+    rangeWords = (wordCount + rangeCount - 1) / rangeCount;
+
+    rangeFrameOffsets->resize(rangeCount);
+
+    for (std::vector<uint64_t> &frameOffsets : *rangeFrameOffsets)
+    {
+        frameOffsets.clear();  /* Capacity is kept */
+    }
+
+    if (rangeCount == 1)
+    {
+        return vuprs::LocateADCFrames(words, wordCount, &(*rangeFrameOffsets)[0], layout);
+    }
+
+    rangeBegin.resize(rangeCount);
+    rangeEnd.resize(rangeCount);
+    threadStop.resize(rangeCount);
+    threadFrameOffsets.resize(rangeCount);
+
+    for (uint64_t k = 0; k < rangeCount; k++)
+    {
+        rangeBegin[k] = std::min(wordCount, k * rangeWords);
+        rangeEnd[k] = std::min(wordCount, (k + 1) * rangeWords);
+    }
+
+    /* 1. Every thread: frames with header in [begin, end), the window reaches the tailer of the last one */
+
+    for (uint64_t k = 0; k < rangeCount; k++)
+    {
+        threads.emplace_back([&, k]()
+        {
+            uint64_t windowEnd = std::min(wordCount, rangeEnd[k] + layout.frameWords - 1);
+            std::vector<uint64_t> &frameOffsets = threadFrameOffsets[k];
+
+            frameOffsets.reserve((rangeEnd[k] - rangeBegin[k]) / layout.frameWords + 1);
+            threadStop[k] = rangeBegin[k] + vuprs::LocateADCFrames(words + rangeBegin[k], windowEnd - rangeBegin[k], &frameOffsets, layout);
+
+            for (uint64_t &offset : frameOffsets)
+            {
+                offset += rangeBegin[k];
+            }
+            while (!frameOffsets.empty() && frameOffsets.back() >= rangeEnd[k])
+            {
+                frameOffsets.pop_back();
+            }
+        });
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    /* 2. Stitch: continue the serial scan until it meets a frame of the thread */
+
+    for (uint64_t k = 0; k < rangeCount; k++)
+    {
+        std::vector<uint64_t> &frameOffsets = (*rangeFrameOffsets)[k];
+        const std::vector<uint64_t> &found = threadFrameOffsets[k];
+        bool inSync = false;
+
+        while (scanPointer < rangeEnd[k])
+        {
+            if (words[scanPointer] != layout.header)
+            {
+                scanPointer++;
+                continue;
+            }
+            if (scanPointer + layout.frameWords - 1 >= wordCount)
+            {
+                return scanPointer;  /* Frame is cut by the end of the buffer */
+            }
+            if (words[scanPointer + layout.frameWords - 1] != layout.tailer)
+            {
+                scanPointer += layout.frameWords;
+                continue;
+            }
+
+            std::vector<uint64_t>::const_iterator match = std::lower_bound(found.begin(), found.end(), scanPointer);
+
+            if (match != found.end() && *match == scanPointer)
+            {
+                frameOffsets.insert(frameOffsets.end(), match, found.end());
+                scanPointer = found.back() + layout.frameWords;
+                inSync = true;
+                break;
+            }
+
+            frameOffsets.push_back(scanPointer);
+            scanPointer += layout.frameWords;
+        }
+
+        if (inSync && k == rangeCount - 1)
+        {
+            return threadStop[k];  /* Scans are identical up to the end */
+        }
+    }
+
+    return wordCount;  /* Last range ends at wordCount, the serial scan has finished it */
+}
@@ -0,0 +1,807 @@
+#include "adc_soak.h"
+#include "adc_channel_scaling.h"
+#include "adc_stream_parser.h"
+#include "metrics_registry.h"
+#include "trace_recorder.h"
+
+#include <cmath>
+#include <cerrno>
+#include <fstream>
+#include <fcntl.h>
+
+static const char *ADCSoak__StageNames[ADC_SOAK_STAGES] = {"read", "parse", "analysis", "output"};
+
+static vuprs::MetricsCounter &ADCSoak__DroppedBlocks = vuprs::Metrics().Counter("vuprs_soak_dropped_blocks_total", "Soak blocks dropped because all blocks were busy.");
+static vuprs::MetricsCounter &ADCSoak__DroppedFrames = vuprs::Metrics().Counter("vuprs_soak_dropped_frames_total", "Frames of the dropped soak blocks.");
+static const vuprs::MetricsIOSeries ADCSoak__OutputMetrics("vuprs_writer", "file writes", {{"writer", "soak-output"}});
+
+/**
+ * @brief vuprs_soak_queue_depth{stage}: blocks waiting for the stage (read: blocks in flight).
+ */
+static const std::vector<vuprs::MetricsGauge*> ADCSoak__QueueDepthGauges = []()
+{
+    std::vector<vuprs::MetricsGauge*> gauges;
+
+    for (int stage = 0; stage < ADC_SOAK_STAGES; stage++)
+    {
+        gauges.push_back(&vuprs::Metrics().Gauge("vuprs_soak_queue_depth", "Blocks waiting for a soak pipeline stage (read: blocks in flight).",
+                                                 {{"stage", ADCSoak__StageNames[stage]}}));
+    }
+
+    return gauges;
+}();
+
+static vuprs::MetricsGauge &ADCSoak__QueueDepthGauge(const int &stage)
+{
+    return *ADCSoak__QueueDepthGauges[stage];
+}
+
+static int64_t ADCSoak__ThreadCPU_ns()
+{
+    struct timespec ts;
+
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+    {
+        return 0;
+    }
+
+    return static_cast<int64_t>(ts.tv_sec) * ADC_TIME_NS_PER_S + ts.tv_nsec;
+}
+
+double vuprs::ProcessRSS_megabytes()
+{
+    std::ifstream statmFile("/proc/self/statm");
+    uint64_t sizePages = 0, residentPages = 0;
+
+    if (!(statmFile >> sizePages >> residentPages))
+    {
+        return 0;
+    }
+
+    return residentPages * static_cast<double>(sysconf(_SC_PAGESIZE)) / (1024.0 * 1024.0);
+}
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* ---------------------------------------------- Latency Histogram ---------------------------------------------- */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+vuprs::ADCSoakHistogram::ADCSoakHistogram()
+{
+    this->buckets.assign(ADC_SOAK_HISTOGRAM_BUCKETS_PER_DECADE * ADC_SOAK_HISTOGRAM_DECADES + 1, 0);
+    this->count = 0;
+    this->max_ns = 0;
+}
+
+void vuprs::ADCSoakHistogram::Add(const int64_t &latency_ns)
+{
+    /* Bucket i: [1 us * 10^(i / N), 1 us * 10^((i + 1) / N)), bucket 0 also takes < 1 us, the last one the rest */
+
+    double position = latency_ns > 1000 ? std::log10(latency_ns / 1000.0) * ADC_SOAK_HISTOGRAM_BUCKETS_PER_DECADE : 0;
+    uint64_t index = std::min(static_cast<uint64_t>(position), static_cast<uint64_t>(this->buckets.size() - 1));
+
+    this->buckets[index]++;
+    this->count++;
+    this->max_ns = std::max(this->max_ns, latency_ns);
+}
+
+vuprs::ADCSoakLatency vuprs::ADCSoakHistogram::Summary() const
+{
+    vuprs::ADCSoakLatency latency = vuprs::ADCSoakLatency();
+    const double quantiles[3] = {0.5, 0.99, 0.999};
+    double *results[3] = {&latency.p50_ms, &latency.p99_ms, &latency.p999_ms};
+    uint64_t cumulative = 0, rank = 0;
+    uint32_t q = 0;
+
+    latency.count = this->count;
+    latency.max_ms = this->max_ns / 1e6;
+
+    if (this->count == 0)
+    {
+        return latency;
+    }
+
+    /* Upper edge of the bucket holding the rank, never above the maximum */
+
+    for (uint64_t i = 0; i < this->buckets.size() && q < 3; i++)
+    {
+        cumulative += this->buckets[i];
+
+        while (q < 3)
+        {
+            rank = static_cast<uint64_t>(std::ceil(quantiles[q] * this->count));
+
+            if (cumulative < std::max(rank, static_cast<uint64_t>(1)))
+            {
+                break;
+            }
+
+            *results[q] = std::min(1e-3 * std::pow(10.0, static_cast<double>(i + 1) / ADC_SOAK_HISTOGRAM_BUCKETS_PER_DECADE), latency.max_ms);
+            q++;
+        }
+    }
+
+    return latency;
+}
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* ------------------------------------------------- Soak Test --------------------------------------------------- */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+vuprs::ADCSoakTest::ADCSoakTest(const vuprs::ADCSoakConfig &config, const vuprs::FPGAhardwareConfigADC &adcFeatures,
+                                const vuprs::FPGAhardwareConfigFrame &frameFeatures, const vuprs::FPGAhardwareConfigCalibration &calibration)
+{
+    /* ------------------------ Security Check Start ------------------------- */
+
+    if (!adcFeatures.configdown)
+    {
+        throw std::runtime_error("Do not find ADC features, convert disabled");
+    }
+    if (!frameFeatures.configdown)
+    {
+        throw std::runtime_error("Do not find frame features, convert disabled");
+    }
+
+    vuprs::CheckFrameFeatures(frameFeatures);
+
+    if (!calibration.configdown)
+    {
+        throw std::runtime_error("Do not find calibration, convert disabled");
+    }
+
+    vuprs::CheckCalibration(calibration, frameFeatures.channels);
+
+    if (!(config.duration_s > 0))
+    {
+        throw std::runtime_error("Soak duration must be > 0.");
+    }
+    if (config.chunkByteSize == 0 || config.chunkByteSize % sizeof(uint32_t) != 0)
+    {
+        throw std::runtime_error("Chunk bytes is 0 or not a multiple of " + std::to_string(sizeof(uint32_t)) + ".");
+    }
+    if (config.queueDepth == 0)
+    {
+        throw std::runtime_error("Soak queue depth is 0.");
+    }
+    if (config.outputFilename.empty())
+    {
+        throw std::runtime_error("Empty filename.");
+    }
+
+    /* ------------------------- Security Check End -------------------------- */
+
+    this->soakConfig = config;
+    this->adcFeatures = adcFeatures;
+    this->frameFeatures = frameFeatures;
+    this->calibration = calibration;
+
+    for (uint64_t i = 0; i < config.queueDepth; i++)
+    {
+        std::unique_ptr<Block> block(new Block());
+
+        if (!block->raw.malloc(config.chunkByteSize))
+        {
+            throw std::bad_alloc();
+        }
+
+        this->blocks.push_back(std::move(block));
+    }
+}
+
+vuprs::ADCSoakTest::~ADCSoakTest()
+{
+
+}
+
+vuprs::ADCSoakConfig vuprs::ADCSoakTest::DefaultSoakConfig()
+{
+    vuprs::ADCSoakConfig config;
+
+    config.duration_s = 60;
+    config.chunkByteSize = DMA_STREAM_PARSE_CHUNK_BYTES;
+    config.queueDepth = ADC_SOAK_DEFAULT_QUEUE_DEPTH;
+    config.outputFilename = ADC_SOAK_DEFAULT_OUTPUT;
+
+    config.slo.maxDroppedFrames = 0;
+    config.slo.maxLatencyP99_ms = 100;
+    config.slo.minRateRatio = 0.99;
+    config.slo.maxRSS_megabytes = 0;
+    config.slo.maxThreadCPU_percent = 0;
+
+    return config;
+}
+
+vuprs::ADCSoakTest::Block *vuprs::ADCSoakTest::Take(const int &stage)
+{
+    std::unique_lock<std::mutex> lock(this->soakMutex);
+    Block *block = nullptr;
+
+    this->soakCondition.wait(lock, [&]()
+    {
+        return !this->queues[stage].empty() || this->stageFinished[stage - 1] || !this->stageError.empty();
+    });
+
+    if (this->queues[stage].empty() || !this->stageError.empty())
+    {
+        return nullptr;
+    }
+
+    block = this->queues[stage].front();
+    this->queues[stage].pop_front();
+    ADCSoak__QueueDepthGauge(stage).Set(this->queues[stage].size());
+
+    return block;
+}
+
+void vuprs::ADCSoakTest::Pass(Block *block, const int &stage)
+{
+    std::lock_guard<std::mutex> lock(this->soakMutex);
+
+    this->queues[stage].push_back(block);
+
+    if (stage != ADC_SOAK_STAGE__READ)
+    {
+        this->depthSum[stage] += this->queues[stage].size();
+        this->depthMax[stage] = std::max(this->depthMax[stage], static_cast<uint64_t>(this->queues[stage].size()));
+        this->depthSamples[stage]++;
+        ADCSoak__QueueDepthGauge(stage).Set(this->queues[stage].size());
+    }
+
+    this->soakCondition.notify_all();
+}
+
+void vuprs::ADCSoakTest::FinishStage(const int &stage, const std::string &error)
+{
+    std::lock_guard<std::mutex> lock(this->soakMutex);
+
+    this->stageFinished[stage] = true;
+
+    if (!error.empty() && this->stageError.empty())
+    {
+        this->stageError = std::string(ADCSoak__StageNames[stage]) + ": " + error;
+    }
+
+    this->soakCondition.notify_all();
+}
+
+void vuprs::ADCSoakTest::ReadLoop(vuprs::CaptureReplaySource *source)
+{
+    const uint64_t frameBytes = (this->frameFeatures.channels + 2) * sizeof(uint32_t);
+    vuprs::AlignedBufferDMA scratch;
+    uint64_t readBytes = 0, inFlight = 0;
+    int64_t readStart_ns = 0, readEnd_ns = 0;
+    bool readSuccess = false, pendingGap = false;
+    std::string error;
+
+    try
+    {
+        if (!scratch.malloc(this->soakConfig.chunkByteSize))
+        {
+            throw std::bad_alloc();
+        }
+
+        while (true)
+        {
+            Block *block = nullptr;
+
+            /* Never wait for a block: the source runs on its own clock */
+
+            {
+                std::lock_guard<std::mutex> lock(this->soakMutex);
+
+                if (!this->stageError.empty())
+                {
+                    break;
+                }
+                if (!this->queues[ADC_SOAK_STAGE__READ].empty())
+                {
+                    block = this->queues[ADC_SOAK_STAGE__READ].front();
+                    this->queues[ADC_SOAK_STAGE__READ].pop_front();
+                }
+
+                inFlight = this->blocks.size() - this->queues[ADC_SOAK_STAGE__READ].size();
+                this->depthSum[ADC_SOAK_STAGE__READ] += inFlight;
+                this->depthMax[ADC_SOAK_STAGE__READ] = std::max(this->depthMax[ADC_SOAK_STAGE__READ], inFlight);
+                this->depthSamples[ADC_SOAK_STAGE__READ]++;
+                ADCSoak__QueueDepthGauge(ADC_SOAK_STAGE__READ).Set(inFlight);
+            }
+
+            {
+                VUPRS_TRACE_SPAN_VALUE("soak.read", block != nullptr);  /* Value 0: the chunk is dropped */
+
+                readStart_ns = vuprs::HostMonotonic_ns();
+                readSuccess = source->Read(block != nullptr ? block->raw.data() : scratch.data(),
+                                           this->soakConfig.chunkByteSize, &readBytes);
+                readEnd_ns = vuprs::HostMonotonic_ns();
+            }
+
+            if (!readSuccess || readBytes == 0)
+            {
+                if (block != nullptr)
+                {
+                    this->Pass(block, ADC_SOAK_STAGE__READ);
+                }
+                if (!readSuccess)
+                {
+                    error = "Source read failed.";
+                }
+                break;
+            }
+
+            this->sourceBytes += readBytes;
+
+            if (block == nullptr)
+            {
+                ADCSoak__DroppedBlocks.Add();
+                ADCSoak__DroppedFrames.Add((this->droppedBytes + readBytes) / frameBytes - this->droppedBytes / frameBytes);
+                this->droppedBlocks++;
+                this->droppedBytes += readBytes;
+                pendingGap = true;
+                continue;
+            }
+
+            this->service[ADC_SOAK_STAGE__READ].Add(readEnd_ns - readStart_ns);
+
+            block->bytes = readBytes;
+            block->gap = pendingGap;
+            block->readTime_ns = readEnd_ns;
+            block->stageDone_ns = readEnd_ns;
+            pendingGap = false;
+
+            this->blocksInFlight++;
+            this->Pass(block, ADC_SOAK_STAGE__PARSE);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        error = e.what();
+    }
+
+    this->threadCPU_s[ADC_SOAK_STAGE__READ] = ADCSoak__ThreadCPU_ns() / 1e9;
+    this->FinishStage(ADC_SOAK_STAGE__READ, error);
+}
+
+void vuprs::ADCSoakTest::ParseLoop()
+{
+    vuprs::ADCStreamParser streamParser(this->frameFeatures);
+    int64_t start_ns = 0, end_ns = 0;
+    std::string error;
+    Block *block = nullptr;
+
+    try
+    {
+        while ((block = this->Take(ADC_SOAK_STAGE__PARSE)) != nullptr)
+        {
+            start_ns = vuprs::HostMonotonic_ns();
+            VUPRS_TRACE_SPAN("soak.parse");
+            this->queueWait[ADC_SOAK_STAGE__PARSE].Add(start_ns - block->stageDone_ns);
+
+            if (block->gap)
+            {
+                streamParser.Reset();  /* Not contiguous, search the next header */
+            }
+
+            block->samples.set_channels(this->frameFeatures.channels);
+            block->samples.clear();
+
+            streamParser.Feed(block->raw.data(), block->bytes, [&](const uint32_t *words, const uint64_t *frameOffsets, const uint64_t &frameCount)
+            {
+                vuprs::FramesData2ADCChannels(words, frameOffsets, frameCount, &block->samples, this->adcFeatures, this->frameFeatures, this->calibration);
+            });
+
+            this->parsedFrames += block->samples.samples();
+
+            end_ns = vuprs::HostMonotonic_ns();
+            this->service[ADC_SOAK_STAGE__PARSE].Add(end_ns - start_ns);
+            block->stageDone_ns = end_ns;
+
+            this->Pass(block, ADC_SOAK_STAGE__ANALYSIS);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        error = e.what();
+    }
+
+    this->threadCPU_s[ADC_SOAK_STAGE__PARSE] = ADCSoak__ThreadCPU_ns() / 1e9;
+    this->FinishStage(ADC_SOAK_STAGE__PARSE, error);
+}
+
+void vuprs::ADCSoakTest::AnalysisLoop()
+{
+    int64_t start_ns = 0, end_ns = 0;
+    std::string error;
+    Block *block = nullptr;
+
+    try
+    {
+        while ((block = this->Take(ADC_SOAK_STAGE__ANALYSIS)) != nullptr)
+        {
+            start_ns = vuprs::HostMonotonic_ns();
+            VUPRS_TRACE_SPAN("soak.analysis");
+            this->queueWait[ADC_SOAK_STAGE__ANALYSIS].Add(start_ns - block->stageDone_ns);
+
+            for (uint64_t c = 0; c < block->samples.channels() && block->samples.samples() > 0; c++)
+            {
+                const double *samples = block->samples.channel(c);
+                double squareSum = 0;
+
+                for (uint64_t i = 0; i < block->samples.samples(); i++)
+                {
+                    const bool crcFailed = std::isnan(samples[i]);  /* Sample of a data word with broken CRC */
+
+                    squareSum += crcFailed ? 0.0 : samples[i] * samples[i];
+                    this->crcFailedSamples += crcFailed;
+                }
+
+                this->channelSquareSum[c] += squareSum;
+            }
+
+            this->analysedSamples += block->samples.samples();
+
+            end_ns = vuprs::HostMonotonic_ns();
+            this->service[ADC_SOAK_STAGE__ANALYSIS].Add(end_ns - start_ns);
+            block->stageDone_ns = end_ns;
+
+            this->Pass(block, ADC_SOAK_STAGE__OUTPUT);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        error = e.what();
+    }
+
+    this->threadCPU_s[ADC_SOAK_STAGE__ANALYSIS] = ADCSoak__ThreadCPU_ns() / 1e9;
+    this->FinishStage(ADC_SOAK_STAGE__ANALYSIS, error);
+}
+
+void vuprs::ADCSoakTest::OutputLoop(const int &output_fd)
+{
+    int64_t start_ns = 0, end_ns = 0;
+    uint64_t channelBytes = 0, writtenBytes = 0;
+    ssize_t writeBytes = 0;
+    std::string error;
+    Block *block = nullptr;
+
+    try
+    {
+        while ((block = this->Take(ADC_SOAK_STAGE__OUTPUT)) != nullptr)
+        {
+            start_ns = vuprs::HostMonotonic_ns();
+            VUPRS_TRACE_SPAN("soak.output");
+            this->queueWait[ADC_SOAK_STAGE__OUTPUT].Add(start_ns - block->stageDone_ns);
+
+            /* Channel after channel (the channel-major samples of the block) */
+
+            channelBytes = block->samples.samples() * sizeof(double);
+
+            for (uint64_t c = 0; c < block->samples.channels() && channelBytes > 0; c++)
+            {
+                writtenBytes = 0;
+
+                while (writtenBytes < channelBytes)
+                {
+                    writeBytes = write(output_fd, reinterpret_cast<const uint8_t*>(block->samples.channel(c)) + writtenBytes, channelBytes - writtenBytes);
+
+                    if (writeBytes < 0 && errno == EINTR)
+                    {
+                        continue;
+                    }
+                    if (writeBytes <= 0)
+                    {
+                        ADCSoak__OutputMetrics.Count(0, false, vuprs::HostMonotonic_ns() - start_ns);
+                        throw std::runtime_error("Cannot write output file: " + this->soakConfig.outputFilename);
+                    }
+
+                    writtenBytes += writeBytes;
+                }
+
+                this->outputBytes += channelBytes;
+            }
+
+            end_ns = vuprs::HostMonotonic_ns();
+            ADCSoak__OutputMetrics.Count(channelBytes * block->samples.channels(), true, end_ns - start_ns);
+            this->service[ADC_SOAK_STAGE__OUTPUT].Add(end_ns - start_ns);
+            this->endToEnd.Add(end_ns - block->readTime_ns);
+
+            this->blocksInFlight--;
+            this->Pass(block, ADC_SOAK_STAGE__READ);  /* Free */
+        }
+    }
+    catch (const std::exception &e)
+    {
+        error = e.what();
+    }
+
+    this->threadCPU_s[ADC_SOAK_STAGE__OUTPUT] = ADCSoak__ThreadCPU_ns() / 1e9;
+    this->FinishStage(ADC_SOAK_STAGE__OUTPUT, error);
+}
+
+bool vuprs::ADCSoakTest::Run(vuprs::CaptureReplaySource *source, vuprs::ADCSoakReport *report,
+                             const std::function<void(const vuprs::ADCSoakProgress&)> &progress,
+                             const vuprs::ADCTimeDescriptor *captureTime)
+{
+    /* ------------------------ Security Check Start ------------------------- */
+
+    if (source == nullptr)
+    {
+        throw std::runtime_error("*Source is nullptr.");
+    }
+    if (report == nullptr)
+    {
+        throw std::runtime_error("*Report is nullptr.");
+    }
+
+    /* ------------------------- Security Check End -------------------------- */
+
+    const vuprs::ADCSoakSLO &slo = this->soakConfig.slo;
+    const uint64_t frameBytes = (this->frameFeatures.channels + 2) * sizeof(uint32_t);
+    vuprs::ADCSoakProgress soakProgress = vuprs::ADCSoakProgress();
+    std::chrono::steady_clock::time_point startTime;
+    double elapsed_s = 0, rss_megabytes = 0;
+    char violation[160] = {0};
+    int output_fd = -1;
+
+    output_fd = open(this->soakConfig.outputFilename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (output_fd < 0)
+    {
+        throw std::runtime_error("Cannot open output file: " + this->soakConfig.outputFilename);
+    }
+
+    /* Reset */
+
+    for (int stage = 0; stage < ADC_SOAK_STAGES; stage++)
+    {
+        this->queues[stage].clear();
+        this->stageFinished[stage] = false;
+        this->queueWait[stage] = vuprs::ADCSoakHistogram();
+        this->service[stage] = vuprs::ADCSoakHistogram();
+        this->depthSum[stage] = 0;
+        this->depthMax[stage] = 0;
+        this->depthSamples[stage] = 0;
+        this->threadCPU_s[stage] = 0;
+    }
+    for (std::unique_ptr<Block> &block : this->blocks)
+    {
+        this->queues[ADC_SOAK_STAGE__READ].push_back(block.get());
+    }
+
+    this->stageError.clear();
+    this->endToEnd = vuprs::ADCSoakHistogram();
+    this->sourceBytes = 0;
+    this->droppedBlocks = 0;
+    this->droppedBytes = 0;
+    this->blocksInFlight = 0;
+    this->parsedFrames = 0;
+    this->crcFailedSamples = 0;
+    this->outputBytes = 0;
+    this->channelSquareSum.assign(this->frameFeatures.channels, 0.0);
+    this->analysedSamples = 0;
+
+    *report = vuprs::ADCSoakReport();
+    report->frameBytes = frameBytes;
+    report->startRSS_megabytes = vuprs::ProcessRSS_megabytes();
+    report->peakRSS_megabytes = report->startRSS_megabytes;
+
+    /* Pipeline */
+
+    startTime = std::chrono::steady_clock::now();
+
+    std::thread readThread(&vuprs::ADCSoakTest::ReadLoop, this, source);
+    std::thread parseThread(&vuprs::ADCSoakTest::ParseLoop, this);
+    std::thread analysisThread(&vuprs::ADCSoakTest::AnalysisLoop, this);
+    std::thread outputThread(&vuprs::ADCSoakTest::OutputLoop, this, output_fd);
+
+    /* Monitor: RSS & progress until the duration is over, the source ends or a stage fails */
+
+    while (true)
+    {
+        std::unique_lock<std::mutex> lock(this->soakMutex);
+
+        elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+        if (elapsed_s >= this->soakConfig.duration_s ||
+            this->soakCondition.wait_for(lock, std::chrono::duration<double>(std::min(ADC_SOAK_MONITOR_INTERVAL_S, this->soakConfig.duration_s - elapsed_s)),
+                                         [&]() { return this->stageFinished[ADC_SOAK_STAGE__READ] || !this->stageError.empty(); }))
+        {
+            break;
+        }
+
+        lock.unlock();
+
+        rss_megabytes = vuprs::ProcessRSS_megabytes();
+        report->peakRSS_megabytes = std::max(report->peakRSS_megabytes, rss_megabytes);
+
+        if (progress)
+        {
+            soakProgress.elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+            soakProgress.sourceBytes = this->sourceBytes;
+            soakProgress.droppedFrames = this->droppedBytes / frameBytes;
+            soakProgress.blocksInFlight = this->blocksInFlight;
+            soakProgress.rss_megabytes = rss_megabytes;
+            progress(soakProgress);
+        }
+    }
+
+    source->Stop();
+
+    readThread.join();
+    parseThread.join();
+    analysisThread.join();
+    outputThread.join();
+
+    close(output_fd);
+
+    if (!this->stageError.empty())
+    {
+        throw std::runtime_error("Soak pipeline failed, " + this->stageError);
+    }
+
+    /* Report */
+
+    report->duration_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    report->endRSS_megabytes = vuprs::ProcessRSS_megabytes();
+    report->peakRSS_megabytes = std::max(report->peakRSS_megabytes, report->endRSS_megabytes);
+
+    report->sourceBytes = this->sourceBytes;
+    report->droppedBlocks = this->droppedBlocks;
+    report->processedBytes = this->sourceBytes - this->droppedBytes;
+    report->droppedFrames = (this->droppedBytes + frameBytes - 1) / frameBytes;
+    report->parsedFrames = this->parsedFrames;
+    report->lostFrames = report->processedBytes / frameBytes > this->parsedFrames ? report->processedBytes / frameBytes - this->parsedFrames : 0;
+    report->crcFailedSamples = this->crcFailedSamples;
+    report->outputBytes = this->outputBytes;
+    report->endToEnd = this->endToEnd.Summary();
+    report->source = source->Report();
+
+    if (captureTime != nullptr)
+    {
+        report->timed = true;
+        report->time = *captureTime;
+        report->firstSampleRealtime_ns = captureTime->SampleRealtime_ns(0);
+        report->lastSampleRealtime_ns = captureTime->SampleRealtime_ns(static_cast<int64_t>(this->sourceBytes / frameBytes) - 1);
+    }
+
+    for (uint64_t c = 0; c < this->channelSquareSum.size(); c++)
+    {
+        report->channelRMS_v.push_back(this->analysedSamples > 0 ? std::sqrt(this->channelSquareSum[c] / this->analysedSamples) : 0);
+    }
+
+    for (int stage = 0; stage < ADC_SOAK_STAGES; stage++)
+    {
+        report->stages[stage].name = ADCSoak__StageNames[stage];
+        report->stages[stage].queueWait = this->queueWait[stage].Summary();
+        report->stages[stage].service = this->service[stage].Summary();
+        report->stages[stage].maxQueueDepth = this->depthMax[stage];
+        report->stages[stage].meanQueueDepth = this->depthSamples[stage] > 0 ? static_cast<double>(this->depthSum[stage]) / this->depthSamples[stage] : 0;
+        report->stages[stage].cpu_percent = this->threadCPU_s[stage] / report->duration_s * 100;
+    }
+
+    /* SLOs */
+
+    if (report->droppedFrames > slo.maxDroppedFrames)
+    {
+        snprintf(violation, sizeof(violation), "dropped frames %lu > %lu",
+                 static_cast<unsigned long>(report->droppedFrames), static_cast<unsigned long>(slo.maxDroppedFrames));
+        report->violations.push_back(violation);
+    }
+    if (slo.maxLatencyP99_ms > 0 && report->endToEnd.p99_ms > slo.maxLatencyP99_ms)
+    {
+        snprintf(violation, sizeof(violation), "end-to-end p99 %.3f ms > %.3f ms", report->endToEnd.p99_ms, slo.maxLatencyP99_ms);
+        report->violations.push_back(violation);
+    }
+    if (slo.minRateRatio > 0 && report->source.requestedRate_bytesPerSecond > 0 && report->source.rateRatio < slo.minRateRatio)
+    {
+        snprintf(violation, sizeof(violation), "source rate %.1f %% < %.1f %% of requested", report->source.rateRatio * 100, slo.minRateRatio * 100);
+        report->violations.push_back(violation);
+    }
+    if (slo.maxRSS_megabytes > 0 && report->peakRSS_megabytes > slo.maxRSS_megabytes)
+    {
+        snprintf(violation, sizeof(violation), "peak RSS %.1f MB > %.1f MB", report->peakRSS_megabytes, slo.maxRSS_megabytes);
+        report->violations.push_back(violation);
+    }
+    for (int stage = 0; stage < ADC_SOAK_STAGES && slo.maxThreadCPU_percent > 0; stage++)
+    {
+        if (report->stages[stage].cpu_percent > slo.maxThreadCPU_percent)
+        {
+            snprintf(violation, sizeof(violation), "%s thread CPU %.1f %% > %.1f %%",
+                     ADCSoak__StageNames[stage], report->stages[stage].cpu_percent, slo.maxThreadCPU_percent);
+            report->violations.push_back(violation);
+        }
+    }
+
+    report->passed = report->violations.empty();
+
+    return report->passed;
+}
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* ------------------------------------------------- Soak Report ------------------------------------------------- */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+static nlohmann::json ADCSoak__LatencyJson(const vuprs::ADCSoakLatency &latency)
+{
+    return {
+        {"count", latency.count},
+        {"p50-ms", latency.p50_ms},
+        {"p99-ms", latency.p99_ms},
+        {"p999-ms", latency.p999_ms},
+        {"max-ms", latency.max_ms}
+    };
+}
+
+bool vuprs::SaveADCSoakReport(const std::string &reportFilename, const vuprs::ADCSoakReport &report)
+{
+    if (reportFilename.empty())
+    {
+        return false;
+    }
+
+    nlohmann::json reportJsonData, stagesJsonData = nlohmann::json::array();
+    std::ofstream reportFile(reportFilename, std::ios::trunc);
+
+    if (!reportFile.is_open())
+    {
+        return false;
+    }
+
+    reportJsonData["description"] = "VUPRS Soak Test Report";
+    reportJsonData["duration-s"] = report.duration_s;
+    reportJsonData["frame-bytes"] = report.frameBytes;
+    reportJsonData["source-bytes"] = report.sourceBytes;
+    reportJsonData["processed-bytes"] = report.processedBytes;
+    reportJsonData["dropped-blocks"] = report.droppedBlocks;
+    reportJsonData["dropped-frames"] = report.droppedFrames;
+    reportJsonData["parsed-frames"] = report.parsedFrames;
+    reportJsonData["lost-frames"] = report.lostFrames;
+    reportJsonData["crc-failed-samples"] = report.crcFailedSamples;
+    reportJsonData["output-bytes"] = report.outputBytes;
+    reportJsonData["channel-rms-v"] = report.channelRMS_v;
+    reportJsonData["end-to-end"] = ADCSoak__LatencyJson(report.endToEnd);
+
+    if (report.timed)
+    {
+        reportJsonData["time"] = {
+            {"first-frame", report.time.firstFrameIndex},
+            {"sample-period-s", report.time.samplePeriod_s},
+            {"clock-ratio", report.time.clockRatio},
+            {"first-sample-realtime-ns", report.firstSampleRealtime_ns},
+            {"last-sample-realtime-ns", report.lastSampleRealtime_ns}
+        };
+    }
+
+    for (const vuprs::ADCSoakStageReport &stage : report.stages)
+    {
+        stagesJsonData.push_back({
+            {"stage", stage.name},
+            {"queue-wait", ADCSoak__LatencyJson(stage.queueWait)},
+            {"service", ADCSoak__LatencyJson(stage.service)},
+            {"max-queue-depth", stage.maxQueueDepth},
+            {"mean-queue-depth", stage.meanQueueDepth},
+            {"cpu-percent", stage.cpu_percent}
+        });
+    }
+    reportJsonData["stages"] = stagesJsonData;
+
+    reportJsonData["rss-start-mb"] = report.startRSS_megabytes;
+    reportJsonData["rss-peak-mb"] = report.peakRSS_megabytes;
+    reportJsonData["rss-end-mb"] = report.endRSS_megabytes;
+
+    reportJsonData["source"] = {
+        {"delivered-bytes", report.source.deliveredBytes},
+        {"completed-loops", report.source.completedLoops},
+        {"requested-bytes-per-second", report.source.requestedRate_bytesPerSecond},
+        {"achieved-bytes-per-second", report.source.achievedRate_bytesPerSecond},
+        {"rate-ratio", report.source.rateRatio},
+        {"reads", report.source.reads},
+        {"late-reads", report.source.lateReads},
+        {"max-lag-s", report.source.maxLag_s}
+    };
+
+    reportJsonData["violations"] = report.violations;
+    reportJsonData["passed"] = report.passed;
+
+    reportFile << reportJsonData.dump(4) << std::endl;
+
+    return reportFile.good();
+}
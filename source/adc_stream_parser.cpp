@@ -0,0 +1,241 @@
+#include "adc_stream_parser.h"
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* ---------------------------------------------- ADC Stream Parser ---------------------------------------------- */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+vuprs::ADCStreamParser::ADCStreamParser(const vuprs::ADCFrameSyncLayout &layout)
+{
+    if (layout.frameWords < 3 || layout.frameWords > ADC_FRAME_MAX_CHANNELS + 2)
+    {
+        throw std::runtime_error("Frame must be header + 1 ~ " + std::to_string(ADC_FRAME_MAX_CHANNELS) + " data words + tailer.");
+    }
+    if (layout.header == layout.tailer)
+    {
+        throw std::runtime_error("Header and tailer are the same word.");
+    }
+
+    this->layout = layout;
+    this->dataWords = layout.frameWords - 2;
+
+    this->carryWords.reserve(layout.frameWords);
+    this->stitchWords.reserve(2 * layout.frameWords);
+
+    this->Reset();
+}
+
+static vuprs::ADCFrameSyncLayout ADCStreamParser__Layout(const vuprs::FPGAhardwareConfigFrame &frameFeatures)
+{
+    vuprs::ADCFrameSyncLayout layout;
+
+    if (!frameFeatures.configdown)
+    {
+        throw std::runtime_error("Do not find frame features, parse disabled");
+    }
+
+    vuprs::CheckFrameFeatures(frameFeatures);
+
+    layout.header = static_cast<uint32_t>(frameFeatures.header);
+    layout.tailer = static_cast<uint32_t>(frameFeatures.tailer);
+    layout.frameWords = frameFeatures.channels + 2;
+
+    return layout;
+}
+
+vuprs::ADCStreamParser::ADCStreamParser(const vuprs::FPGAhardwareConfigFrame &frameFeatures)
+    : ADCStreamParser(ADCStreamParser__Layout(frameFeatures))
+{
+
+}
+
+vuprs::ADCStreamParser::~ADCStreamParser()
+{
+
+}
+
+void vuprs::ADCStreamParser::Reset()
+{
+    this->carryWords.clear();
+    this->carryByteCount = 0;
+
+    this->consumedBytes = 0;
+    this->emittedFrames = 0;
+}
+
+void vuprs::ADCStreamParser::EmitFrames(const uint32_t *words, const vuprs::ADCStreamFrameSink &onFrames)
+{
+    if (this->frameOffsets.empty())
+    {
+        return;
+    }
+
+    onFrames(words, this->frameOffsets.data(), this->frameOffsets.size());
+
+    this->emittedFrames += this->frameOffsets.size();
+}
+
+uint64_t vuprs::ADCStreamParser::Feed(const void *chunk, const uint64_t &byteCount, const vuprs::ADCStreamFrameSink &onFrames)
+{
+    /* ------------------------ Security Check Start ------------------------- */
+
+    if (!onFrames)
+    {
+        throw std::runtime_error("Empty frame callback.");
+    }
+    if (chunk == nullptr && byteCount != 0)
+    {
+        throw std::runtime_error("*Chunk is nullptr.");
+    }
+
+    /* ------------------------- Security Check End -------------------------- */
+
+    const uint8_t *bytes = static_cast<const uint8_t*>(chunk);
+    const uint32_t *words = nullptr;
+    const uint64_t framesBefore = this->emittedFrames;
+    uint64_t remainingBytes = byteCount, wordCount = 0, chunkStart = 0, stopPosition = 0, takeBytes = 0;
+    uint32_t completedWord = 0;
+
+    this->consumedBytes += byteCount;
+
+    /* 1. Complete the word cut by the last chunk */
+
+    if (this->carryByteCount > 0)
+    {
+        takeBytes = std::min(static_cast<uint64_t>(sizeof(uint32_t) - this->carryByteCount), remainingBytes);
+        memcpy(this->carryBytes + this->carryByteCount, bytes, takeBytes);
+
+        this->carryByteCount += takeBytes;
+        bytes += takeBytes;
+        remainingBytes -= takeBytes;
+
+        if (this->carryByteCount < sizeof(uint32_t))
+        {
+            return 0;
+        }
+
+        memcpy(&completedWord, this->carryBytes, sizeof(uint32_t));
+        this->carryWords.push_back(completedWord);
+        this->carryByteCount = 0;
+    }
+
+    /* 2. Word view of the chunk (copied only when not aligned) */
+
+    wordCount = remainingBytes / sizeof(uint32_t);
+
+    if (reinterpret_cast<uintptr_t>(bytes) % sizeof(uint32_t) == 0)
+    {
+        words = reinterpret_cast<const uint32_t*>(bytes);
+    }
+    else
+    {
+        this->alignedWords.resize(wordCount);
+        memcpy(this->alignedWords.data(), bytes, wordCount * sizeof(uint32_t));
+        words = this->alignedWords.data();
+    }
+
+    /* 3. Carried words + one frame of the chunk, resume the scan where it left */
+
+    if (!this->carryWords.empty())
+    {
+        const uint64_t carryCount = this->carryWords.size();
+        const uint64_t headCount = std::min(this->layout.frameWords, wordCount);
+
+        this->stitchWords.assign(this->carryWords.begin(), this->carryWords.end());
+        this->stitchWords.insert(this->stitchWords.end(), words, words + headCount);
+
+        this->frameOffsets.clear();
+        stopPosition = vuprs::LocateADCFrames(this->stitchWords.data(), this->stitchWords.size(), &this->frameOffsets, this->layout);
+        this->EmitFrames(this->stitchWords.data(), onFrames);
+
+        this->carryWords.clear();
+
+        if (stopPosition == this->stitchWords.size())
+        {
+            chunkStart = headCount;
+        }
+        else if (stopPosition >= carryCount)
+        {
+            chunkStart = stopPosition - carryCount;
+        }
+        else
+        {
+            /* Chunk is shorter than a frame, the cut frame is still incomplete */
+
+            this->carryWords.assign(this->stitchWords.begin() + stopPosition, this->stitchWords.end());
+            chunkStart = wordCount;
+        }
+    }
+
+    /* 4. Rest of the chunk in place */
+
+    if (chunkStart < wordCount)
+    {
+        this->frameOffsets.clear();
+        stopPosition = vuprs::LocateADCFrames(words + chunkStart, wordCount - chunkStart, &this->frameOffsets, this->layout);
+        this->EmitFrames(words + chunkStart, onFrames);
+
+        if (stopPosition < wordCount - chunkStart)
+        {
+            this->carryWords.assign(words + chunkStart + stopPosition, words + wordCount);
+        }
+    }
+
+    /* 5. Bytes of an incomplete word */
+
+    this->carryByteCount = remainingBytes % sizeof(uint32_t);
+    memcpy(this->carryBytes, bytes + wordCount * sizeof(uint32_t), this->carryByteCount);
+
+    return this->emittedFrames - framesBefore;
+}
+
+uint64_t vuprs::ADCStreamParser::Feed(const void *chunk, const uint64_t &byteCount,
+                                      std::vector<uint32_t> *frameWords, std::vector<uint16_t> *crcPassMasks)
+{
+    /* ------------------------ Security Check Start ------------------------- */
+
+    if (frameWords == nullptr)
+    {
+        throw std::runtime_error("*FrameWords is nullptr.");
+    }
+    if (crcPassMasks != nullptr && this->dataWords != ADC_CHANNELS)
+    {
+        throw std::runtime_error("CRC pass masks need " + std::to_string(ADC_CHANNELS) + " data words per frame.");
+    }
+
+    /* ------------------------- Security Check End -------------------------- */
+
+    return this->Feed(chunk, byteCount, [&](const uint32_t *words, const uint64_t *frameOffsets, const uint64_t &frameCount)
+    {
+        uint64_t outputOffset = frameWords->size();
+
+        frameWords->resize(outputOffset + frameCount * this->dataWords);
+
+        for (uint64_t i = 0; i < frameCount; i++)
+        {
+            memcpy(frameWords->data() + outputOffset, words + frameOffsets[i] + 1, this->dataWords * sizeof(uint32_t));
+            outputOffset += this->dataWords;
+        }
+
+        if (crcPassMasks != nullptr)
+        {
+            outputOffset = crcPassMasks->size();
+            crcPassMasks->resize(outputOffset + frameCount);
+            vuprs::CheckADCFramesCRC(words, frameOffsets, frameCount, crcPassMasks->data() + outputOffset);
+        }
+    });
+}
+
+uint64_t vuprs::ADCStreamParser::PendingBytes() const
+{
+    return this->carryWords.size() * sizeof(uint32_t) + this->carryByteCount;
+}
+
+uint64_t vuprs::ADCStreamParser::ConsumedBytes() const
+{
+    return this->consumedBytes;
+}
+
+uint64_t vuprs::ADCStreamParser::EmittedFrames() const
+{
+    return this->emittedFrames;
+}
@@ -0,0 +1,208 @@
+#include "adc_time.h"
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* ---------------------------------------------- Clocks & Registers --------------------------------------------- */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+double vuprs::SamplePeriodFromSCI(const uint32_t &sci, const vuprs::FPGAhardwareConfigADC &adcFeatures)
+{
+    /* ------------------------ Security Check Start ------------------------- */
+
+    if (!adcFeatures.configdown || adcFeatures.adcSamplingClock_Hz == 0)
+    {
+        throw std::runtime_error("Do not find sampling clock of ADC features, time disabled");
+    }
+
+    if (sci == 0)
+    {
+        throw std::runtime_error("SCI is 0, ADC is not sampling.");
+    }
+
+    if (adcFeatures.adcSCIAccumulatorBits > 63)
+    {
+        throw std::runtime_error("Invalid SCI accumulator bits: " + std::to_string(adcFeatures.adcSCIAccumulatorBits));
+    }
+
+    /* ------------------------- Security Check End -------------------------- */
+
+    if (adcFeatures.adcSCIAccumulatorBits == 0)
+    {
+        return static_cast<double>(sci) / adcFeatures.adcSamplingClock_Hz;
+    }
+
+    return ldexp(1.0, static_cast<int>(adcFeatures.adcSCIAccumulatorBits)) / (static_cast<double>(sci) * adcFeatures.adcSamplingClock_Hz);
+}
+
+static int64_t ADCTime__Clock_ns(const clockid_t &clockId)
+{
+    struct timespec now;
+
+    clock_gettime(clockId, &now);
+
+    return static_cast<int64_t>(now.tv_sec) * ADC_TIME_NS_PER_S + now.tv_nsec;
+}
+
+int64_t vuprs::HostMonotonic_ns()
+{
+    return ADCTime__Clock_ns(CLOCK_MONOTONIC);
+}
+
+int64_t vuprs::HostRealtime_ns()
+{
+    return ADCTime__Clock_ns(CLOCK_REALTIME);
+}
+
+bool vuprs::ReadADCTimeReference(vuprs::FPGAController *fpgaController, const uint64_t &lastFrameIndex, vuprs::ADCTimeReference *reference)
+{
+    /* ------------------------ Security Check Start ------------------------- */
+
+    if (fpgaController == nullptr || reference == nullptr)
+    {
+        throw std::runtime_error("*FPGAController or *Reference is nullptr.");
+    }
+
+    /* ------------------------- Security Check End -------------------------- */
+
+    uint32_t counter = 0;
+    int64_t monotonicBefore = 0, monotonicAfter = 0, realtime = 0;
+
+    monotonicBefore = vuprs::HostMonotonic_ns();
+    realtime = vuprs::HostRealtime_ns();
+
+    if (!fpgaController->AXILite_ReadFPGARegister(AXI_LITE_REGISTER__ADC__NGF, &counter))
+    {
+        return false;
+    }
+
+    monotonicAfter = vuprs::HostMonotonic_ns();
+
+    /* NGF was read somewhere between the clock reads, take the midpoint (realtime moves with monotonic) */
+
+    reference->frameIndex = vuprs::UnwrapFrameCounter(lastFrameIndex, counter);
+    reference->hostMonotonic_ns = monotonicBefore + (monotonicAfter - monotonicBefore) / 2;
+    reference->hostRealtime_ns = realtime + (monotonicAfter - monotonicBefore) / 2;
+
+    return true;
+}
+
+bool vuprs::ReadADCSamplePeriod(vuprs::FPGAController *fpgaController, const vuprs::FPGAhardwareConfigADC &adcFeatures, double *samplePeriod_s)
+{
+    /* ------------------------ Security Check Start ------------------------- */
+
+    if (fpgaController == nullptr || samplePeriod_s == nullptr)
+    {
+        throw std::runtime_error("*FPGAController or *SamplePeriod is nullptr.");
+    }
+
+    /* ------------------------- Security Check End -------------------------- */
+
+    uint32_t sci = 0;
+
+    if (!fpgaController->AXILite_ReadFPGARegister(AXI_LITE_REGISTER__ADC__SCI, &sci))
+    {
+        return false;
+    }
+
+    *samplePeriod_s = vuprs::SamplePeriodFromSCI(sci, adcFeatures);
+
+    return true;
+}
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* -------------------------------------------- Clock Drift Estimator -------------------------------------------- */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+vuprs::ADCClockDriftEstimator::ADCClockDriftEstimator(const double &samplePeriod_s, const uint32_t &window)
+{
+    if (!(samplePeriod_s > 0) || !std::isfinite(samplePeriod_s))
+    {
+        throw std::runtime_error("Invalid sample period.");
+    }
+    if (window < 2)
+    {
+        throw std::runtime_error("Drift window must be >= 2 references.");
+    }
+
+    this->samplePeriod_s = samplePeriod_s;
+    this->forgetting = 1.0 - 1.0 / window;
+
+    this->Reset();
+}
+
+vuprs::ADCClockDriftEstimator::~ADCClockDriftEstimator()
+{
+
+}
+
+void vuprs::ADCClockDriftEstimator::Reset()
+{
+    this->origin = vuprs::ADCTimeReference();
+    this->span_ns = 0;
+    this->references = 0;
+
+    this->weight = 0;
+    this->meanFrames = 0;
+    this->meanTime_ns = 0;
+    this->covariance = 0;
+    this->variance = 0;
+}
+
+void vuprs::ADCClockDriftEstimator::AddReference(const vuprs::ADCTimeReference &reference)
+{
+    if (this->references == 0)
+    {
+        this->origin = reference;
+    }
+
+    /* Relative to the first reference, weighted Welford update of means & co-moments */
+
+    const double frames = static_cast<double>(static_cast<int64_t>(reference.frameIndex - this->origin.frameIndex));
+    const double time_ns = static_cast<double>(reference.hostMonotonic_ns - this->origin.hostMonotonic_ns);
+    double deltaFrames = 0;
+
+    this->weight = this->forgetting * this->weight + 1.0;
+
+    deltaFrames = frames - this->meanFrames;
+    this->meanFrames += deltaFrames / this->weight;
+    this->meanTime_ns += (time_ns - this->meanTime_ns) / this->weight;
+
+    this->covariance = this->forgetting * this->covariance + deltaFrames * (time_ns - this->meanTime_ns);
+    this->variance = this->forgetting * this->variance + deltaFrames * (frames - this->meanFrames);
+
+    this->span_ns = reference.hostMonotonic_ns - this->origin.hostMonotonic_ns;
+    this->references++;
+}
+
+uint64_t vuprs::ADCClockDriftEstimator::References() const
+{
+    return this->references;
+}
+
+double vuprs::ADCClockDriftEstimator::ClockRatio() const
+{
+    if (this->references < 2 || !(this->variance > 0) || this->span_ns < ADC_TIME_DRIFT_MIN_SPAN_S * ADC_TIME_NS_PER_S)
+    {
+        return 1.0;
+    }
+
+    /* Slope: host ns per frame */
+
+    return this->covariance / this->variance / (this->samplePeriod_s * ADC_TIME_NS_PER_S);
+}
+
+double vuprs::ADCClockDriftEstimator::Drift_ppm() const
+{
+    return (this->ClockRatio() - 1.0) * 1e6;
+}
+
+vuprs::ADCTimeDescriptor vuprs::ADCClockDriftEstimator::Descriptor(const uint64_t &firstFrameIndex, const vuprs::ADCTimeReference &reference) const
+{
+    vuprs::ADCTimeDescriptor descriptor;
+
+    descriptor.firstFrameIndex = firstFrameIndex;
+    descriptor.samplePeriod_s = this->samplePeriod_s;
+    descriptor.clockRatio = this->ClockRatio();
+    descriptor.reference = reference;
+
+    return descriptor;
+}
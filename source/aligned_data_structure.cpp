@@ -1,10 +1,15 @@
 #include "aligned_data_structure.h"
+#include "metrics_registry.h"
+#include "trace_recorder.h"
+#include "adc_time.h"
+
+static const vuprs::MetricsIOSeries AlignedData__WriterMetrics("vuprs_writer", "file writes", {{"writer", "buffer-file"}});
 
 /* --------------------------------------------------------------------------------------------------------------- */
 /* ---------------------------------------- Aligned Data Structure ----------------------------------------------- */
 /* --------------------------------------------------------------------------------------------------------------- */
 
-vuprs::AlignedBufferDMA::AlignedBufferDMA(uint64_t byteSize)
+vuprs::AlignedBufferDMA::AlignedBufferDMA(uint64_t byteSize) : byteSize(0), byteCapacity(0), allocated(nullptr)
 {
     if (!this->malloc(byteSize))
     {
@@ -109,9 +114,11 @@ bool vuprs::AlignedBufferDMA::to_file(const std::string &fileName, const uint64_
         throw std::runtime_error("Empty filename.");
     }
 
+
     int file_fd = -1;
     ssize_t currentWriteBytes = 0, seekPosition = -1;
     uint64_t targetWriteBytes = std::min(this->byteSize, writeBytes);
+    int64_t writeStart_ns = 0;
 
     /* Open file */
 
@@ -138,7 +145,11 @@ bool vuprs::AlignedBufferDMA::to_file(const std::string &fileName, const uint64_
         return false;
     }
 
+    VUPRS_TRACE_SPAN_VALUE("write.buffer-file", targetWriteBytes);
+
+    writeStart_ns = vuprs::HostMonotonic_ns();
     currentWriteBytes = write(file_fd, this->allocated, targetWriteBytes);
+    AlignedData__WriterMetrics.Count(targetWriteBytes, targetWriteBytes == static_cast<uint64_t>(currentWriteBytes), vuprs::HostMonotonic_ns() - writeStart_ns);
 
     if (targetWriteBytes != static_cast<uint64_t>(currentWriteBytes))
     {
@@ -0,0 +1,152 @@
+#include "cpu_dispatch.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <mutex>
+
+#if defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+/* Missing in old kernel headers */
+
+#if defined(__aarch64__)
+#ifndef HWCAP_ASIMD
+#define HWCAP_ASIMD                      (1 << 1)
+#endif
+#ifndef HWCAP_CRC32
+#define HWCAP_CRC32                      (1 << 7)
+#endif
+#ifndef HWCAP_ASIMDDP
+#define HWCAP_ASIMDDP                    (1 << 20)
+#endif
+#endif
+
+static uint64_t CPUDispatch__Detect()
+{
+    uint64_t features = 0;
+
+#if defined(__x86_64__) || defined(__i386__)
+
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("sse2")) features |= CPU_FEATURE__SSE2;
+    if (__builtin_cpu_supports("ssse3")) features |= CPU_FEATURE__SSSE3;
+    if (__builtin_cpu_supports("sse4.1")) features |= CPU_FEATURE__SSE4_1;
+    if (__builtin_cpu_supports("sse4.2")) features |= CPU_FEATURE__SSE4_2;
+    if (__builtin_cpu_supports("avx2")) features |= CPU_FEATURE__AVX2;
+    if (__builtin_cpu_supports("avx512f")) features |= CPU_FEATURE__AVX512F;
+    if (__builtin_cpu_supports("avx512bw")) features |= CPU_FEATURE__AVX512BW;
+
+#elif defined(__aarch64__) && defined(__linux__)
+
+    unsigned long hwcap = getauxval(AT_HWCAP);
+
+    if (hwcap & HWCAP_ASIMD) features |= CPU_FEATURE__ASIMD;
+    if (hwcap & HWCAP_ASIMDDP) features |= CPU_FEATURE__ASIMDDP;
+    if (hwcap & HWCAP_CRC32) features |= CPU_FEATURE__ARM_CRC32;
+
+#endif
+
+    return features;
+}
+
+uint64_t vuprs::DetectCPUFeatures()
+{
+    static const uint64_t features = CPUDispatch__Detect();
+    return features;
+}
+
+bool vuprs::CPUForceScalar()
+{
+    static const bool forceScalar = []()
+    {
+        const char *value = getenv(CPU_DISPATCH_FORCE_SCALAR_ENV);
+        return value != nullptr && value[0] != '\0' && strcmp(value, "0") != 0;
+    }();
+
+    return forceScalar;
+}
+
+std::string vuprs::CPUFeaturesString(const uint64_t &features)
+{
+    static const std::pair<uint64_t, const char*> FEATURE_NAMES[] = {
+        {CPU_FEATURE__SSE2, "sse2"}, {CPU_FEATURE__SSSE3, "ssse3"}, {CPU_FEATURE__SSE4_1, "sse4.1"},
+        {CPU_FEATURE__SSE4_2, "sse4.2"}, {CPU_FEATURE__AVX2, "avx2"}, {CPU_FEATURE__AVX512F, "avx512f"},
+        {CPU_FEATURE__AVX512BW, "avx512bw"}, {CPU_FEATURE__ASIMD, "asimd"}, {CPU_FEATURE__ASIMDDP, "asimddp"},
+        {CPU_FEATURE__ARM_CRC32, "crc32"}
+    };
+
+    std::string featuresString;
+
+    for (const std::pair<uint64_t, const char*> &feature : FEATURE_NAMES)
+    {
+        if (features & feature.first)
+        {
+            if (!featuresString.empty()) featuresString += " ";
+            featuresString += feature.second;
+        }
+    }
+
+    return featuresString.empty() ? std::string("none") : featuresString;
+}
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* ------------------------------------------------- Registry ---------------------------------------------------- */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+typedef struct CPUDispatch__Registry
+{
+    std::mutex lock;
+    std::vector<std::pair<std::string, std::string>> kernels;
+};
+
+static CPUDispatch__Registry &CPUDispatch__GetRegistry()
+{
+    static CPUDispatch__Registry registry;
+    return registry;
+}
+
+void vuprs::RegisterCPUKernel(const std::string &kernelName, const std::string &variantName)
+{
+    CPUDispatch__Registry &registry = CPUDispatch__GetRegistry();
+    std::lock_guard<std::mutex> guard(registry.lock);
+
+    for (std::pair<std::string, std::string> &kernel : registry.kernels)
+    {
+        if (kernel.first == kernelName)
+        {
+            kernel.second = variantName;
+            return;
+        }
+    }
+
+    registry.kernels.emplace_back(kernelName, variantName);
+}
+
+std::vector<std::pair<std::string, std::string>> vuprs::ActiveCPUKernels()
+{
+    CPUDispatch__Registry &registry = CPUDispatch__GetRegistry();
+    std::lock_guard<std::mutex> guard(registry.lock);
+
+    return registry.kernels;
+}
+
+std::string vuprs::CPUDispatchReport()
+{
+    std::string report = "cpu features: " + vuprs::CPUFeaturesString(vuprs::DetectCPUFeatures());
+
+    if (vuprs::CPUForceScalar())
+    {
+        report += " (" CPU_DISPATCH_FORCE_SCALAR_ENV ")";
+    }
+    report += "\n";
+
+    for (const std::pair<std::string, std::string> &kernel : vuprs::ActiveCPUKernels())
+    {
+        report += kernel.first + ": " + kernel.second + "\n";
+    }
+
+    return report;
+}
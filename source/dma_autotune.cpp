@@ -0,0 +1,278 @@
+#include "dma_autotune.h"
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* ----------------------------------------------- DMA Auto Tuner ------------------------------------------------ */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+vuprs::DMAAutoTuner::DMAAutoTuner(vuprs::FPGAController *fpgaController)
+{
+    if (fpgaController == nullptr)
+    {
+        throw std::runtime_error("*FPGAController is nullptr.");
+    }
+    if (!fpgaController->GetFPGAConfig().ConfigDown())
+    {
+        throw std::runtime_error("Config not complete.");
+    }
+
+    this->fpgaController = fpgaController;
+    this->tunerConfig = vuprs::DMAAutoTuner::DefaultTunerConfig(fpgaController->GetFPGAConfig());
+}
+
+vuprs::DMAAutoTuner::~DMAAutoTuner()
+{
+
+}
+
+vuprs::DMATunerConfig vuprs::DMAAutoTuner::DefaultTunerConfig(const vuprs::FPGAConfigManager &configManager)
+{
+    vuprs::DMATunerConfig config;
+    uint64_t ddrCapacityBytes = configManager.fpgaConfig.hardwareConfig.hardwareConfigDDR.ddrMemoryCapacity_megabytes * 1024 * 1024;
+
+    config.scratchByteSize = std::min(static_cast<uint64_t>(DMA_AUTOTUNE_DEFAULT_SCRATCH_BYTES), ddrCapacityBytes);
+    config.scratchDdrOffset = ddrCapacityBytes - config.scratchByteSize;
+    config.measureDuration_ms = DMA_AUTOTUNE_DEFAULT_MEASURE_MS;
+
+    config.chunkSizes = {4096, 16384, 65536, 262144, 1048576, 4194304};
+
+    return config;
+}
+
+std::string vuprs::DMAAutoTuner::CacheKey(const vuprs::FPGAController &fpgaController)
+{
+    const vuprs::FPGAConfigManager &configManager = fpgaController.GetFPGAConfig();
+    struct utsname systemName;
+    std::string kernelRelease = "unknown", device = "unknown";
+
+    if (uname(&systemName) == 0)
+    {
+        kernelRelease = std::string(systemName.release) + "-" + std::string(systemName.machine);
+    }
+    if (!configManager.fpgaConfig.xdmaDriverConfig.deviceFilename_xdma_c2h.empty())
+    {
+        device = configManager.fpgaConfig.xdmaDriverConfig.deviceFilename_xdma_c2h[0];
+    }
+
+    /* Transport first: a simulated card uses the same device names as the board */
+
+    return fpgaController.TransportName() + "|" + kernelRelease + "|" + device + "|" + std::to_string(__XDMA_DMA_ALIGNMENT_BYTES__);
+}
+
+void vuprs::DMAAutoTuner::SetTunerConfig(const vuprs::DMATunerConfig &config)
+{
+    this->tunerConfig = config;
+}
+
+double vuprs::DMAAutoTuner::MeasurePoint(const uint64_t &chunkSize)
+{
+    const uint64_t slots = this->tunerConfig.scratchByteSize / chunkSize;
+
+    vuprs::AlignedBufferDMA buffer(chunkSize);
+    vuprs::DMATransferConfig transferConfig;
+    uint64_t transferredBytes = 0, slot = 0;
+    std::chrono::steady_clock::time_point startTime, stopTime;
+
+    transferConfig.transferDmaChannel = 0;
+    transferConfig.transferByteSize = chunkSize;
+    transferConfig.transferDirectionSelection = DMA_TRANSFER_DIRECTION__FPGA_TO_HOST;
+
+    startTime = std::chrono::steady_clock::now();
+    stopTime = startTime + std::chrono::milliseconds(this->tunerConfig.measureDuration_ms);
+
+    /* Back-to-back transfers through the scratch region */
+
+    try
+    {
+        while (std::chrono::steady_clock::now() < stopTime)
+        {
+            transferConfig.ddrOffset = this->tunerConfig.scratchDdrOffset + (slot % slots) * chunkSize;
+
+            if (!this->fpgaController->AXIFull_IO(transferConfig, buffer.data()))
+            {
+                return 0;
+            }
+
+            transferredBytes += chunkSize;
+            slot++;
+        }
+    }
+    catch (...)
+    {
+        return 0;
+    }
+
+    return static_cast<double>(transferredBytes) / std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+bool vuprs::DMAAutoTuner::Tune(vuprs::DMATuningResult *result, const std::function<void(const vuprs::DMATuningPoint&)> &progress)
+{
+    if (result == nullptr)
+    {
+        throw std::runtime_error("*Result is nullptr.");
+    }
+
+    const vuprs::FPGAConfigManager &configManager = this->fpgaController->GetFPGAConfig();
+    vuprs::DMATuningPoint point;
+
+    result->cacheKey = vuprs::DMAAutoTuner::CacheKey(*this->fpgaController);
+    result->sweep.clear();
+    result->best = vuprs::DMATuningPoint();
+    result->configdown = false;
+
+    for (uint64_t chunkSize : this->tunerConfig.chunkSizes)
+    {
+        if (chunkSize == 0 || chunkSize > this->tunerConfig.scratchByteSize || chunkSize % __XDMA_DMA_ALIGNMENT_BYTES__ != 0)
+        {
+            continue;
+        }
+
+        point.chunkSize = chunkSize;
+        point.throughput_bytesPerSecond = this->MeasurePoint(chunkSize);
+
+        result->sweep.push_back(point);
+
+        if (progress)
+        {
+            progress(point);
+        }
+
+        if (point.throughput_bytesPerSecond > result->best.throughput_bytesPerSecond)
+        {
+            result->best = point;
+            result->configdown = true;
+        }
+    }
+
+    return result->configdown;
+}
+
+bool vuprs::DMAAutoTuner::LoadOrTune(const std::string &cacheFilename, vuprs::DMATuningResult *result, bool *loadedFromCache, const std::function<void(const vuprs::DMATuningPoint&)> &progress)
+{
+    if (loadedFromCache != nullptr)
+    {
+        *loadedFromCache = false;
+    }
+
+    if (!cacheFilename.empty() &&
+        vuprs::LoadDMATuningCache(cacheFilename, vuprs::DMAAutoTuner::CacheKey(*this->fpgaController), result))
+    {
+        if (loadedFromCache != nullptr)
+        {
+            *loadedFromCache = true;
+        }
+        return true;
+    }
+
+    if (!this->Tune(result, progress))
+    {
+        return false;
+    }
+
+    if (!cacheFilename.empty())
+    {
+        vuprs::SaveDMATuningCache(cacheFilename, *result);
+    }
+
+    return true;
+}
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* ------------------------------------------------ Tuning Cache ------------------------------------------------- */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+bool vuprs::LoadDMATuningCache(const std::string &cacheFilename, const std::string &expectedKey, vuprs::DMATuningResult *result)
+{
+    if (result == nullptr)
+    {
+        return false;
+    }
+
+    std::ifstream cacheFile(cacheFilename);
+    nlohmann::json cacheJsonData;
+    bool parseStatus = false;
+    int successCount = 0;
+
+    if (!cacheFile.is_open())
+    {
+        return false;
+    }
+
+    try
+    {
+        cacheFile >> cacheJsonData;
+
+        if (!cacheJsonData.contains("cache-key") || cacheJsonData["cache-key"].get<std::string>() != expectedKey)
+        {
+            return false;
+        }
+
+        result->cacheKey = expectedKey;
+        result->sweep.clear();
+
+        if (cacheJsonData.contains("max-transfer-size-bytes"))
+        {
+            result->best.chunkSize = vuprs::ParseNumberFromString(cacheJsonData["max-transfer-size-bytes"].get<std::string>(), &parseStatus);
+            if (parseStatus) successCount++;
+        }
+        if (cacheJsonData.contains("throughput-bytes-per-second"))
+        {
+            result->best.throughput_bytesPerSecond = cacheJsonData["throughput-bytes-per-second"].get<double>();
+        }
+    }
+    catch (const std::exception &e)
+    {
+        return false;
+    }
+
+    result->configdown = (successCount == 1 && result->best.chunkSize != 0);
+
+    return result->configdown;
+}
+
+bool vuprs::SaveDMATuningCache(const std::string &cacheFilename, const vuprs::DMATuningResult &result)
+{
+    if (!result.configdown || cacheFilename.empty())
+    {
+        return false;
+    }
+
+    nlohmann::json cacheJsonData, sweepJsonData = nlohmann::json::array();
+    std::ofstream cacheFile(cacheFilename, std::ios::trunc);
+
+    if (!cacheFile.is_open())
+    {
+        return false;
+    }
+
+    /* Numbers are stored as strings, same as the config JSON */
+
+    cacheJsonData["description"] = "VUPRS DMA Tuning Cache";
+    cacheJsonData["cache-key"] = result.cacheKey;
+    cacheJsonData["max-transfer-size-bytes"] = std::to_string(result.best.chunkSize);
+    cacheJsonData["throughput-bytes-per-second"] = result.best.throughput_bytesPerSecond;
+
+    for (const vuprs::DMATuningPoint &point : result.sweep)
+    {
+        sweepJsonData.push_back({
+            {"chunk-bytes", point.chunkSize},
+            {"throughput-bytes-per-second", point.throughput_bytesPerSecond}
+        });
+    }
+    cacheJsonData["sweep"] = sweepJsonData;
+
+    cacheFile << cacheJsonData.dump(4) << std::endl;
+
+    return cacheFile.good();
+}
+
+bool vuprs::ApplyDMATuning(const vuprs::DMATuningResult &result, vuprs::FPGAConfigManager *configManager)
+{
+    if (configManager == nullptr || !result.configdown || !configManager->ConfigDown())
+    {
+        return false;
+    }
+
+    configManager->fpgaConfig.xdmaDriverConfig.maxTransferSize_bytes = result.best.chunkSize;
+
+    return true;
+}
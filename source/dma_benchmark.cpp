@@ -0,0 +1,323 @@
+#include "dma_benchmark.h"
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* ------------------------------------------------ DMA Benchmark ------------------------------------------------ */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+static double DMABenchmark__Percentile(const std::vector<uint64_t> &sortedLatency_ns, const double &quantile)
+{
+    if (sortedLatency_ns.empty())
+    {
+        return 0;
+    }
+
+    uint64_t index = static_cast<uint64_t>(quantile * (sortedLatency_ns.size() - 1) + 0.5);
+
+    return sortedLatency_ns[std::min(index, static_cast<uint64_t>(sortedLatency_ns.size() - 1))] / 1e3;
+}
+
+static double DMABenchmark__TimevalSeconds(const struct timeval &tv)
+{
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+vuprs::DMABenchmark::DMABenchmark(vuprs::FPGAController *fpgaController)
+{
+    if (fpgaController == nullptr)
+    {
+        throw std::runtime_error("*FPGAController is nullptr.");
+    }
+    if (!fpgaController->GetFPGAConfig().ConfigDown())
+    {
+        throw std::runtime_error("Config not complete.");
+    }
+
+    this->fpgaController = fpgaController;
+    this->benchmarkConfig = vuprs::DMABenchmark::DefaultBenchmarkConfig(fpgaController->GetFPGAConfig());
+}
+
+vuprs::DMABenchmark::~DMABenchmark()
+{
+
+}
+
+vuprs::DMABenchmarkConfig vuprs::DMABenchmark::DefaultBenchmarkConfig(const vuprs::FPGAConfigManager &configManager)
+{
+    vuprs::DMABenchmarkConfig config;
+    uint64_t ddrCapacityBytes = configManager.fpgaConfig.hardwareConfig.hardwareConfigDDR.ddrMemoryCapacity_megabytes * 1024 * 1024;
+    uint64_t channelCount = std::min(configManager.fpgaConfig.xdmaDriverConfig.deviceFilename_xdma_c2h.size(),
+                                     configManager.fpgaConfig.xdmaDriverConfig.deviceFilename_xdma_h2c.size());
+
+    config.scratchByteSize = std::min(static_cast<uint64_t>(DMA_BENCHMARK_DEFAULT_SCRATCH_BYTES), ddrCapacityBytes);
+    config.scratchDdrOffset = ddrCapacityBytes - config.scratchByteSize;
+    config.duration_ms = DMA_BENCHMARK_DEFAULT_DURATION_MS;
+
+    config.modes = {DMA_BENCHMARK_MODE__C2H, DMA_BENCHMARK_MODE__H2C, DMA_BENCHMARK_MODE__LOOPBACK};
+    config.transferSizes = {4096, 16384, 65536, 262144, 1048576, 4194304};
+
+    for (uint64_t i = 1; i <= channelCount; i++)
+    {
+        config.channelCounts.push_back(i);
+    }
+
+    return config;
+}
+
+void vuprs::DMABenchmark::SetBenchmarkConfig(const vuprs::DMABenchmarkConfig &config)
+{
+    this->benchmarkConfig = config;
+}
+
+vuprs::DMABenchmarkPoint vuprs::DMABenchmark::MeasurePoint(const uint8_t &mode, const uint64_t &transferSize, const uint64_t &channels)
+{
+    /* Every worker owns a slice of the scratch region, so loopback data of different workers never overlaps */
+
+    const uint64_t sliceBytes = (this->benchmarkConfig.scratchByteSize / channels) / transferSize * transferSize;
+
+    vuprs::DMABenchmarkPoint point = vuprs::DMABenchmarkPoint();
+    std::vector<std::thread> workers;
+    std::vector<std::vector<uint64_t>> workerLatency_ns(channels);
+    std::atomic<uint64_t> verifyErrors(0);
+    std::atomic<bool> transferFailed(false);
+    std::chrono::steady_clock::time_point startTime, stopTime;
+    struct rusage usageStart, usageStop;
+    std::vector<uint64_t> latency_ns;
+
+    point.mode = mode;
+    point.transferSize = transferSize;
+    point.channels = channels;
+
+    getrusage(RUSAGE_SELF, &usageStart);
+    startTime = std::chrono::steady_clock::now();
+    stopTime = startTime + std::chrono::milliseconds(this->benchmarkConfig.duration_ms);
+
+    for (uint64_t w = 0; w < channels; w++)
+    {
+        workers.emplace_back([&, w]()
+        {
+            vuprs::AlignedBufferDMA writeBuffer(transferSize), readBuffer(transferSize);
+            vuprs::DMATransferConfig writeConfig, readConfig;
+            std::vector<uint64_t> &latency = workerLatency_ns[w];
+            std::chrono::steady_clock::time_point transferStart;
+            uint64_t sliceOffset = 0, iteration = 0;
+            uint32_t *pattern = reinterpret_cast<uint32_t*>(writeBuffer.data());
+
+            writeConfig.transferDmaChannel = static_cast<uint8_t>(w);
+            writeConfig.transferByteSize = transferSize;
+            writeConfig.transferDirectionSelection = DMA_TRANSFER_DIRECTION__HOST_TO_FPGA;
+
+            readConfig = writeConfig;
+            readConfig.transferDirectionSelection = DMA_TRANSFER_DIRECTION__FPGA_TO_HOST;
+
+            memset(writeBuffer.data(), 0x5A, transferSize);
+            latency.reserve(4096);
+
+            try
+            {
+                while (std::chrono::steady_clock::now() < stopTime && !transferFailed.load())
+                {
+                    writeConfig.ddrOffset = this->benchmarkConfig.scratchDdrOffset + w * sliceBytes + sliceOffset;
+                    readConfig.ddrOffset = writeConfig.ddrOffset;
+
+                    if (mode == DMA_BENCHMARK_MODE__LOOPBACK)
+                    {
+                        /* New pattern every round trip, stale DDR content cannot pass (not timed) */
+
+                        for (uint64_t i = 0; i < transferSize / sizeof(uint32_t); i++)
+                        {
+                            pattern[i] = static_cast<uint32_t>((iteration * 0x9E3779B9UL) ^ (w << 28) ^ i);
+                        }
+                    }
+
+                    transferStart = std::chrono::steady_clock::now();
+
+                    if (mode != DMA_BENCHMARK_MODE__C2H && !this->fpgaController->AXIFull_IO(writeConfig, writeBuffer.data()))
+                    {
+                        transferFailed.store(true);
+                        break;
+                    }
+                    if (mode != DMA_BENCHMARK_MODE__H2C && !this->fpgaController->AXIFull_IO(readConfig, readBuffer.data()))
+                    {
+                        transferFailed.store(true);
+                        break;
+                    }
+
+                    latency.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - transferStart).count());
+
+                    if (mode == DMA_BENCHMARK_MODE__LOOPBACK && memcmp(writeBuffer.data(), readBuffer.data(), transferSize) != 0)
+                    {
+                        verifyErrors.fetch_add(1);
+                    }
+
+                    sliceOffset = (sliceOffset + transferSize) % sliceBytes;
+                    iteration++;
+                }
+            }
+            catch (...)
+            {
+                transferFailed.store(true);
+            }
+        });
+    }
+
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        workers[i].join();
+    }
+
+    point.elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    getrusage(RUSAGE_SELF, &usageStop);
+
+    /* Statistic */
+
+    for (uint64_t w = 0; w < channels; w++)
+    {
+        latency_ns.insert(latency_ns.end(), workerLatency_ns[w].begin(), workerLatency_ns[w].end());
+    }
+    std::sort(latency_ns.begin(), latency_ns.end());
+
+    point.transfers = latency_ns.size();
+    point.verifyErrors = verifyErrors.load();
+    point.throughput_bytesPerSecond = point.elapsed_s > 0 ? point.transfers * transferSize / point.elapsed_s : 0;
+
+    point.latencyP50_us = DMABenchmark__Percentile(latency_ns, 0.50);
+    point.latencyP99_us = DMABenchmark__Percentile(latency_ns, 0.99);
+    point.latencyP999_us = DMABenchmark__Percentile(latency_ns, 0.999);
+    point.latencyMax_us = latency_ns.empty() ? 0 : latency_ns.back() / 1e3;
+
+    if (point.elapsed_s > 0)
+    {
+        point.cpuUser_percent = 100.0 * (DMABenchmark__TimevalSeconds(usageStop.ru_utime) - DMABenchmark__TimevalSeconds(usageStart.ru_utime)) / point.elapsed_s;
+        point.cpuSystem_percent = 100.0 * (DMABenchmark__TimevalSeconds(usageStop.ru_stime) - DMABenchmark__TimevalSeconds(usageStart.ru_stime)) / point.elapsed_s;
+    }
+
+    point.success = !transferFailed.load() && point.transfers > 0 && point.verifyErrors == 0;
+
+    return point;
+}
+
+bool vuprs::DMABenchmark::Run(vuprs::DMABenchmarkReport *report, const std::function<void(const vuprs::DMABenchmarkPoint&)> &progress)
+{
+    if (report == nullptr)
+    {
+        throw std::runtime_error("*Report is nullptr.");
+    }
+
+    const vuprs::FPGAConfigManager &configManager = this->fpgaController->GetFPGAConfig();
+    const uint64_t channelLimit = std::min(configManager.fpgaConfig.xdmaDriverConfig.deviceFilename_xdma_c2h.size(),
+                                           configManager.fpgaConfig.xdmaDriverConfig.deviceFilename_xdma_h2c.size());
+    struct utsname systemName;
+    vuprs::DMABenchmarkPoint point;
+    bool allSuccess = true;
+
+    report->kernelRelease = "unknown";
+    report->machine = "unknown";
+    report->deviceC2H = configManager.fpgaConfig.xdmaDriverConfig.deviceFilename_xdma_c2h.empty() ? "" : configManager.fpgaConfig.xdmaDriverConfig.deviceFilename_xdma_c2h[0];
+    report->deviceH2C = configManager.fpgaConfig.xdmaDriverConfig.deviceFilename_xdma_h2c.empty() ? "" : configManager.fpgaConfig.xdmaDriverConfig.deviceFilename_xdma_h2c[0];
+    report->points.clear();
+
+    if (uname(&systemName) == 0)
+    {
+        report->kernelRelease = systemName.release;
+        report->machine = systemName.machine;
+    }
+
+    for (uint8_t mode : this->benchmarkConfig.modes)
+    {
+        if (!IS_DMA_BENCHMARK_MODE(mode))
+        {
+            continue;
+        }
+
+        for (uint64_t transferSize : this->benchmarkConfig.transferSizes)
+        {
+            if (transferSize == 0 || transferSize % __XDMA_DMA_ALIGNMENT_BYTES__ != 0)
+            {
+                continue;
+            }
+
+            for (uint64_t channels : this->benchmarkConfig.channelCounts)
+            {
+                if (channels == 0 || channels > channelLimit || transferSize * channels > this->benchmarkConfig.scratchByteSize)
+                {
+                    continue;
+                }
+
+                point = this->MeasurePoint(mode, transferSize, channels);
+                report->points.push_back(point);
+
+                if (progress)
+                {
+                    progress(point);
+                }
+
+                allSuccess = allSuccess && point.success;
+            }
+        }
+    }
+
+    return allSuccess && !report->points.empty();
+}
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* ---------------------------------------------------- Report --------------------------------------------------- */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+const char *vuprs::DMABenchmarkModeName(const uint8_t &mode)
+{
+    switch (mode)
+    {
+        case DMA_BENCHMARK_MODE__C2H: return "c2h";
+        case DMA_BENCHMARK_MODE__H2C: return "h2c";
+        case DMA_BENCHMARK_MODE__LOOPBACK: return "loopback";
+        default: return "unknown";
+    }
+}
+
+bool vuprs::SaveDMABenchmarkReport(const std::string &reportFilename, const vuprs::DMABenchmarkReport &report)
+{
+    if (reportFilename.empty())
+    {
+        return false;
+    }
+
+    nlohmann::json reportJsonData, pointsJsonData = nlohmann::json::array();
+    std::ofstream reportFile(reportFilename, std::ios::trunc);
+
+    if (!reportFile.is_open())
+    {
+        return false;
+    }
+
+    reportJsonData["description"] = "VUPRS DMA Benchmark Report";
+    reportJsonData["kernel-release"] = report.kernelRelease;
+    reportJsonData["machine"] = report.machine;
+    reportJsonData["xdma-c2h"] = report.deviceC2H;
+    reportJsonData["xdma-h2c"] = report.deviceH2C;
+    reportJsonData["dma-alignment-bytes"] = __XDMA_DMA_ALIGNMENT_BYTES__;
+
+    for (const vuprs::DMABenchmarkPoint &point : report.points)
+    {
+        pointsJsonData.push_back({
+            {"mode", vuprs::DMABenchmarkModeName(point.mode)},
+            {"transfer-bytes", point.transferSize},
+            {"channels", point.channels},
+            {"transfers", point.transfers},
+            {"verify-errors", point.verifyErrors},
+            {"elapsed-s", point.elapsed_s},
+            {"throughput-bytes-per-second", point.throughput_bytesPerSecond},
+            {"latency-p50-us", point.latencyP50_us},
+            {"latency-p99-us", point.latencyP99_us},
+            {"latency-p999-us", point.latencyP999_us},
+            {"latency-max-us", point.latencyMax_us},
+            {"cpu-user-percent", point.cpuUser_percent},
+            {"cpu-system-percent", point.cpuSystem_percent},
+            {"success", point.success}
+        });
+    }
+    reportJsonData["points"] = pointsJsonData;
+
+    reportFile << reportJsonData.dump(4) << std::endl;
+
+    return reportFile.good();
+}
@@ -0,0 +1,256 @@
+#include "dma_capture_recorder.h"
+#include "metrics_registry.h"
+#include "trace_recorder.h"
+#include "adc_time.h"
+
+#include <cerrno>
+
+static const vuprs::MetricsIOSeries DMACaptureRecorder__WriterMetrics("vuprs_writer", "file writes", {{"writer", "capture-recorder"}});
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* ------------------------------------------- DMA Capture Recorder ---------------------------------------------- */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief Reserve blocks in advance, page faults in the mapped window will not allocate on the fly. Filesystems
+ *        without fallocate() (EOPNOTSUPP: tmpfs of old kernels, NFS...) fall back to posix_fallocate() (glibc
+ *        writes one byte per block), and to a sparse ftruncate() when that fails too.
+ */
+static bool DMACaptureRecorder__Reserve(const int &file_fd, const uint64_t &byteSize)
+{
+    if (fallocate(file_fd, 0, 0, byteSize) == 0)
+    {
+        return true;
+    }
+    if (errno != EOPNOTSUPP)
+    {
+        return false;
+    }
+    if (posix_fallocate(file_fd, 0, byteSize) == 0)
+    {
+        return true;
+    }
+
+    return ftruncate(file_fd, byteSize) == 0;
+}
+
+vuprs::DMACaptureRecorder::DMACaptureRecorder(vuprs::FPGAController *fpgaController)
+{
+    if (fpgaController == nullptr)
+    {
+        throw std::runtime_error("*FPGAController is nullptr.");
+    }
+
+    this->fpgaController = fpgaController;
+    this->recorderConfig = vuprs::CaptureRecorderConfig();
+    this->file_fd = -1;
+    this->window = nullptr;
+    this->windowFileOffset = 0;
+    this->windowBytes = 0;
+    this->recordedBytes = 0;
+    this->flushedBytes = 0;
+}
+
+vuprs::DMACaptureRecorder::~DMACaptureRecorder()
+{
+    this->Close();
+}
+
+bool vuprs::DMACaptureRecorder::Open(const vuprs::CaptureRecorderConfig &config)
+{
+    /* ------------------------ Security Check Start ------------------------- */
+
+    if (config.captureFilename.empty())
+    {
+        throw std::runtime_error("Empty filename.");
+    }
+    if (config.captureByteSize == 0)
+    {
+        throw std::runtime_error("Capture bytes is 0.");
+    }
+    if (config.windowByteSize == 0 || config.windowByteSize % __XDMA_DMA_ALIGNMENT_BYTES__ != 0 ||
+        config.windowByteSize % static_cast<uint64_t>(sysconf(_SC_PAGESIZE)) != 0)
+    {
+        throw std::runtime_error("Window bytes must be a multiple of the page size and DMA alignment.");
+    }
+
+    /* ------------------------- Security Check End -------------------------- */
+
+    this->Close();
+
+    this->file_fd = open(config.captureFilename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+
+    if (this->file_fd < 0)
+    {
+        return false;
+    }
+
+    if (!DMACaptureRecorder__Reserve(this->file_fd, config.captureByteSize))
+    {
+        close(this->file_fd);
+        this->file_fd = -1;
+        return false;
+    }
+
+    this->recorderConfig = config;
+    this->recordedBytes = 0;
+    this->flushedBytes = 0;
+
+    return true;
+}
+
+bool vuprs::DMACaptureRecorder::MapWindow(const uint64_t &fileOffset, const uint64_t &minimumBytes)
+{
+    uint64_t alignedOffset = fileOffset - (fileOffset % this->recorderConfig.windowByteSize);
+    uint64_t mapBytes = this->recorderConfig.windowByteSize;
+    void *mapBase = MAP_FAILED;
+
+    /* A block larger than one window gets a larger window */
+
+    while (alignedOffset + mapBytes < fileOffset + minimumBytes)
+    {
+        mapBytes += this->recorderConfig.windowByteSize;
+    }
+    if (alignedOffset + mapBytes > this->recorderConfig.captureByteSize)
+    {
+        mapBytes = this->recorderConfig.captureByteSize - alignedOffset;
+    }
+
+    this->UnmapWindow();
+
+    mapBase = mmap(nullptr, mapBytes, PROT_READ | PROT_WRITE, MAP_SHARED, this->file_fd, alignedOffset);
+
+    if (mapBase == MAP_FAILED)
+    {
+        return false;
+    }
+
+    this->window = reinterpret_cast<uint8_t*>(mapBase);
+    this->windowFileOffset = alignedOffset;
+    this->windowBytes = mapBytes;
+
+    return true;
+}
+
+void vuprs::DMACaptureRecorder::UnmapWindow()
+{
+    if (this->window == nullptr)
+    {
+        return;
+    }
+
+    /*
+        Writeback of the leaving window was started block by block, wait for it here so that
+        the dirty page cache is bounded by about one window.
+    */
+    if (this->recordedBytes > this->flushedBytes)
+    {
+        sync_file_range(this->file_fd, this->flushedBytes, this->recordedBytes - this->flushedBytes,
+                        SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+        this->flushedBytes = this->recordedBytes;
+    }
+
+    munmap(this->window, this->windowBytes);
+
+    this->window = nullptr;
+    this->windowFileOffset = 0;
+    this->windowBytes = 0;
+}
+
+bool vuprs::DMACaptureRecorder::Record(const uint64_t &ddrOffset, const uint64_t &transferBytes)
+{
+    if (this->file_fd < 0)
+    {
+        throw std::runtime_error("Capture file not open.");
+    }
+    if (transferBytes == 0)
+    {
+        throw std::runtime_error("Transfer bytes is 0.");
+    }
+    if (this->recordedBytes % __XDMA_DMA_ALIGNMENT_BYTES__ != 0)
+    {
+        throw std::runtime_error("Previous block is not aligned, only the last block can be unaligned.");
+    }
+    if (this->recordedBytes + transferBytes > this->recorderConfig.captureByteSize)
+    {
+        return false;
+    }
+
+
+    vuprs::DMATransferConfig transferConfig;
+    uint64_t fileOffset = this->recordedBytes;
+    const int64_t start_ns = vuprs::HostMonotonic_ns();
+
+    VUPRS_TRACE_SPAN_VALUE("write.capture-recorder", transferBytes);  /* The C2H transfer (dma.c2h) is nested */
+
+    /* Slide window */
+
+    if (this->window == nullptr || fileOffset < this->windowFileOffset ||
+        fileOffset + transferBytes > this->windowFileOffset + this->windowBytes)
+    {
+        if (!this->MapWindow(fileOffset, transferBytes))
+        {
+            DMACaptureRecorder__WriterMetrics.Count(transferBytes, false, vuprs::HostMonotonic_ns() - start_ns);
+            return false;
+        }
+    }
+
+    /* DMA straight into the file pages */
+
+    transferConfig.transferDmaChannel = this->recorderConfig.dmaChannel;
+    transferConfig.ddrOffset = ddrOffset;
+    transferConfig.transferByteSize = transferBytes;
+    transferConfig.transferDirectionSelection = DMA_TRANSFER_DIRECTION__FPGA_TO_HOST;
+
+    if (!this->fpgaController->AXIFull_IO(transferConfig, reinterpret_cast<void*>(this->window + (fileOffset - this->windowFileOffset))))
+    {
+        DMACaptureRecorder__WriterMetrics.Count(transferBytes, false, vuprs::HostMonotonic_ns() - start_ns);
+        return false;
+    }
+
+    this->recordedBytes += transferBytes;
+
+    /* Start writeback of the dirty range, do not wait */
+
+    sync_file_range(this->file_fd, fileOffset, transferBytes, SYNC_FILE_RANGE_WRITE);
+    DMACaptureRecorder__WriterMetrics.Count(transferBytes, true, vuprs::HostMonotonic_ns() - start_ns);
+
+    return true;
+}
+
+bool vuprs::DMACaptureRecorder::Close()
+{
+    bool closeSuccess = true;
+
+    if (this->file_fd < 0)
+    {
+        return true;
+    }
+
+    this->UnmapWindow();
+
+    /* Drop the unused preallocated tail */
+
+    if (ftruncate(this->file_fd, this->recordedBytes) != 0)
+    {
+        closeSuccess = false;
+    }
+    if (close(this->file_fd) < 0)
+    {
+        closeSuccess = false;
+    }
+
+    this->file_fd = -1;
+
+    return closeSuccess;
+}
+
+bool vuprs::DMACaptureRecorder::IsOpen() const
+{
+    return this->file_fd >= 0;
+}
+
+uint64_t vuprs::DMACaptureRecorder::RecordedBytes() const
+{
+    return this->recordedBytes;
+}
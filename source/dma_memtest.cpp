@@ -0,0 +1,485 @@
+#include "dma_memtest.h"
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* --------------------------------------------------- Patterns -------------------------------------------------- */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+const char *vuprs::DMAMemTestPatternName(const uint8_t &pattern)
+{
+    switch (pattern)
+    {
+        case DMA_MEMTEST_PATTERN__WALKING_ONES: return "walking-ones";
+        case DMA_MEMTEST_PATTERN__ADDRESS: return "address";
+        case DMA_MEMTEST_PATTERN__PRBS: return "prbs";
+        default: return "unknown";
+    }
+}
+
+void vuprs::DMAMemTestFillPattern(const uint8_t &pattern, const uint64_t &ddrAddress, uint32_t *words, const uint64_t &wordCount)
+{
+    const uint64_t pageWords = DMA_MEMTEST_PAGE_BYTES / sizeof(uint32_t);
+    const uint64_t firstWord = ddrAddress / sizeof(uint32_t);
+    uint32_t state = 0;
+
+    switch (pattern)
+    {
+        case DMA_MEMTEST_PATTERN__WALKING_ONES:
+        {
+            for (uint64_t i = 0; i < wordCount; i++)
+            {
+                words[i] = 1U << ((firstWord + i) & 31U);
+            }
+            break;
+        }
+        case DMA_MEMTEST_PATTERN__ADDRESS:
+        {
+            for (uint64_t i = 0; i < wordCount; i++)
+            {
+                words[i] = static_cast<uint32_t>(ddrAddress + i * sizeof(uint32_t));
+            }
+            break;
+        }
+        case DMA_MEMTEST_PATTERN__PRBS:
+        {
+            /* Reseed every page from its address, so any page can be regenerated on its own */
+
+            for (uint64_t i = 0; i < wordCount; i++)
+            {
+                if (i % pageWords == 0)
+                {
+                    state = static_cast<uint32_t>(((firstWord + i) / pageWords + 1) * 0x9E3779B9UL) | 1U;
+                }
+
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+                words[i] = state;
+            }
+            break;
+        }
+        default:
+        {
+            throw std::runtime_error("Invalid memory test pattern.");
+        }
+    }
+}
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* --------------------------------------------------- Pipeline -------------------------------------------------- */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+namespace
+{
+    typedef struct DMAMemTestBlock
+    {
+        uint32_t bufferIndex;  /* Index in the buffer pool */
+        uint64_t blockIndex;  /* Index of the block in the tested region */
+    };
+
+    /* Blocking FIFO between pipeline stages, Pop() returns false once closed & drained */
+
+    class DMAMemTestQueue
+    {
+        private:
+
+            std::mutex queueMutex;
+            std::condition_variable queueCondition;
+            std::deque<DMAMemTestBlock> queue;
+            bool closed = false;
+
+        public:
+
+            void Push(const DMAMemTestBlock &block)
+            {
+                std::lock_guard<std::mutex> lock(this->queueMutex);
+                this->queue.push_back(block);
+                this->queueCondition.notify_one();
+            }
+
+            bool Pop(DMAMemTestBlock *block)
+            {
+                std::unique_lock<std::mutex> lock(this->queueMutex);
+                this->queueCondition.wait(lock, [this]() { return !this->queue.empty() || this->closed; });
+
+                if (this->queue.empty())
+                {
+                    return false;
+                }
+
+                *block = this->queue.front();
+                this->queue.pop_front();
+                return true;
+            }
+
+            void Close()
+            {
+                std::lock_guard<std::mutex> lock(this->queueMutex);
+                this->closed = true;
+                this->queueCondition.notify_all();
+            }
+    };
+}
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* ----------------------------------------------- DDR Memory Test ----------------------------------------------- */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+vuprs::DMAMemTest::DMAMemTest(vuprs::FPGAController *fpgaController)
+{
+    if (fpgaController == nullptr)
+    {
+        throw std::runtime_error("*FPGAController is nullptr.");
+    }
+    if (!fpgaController->GetFPGAConfig().ConfigDown())
+    {
+        throw std::runtime_error("Config not complete.");
+    }
+
+    this->fpgaController = fpgaController;
+    this->SetMemTestConfig(vuprs::DMAMemTest::DefaultMemTestConfig(fpgaController->GetFPGAConfig()));
+}
+
+vuprs::DMAMemTest::~DMAMemTest()
+{
+
+}
+
+vuprs::DMAMemTestConfig vuprs::DMAMemTest::DefaultMemTestConfig(const vuprs::FPGAConfigManager &configManager)
+{
+    vuprs::DMAMemTestConfig config;
+    uint64_t transferBytes = configManager.fpgaConfig.xdmaDriverConfig.maxTransferSize_bytes;
+
+    config.ddrOffset = 0;
+    config.byteSize = configManager.fpgaConfig.hardwareConfig.hardwareConfigDDR.ddrMemoryCapacity_megabytes * 1024 * 1024;
+    config.blockByteSize = std::max(static_cast<uint64_t>(DMA_MEMTEST_PAGE_BYTES), transferBytes / DMA_MEMTEST_PAGE_BYTES * DMA_MEMTEST_PAGE_BYTES);
+
+    config.verifyThreads = std::max(1U, std::min(4U, std::thread::hardware_concurrency() / 2));
+    config.maxReportedErrors = DMA_MEMTEST_DEFAULT_MAX_REPORTED_ERRORS;
+
+    config.patterns = {DMA_MEMTEST_PATTERN__WALKING_ONES, DMA_MEMTEST_PATTERN__ADDRESS, DMA_MEMTEST_PATTERN__PRBS};
+
+    return config;
+}
+
+void vuprs::DMAMemTest::SetMemTestConfig(const vuprs::DMAMemTestConfig &config)
+{
+    /* ------------------------ Security Check Start ------------------------- */
+
+    uint64_t ddrCapacityBytes = this->fpgaController->GetFPGAConfig().fpgaConfig.hardwareConfig.hardwareConfigDDR.ddrMemoryCapacity_megabytes * 1024 * 1024;
+
+    if (config.byteSize == 0 || config.ddrOffset + config.byteSize > ddrCapacityBytes)
+    {
+        throw std::runtime_error("Memory test region out of DDR.");
+    }
+    if (config.ddrOffset % DMA_MEMTEST_PAGE_BYTES != 0 || config.byteSize % DMA_MEMTEST_PAGE_BYTES != 0)
+    {
+        throw std::runtime_error("Memory test region is not aligned to " + std::to_string(DMA_MEMTEST_PAGE_BYTES) + " bytes.");
+    }
+    if (config.blockByteSize == 0 || config.blockByteSize % DMA_MEMTEST_PAGE_BYTES != 0)
+    {
+        throw std::runtime_error("Memory test block is not a multiple of " + std::to_string(DMA_MEMTEST_PAGE_BYTES) + " bytes.");
+    }
+    if (config.verifyThreads == 0)
+    {
+        throw std::runtime_error("Verify threads is 0.");
+    }
+
+    /* ------------------------- Security Check End -------------------------- */
+
+    this->memTestConfig = config;
+}
+
+bool vuprs::DMAMemTest::WritePattern(const uint8_t &pattern, std::vector<vuprs::AlignedBufferDMA> &bufferPool, vuprs::DMAMemTestResult *result)
+{
+    const vuprs::FPGAConfigManager &configManager = this->fpgaController->GetFPGAConfig();
+    const uint64_t blockCount = (this->memTestConfig.byteSize + this->memTestConfig.blockByteSize - 1) / this->memTestConfig.blockByteSize;
+    const uint64_t channelCount = configManager.fpgaConfig.xdmaDriverConfig.deviceFilename_xdma_h2c.size();
+
+    DMAMemTestQueue freeQueue, readyQueue;
+    std::vector<std::thread> writers;
+    std::atomic<bool> transferFailed(false);
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    for (uint32_t i = 0; i < bufferPool.size(); i++)
+    {
+        freeQueue.Push({i, 0});
+    }
+
+    /* Stage 2: H2C on every channel */
+
+    for (uint64_t c = 0; c < channelCount; c++)
+    {
+        writers.emplace_back([&, c]()
+        {
+            vuprs::DMATransferConfig transferConfig;
+            DMAMemTestBlock block;
+
+            transferConfig.transferDmaChannel = static_cast<uint8_t>(c);
+            transferConfig.transferDirectionSelection = DMA_TRANSFER_DIRECTION__HOST_TO_FPGA;
+
+            while (readyQueue.Pop(&block) && !transferFailed.load())
+            {
+                transferConfig.ddrOffset = this->memTestConfig.ddrOffset + block.blockIndex * this->memTestConfig.blockByteSize;
+                transferConfig.transferByteSize = std::min(this->memTestConfig.blockByteSize,
+                                                           this->memTestConfig.byteSize - block.blockIndex * this->memTestConfig.blockByteSize);
+
+                bool transferSuccess = false;
+
+                try
+                {
+                    transferSuccess = this->fpgaController->AXIFull_IO(transferConfig, bufferPool[block.bufferIndex].data());
+                }
+                catch (...)
+                {
+                    transferSuccess = false;
+                }
+
+                if (!transferSuccess)
+                {
+                    transferFailed.store(true);
+                    freeQueue.Close();
+                    readyQueue.Close();
+                    break;
+                }
+
+                freeQueue.Push(block);
+            }
+        });
+    }
+
+    /* Stage 1: generate (this thread) */
+
+    DMAMemTestBlock block;
+
+    for (uint64_t b = 0; b < blockCount && !transferFailed.load(); b++)
+    {
+        if (!freeQueue.Pop(&block))
+        {
+            break;
+        }
+
+        uint64_t blockBytes = std::min(this->memTestConfig.blockByteSize, this->memTestConfig.byteSize - b * this->memTestConfig.blockByteSize);
+
+        block.blockIndex = b;
+        vuprs::DMAMemTestFillPattern(pattern, this->memTestConfig.ddrOffset + b * this->memTestConfig.blockByteSize,
+                                     reinterpret_cast<uint32_t*>(bufferPool[block.bufferIndex].data()), blockBytes / sizeof(uint32_t));
+        readyQueue.Push(block);
+    }
+
+    readyQueue.Close();
+
+    for (size_t i = 0; i < writers.size(); i++)
+    {
+        writers[i].join();
+    }
+
+    result->writeElapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    result->writeThroughput_bytesPerSecond = result->writeElapsed_s > 0 ? this->memTestConfig.byteSize / result->writeElapsed_s : 0;
+
+    return !transferFailed.load();
+}
+
+bool vuprs::DMAMemTest::VerifyPattern(const uint8_t &pattern, std::vector<vuprs::AlignedBufferDMA> &bufferPool, vuprs::DMAMemTestResult *result)
+{
+    const vuprs::FPGAConfigManager &configManager = this->fpgaController->GetFPGAConfig();
+    const uint64_t blockCount = (this->memTestConfig.byteSize + this->memTestConfig.blockByteSize - 1) / this->memTestConfig.blockByteSize;
+    const uint64_t channelCount = configManager.fpgaConfig.xdmaDriverConfig.deviceFilename_xdma_c2h.size();
+
+    DMAMemTestQueue freeQueue, verifyQueue;
+    std::vector<std::thread> readers, verifiers;
+    std::atomic<uint64_t> nextBlock(0), activeReaders(channelCount), errorWords(0);
+    std::atomic<bool> transferFailed(false);
+    std::mutex errorMutex;
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    for (uint32_t i = 0; i < bufferPool.size(); i++)
+    {
+        freeQueue.Push({i, 0});
+    }
+
+    /* Stage 1: C2H on every channel */
+
+    for (uint64_t c = 0; c < channelCount; c++)
+    {
+        readers.emplace_back([&, c]()
+        {
+            vuprs::DMATransferConfig transferConfig;
+            DMAMemTestBlock block;
+            uint64_t b = 0;
+
+            transferConfig.transferDmaChannel = static_cast<uint8_t>(c);
+            transferConfig.transferDirectionSelection = DMA_TRANSFER_DIRECTION__FPGA_TO_HOST;
+
+            while ((b = nextBlock.fetch_add(1)) < blockCount && !transferFailed.load())
+            {
+                if (!freeQueue.Pop(&block))
+                {
+                    break;
+                }
+
+                block.blockIndex = b;
+                transferConfig.ddrOffset = this->memTestConfig.ddrOffset + b * this->memTestConfig.blockByteSize;
+                transferConfig.transferByteSize = std::min(this->memTestConfig.blockByteSize, this->memTestConfig.byteSize - b * this->memTestConfig.blockByteSize);
+
+                bool transferSuccess = false;
+
+                try
+                {
+                    transferSuccess = this->fpgaController->AXIFull_IO(transferConfig, bufferPool[block.bufferIndex].data());
+                }
+                catch (...)
+                {
+                    transferSuccess = false;
+                }
+
+                if (!transferSuccess)
+                {
+                    transferFailed.store(true);
+                    freeQueue.Close();
+                    break;
+                }
+
+                verifyQueue.Push(block);
+            }
+
+            if (activeReaders.fetch_sub(1) == 1)
+            {
+                verifyQueue.Close();  /* Last reader */
+            }
+        });
+    }
+
+    /* Stage 2: regenerate & compare page by page */
+
+    for (uint64_t v = 0; v < this->memTestConfig.verifyThreads; v++)
+    {
+        verifiers.emplace_back([&]()
+        {
+            alignas(64) uint32_t expected[DMA_MEMTEST_PAGE_BYTES / sizeof(uint32_t)];
+            const uint64_t pageWords = DMA_MEMTEST_PAGE_BYTES / sizeof(uint32_t);
+            DMAMemTestBlock block;
+
+            while (verifyQueue.Pop(&block))
+            {
+                const uint64_t blockAddress = this->memTestConfig.ddrOffset + block.blockIndex * this->memTestConfig.blockByteSize;
+                const uint64_t blockBytes = std::min(this->memTestConfig.blockByteSize, this->memTestConfig.byteSize - block.blockIndex * this->memTestConfig.blockByteSize);
+                const uint32_t *actual = reinterpret_cast<const uint32_t*>(bufferPool[block.bufferIndex].data());
+
+                for (uint64_t page = 0; page < blockBytes / DMA_MEMTEST_PAGE_BYTES; page++)
+                {
+                    const uint32_t *actualPage = actual + page * pageWords;
+
+                    vuprs::DMAMemTestFillPattern(pattern, blockAddress + page * DMA_MEMTEST_PAGE_BYTES, expected, pageWords);
+
+                    /* memcmp is the vectorized fast path, words are scanned only for a bad page */
+
+                    if (memcmp(expected, actualPage, DMA_MEMTEST_PAGE_BYTES) == 0)
+                    {
+                        continue;
+                    }
+
+                    for (uint64_t i = 0; i < pageWords; i++)
+                    {
+                        if (expected[i] == actualPage[i])
+                        {
+                            continue;
+                        }
+
+                        errorWords.fetch_add(1);
+
+                        std::lock_guard<std::mutex> lock(errorMutex);
+                        result->firstErrors.push_back({blockAddress + page * DMA_MEMTEST_PAGE_BYTES + i * sizeof(uint32_t), expected[i], actualPage[i]});
+
+                        /* Keep the lowest addresses, blocks finish out of order */
+
+                        if (result->firstErrors.size() > this->memTestConfig.maxReportedErrors)
+                        {
+                            std::sort(result->firstErrors.begin(), result->firstErrors.end(),
+                                      [](const vuprs::DMAMemTestError &a, const vuprs::DMAMemTestError &b) { return a.ddrAddress < b.ddrAddress; });
+                            result->firstErrors.resize(this->memTestConfig.maxReportedErrors);
+                        }
+                    }
+                }
+
+                freeQueue.Push(block);
+            }
+        });
+    }
+
+    for (size_t i = 0; i < readers.size(); i++)
+    {
+        readers[i].join();
+    }
+    for (size_t i = 0; i < verifiers.size(); i++)
+    {
+        verifiers[i].join();
+    }
+
+    std::sort(result->firstErrors.begin(), result->firstErrors.end(),
+              [](const vuprs::DMAMemTestError &a, const vuprs::DMAMemTestError &b) { return a.ddrAddress < b.ddrAddress; });
+
+    result->errorWords = errorWords.load();
+    result->readElapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    result->readThroughput_bytesPerSecond = result->readElapsed_s > 0 ? this->memTestConfig.byteSize / result->readElapsed_s : 0;
+
+    return !transferFailed.load();
+}
+
+bool vuprs::DMAMemTest::Run(std::vector<vuprs::DMAMemTestResult> *results, const std::function<void(const vuprs::DMAMemTestResult&)> &progress)
+{
+    if (results == nullptr)
+    {
+        throw std::runtime_error("*Results is nullptr.");
+    }
+
+    const vuprs::FPGAConfigManager &configManager = this->fpgaController->GetFPGAConfig();
+    const uint64_t channelCount = std::max(configManager.fpgaConfig.xdmaDriverConfig.deviceFilename_xdma_h2c.size(),
+                                           configManager.fpgaConfig.xdmaDriverConfig.deviceFilename_xdma_c2h.size());
+
+    /* 2 buffers per channel keep the DMA busy, 1 per verify thread keeps the compare busy */
+
+    std::vector<vuprs::AlignedBufferDMA> bufferPool(2 * channelCount + this->memTestConfig.verifyThreads);
+    vuprs::DMAMemTestResult result;
+    bool allSuccess = true;
+
+    if (channelCount == 0)
+    {
+        throw std::runtime_error("No DMA channel.");
+    }
+
+    for (size_t i = 0; i < bufferPool.size(); i++)
+    {
+        if (!bufferPool[i].malloc(this->memTestConfig.blockByteSize))
+        {
+            throw std::bad_alloc();
+        }
+    }
+
+    results->clear();
+
+    for (uint8_t pattern : this->memTestConfig.patterns)
+    {
+        if (!IS_DMA_MEMTEST_PATTERN(pattern))
+        {
+            continue;
+        }
+
+        result = vuprs::DMAMemTestResult();
+        result.pattern = pattern;
+        result.testedBytes = this->memTestConfig.byteSize;
+
+        result.transferSuccess = this->WritePattern(pattern, bufferPool, &result) &&
+                                 this->VerifyPattern(pattern, bufferPool, &result);
+
+        results->push_back(result);
+
+        if (progress)
+        {
+            progress(result);
+        }
+
+        allSuccess = allSuccess && result.transferSuccess && result.errorWords == 0;
+    }
+
+    return allSuccess && !results->empty();
+}
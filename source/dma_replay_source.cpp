@@ -0,0 +1,380 @@
+#include "dma_replay_source.h"
+
+#include <cerrno>
+#include <cmath>
+#include <random>
+#include <thread>
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* ------------------------------------------------ Synthetic Capture -------------------------------------------- */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+std::vector<uint32_t> vuprs::GenerateADCCapture(const vuprs::FPGAhardwareConfigFrame &frameFeatures, const uint64_t &frames,
+                                                const double &crcErrorRate, const uint64_t &seed)
+{
+    vuprs::CheckFrameFeatures(frameFeatures);
+
+    const uint64_t frameWords = frameFeatures.channels + 2;
+    const double amplitude = std::ldexp(1.0, static_cast<int>(frameFeatures.dataWidth_bits) - 2);  /* Half full scale */
+    std::vector<uint32_t> words(frames * frameWords);
+    std::mt19937_64 random(seed);
+    std::bernoulli_distribution crcError(std::min(std::max(crcErrorRate, 0.0), 1.0));
+    uint32_t *frame = nullptr;
+    int32_t value = 0;
+
+    for (uint64_t f = 0; f < frames; f++)
+    {
+        frame = words.data() + f * frameWords;
+        frame[0] = static_cast<uint32_t>(frameFeatures.header);
+        frame[frameWords - 1] = static_cast<uint32_t>(frameFeatures.tailer);
+
+        for (uint64_t c = 0; c < frameFeatures.channels; c++)
+        {
+            value = static_cast<int32_t>(std::lround(amplitude * std::sin(2 * M_PI * (c + 1) * (f % 1024) / 1024.0)));
+            frame[1 + frameFeatures.storageOrder[c]] = vuprs::EncodeADCDataWord(value, frameFeatures.dataWidth_bits);
+
+            if (crcError(random))
+            {
+                frame[1 + frameFeatures.storageOrder[c]] ^= 1U;  /* Broken CRC */
+            }
+        }
+    }
+
+    return words;
+}
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* ------------------------------------------- Capture Replay Source --------------------------------------------- */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+vuprs::CaptureReplaySource::CaptureReplaySource()
+{
+    this->replayConfig = vuprs::CaptureReplayConfig();
+    this->file_fd = -1;
+    this->timer_fd = -1;
+    this->loopBytes = 0;
+    this->loopOffset = 0;
+    this->requestedRate_bytesPerSecond = 0;
+    this->startTime_ns = 0;
+    this->lastReadTime_ns = 0;
+    this->replayReport = vuprs::CaptureReplayReport();
+    this->stopRequested = false;
+}
+
+vuprs::CaptureReplaySource::~CaptureReplaySource()
+{
+    this->Close();
+}
+
+bool vuprs::CaptureReplaySource::Open(const vuprs::CaptureReplayConfig &config)
+{
+    /* ------------------------ Security Check Start ------------------------- */
+
+    if (config.captureFilename.empty() && config.captureWords == nullptr)
+    {
+        throw std::runtime_error("Empty filename.");
+    }
+    if (!(config.speed >= 0))
+    {
+        throw std::runtime_error("Replay speed must be >= 0.");
+    }
+    if (config.speed > 0 && (!(config.frameRate_Hz > 0) || config.frameBytes == 0))
+    {
+        throw std::runtime_error("Paced replay needs the frame rate and the frame bytes.");
+    }
+
+    /* ------------------------- Security Check End -------------------------- */
+
+    struct stat fileStatus;
+    uint64_t captureBytes = 0;
+
+    this->Close();
+
+    if (config.captureWords != nullptr)
+    {
+        /* In-memory capture */
+
+        captureBytes = config.captureWords->size() * sizeof(uint32_t);
+
+        if (config.fileOffset >= captureBytes || config.byteSize > captureBytes - config.fileOffset)
+        {
+            throw std::runtime_error("Replay region is out of the in-memory capture.");
+        }
+
+        this->captureWords = config.captureWords;
+        this->loopBytes = config.byteSize != 0 ? config.byteSize : captureBytes - config.fileOffset;
+    }
+    else
+    {
+
+#ifdef _WIN32
+
+    this->file_fd = open(config.captureFilename.c_str(), O_RDONLY | O_BINARY);
+
+#else
+
+        this->file_fd = open(config.captureFilename.c_str(), O_RDONLY);
+
+#endif
+
+        if (this->file_fd < 0)
+        {
+            return false;
+        }
+
+        if (fstat(this->file_fd, &fileStatus) < 0 ||
+            config.fileOffset >= static_cast<uint64_t>(fileStatus.st_size) ||
+            config.byteSize > static_cast<uint64_t>(fileStatus.st_size) - config.fileOffset)
+        {
+            this->Close();
+            throw std::runtime_error("Replay region is out of the capture file: " + config.captureFilename);
+        }
+
+        this->loopBytes = config.byteSize != 0 ? config.byteSize : static_cast<uint64_t>(fileStatus.st_size) - config.fileOffset;
+
+#ifndef _WIN32
+
+        posix_fadvise(this->file_fd, config.fileOffset, this->loopBytes, POSIX_FADV_SEQUENTIAL);
+
+#endif
+
+    }
+
+    this->loopBytes -= this->loopBytes % sizeof(uint32_t);
+
+    if (this->loopBytes == 0)
+    {
+        this->Close();
+        throw std::runtime_error("Replay region is shorter than a word: " + config.captureFilename);
+    }
+
+#ifndef _WIN32
+
+    if (config.speed > 0)
+    {
+        this->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+
+        if (this->timer_fd < 0)
+        {
+            this->Close();
+            return false;
+        }
+    }
+
+#endif
+
+    this->replayConfig = config;
+    this->loopOffset = 0;
+    this->requestedRate_bytesPerSecond = config.frameRate_Hz * config.frameBytes * config.speed;
+    this->startTime_ns = 0;
+    this->lastReadTime_ns = 0;
+    this->replayReport = vuprs::CaptureReplayReport();
+    this->replayReport.requestedRate_bytesPerSecond = this->requestedRate_bytesPerSecond;
+    this->stopRequested = false;
+
+    return true;
+}
+
+void vuprs::CaptureReplaySource::Close()
+{
+    if (this->timer_fd >= 0)
+    {
+        close(this->timer_fd);
+        this->timer_fd = -1;
+    }
+    if (this->file_fd >= 0)
+    {
+        close(this->file_fd);
+        this->file_fd = -1;
+    }
+
+    this->captureWords.reset();
+}
+
+void vuprs::CaptureReplaySource::Stop()
+{
+    this->stopRequested = true;
+
+#ifndef _WIN32
+
+    /* Expire the timer at once, a read blocked on it returns */
+
+    struct itimerspec expireNow = {{0, 0}, {0, 1}};
+
+    if (this->timer_fd >= 0)
+    {
+        timerfd_settime(this->timer_fd, TFD_TIMER_ABSTIME, &expireNow, nullptr);
+    }
+
+#endif
+}
+
+bool vuprs::CaptureReplaySource::WaitUntil(const int64_t &deadline_ns)
+{
+
+#ifndef _WIN32
+
+    struct itimerspec deadline = {{0, 0}, {static_cast<time_t>(deadline_ns / ADC_TIME_NS_PER_S), static_cast<long>(deadline_ns % ADC_TIME_NS_PER_S)}};
+    uint64_t expirations = 0;
+
+    if (timerfd_settime(this->timer_fd, TFD_TIMER_ABSTIME, &deadline, nullptr) < 0)
+    {
+        return false;
+    }
+
+    /* Stop() after this point expires the timer, before it the flag is seen here */
+
+    if (this->stopRequested)
+    {
+        return false;
+    }
+
+    while (::read(this->timer_fd, &expirations, sizeof(expirations)) < 0)
+    {
+        if (errno != EINTR)
+        {
+            return false;
+        }
+    }
+
+#else
+
+    std::this_thread::sleep_for(std::chrono::nanoseconds(deadline_ns - vuprs::HostMonotonic_ns()));
+
+#endif
+
+    return !this->stopRequested;
+}
+
+const char *vuprs::CaptureReplaySource::Name() const
+{
+    return "replay";
+}
+
+uint64_t vuprs::CaptureReplaySource::TotalBytes() const
+{
+    return this->replayConfig.loops == 0 ? 0 : this->loopBytes * this->replayConfig.loops;
+}
+
+bool vuprs::CaptureReplaySource::Read(void *data, const uint64_t &maxBytes, uint64_t *readBytes)
+{
+    /* ------------------------ Security Check Start ------------------------- */
+
+    if (readBytes == nullptr)
+    {
+        throw std::runtime_error("*ReadBytes is nullptr.");
+    }
+    if (this->file_fd < 0 && this->captureWords == nullptr)
+    {
+        throw std::runtime_error("Capture file is not open.");
+    }
+
+    /* ------------------------- Security Check End -------------------------- */
+
+    const uint64_t wantBytes = maxBytes - maxBytes % sizeof(uint32_t);
+    uint64_t transferBytes = 0, doneBytes = 0;
+    int64_t now_ns = 0, deadline_ns = 0;
+    ssize_t fileReadBytes = 0;
+
+    *readBytes = 0;
+
+    if (this->stopRequested || wantBytes == 0)
+    {
+        return true;
+    }
+
+    /* Next loop */
+
+    if (this->loopOffset == this->loopBytes)
+    {
+        if (this->replayConfig.loops != 0 && this->replayReport.completedLoops >= this->replayConfig.loops)
+        {
+            return true;
+        }
+
+        this->loopOffset = 0;
+    }
+
+    if (this->startTime_ns == 0)
+    {
+        this->startTime_ns = vuprs::HostMonotonic_ns();
+    }
+
+    /* Read the file first, the pacing wait hides the file I/O */
+
+    transferBytes = std::min(wantBytes, this->loopBytes - this->loopOffset);
+
+    if (this->captureWords != nullptr)
+    {
+        memcpy(data, reinterpret_cast<const uint8_t*>(this->captureWords->data()) + this->replayConfig.fileOffset + this->loopOffset, transferBytes);
+        doneBytes = transferBytes;
+    }
+
+    while (doneBytes < transferBytes)
+    {
+        fileReadBytes = pread(this->file_fd, static_cast<uint8_t*>(data) + doneBytes, transferBytes - doneBytes,
+                              this->replayConfig.fileOffset + this->loopOffset + doneBytes);
+
+        if (fileReadBytes < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (fileReadBytes <= 0)
+        {
+            return false;
+        }
+
+        doneBytes += fileReadBytes;
+    }
+
+    /* Release at the deadline of the last byte */
+
+    if (this->requestedRate_bytesPerSecond > 0)
+    {
+        deadline_ns = this->startTime_ns + static_cast<int64_t>((this->replayReport.deliveredBytes + transferBytes) /
+                                                                this->requestedRate_bytesPerSecond * ADC_TIME_NS_PER_S);
+        now_ns = vuprs::HostMonotonic_ns();
+
+        if (now_ns < deadline_ns)
+        {
+            if (!this->WaitUntil(deadline_ns))
+            {
+                return this->stopRequested;  /* Stopped: end of stream, otherwise the timer failed */
+            }
+        }
+        else
+        {
+            this->replayReport.maxLag_s = std::max(this->replayReport.maxLag_s, (now_ns - deadline_ns) * 1e-9);
+
+            if ((now_ns - deadline_ns) * 1e-9 > CAPTURE_REPLAY_LATE_THRESHOLD_S)
+            {
+                this->replayReport.lateReads++;
+            }
+        }
+    }
+
+    this->lastReadTime_ns = vuprs::HostMonotonic_ns();
+    this->loopOffset += transferBytes;
+    this->replayReport.deliveredBytes += transferBytes;
+    this->replayReport.reads++;
+
+    if (this->loopOffset == this->loopBytes)
+    {
+        this->replayReport.completedLoops++;
+    }
+
+    *readBytes = transferBytes;
+
+    return true;
+}
+
+vuprs::CaptureReplayReport vuprs::CaptureReplaySource::Report() const
+{
+    vuprs::CaptureReplayReport report = this->replayReport;
+
+    report.elapsed_s = this->lastReadTime_ns > this->startTime_ns ? (this->lastReadTime_ns - this->startTime_ns) * 1e-9 : 0;
+    report.achievedRate_bytesPerSecond = report.elapsed_s > 0 ? report.deliveredBytes / report.elapsed_s : 0;
+    report.rateRatio = report.requestedRate_bytesPerSecond > 0 ? report.achievedRate_bytesPerSecond / report.requestedRate_bytesPerSecond : 0;
+
+    return report;
+}
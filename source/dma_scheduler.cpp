@@ -0,0 +1,416 @@
+#include "dma_scheduler.h"
+#include "metrics_registry.h"
+
+/* Per class queue & service time (file-scope: exported as 0 before the first request) */
+
+static const char *DMAScheduler__ClassNames[DMA_REQUEST_CLASSES] = {"realtime", "bulk"};
+
+static std::vector<vuprs::MetricsHistogram*> DMAScheduler__ClassHistograms(const std::string &name, const std::string &help)
+{
+    std::vector<vuprs::MetricsHistogram*> histograms;
+
+    for (int c = 0; c < DMA_REQUEST_CLASSES; c++)
+    {
+        histograms.push_back(&vuprs::Metrics().Histogram(name, help, vuprs::MetricsLatencyBuckets(), {{"class", DMAScheduler__ClassNames[c]}}));
+    }
+
+    return histograms;
+}
+
+static const std::vector<vuprs::MetricsHistogram*> DMAScheduler__QueueSeconds =
+    DMAScheduler__ClassHistograms("vuprs_dma_queue_seconds", "Time of a DMA request in the scheduler queue (submit -> dispatch).");
+static const std::vector<vuprs::MetricsHistogram*> DMAScheduler__ServiceSeconds =
+    DMAScheduler__ClassHistograms("vuprs_dma_service_seconds", "Time of the DMA transfer serving a request (dispatch -> complete, merged reads share it).");
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* ----------------------------------------------- DMA Scheduler ------------------------------------------------- */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+vuprs::DMAScheduler::DMAScheduler(vuprs::FPGAController *fpgaController, const vuprs::DMASchedulerConfig &config)
+{
+    if (fpgaController == nullptr)
+    {
+        throw std::runtime_error("*FPGAController is nullptr.");
+    }
+
+    const vuprs::FPGAConfigManager &configManager = fpgaController->GetFPGAConfig();
+
+    if (!configManager.ConfigDown())
+    {
+        throw std::runtime_error("Config not complete.");
+    }
+
+    this->fpgaController = fpgaController;
+    this->schedulerConfig = config;
+
+    if (this->schedulerConfig.maxMergedTransferBytes == 0)
+    {
+        this->schedulerConfig.maxMergedTransferBytes = DMA_SCHEDULER_DEFAULT_MAX_MERGE_BYTES;
+    }
+
+    for (int i = 0; i < DMA_REQUEST_CLASSES; i++)
+    {
+        this->classMetrics[i] = vuprs::DMAClassMetrics();
+    }
+
+    this->bulkTokens = 0;
+    this->bulkTokensUpdateTime = std::chrono::steady_clock::now();
+    this->stopRequested = false;
+
+    /* One worker per channel and direction */
+
+    for (size_t i = 0; i < configManager.fpgaConfig.xdmaDriverConfig.deviceFilename_xdma_c2h.size(); i++)
+    {
+        this->workers.emplace_back(&vuprs::DMAScheduler::WorkerLoop, this, DMA_TRANSFER_DIRECTION__FPGA_TO_HOST, static_cast<uint8_t>(i));
+    }
+    for (size_t i = 0; i < configManager.fpgaConfig.xdmaDriverConfig.deviceFilename_xdma_h2c.size(); i++)
+    {
+        this->workers.emplace_back(&vuprs::DMAScheduler::WorkerLoop, this, DMA_TRANSFER_DIRECTION__HOST_TO_FPGA, static_cast<uint8_t>(i));
+    }
+}
+
+vuprs::DMAScheduler::~DMAScheduler()
+{
+    this->Stop();
+}
+
+void vuprs::DMAScheduler::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->schedulerMutex);
+        this->stopRequested = true;
+    }
+
+    this->schedulerCondition.notify_all();
+
+    for (size_t i = 0; i < this->workers.size(); i++)
+    {
+        if (this->workers[i].joinable())
+        {
+            this->workers[i].join();
+        }
+    }
+    this->workers.clear();
+
+    /* Fail what is left */
+
+    std::lock_guard<std::mutex> lock(this->schedulerMutex);
+
+    for (int d = 0; d < 2; d++)
+    {
+        for (int c = 0; c < DMA_REQUEST_CLASSES; c++)
+        {
+            while (!this->requestQueues[d][c].empty())
+            {
+                this->requestQueues[d][c].front().completion.set_value(false);
+                this->requestQueues[d][c].pop_front();
+            }
+        }
+    }
+}
+
+std::future<bool> vuprs::DMAScheduler::Submit(const vuprs::DMATransferConfig &transferConfig, void *data, const int &requestClass)
+{
+    /* ------------------------ Security Check Start ------------------------- */
+
+    if (!IS_DMA_REQUEST_CLASS(requestClass))
+    {
+        throw std::runtime_error("Invalid request class: " + std::to_string(requestClass));
+    }
+    if (!IS_DMA_TRANSFER_DIRECTION(transferConfig.transferDirectionSelection))
+    {
+        throw std::runtime_error("Invalid direction.");
+    }
+    if (transferConfig.transferByteSize == 0)
+    {
+        throw std::runtime_error("Transfer bytes is 0.");
+    }
+    if (data == nullptr)
+    {
+        throw std::runtime_error("*Data is nullptr.");
+    }
+
+    /* ------------------------- Security Check End -------------------------- */
+
+    vuprs::DMAScheduledRequest request;
+    std::future<bool> result;
+
+    request.transferConfig = transferConfig;
+    request.data = data;
+    request.requestClass = requestClass;
+    request.submitTime = std::chrono::steady_clock::now();
+    result = request.completion.get_future();
+
+    {
+        std::lock_guard<std::mutex> lock(this->schedulerMutex);
+
+        if (this->stopRequested)
+        {
+            throw std::runtime_error("Scheduler stopped.");
+        }
+
+        this->requestQueues[transferConfig.transferDirectionSelection][requestClass].push_back(std::move(request));
+    }
+
+    this->schedulerCondition.notify_all();
+
+    return result;
+}
+
+bool vuprs::DMAScheduler::Transfer(const vuprs::DMATransferConfig &transferConfig, void *data, const int &requestClass)
+{
+    return this->Submit(transferConfig, data, requestClass).get();
+}
+
+bool vuprs::DMAScheduler::GetClassMetrics(const int &requestClass, vuprs::DMAClassMetrics *metrics) const
+{
+    if (!IS_DMA_REQUEST_CLASS(requestClass) || metrics == nullptr)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(this->schedulerMutex);
+    *metrics = this->classMetrics[requestClass];
+
+    return true;
+}
+
+/* ------------------------------------------------- Scheduling -------------------------------------------------- */
+
+void vuprs::DMAScheduler::RefillBulkTokens(const std::chrono::steady_clock::time_point &now)
+{
+    if (this->schedulerConfig.bulkBandwidthLimit_bytesPerSecond == 0)
+    {
+        return;
+    }
+
+    /* Burst is bounded to 100 ms of bandwidth, but at least one merged transfer */
+
+    double rate = static_cast<double>(this->schedulerConfig.bulkBandwidthLimit_bytesPerSecond);
+    double burst = std::max(rate / 10.0, static_cast<double>(this->schedulerConfig.maxMergedTransferBytes));
+    double elapsed = std::chrono::duration<double>(now - this->bulkTokensUpdateTime).count();
+
+    this->bulkTokens = std::min(burst, this->bulkTokens + elapsed * rate);
+    this->bulkTokensUpdateTime = now;
+}
+
+bool vuprs::DMAScheduler::SelectRequests(const int &direction, std::vector<vuprs::DMAScheduledRequest> *batch, std::chrono::steady_clock::time_point *wakeTime)
+{
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    int selectedClass = -1;
+    uint64_t rangeBegin = 0, rangeEnd = 0, requestBegin = 0, requestEnd = 0;
+    bool merged = true;
+
+    *wakeTime = std::chrono::steady_clock::time_point::max();
+
+    /* Strict priority */
+
+    if (!this->requestQueues[direction][DMA_REQUEST_CLASS__REALTIME].empty())
+    {
+        selectedClass = DMA_REQUEST_CLASS__REALTIME;
+    }
+    else if (!this->requestQueues[direction][DMA_REQUEST_CLASS__BULK].empty())
+    {
+        this->RefillBulkTokens(now);
+
+        if (this->schedulerConfig.bulkBandwidthLimit_bytesPerSecond == 0 || this->bulkTokens >= 0)
+        {
+            selectedClass = DMA_REQUEST_CLASS__BULK;
+        }
+        else
+        {
+            /* Sleep until the bucket is back to zero */
+            *wakeTime = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(-this->bulkTokens / static_cast<double>(this->schedulerConfig.bulkBandwidthLimit_bytesPerSecond)));
+        }
+    }
+
+    if (selectedClass < 0)
+    {
+        return false;
+    }
+
+    std::deque<vuprs::DMAScheduledRequest> &queue = this->requestQueues[direction][selectedClass];
+
+    batch->clear();
+    batch->push_back(std::move(queue.front()));
+    queue.pop_front();
+
+    rangeBegin = batch->front().transferConfig.ddrOffset;
+    rangeEnd = rangeBegin + batch->front().transferConfig.transferByteSize;
+
+    /* Coalesce overlapping or adjacent reads */
+
+    while (direction == DMA_TRANSFER_DIRECTION__FPGA_TO_HOST && merged)
+    {
+        merged = false;
+
+        for (auto it = queue.begin(); it != queue.end(); ++it)
+        {
+            requestBegin = it->transferConfig.ddrOffset;
+            requestEnd = requestBegin + it->transferConfig.transferByteSize;
+
+            if (requestBegin <= rangeEnd && requestEnd >= rangeBegin &&
+                std::max(rangeEnd, requestEnd) - std::min(rangeBegin, requestBegin) <= this->schedulerConfig.maxMergedTransferBytes)
+            {
+                rangeBegin = std::min(rangeBegin, requestBegin);
+                rangeEnd = std::max(rangeEnd, requestEnd);
+
+                batch->push_back(std::move(*it));
+                queue.erase(it);
+                merged = true;
+                break;
+            }
+        }
+    }
+
+    if (selectedClass == DMA_REQUEST_CLASS__BULK && this->schedulerConfig.bulkBandwidthLimit_bytesPerSecond != 0)
+    {
+        this->bulkTokens -= static_cast<double>(rangeEnd - rangeBegin);
+    }
+
+    return true;
+}
+
+bool vuprs::DMAScheduler::ExecuteBatch(const int &direction, const uint8_t &channel, std::vector<vuprs::DMAScheduledRequest> *batch, vuprs::AlignedBufferDMA *bounceBuffer, uint64_t *transferredBytes)
+{
+    vuprs::DMATransferConfig transferConfig;
+    uint64_t rangeBegin = UINT64_MAX, rangeEnd = 0;
+    bool directIO = false;
+
+    for (size_t i = 0; i < batch->size(); i++)
+    {
+        rangeBegin = std::min(rangeBegin, (*batch)[i].transferConfig.ddrOffset);
+        rangeEnd = std::max(rangeEnd, (*batch)[i].transferConfig.ddrOffset + (*batch)[i].transferConfig.transferByteSize);
+    }
+
+    transferConfig.transferDmaChannel = channel;
+    transferConfig.ddrOffset = rangeBegin;
+    transferConfig.transferByteSize = rangeEnd - rangeBegin;
+    transferConfig.transferDirectionSelection = direction;
+
+    *transferredBytes = transferConfig.transferByteSize;
+
+    /* Single aligned request goes straight to the caller memory */
+
+    directIO = batch->size() == 1 && reinterpret_cast<uintptr_t>(batch->front().data) % __XDMA_DMA_ALIGNMENT_BYTES__ == 0;
+
+    if (directIO)
+    {
+        return this->fpgaController->AXIFull_IO(transferConfig, batch->front().data);
+    }
+
+    if (bounceBuffer->size() < transferConfig.transferByteSize)
+    {
+        if (!bounceBuffer->malloc(transferConfig.transferByteSize))
+        {
+            throw std::runtime_error("Cannot malloc buffer.");
+        }
+    }
+
+    if (direction == DMA_TRANSFER_DIRECTION__HOST_TO_FPGA)
+    {
+        std::memcpy(bounceBuffer->data(), batch->front().data, transferConfig.transferByteSize);
+        return this->fpgaController->AXIFull_IO(transferConfig, bounceBuffer->data());
+    }
+
+    if (!this->fpgaController->AXIFull_IO(transferConfig, bounceBuffer->data()))
+    {
+        return false;
+    }
+
+    /* Scatter to the requesters */
+
+    for (size_t i = 0; i < batch->size(); i++)
+    {
+        std::memcpy((*batch)[i].data, bounceBuffer->as<uint8_t>() + ((*batch)[i].transferConfig.ddrOffset - rangeBegin), (*batch)[i].transferConfig.transferByteSize);
+    }
+
+    return true;
+}
+
+void vuprs::DMAScheduler::WorkerLoop(const int direction, const uint8_t channel)
+{
+    std::vector<vuprs::DMAScheduledRequest> batch;
+    std::chrono::steady_clock::time_point wakeTime, dispatchTime, completeTime;
+    vuprs::AlignedBufferDMA bounceBuffer;
+    std::exception_ptr batchException;
+    uint64_t transferredBytes = 0, queueTime_ns = 0, serviceTime_ns = 0;
+    bool batchSuccess = false;
+    int requestClass = 0;
+
+    std::unique_lock<std::mutex> lock(this->schedulerMutex);
+
+    while (!this->stopRequested)
+    {
+        if (!this->SelectRequests(direction, &batch, &wakeTime))
+        {
+            if (wakeTime == std::chrono::steady_clock::time_point::max())
+            {
+                this->schedulerCondition.wait(lock);
+            }
+            else
+            {
+                this->schedulerCondition.wait_until(lock, wakeTime);
+            }
+            continue;
+        }
+
+        /* Transfer without holding the lock */
+
+        lock.unlock();
+
+        dispatchTime = std::chrono::steady_clock::now();
+        batchException = nullptr;
+        batchSuccess = false;
+
+        try
+        {
+            batchSuccess = this->ExecuteBatch(direction, channel, &batch, &bounceBuffer, &transferredBytes);
+        }
+        catch (...)
+        {
+            batchException = std::current_exception();
+        }
+
+        completeTime = std::chrono::steady_clock::now();
+        serviceTime_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(completeTime - dispatchTime).count();
+
+        lock.lock();
+
+        /* Metrics */
+
+        requestClass = batch.front().requestClass;
+
+        vuprs::DMAClassMetrics &metrics = this->classMetrics[requestClass];
+
+        metrics.transfers++;
+        metrics.transferredBytes += batchSuccess ? transferredBytes : 0;
+
+        for (size_t i = 0; i < batch.size(); i++)
+        {
+            queueTime_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(dispatchTime - batch[i].submitTime).count();
+
+            metrics.requests++;
+            metrics.failedRequests += batchSuccess ? 0 : 1;
+            metrics.queueTimeTotal_ns += queueTime_ns;
+            metrics.queueTimeMax_ns = std::max(metrics.queueTimeMax_ns, queueTime_ns);
+            metrics.serviceTimeTotal_ns += serviceTime_ns;
+            metrics.serviceTimeMax_ns = std::max(metrics.serviceTimeMax_ns, serviceTime_ns);
+
+            DMAScheduler__QueueSeconds[requestClass]->Observe(queueTime_ns * 1e-9);
+            DMAScheduler__ServiceSeconds[requestClass]->Observe(serviceTime_ns * 1e-9);
+
+            if (batchException != nullptr)
+            {
+                batch[i].completion.set_exception(batchException);
+            }
+            else
+            {
+                batch[i].completion.set_value(batchSuccess);
+            }
+        }
+
+        batch.clear();
+    }
+}
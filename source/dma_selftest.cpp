@@ -0,0 +1,432 @@
+#include "dma_selftest.h"
+
+/**
+ * @brief SCI of a sample period (inverse of SamplePeriodFromSCI()).
+ */
+static uint32_t DMASelfTest__SCI(const double &samplePeriod_s, const vuprs::FPGAhardwareConfigADC &adcFeatures)
+{
+    if (adcFeatures.adcSCIAccumulatorBits == 0)
+    {
+        return static_cast<uint32_t>(std::lround(samplePeriod_s * adcFeatures.adcSamplingClock_Hz));
+    }
+
+    return static_cast<uint32_t>(std::lround(ldexp(1.0, static_cast<int>(adcFeatures.adcSCIAccumulatorBits)) / (samplePeriod_s * adcFeatures.adcSamplingClock_Hz)));
+}
+
+vuprs::DMASelfTest::DMASelfTest(vuprs::FPGAController *fpgaController)
+{
+    if (fpgaController == nullptr)
+    {
+        throw std::runtime_error("*FPGAController is nullptr.");
+    }
+    if (!fpgaController->GetFPGAConfig().ConfigDown())
+    {
+        throw std::runtime_error("Config not complete.");
+    }
+
+    this->fpgaController = fpgaController;
+}
+
+vuprs::DMASelfTest::~DMASelfTest()
+{
+
+}
+
+/**
+ * @brief Write PRBS (DMAMemTestFillPattern()) to DDR [0, byteSize) and keep it in expected.
+ */
+bool vuprs::DMASelfTest::WriteRegion(const uint64_t &byteSize, vuprs::AlignedBufferDMA *expected)
+{
+    const uint64_t transferBytes = this->fpgaController->GetFPGAConfig().fpgaConfig.xdmaDriverConfig.maxTransferSize_bytes;
+    vuprs::DMATransferConfig transferConfig = vuprs::DMATransferConfig();
+
+    if (!expected->malloc(byteSize))
+    {
+        throw std::bad_alloc();
+    }
+
+    vuprs::DMAMemTestFillPattern(DMA_MEMTEST_PATTERN__PRBS, 0, expected->as<uint32_t>(), byteSize / sizeof(uint32_t));
+
+    transferConfig.transferDmaChannel = 0;
+    transferConfig.transferDirectionSelection = DMA_TRANSFER_DIRECTION__HOST_TO_FPGA;
+
+    for (uint64_t offset = 0; offset < byteSize; offset += transferConfig.transferByteSize)
+    {
+        transferConfig.ddrOffset = offset;
+        transferConfig.transferByteSize = transferBytes > 0 ? std::min(transferBytes, byteSize - offset) : byteSize - offset;
+
+        if (!this->fpgaController->AXIFull_IO(transferConfig, expected->as<uint8_t>() + offset))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Adjacent bulk reads queued at once must leave in fewer transfers and scatter the right bytes.
+ */
+vuprs::DMASelfTestResult vuprs::DMASelfTest::CheckSchedulerMerge()
+{
+    const uint64_t regionBytes = DMA_SELFTEST_MERGE_REQUESTS * DMA_SELFTEST_MERGE_REQUEST_BYTES;
+    vuprs::DMASelfTestResult result = {"scheduler-merge", false, ""};
+    vuprs::DMASchedulerConfig schedulerConfig = vuprs::DMASchedulerConfig();
+    vuprs::DMAClassMetrics metrics = vuprs::DMAClassMetrics();
+    vuprs::DMATransferConfig transferConfig = vuprs::DMATransferConfig();
+    vuprs::AlignedBufferDMA expected, readBack;
+    std::vector<std::future<bool>> completions;
+    bool readSuccess = true, dataMatch = false;
+    char detail[128] = {0};
+
+    if (!this->WriteRegion(regionBytes, &expected))
+    {
+        result.detail = "H2C write of the test region failed";
+        return result;
+    }
+    if (!readBack.malloc(regionBytes))
+    {
+        throw std::bad_alloc();
+    }
+
+    /* The first read empties the token bucket (1 request takes 2 ms at 8 MB/s), the others queue up behind it */
+
+    schedulerConfig.bulkBandwidthLimit_bytesPerSecond = 8 * 1024 * 1024UL;
+    schedulerConfig.maxMergedTransferBytes = regionBytes;
+
+    transferConfig.transferDirectionSelection = DMA_TRANSFER_DIRECTION__FPGA_TO_HOST;
+    transferConfig.transferByteSize = DMA_SELFTEST_MERGE_REQUEST_BYTES;
+
+    {
+        vuprs::DMAScheduler dmaScheduler(this->fpgaController, schedulerConfig);
+
+        for (uint64_t i = 0; i < DMA_SELFTEST_MERGE_REQUESTS; i++)
+        {
+            transferConfig.ddrOffset = i * DMA_SELFTEST_MERGE_REQUEST_BYTES;
+            completions.push_back(dmaScheduler.Submit(transferConfig, readBack.as<uint8_t>() + transferConfig.ddrOffset, DMA_REQUEST_CLASS__BULK));
+        }
+        for (std::future<bool> &completion : completions)
+        {
+            readSuccess = completion.get() && readSuccess;
+        }
+
+        dmaScheduler.GetClassMetrics(DMA_REQUEST_CLASS__BULK, &metrics);
+    }
+
+    dataMatch = memcmp(readBack.data(), expected.data(), regionBytes) == 0;
+
+    snprintf(detail, sizeof(detail), "%lu reads -> %lu DMA transfers%s%s", static_cast<unsigned long>(metrics.requests),
+             static_cast<unsigned long>(metrics.transfers), readSuccess ? "" : ", read failed", dataMatch ? "" : ", data mismatch");
+
+    result.success = readSuccess && dataMatch && metrics.requests == DMA_SELFTEST_MERGE_REQUESTS && metrics.transfers < metrics.requests;
+    result.detail = detail;
+
+    return result;
+}
+
+/**
+ * @brief Bulk reads with gaps must not exceed the cap, a real-time read submitted behind them must not wait for them.
+ */
+void vuprs::DMASelfTest::CheckSchedulerBandwidth(vuprs::DMASelfTestResult *capResult, vuprs::DMASelfTestResult *priorityResult)
+{
+    const uint64_t strideBytes = 2 * DMA_SELFTEST_CAP_REQUEST_BYTES;  /* Gap of one request, reads are never adjacent */
+    const uint64_t regionBytes = DMA_SELFTEST_CAP_REQUESTS * strideBytes;
+    const double requestInterval_s = static_cast<double>(DMA_SELFTEST_CAP_REQUEST_BYTES) / DMA_SELFTEST_CAP_BANDWIDTH;
+    vuprs::DMASchedulerConfig schedulerConfig = vuprs::DMASchedulerConfig();
+    vuprs::DMATransferConfig transferConfig = vuprs::DMATransferConfig();
+    vuprs::AlignedBufferDMA expected, readBack, realtimeReadBack;
+    std::vector<std::future<bool>> completions;
+    std::chrono::steady_clock::time_point startTime, realtimeStartTime;
+    double bulkElapsed_s = 0, bulkRate_bytesPerSecond = 0, realtimeLatency_s = 0;
+    bool readSuccess = true, dataMatch = true, realtimeSuccess = false;
+    char detail[128] = {0};
+
+    *capResult = {"scheduler-cap", false, ""};
+    *priorityResult = {"scheduler-priority", false, ""};
+
+    if (!this->WriteRegion(regionBytes, &expected))
+    {
+        capResult->detail = priorityResult->detail = "H2C write of the test region failed";
+        return;
+    }
+    if (!readBack.malloc(DMA_SELFTEST_CAP_REQUESTS * DMA_SELFTEST_CAP_REQUEST_BYTES) || !realtimeReadBack.malloc(DMA_SELFTEST_CAP_REQUEST_BYTES))
+    {
+        throw std::bad_alloc();
+    }
+
+    schedulerConfig.bulkBandwidthLimit_bytesPerSecond = DMA_SELFTEST_CAP_BANDWIDTH;
+    schedulerConfig.maxMergedTransferBytes = DMA_SELFTEST_CAP_REQUEST_BYTES;
+
+    transferConfig.transferDirectionSelection = DMA_TRANSFER_DIRECTION__FPGA_TO_HOST;
+    transferConfig.transferByteSize = DMA_SELFTEST_CAP_REQUEST_BYTES;
+
+    {
+        vuprs::DMAScheduler dmaScheduler(this->fpgaController, schedulerConfig);
+
+        startTime = std::chrono::steady_clock::now();
+
+        for (uint64_t i = 0; i < DMA_SELFTEST_CAP_REQUESTS; i++)
+        {
+            transferConfig.ddrOffset = i * strideBytes;
+            completions.push_back(dmaScheduler.Submit(transferConfig, readBack.as<uint8_t>() + i * DMA_SELFTEST_CAP_REQUEST_BYTES, DMA_REQUEST_CLASS__BULK));
+        }
+
+        /* Real-time read from a gap, the bulk queue is still full */
+
+        transferConfig.ddrOffset = DMA_SELFTEST_CAP_REQUEST_BYTES;
+
+        realtimeStartTime = std::chrono::steady_clock::now();
+        realtimeSuccess = dmaScheduler.Transfer(transferConfig, realtimeReadBack.data(), DMA_REQUEST_CLASS__REALTIME);
+        realtimeLatency_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - realtimeStartTime).count();
+
+        for (std::future<bool> &completion : completions)
+        {
+            readSuccess = completion.get() && readSuccess;
+        }
+
+        bulkElapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    }
+
+    for (uint64_t i = 0; i < DMA_SELFTEST_CAP_REQUESTS && dataMatch; i++)
+    {
+        dataMatch = memcmp(readBack.as<uint8_t>() + i * DMA_SELFTEST_CAP_REQUEST_BYTES, expected.as<uint8_t>() + i * strideBytes, DMA_SELFTEST_CAP_REQUEST_BYTES) == 0;
+    }
+
+    bulkRate_bytesPerSecond = DMA_SELFTEST_CAP_REQUESTS * DMA_SELFTEST_CAP_REQUEST_BYTES / bulkElapsed_s;
+
+    snprintf(detail, sizeof(detail), "bulk %.2f MB/s, cap %.2f MB/s%s%s", bulkRate_bytesPerSecond / 1e6, DMA_SELFTEST_CAP_BANDWIDTH / 1e6,
+             readSuccess ? "" : ", read failed", dataMatch ? "" : ", data mismatch");
+
+    capResult->success = readSuccess && dataMatch && bulkRate_bytesPerSecond <= DMA_SELFTEST_CAP_BANDWIDTH * DMA_SELFTEST_CAP_TOLERANCE;
+    capResult->detail = detail;
+
+    /* Served ahead of the queue: within one bulk interval, not after the queued bulk reads */
+
+    dataMatch = memcmp(realtimeReadBack.data(), expected.as<uint8_t>() + DMA_SELFTEST_CAP_REQUEST_BYTES, DMA_SELFTEST_CAP_REQUEST_BYTES) == 0;
+
+    snprintf(detail, sizeof(detail), "realtime read in %.3f ms behind %u queued bulk reads (%.3f ms each)%s%s", realtimeLatency_s * 1e3,
+             DMA_SELFTEST_CAP_REQUESTS, requestInterval_s * 1e3, realtimeSuccess ? "" : ", read failed", dataMatch ? "" : ", data mismatch");
+
+    priorityResult->success = realtimeSuccess && dataMatch && realtimeLatency_s < requestInterval_s;
+    priorityResult->detail = detail;
+}
+
+/**
+ * @brief Capture of the simulated card through the S2MM SG ring: blocks complete in ring order with full buffers,
+ *        TAILDESC follows the released descriptors (flow control mode) and the frames of the blocks are the
+ *        frame generator's in order (SIM_CARD_WAVE_TABLE_SIZE).
+ */
+vuprs::DMASelfTestResult vuprs::DMASelfTest::CheckScatterGather(const bool &cyclicMode)
+{
+    const vuprs::FPGAConfig &fpgaConfig = this->fpgaController->GetFPGAConfig().fpgaConfig;
+    const vuprs::FPGAhardwareConfigADC &adcFeatures = fpgaConfig.hardwareConfig.hardwareConfigADC;
+    const vuprs::FPGAhardwareConfigFrame &frameFeatures = fpgaConfig.hardwareConfig.hardwareConfigFrame;
+    const uint64_t dataWords = frameFeatures.channels;
+    const uint64_t expectedBlocks = static_cast<uint64_t>(DMA_SELFTEST_SG_LAPS) * DMA_SELFTEST_SG_DESCRIPTORS;
+    const vuprs::SGRingConfigS2MM ringConfig = {DMA_SELFTEST_SG_DDR_OFFSET, DMA_SELFTEST_SG_DDR_OFFSET + DMA_SELFTEST_SG_DESCRIPTORS * SG_DESCRIPTOR_BYTES,
+                                                DMA_SELFTEST_SG_BUFFER_BYTES, DMA_SELFTEST_SG_DESCRIPTORS, 0, cyclicMode};
+    vuprs::DMASelfTestResult result = {cyclicMode ? "sg-cyclic" : "sg-flow-control", false, ""};
+    vuprs::SGEngineS2MM sgEngine(this->fpgaController);
+    vuprs::ADCStreamParser streamParser(frameFeatures);
+    vuprs::DMATransferConfig transferConfig = vuprs::DMATransferConfig();
+    vuprs::AlignedBufferDMA block;
+    std::vector<vuprs::SGCompletedBlock> completed;
+    std::vector<uint32_t> frameWords;
+    std::vector<int32_t> waveTable(SIM_CARD_WAVE_TABLE_SIZE);
+    std::chrono::steady_clock::time_point startTime;
+    uint64_t harvestedBlocks = 0, badBlocks = 0, frames = 0, badFrames = 0, tailAdvances = 0, badTails = 0, previousTail = 0, tail = 0;
+    uint32_t tailLSB = 0, tailMSB = 0, adcError = 0, dmasr = 0, expectedWord = 0;
+    bool ioSuccess = true, timeout = false;
+    char detail[192] = {0};
+
+    /* Same table as the frame generator of the simulated card */
+
+    const double amplitude = 0.5 * (frameFeatures.dataWidth_bits == 16 ? 32767.0 : 8388607.0);
+
+    for (uint32_t i = 0; i < SIM_CARD_WAVE_TABLE_SIZE; i++)
+    {
+        waveTable[i] = static_cast<int32_t>(std::lround(amplitude * std::sin(2.0 * M_PI * i / SIM_CARD_WAVE_TABLE_SIZE)));
+    }
+
+    if (!block.malloc(DMA_SELFTEST_SG_BUFFER_BYTES))
+    {
+        throw std::bad_alloc();
+    }
+
+    /* Continuous capture, no TLAST */
+
+    ioSuccess = this->fpgaController->AXILite_WriteToFPGARegister(AXI_LITE_REGISTER__ADC__STR, 0) &&
+                this->fpgaController->AXILite_WriteToFPGARegister(AXI_LITE_REGISTER__ADC__SCI, DMASelfTest__SCI(DMA_SELFTEST_SG_SAMPLE_PERIOD, adcFeatures)) &&
+                this->fpgaController->AXILite_WriteToFPGARegister(AXI_LITE_REGISTER__ADC__SP, 0) &&
+                this->fpgaController->AXILite_WriteToFPGARegister(AXI_LITE_REGISTER__ADC__SF, 0);
+
+    if (!ioSuccess || !sgEngine.Start(ringConfig))
+    {
+        result.detail = "SG engine start failed";
+        return result;
+    }
+
+    previousTail = sgEngine.GetDescriptorRing().TailDescriptorAXIAddress();
+
+    ioSuccess = this->fpgaController->AXILite_WriteToFPGARegister(AXI_LITE_REGISTER__ADC__STR, ADC_STR__TRIGGER);
+
+    transferConfig.transferDirectionSelection = DMA_TRANSFER_DIRECTION__FPGA_TO_HOST;
+
+    startTime = std::chrono::steady_clock::now();
+
+    while (ioSuccess && harvestedBlocks < expectedBlocks)
+    {
+        if (std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count() > DMA_SELFTEST_SG_TIMEOUT)
+        {
+            timeout = true;
+            break;
+        }
+
+        completed.clear();
+        sgEngine.Harvest(&completed);
+
+        for (const vuprs::SGCompletedBlock &completedBlock : completed)
+        {
+            /* Ring order, full buffer, no error */
+
+            if (completedBlock.descriptorIndex != harvestedBlocks % DMA_SELFTEST_SG_DESCRIPTORS ||
+                !(completedBlock.status & SG_DESCRIPTOR_STATUS__CMPLT) || (completedBlock.status & SG_DESCRIPTOR_STATUS__ERROR_MASK) ||
+                (completedBlock.status & SG_DESCRIPTOR_LENGTH_MASK) != DMA_SELFTEST_SG_BUFFER_BYTES || completedBlock.transferredBytes != DMA_SELFTEST_SG_BUFFER_BYTES)
+            {
+                badBlocks++;
+            }
+
+            harvestedBlocks++;
+
+            transferConfig.ddrOffset = completedBlock.ddrOffset;
+            transferConfig.transferByteSize = completedBlock.transferredBytes;
+
+            if (!this->fpgaController->AXIFull_IO(transferConfig, block.data()))
+            {
+                ioSuccess = false;
+                break;
+            }
+
+            frameWords.clear();
+            streamParser.Feed(block.data(), completedBlock.transferredBytes, &frameWords);
+
+            /* Frame f, channel c: waveTable[(f * (c + 1)) % size] (simulated CRC errors only flip bit 0) */
+
+            for (uint64_t offset = 0; offset + dataWords <= frameWords.size(); offset += dataWords, frames++)
+            {
+                for (uint64_t c = 0; c < frameFeatures.channels; c++)
+                {
+                    expectedWord = vuprs::EncodeADCDataWord(waveTable[(frames * (c + 1)) % SIM_CARD_WAVE_TABLE_SIZE], frameFeatures.dataWidth_bits);
+
+                    if ((frameWords[offset + frameFeatures.storageOrder[c]] | 1U) != (expectedWord | 1U))
+                    {
+                        badFrames++;
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (!ioSuccess || !sgEngine.Release(static_cast<uint32_t>(completed.size())))
+        {
+            ioSuccess = false;
+            break;
+        }
+
+        /* Flow control mode: TAILDESC moves to the last released descriptor, cyclic mode: it is never written again */
+
+        if (!completed.empty())
+        {
+            if (!this->fpgaController->AXILite_ReadFPGARegister(AXI_LITE_REGISTER__DMA__S2MM_TAILDESC, &tailLSB) ||
+                !this->fpgaController->AXILite_ReadFPGARegister(AXI_LITE_REGISTER__DMA__S2MM_TAILDESC_MSB, &tailMSB))
+            {
+                ioSuccess = false;
+                break;
+            }
+
+            tail = (static_cast<uint64_t>(tailMSB) << 32) | tailLSB;
+
+            if (tail != sgEngine.GetDescriptorRing().TailDescriptorAXIAddress() || (cyclicMode && tail != previousTail) ||
+                (!cyclicMode && tail == previousTail && completed.size() % DMA_SELFTEST_SG_DESCRIPTORS != 0))
+            {
+                badTails++;
+            }
+            if (tail != previousTail)
+            {
+                tailAdvances++;
+            }
+
+            previousTail = tail;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    ioSuccess = this->fpgaController->AXILite_WriteToFPGARegister(AXI_LITE_REGISTER__ADC__STR, 0) && ioSuccess;
+    ioSuccess = this->fpgaController->AXILite_ReadFPGARegister(AXI_LITE_REGISTER__ADC__ERR, &adcError) && ioSuccess;
+    ioSuccess = sgEngine.ReadStatus(&dmasr) && sgEngine.Stop() && ioSuccess;
+
+    snprintf(detail, sizeof(detail), "%lu blocks (%u laps of %u), %lu frames, TAILDESC moved %lu times%s%s%s%s%s%s%s",
+             static_cast<unsigned long>(harvestedBlocks), DMA_SELFTEST_SG_LAPS, DMA_SELFTEST_SG_DESCRIPTORS, static_cast<unsigned long>(frames),
+             static_cast<unsigned long>(tailAdvances), ioSuccess ? "" : ", I/O failed", timeout ? ", timeout" : "",
+             badBlocks == 0 ? "" : ", bad status", badFrames == 0 ? "" : ", frames out of order", badTails == 0 ? "" : ", bad TAILDESC",
+             (adcError & ADC_ERR__FIFO_OVERFLOW) ? ", FIFO overflow" : "", (dmasr & S2MM_DMASR__ERROR_MASK) ? ", DMA error" : "");
+
+    result.success = ioSuccess && !timeout && badBlocks == 0 && badFrames == 0 && badTails == 0 && frames > 0 &&
+                     (cyclicMode || tailAdvances > 0) &&
+                     !(adcError & ADC_ERR__FIFO_OVERFLOW) && !(dmasr & S2MM_DMASR__ERROR_MASK);
+    result.detail = detail;
+
+    return result;
+}
+
+bool vuprs::DMASelfTest::Run(std::vector<vuprs::DMASelfTestResult> *results, const std::function<void(const vuprs::DMASelfTestResult&)> &progress)
+{
+    /* ------------------------ Security Check Start ------------------------- */
+
+    if (results == nullptr)
+    {
+        throw std::runtime_error("*Results is nullptr.");
+    }
+
+    const uint64_t ddrBytes = this->fpgaController->GetFPGAConfig().fpgaConfig.hardwareConfig.hardwareConfigDDR.ddrMemoryCapacity_megabytes * 1024 * 1024;
+
+    if (ddrBytes < 2 * DMA_SELFTEST_CAP_REQUESTS * DMA_SELFTEST_CAP_REQUEST_BYTES)
+    {
+        throw std::runtime_error("DDR is smaller than the test region.");
+    }
+
+    /* ------------------------- Security Check End -------------------------- */
+
+    vuprs::DMASelfTestResult capResult, priorityResult;
+    bool allSuccess = true;
+
+    results->clear();
+
+    results->push_back(this->CheckSchedulerMerge());
+
+    this->CheckSchedulerBandwidth(&capResult, &priorityResult);
+
+    results->push_back(capResult);
+    results->push_back(priorityResult);
+
+    /* The expected frames are the simulated card's */
+
+    if (this->fpgaController->TransportName() == FPGA_TRANSPORT__SIMULATED)
+    {
+        results->push_back(this->CheckScatterGather(false));
+        results->push_back(this->CheckScatterGather(true));
+    }
+
+    for (const vuprs::DMASelfTestResult &result : *results)
+    {
+        if (progress)
+        {
+            progress(result);
+        }
+
+        allSuccess = allSuccess && result.success;
+    }
+
+    return allSuccess;
+}
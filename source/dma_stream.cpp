@@ -0,0 +1,506 @@
+#include "dma_stream.h"
+#include "adc_stream_parser.h"
+#include "trace_recorder.h"
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* ------------------------------------------------ File -> DDR -------------------------------------------------- */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+bool vuprs::StreamFileToDDR(vuprs::FPGAController *fpgaController,
+                            const std::string &fileName, const uint64_t &fileOffset,
+                            const uint64_t &ddrOffset, const uint64_t &totalBytes,
+                            const vuprs::DMAStreamConfig &streamConfig,
+                            const std::function<void(const vuprs::DMAStreamProgress&)> &progress,
+                            vuprs::DMAStreamProgress *summary)
+{
+    /* ------------------------ Security Check Start ------------------------- */
+
+    if (fpgaController == nullptr)
+    {
+        throw std::runtime_error("*FPGAController is nullptr.");
+    }
+    if (fileName.empty())
+    {
+        throw std::runtime_error("Empty filename.");
+    }
+    if (totalBytes == 0 || streamConfig.chunkByteSize == 0)
+    {
+        throw std::runtime_error("Transfer bytes or chunk bytes is 0.");
+    }
+
+    /* ------------------------- Security Check End -------------------------- */
+
+    const uint64_t chunkCount = (totalBytes + streamConfig.chunkByteSize - 1) / streamConfig.chunkByteSize;
+
+    vuprs::AlignedBufferDMA chunkBuffers[DMA_STREAM_BUFFERS];
+    uint64_t chunkBytes[DMA_STREAM_BUFFERS] = {0};
+    bool chunkReady[DMA_STREAM_BUFFERS] = {false};
+
+    std::mutex streamMutex;
+    std::condition_variable streamCondition;
+    bool readFailed = false, dmaFailed = false;
+
+    vuprs::DMAStreamProgress streamProgress = vuprs::DMAStreamProgress();
+    vuprs::DMATransferConfig transferConfig;
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    int file_fd = -1;
+
+    for (uint32_t i = 0; i < DMA_STREAM_BUFFERS; i++)
+    {
+        if (!chunkBuffers[i].malloc(streamConfig.chunkByteSize))
+        {
+            throw std::bad_alloc();
+        }
+    }
+
+#ifdef _WIN32
+
+    file_fd = open(fileName.c_str(), O_RDONLY | O_BINARY);
+
+#else
+
+    file_fd = open(fileName.c_str(), O_RDONLY);
+
+#endif
+
+    if (file_fd < 0)
+    {
+        return false;
+    }
+
+    /* Reader: fills chunk k into buffer k % DMA_STREAM_BUFFERS once the DMA has drained it */
+
+    std::thread fileReader([&]()
+    {
+        uint64_t readOffset = 0, wantBytes = 0;
+        ssize_t readBytes = 0;
+        uint32_t slot = 0;
+
+        for (uint64_t k = 0; k < chunkCount; k++)
+        {
+            slot = k % DMA_STREAM_BUFFERS;
+
+            {
+                std::unique_lock<std::mutex> lock(streamMutex);
+                streamCondition.wait(lock, [&]() { return !chunkReady[slot] || dmaFailed; });
+                if (dmaFailed) return;
+            }
+
+            wantBytes = std::min(streamConfig.chunkByteSize, totalBytes - readOffset);
+            readBytes = pread(file_fd, chunkBuffers[slot].data(), wantBytes, fileOffset + readOffset);
+
+            std::lock_guard<std::mutex> lock(streamMutex);
+
+            if (readBytes < 0 || static_cast<uint64_t>(readBytes) != wantBytes)
+            {
+                readFailed = true;
+                streamCondition.notify_all();
+                return;
+            }
+
+            chunkBytes[slot] = wantBytes;
+            chunkReady[slot] = true;
+            readOffset += wantBytes;
+            streamCondition.notify_all();
+        }
+    });
+
+    /* DMA: drains chunks in order */
+
+    transferConfig.transferDmaChannel = streamConfig.dmaChannel;
+    transferConfig.transferDirectionSelection = DMA_TRANSFER_DIRECTION__HOST_TO_FPGA;
+
+    streamProgress.totalBytes = totalBytes;
+
+    try
+    {
+        for (uint64_t k = 0; k < chunkCount; k++)
+        {
+            uint32_t slot = k % DMA_STREAM_BUFFERS;
+
+            {
+                std::unique_lock<std::mutex> lock(streamMutex);
+                streamCondition.wait(lock, [&]() { return chunkReady[slot] || readFailed; });
+                if (!chunkReady[slot]) break;
+            }
+
+            transferConfig.ddrOffset = ddrOffset + streamProgress.transferredBytes;
+            transferConfig.transferByteSize = chunkBytes[slot];
+
+            bool chunkSuccess = fpgaController->AXIFull_IO(transferConfig, chunkBuffers[slot].data());
+
+            {
+                std::lock_guard<std::mutex> lock(streamMutex);
+                chunkReady[slot] = false;
+                if (!chunkSuccess) dmaFailed = true;
+                streamCondition.notify_all();
+            }
+
+            if (!chunkSuccess) break;
+
+            streamProgress.transferredBytes += transferConfig.transferByteSize;
+            streamProgress.elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+            streamProgress.throughput_bytesPerSecond = streamProgress.elapsed_s > 0 ? streamProgress.transferredBytes / streamProgress.elapsed_s : 0;
+
+            if (progress)
+            {
+                progress(streamProgress);
+            }
+        }
+    }
+    catch (...)
+    {
+        {
+            std::lock_guard<std::mutex> lock(streamMutex);
+            dmaFailed = true;
+            streamCondition.notify_all();
+        }
+        fileReader.join();
+        close(file_fd);
+        throw;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(streamMutex);
+        if (streamProgress.transferredBytes != totalBytes) dmaFailed = true;
+        streamCondition.notify_all();
+    }
+
+    fileReader.join();
+    close(file_fd);
+
+    if (summary != nullptr)
+    {
+        *summary = streamProgress;
+    }
+
+    return streamProgress.transferredBytes == totalBytes && !readFailed;
+}
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* ----------------------------------------------- DDR -> Samples ------------------------------------------------ */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+vuprs::DDRByteSource::DDRByteSource(vuprs::FPGAController *fpgaController, const uint64_t &ddrOffset, const uint64_t &totalBytes, const uint8_t &dmaChannel,
+                                    vuprs::DMAScheduler *scheduler)
+{
+    if (fpgaController == nullptr)
+    {
+        throw std::runtime_error("*FPGAController is nullptr.");
+    }
+
+    this->fpgaController = fpgaController;
+    this->scheduler = scheduler;
+    this->ddrOffset = ddrOffset;
+    this->totalBytes = totalBytes;
+    this->readOffset = 0;
+
+    /* One DMA transfer per tuned C2H transfer size (dma_autotune.h), chunks stay at the parse chunk size */
+
+    this->transferBytes = fpgaController->GetFPGAConfig().fpgaConfig.xdmaDriverConfig.maxTransferSize_bytes;
+    this->transferBytes -= this->transferBytes % __XDMA_DMA_ALIGNMENT_BYTES__;
+
+    this->transferConfig = vuprs::DMATransferConfig();
+    this->transferConfig.transferDmaChannel = dmaChannel;
+    this->transferConfig.transferDirectionSelection = DMA_TRANSFER_DIRECTION__FPGA_TO_HOST;
+}
+
+vuprs::DDRByteSource::~DDRByteSource()
+{
+
+}
+
+const char *vuprs::DDRByteSource::Name() const
+{
+    return "ddr";
+}
+
+uint64_t vuprs::DDRByteSource::TotalBytes() const
+{
+    return this->totalBytes;
+}
+
+bool vuprs::DDRByteSource::Read(void *data, const uint64_t &maxBytes, uint64_t *readBytes)
+{
+    if (readBytes == nullptr)
+    {
+        throw std::runtime_error("*ReadBytes is nullptr.");
+    }
+
+    *readBytes = 0;
+
+    if (this->readOffset >= this->totalBytes)
+    {
+        return true;
+    }
+
+    const uint64_t chunkBytes = std::min(maxBytes, this->totalBytes - this->readOffset);
+
+    while (*readBytes < chunkBytes)
+    {
+        this->transferConfig.ddrOffset = this->ddrOffset + this->readOffset;
+        this->transferConfig.transferByteSize = chunkBytes - *readBytes;
+
+        if (this->transferBytes > 0)
+        {
+            this->transferConfig.transferByteSize = std::min(this->transferConfig.transferByteSize, this->transferBytes);
+        }
+
+        if (this->scheduler != nullptr ?
+            !this->scheduler->Transfer(this->transferConfig, static_cast<uint8_t*>(data) + *readBytes, DMA_REQUEST_CLASS__REALTIME) :
+            !this->fpgaController->AXIFull_IO(this->transferConfig, static_cast<uint8_t*>(data) + *readBytes))
+        {
+            return false;
+        }
+
+        this->readOffset += this->transferConfig.transferByteSize;
+        *readBytes += this->transferConfig.transferByteSize;
+    }
+
+    return true;
+}
+
+bool vuprs::StreamDDRToADCChannels(vuprs::FPGAController *fpgaController,
+                                   const uint64_t &ddrOffset, const uint64_t &totalBytes,
+                                   const vuprs::DMAStreamConfig &streamConfig,
+                                   const vuprs::FPGAhardwareConfigADC &adcFeatures,
+                                   const vuprs::FPGAhardwareConfigFrame &frameFeatures,
+                                   const std::function<void(const vuprs::ADCStreamChunk&)> &onChunk,
+                                   vuprs::DMAStreamProgress *summary,
+                                   const vuprs::ADCTimeDescriptor *captureTime,
+                                   const vuprs::FPGAhardwareConfigCalibration *calibration,
+                                   vuprs::DMAScheduler *scheduler)
+{
+    /* ------------------------ Security Check Start ------------------------- */
+
+    if (fpgaController == nullptr)
+    {
+        throw std::runtime_error("*FPGAController is nullptr.");
+    }
+    if (totalBytes == 0 || streamConfig.chunkByteSize == 0)
+    {
+        throw std::runtime_error("Transfer bytes or chunk bytes is 0.");
+    }
+    if (totalBytes % sizeof(uint32_t) != 0 || streamConfig.chunkByteSize % sizeof(uint32_t) != 0)
+    {
+        throw std::runtime_error("Transfer bytes or chunk bytes is not a multiple of " + std::to_string(sizeof(uint32_t)) + ".");
+    }
+    if (!onChunk)
+    {
+        throw std::runtime_error("Empty chunk callback.");
+    }
+
+    /* ------------------------- Security Check End -------------------------- */
+
+    vuprs::DDRByteSource ddrSource(fpgaController, ddrOffset, totalBytes, streamConfig.dmaChannel, scheduler);
+
+    return vuprs::StreamSourceToADCChannels(&ddrSource, streamConfig, adcFeatures, frameFeatures,
+        [&](const vuprs::ADCStreamChunk &chunk)
+        {
+            vuprs::ADCStreamChunk ddrChunk = chunk;
+            ddrChunk.ddrOffset += ddrOffset;
+            onChunk(ddrChunk);
+        },
+        summary, captureTime, calibration);
+}
+
+bool vuprs::StreamSourceToADCChannels(vuprs::ADCByteSource *source,
+                                      const vuprs::DMAStreamConfig &streamConfig,
+                                      const vuprs::FPGAhardwareConfigADC &adcFeatures,
+                                      const vuprs::FPGAhardwareConfigFrame &frameFeatures,
+                                      const std::function<void(const vuprs::ADCStreamChunk&)> &onChunk,
+                                      vuprs::DMAStreamProgress *summary,
+                                      const vuprs::ADCTimeDescriptor *captureTime,
+                                      const vuprs::FPGAhardwareConfigCalibration *calibration)
+{
+    /* ------------------------ Security Check Start ------------------------- */
+
+    if (source == nullptr)
+    {
+        throw std::runtime_error("*Source is nullptr.");
+    }
+    if (streamConfig.chunkByteSize == 0 || streamConfig.chunkByteSize % sizeof(uint32_t) != 0)
+    {
+        throw std::runtime_error("Chunk bytes is 0 or not a multiple of " + std::to_string(sizeof(uint32_t)) + ".");
+    }
+    if (!onChunk)
+    {
+        throw std::runtime_error("Empty chunk callback.");
+    }
+    if (!adcFeatures.configdown)
+    {
+        throw std::runtime_error("Do not find ADC features, convert disabled");
+    }
+    if (!frameFeatures.configdown)
+    {
+        throw std::runtime_error("Do not find frame features, convert disabled");
+    }
+
+    vuprs::CheckFrameFeatures(frameFeatures);
+
+    /* ------------------------- Security Check End -------------------------- */
+
+    vuprs::AlignedBufferDMA chunkBuffers[DMA_STREAM_BUFFERS];
+    uint64_t chunkBytes[DMA_STREAM_BUFFERS] = {0};
+    bool chunkReady[DMA_STREAM_BUFFERS] = {false};
+
+    std::mutex streamMutex;
+    std::condition_variable streamCondition;
+    bool readFailed = false, readFinished = false, parseStopped = false;
+
+    vuprs::DMAStreamProgress streamProgress = vuprs::DMAStreamProgress();
+    vuprs::ADCStreamChunk streamChunk = vuprs::ADCStreamChunk();
+    vuprs::ADCChannelBuffer<double> samples;
+    vuprs::ADCTimeDescriptor chunkTime = vuprs::ADCTimeDescriptor();
+    vuprs::ADCStreamParser streamParser(frameFeatures);
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    for (uint32_t i = 0; i < DMA_STREAM_BUFFERS; i++)
+    {
+        if (!chunkBuffers[i].malloc(streamConfig.chunkByteSize))
+        {
+            throw std::bad_alloc();
+        }
+    }
+
+    /* Reader: reads chunk k into buffer k % DMA_STREAM_BUFFERS once the parser has drained it */
+
+    std::thread sourceReader([&]()
+    {
+        uint64_t readBytes = 0;
+        uint32_t slot = 0;
+        bool chunkSuccess = false;
+
+        for (uint64_t k = 0; ; k++)
+        {
+            slot = k % DMA_STREAM_BUFFERS;
+
+            {
+                VUPRS_TRACE_SPAN("stream.wait-buffer");  /* Parser behind */
+
+                std::unique_lock<std::mutex> lock(streamMutex);
+                streamCondition.wait(lock, [&]() { return !chunkReady[slot] || parseStopped; });
+                if (parseStopped) return;
+            }
+
+            try
+            {
+                VUPRS_TRACE_SPAN_VALUE("stream.read", k);
+
+                chunkSuccess = source->Read(chunkBuffers[slot].data(), streamConfig.chunkByteSize, &readBytes);
+            }
+            catch (const std::exception &e)
+            {
+                chunkSuccess = false;
+            }
+
+            std::lock_guard<std::mutex> lock(streamMutex);
+
+            if (!chunkSuccess || readBytes == 0)
+            {
+                readFailed = !chunkSuccess;
+                readFinished = true;
+                streamCondition.notify_all();
+                return;
+            }
+
+            chunkBytes[slot] = readBytes;
+            chunkReady[slot] = true;
+            streamCondition.notify_all();
+        }
+    });
+
+    /* Parser: converts chunks in order, ADCStreamParser completes the frame cut by the last chunk */
+
+    streamProgress.totalBytes = source->TotalBytes();
+    streamChunk.samples = &samples;
+
+    try
+    {
+        for (uint64_t k = 0; ; k++)
+        {
+            uint32_t slot = k % DMA_STREAM_BUFFERS;
+
+            {
+                VUPRS_TRACE_SPAN("stream.wait-data");  /* DMA (source) behind */
+
+                std::unique_lock<std::mutex> lock(streamMutex);
+                streamCondition.wait(lock, [&]() { return chunkReady[slot] || readFinished; });
+                if (!chunkReady[slot]) break;
+            }
+
+            {
+                VUPRS_TRACE_SPAN_VALUE("stream.parse", k);
+
+                samples.set_channels(frameFeatures.channels);
+                samples.clear();
+
+                streamParser.Feed(chunkBuffers[slot].data(), chunkBytes[slot], [&](const uint32_t *words, const uint64_t *frameOffsets, const uint64_t &frameCount)
+                {
+                    if (calibration != nullptr)
+                    {
+                        vuprs::FramesData2ADCChannels(words, frameOffsets, frameCount, &samples, adcFeatures, frameFeatures, *calibration);
+                    }
+                    else
+                    {
+                        vuprs::FramesData2ADCChannels(words, frameOffsets, frameCount, &samples, adcFeatures, frameFeatures);
+                    }
+                });
+            }
+
+            streamChunk.chunkIndex = k;
+            streamChunk.ddrOffset = streamProgress.transferredBytes;
+            streamChunk.chunkBytes = chunkBytes[slot];
+
+            {
+                std::lock_guard<std::mutex> lock(streamMutex);
+                chunkReady[slot] = false;
+                streamCondition.notify_all();
+            }
+
+            streamProgress.transferredBytes += streamChunk.chunkBytes;
+            streamProgress.elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+            streamProgress.throughput_bytesPerSecond = streamProgress.elapsed_s > 0 ? streamProgress.transferredBytes / streamProgress.elapsed_s : 0;
+            streamChunk.elapsed_s = streamProgress.elapsed_s;
+
+            if (captureTime != nullptr)
+            {
+                chunkTime = captureTime->Advance(streamChunk.firstSample);
+                streamChunk.time = &chunkTime;
+            }
+
+            {
+                VUPRS_TRACE_SPAN_VALUE("stream.consume", k);  /* Analysis & disk write of the caller */
+
+                onChunk(streamChunk);
+            }
+
+            streamChunk.firstSample += samples.samples();
+        }
+    }
+    catch (...)
+    {
+        {
+            std::lock_guard<std::mutex> lock(streamMutex);
+            parseStopped = true;
+            streamCondition.notify_all();
+        }
+        sourceReader.join();
+        throw;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(streamMutex);
+        parseStopped = true;
+        streamCondition.notify_all();
+    }
+
+    sourceReader.join();
+
+    if (summary != nullptr)
+    {
+        *summary = streamProgress;
+    }
+
+    return !readFailed;
+}
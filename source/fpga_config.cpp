@@ -1,4 +1,7 @@
 #include "fpga_config.h"
+#include "fpga_data_parse.h"
+#include "adc_channel_scaling.h"
+#include "fpga_transport.h"
 
 vuprs::FPGAConfigManager::FPGAConfigManager()
 {
@@ -343,6 +346,43 @@ bool vuprs::FPGAConfigManager::ParseHardwareFeatures(const nlohmann::json &jsonD
             else parseSuccessADC = false;
         }
 
+        /* ADC Sampling Clock (optional, time axis of the samples, see adc_time.h) */
+
+        this->fpgaConfig.hardwareConfig.hardwareConfigADC.adcSamplingClock_Hz = 0;
+        this->fpgaConfig.hardwareConfig.hardwareConfigADC.adcSCIAccumulatorBits = 0;
+
+        if (adcHardware.contains("sampling-clock-hz"))
+        {
+            parseResultValue = vuprs::ParseIntegerFromString(adcHardware["sampling-clock-hz"].get<std::string>(), &parseIntegerStatus);
+            if (parseIntegerStatus) this->fpgaConfig.hardwareConfig.hardwareConfigADC.adcSamplingClock_Hz = parseResultValue;
+            else parseSuccessADC = false;
+        }
+
+        if (adcHardware.contains("sci-accumulator-bits"))
+        {
+            parseResultValue = vuprs::ParseIntegerFromString(adcHardware["sci-accumulator-bits"].get<std::string>(), &parseIntegerStatus);
+            if (parseIntegerStatus && parseResultValue <= 63) this->fpgaConfig.hardwareConfig.hardwareConfigADC.adcSCIAccumulatorBits = parseResultValue;
+            else parseSuccessADC = false;
+        }
+
+        /* ADC Frame Layout (optional, default: ADC_CHANNELS, ADC_DATAWIDTH, ADC_DATA_HEADER/TAILER, ADC_CHANNEL__xxx) */
+
+        this->fpgaConfig.hardwareConfig.hardwareConfigFrame = vuprs::DefaultFrameFeatures();
+
+        if (adcHardware.contains("frame"))
+        {
+            if (!this->ParseFrameFeatures(adcHardware["frame"])) parseSuccessADC = false;
+        }
+
+        /* ADC Channel Calibration (optional, default: identity of every channel of the frame) */
+
+        this->fpgaConfig.hardwareConfig.hardwareConfigCalibration = vuprs::DefaultCalibration(this->fpgaConfig.hardwareConfig.hardwareConfigFrame.channels);
+
+        if (adcHardware.contains("calibration"))
+        {
+            if (!this->ParseCalibration(adcHardware["calibration"])) parseSuccessADC = false;
+        }
+
         if (parseSuccessADC)
         {
             this->fpgaConfig.hardwareConfig.hardwareConfigADC.configdown = true;
@@ -390,6 +430,171 @@ bool vuprs::FPGAConfigManager::ParseHardwareFeatures(const nlohmann::json &jsonD
     return parseSuccessADC && parseSuccessDDR;
 }
 
+bool vuprs::FPGAConfigManager::ParseFrameFeatures(const nlohmann::json &jsonData)
+{
+    vuprs::FPGAhardwareConfigFrame &frameFeatures = this->fpgaConfig.hardwareConfig.hardwareConfigFrame;
+    bool parseStatus, parseSuccess = true;
+    uint64_t parseResultValue;
+
+    if (jsonData.contains("channels"))
+    {
+        parseResultValue = vuprs::ParseNumberFromString(jsonData["channels"].get<std::string>(), &parseStatus);
+        if (parseStatus) frameFeatures.channels = parseResultValue;
+        else parseSuccess = false;
+    }
+
+    if (jsonData.contains("data-width-bits"))
+    {
+        parseResultValue = vuprs::ParseNumberFromString(jsonData["data-width-bits"].get<std::string>(), &parseStatus);
+        if (parseStatus) frameFeatures.dataWidth_bits = parseResultValue;
+        else parseSuccess = false;
+    }
+
+    if (jsonData.contains("header"))
+    {
+        parseResultValue = vuprs::ParseHexFromString(jsonData["header"].get<std::string>(), &parseStatus);
+        if (parseStatus) frameFeatures.header = parseResultValue;
+        else parseSuccess = false;
+    }
+
+    if (jsonData.contains("tailer"))
+    {
+        parseResultValue = vuprs::ParseHexFromString(jsonData["tailer"].get<std::string>(), &parseStatus);
+        if (parseStatus) frameFeatures.tailer = parseResultValue;
+        else parseSuccess = false;
+    }
+
+    /* Storage order: data word of every channel, identity when it is not given */
+
+    if (jsonData.contains("storage-order"))
+    {
+        auto storageOrder = jsonData["storage-order"];
+
+        if (storageOrder.is_array())
+        {
+            frameFeatures.storageOrder.clear();
+
+            for (uint64_t i = 0; i < storageOrder.size(); i++)
+            {
+                parseResultValue = vuprs::ParseNumberFromString(storageOrder[i].get<std::string>(), &parseStatus);
+                if (parseStatus) frameFeatures.storageOrder.push_back(parseResultValue);
+                else parseSuccess = false;
+            }
+        }
+        else
+        {
+            parseSuccess = false;
+        }
+    }
+    else if (frameFeatures.channels != frameFeatures.storageOrder.size())
+    {
+        frameFeatures.storageOrder.resize(frameFeatures.channels);
+
+        for (uint64_t c = 0; c < frameFeatures.channels; c++)
+        {
+            frameFeatures.storageOrder[c] = c;
+        }
+    }
+
+    /* Validate */
+
+    if (parseSuccess)
+    {
+        try
+        {
+            vuprs::CheckFrameFeatures(frameFeatures);
+        }
+        catch (const std::exception &e)
+        {
+            parseSuccess = false;
+        }
+    }
+
+    frameFeatures.configdown = parseSuccess;
+
+    return parseSuccess;
+}
+
+bool vuprs::FPGAConfigManager::ParseCalibration(const nlohmann::json &jsonData)
+{
+    vuprs::FPGAhardwareConfigCalibration &calibration = this->fpgaConfig.hardwareConfig.hardwareConfigCalibration;
+    std::vector<bool> channelParsed(calibration.gain.size(), false);
+    bool parseStatus, parseSuccess = true;
+    uint64_t channel;
+    double parseResultValue;
+
+    if (!jsonData.is_array())
+    {
+        calibration.configdown = false;
+        return false;
+    }
+
+    /* One entry per channel (channel order), channels without entry keep the identity */
+
+    for (uint64_t i = 0; i < jsonData.size(); i++)
+    {
+        auto channelCalibration = jsonData[i];
+
+        if (!channelCalibration.contains("channel"))
+        {
+            parseSuccess = false;
+            continue;
+        }
+
+        channel = vuprs::ParseNumberFromString(channelCalibration["channel"].get<std::string>(), &parseStatus);
+        if (!parseStatus || channel >= channelParsed.size() || channelParsed[channel])
+        {
+            parseSuccess = false;
+            continue;
+        }
+        channelParsed[channel] = true;
+
+        if (channelCalibration.contains("gain"))
+        {
+            parseResultValue = vuprs::ParseDecimalFromString(channelCalibration["gain"].get<std::string>(), &parseStatus);
+            if (parseStatus) calibration.gain[channel] = parseResultValue;
+            else parseSuccess = false;
+        }
+
+        if (channelCalibration.contains("offset-v"))
+        {
+            parseResultValue = vuprs::ParseDecimalFromString(channelCalibration["offset-v"].get<std::string>(), &parseStatus);
+            if (parseStatus) calibration.offset_v[channel] = parseResultValue;
+            else parseSuccess = false;
+        }
+
+        if (channelCalibration.contains("sensitivity"))
+        {
+            parseResultValue = vuprs::ParseDecimalFromString(channelCalibration["sensitivity"].get<std::string>(), &parseStatus);
+            if (parseStatus) calibration.sensitivity[channel] = parseResultValue;
+            else parseSuccess = false;
+        }
+
+        if (channelCalibration.contains("unit"))
+        {
+            calibration.unit[channel] = channelCalibration["unit"].get<std::string>();
+        }
+    }
+
+    /* Validate */
+
+    if (parseSuccess)
+    {
+        try
+        {
+            vuprs::CheckCalibration(calibration, channelParsed.size());
+        }
+        catch (const std::exception &e)
+        {
+            parseSuccess = false;
+        }
+    }
+
+    calibration.configdown = parseSuccess;
+
+    return parseSuccess;
+}
+
 bool vuprs::FPGAConfigManager::ParseXDMADriverConfig(const nlohmann::json &jsonData)
 {
     bool parseIntegerStatus, parseSuccess = true;
@@ -505,6 +710,34 @@ bool vuprs::FPGAConfigManager::ParseXDMADriverConfig(const nlohmann::json &jsonD
         parseSuccess = false;
     }
 
+    /* Optional: DMA tuning cache (defaults are used until tuned) */
+
+    this->fpgaConfig.xdmaDriverConfig.tuningCacheFilename.clear();
+
+    if (jsonData.contains("tuning-cache-file"))
+    {
+        this->fpgaConfig.xdmaDriverConfig.tuningCacheFilename = jsonData["tuning-cache-file"].get<std::string>();
+    }
+
+    /* Optional: transport (XDMA device files unless a simulated card is selected) */
+
+    this->fpgaConfig.xdmaDriverConfig.transport = FPGA_TRANSPORT__XDMA;
+
+    if (jsonData.contains("transport"))
+    {
+        this->fpgaConfig.xdmaDriverConfig.transport = jsonData["transport"].get<std::string>();
+
+        if (!IS_FPGA_TRANSPORT(this->fpgaConfig.xdmaDriverConfig.transport))
+        {
+            parseSuccess = false;
+        }
+    }
+
+    if (!this->ParseSimulationConfig(jsonData.contains("simulation") ? jsonData["simulation"] : nlohmann::json::object()))
+    {
+        parseSuccess = false;
+    }
+
     if (parseSuccess)
     {
         this->fpgaConfig.xdmaDriverConfig.configdown = true;
@@ -517,6 +750,41 @@ bool vuprs::FPGAConfigManager::ParseXDMADriverConfig(const nlohmann::json &jsonD
     return parseSuccess;
 }
 
+bool vuprs::FPGAConfigManager::ParseSimulationConfig(const nlohmann::json &jsonData)
+{
+    vuprs::FPGASimulationConfig &simulation = this->fpgaConfig.xdmaDriverConfig.simulation;
+    bool parseStatus, parseSuccess = true;
+    double parseResultValue;
+
+    /* Defaults: clean frames, no drift */
+
+    simulation.crcErrorRate = 0;
+    simulation.clockDrift_ppm = 0;
+    simulation.seed = 1;
+
+    if (jsonData.contains("crc-error-rate"))
+    {
+        parseResultValue = vuprs::ParseDecimalFromString(jsonData["crc-error-rate"].get<std::string>(), &parseStatus);
+        if (parseStatus && parseResultValue >= 0 && parseResultValue <= 1) simulation.crcErrorRate = parseResultValue;
+        else parseSuccess = false;
+    }
+
+    if (jsonData.contains("clock-drift-ppm"))
+    {
+        parseResultValue = vuprs::ParseDecimalFromString(jsonData["clock-drift-ppm"].get<std::string>(), &parseStatus);
+        if (parseStatus && parseResultValue > -1e6) simulation.clockDrift_ppm = parseResultValue;
+        else parseSuccess = false;
+    }
+
+    if (jsonData.contains("seed"))
+    {
+        simulation.seed = vuprs::ParseNumberFromString(jsonData["seed"].get<std::string>(), &parseStatus);
+        if (!parseStatus) parseSuccess = false;
+    }
+
+    return parseSuccess;
+}
+
 uint64_t vuprs::ParseHexFromString(const std::string &dataString, bool *status)
 {
     std::string hexString = dataString;
@@ -625,3 +893,36 @@ uint64_t vuprs::ParseNumberFromString(const std::string &dataString, bool *statu
 
     return 0;
 }
+
+double vuprs::ParseDecimalFromString(const std::string &dataString, bool *status)
+{
+    char *parseEnd = nullptr;
+    double parseData = 0;
+
+    if (status != nullptr) (*status) = false;
+
+    if (dataString.empty())
+    {
+        return 0;
+    }
+
+    /* Check Digital Value (decimal or exponent form, no hex / inf / nan) */
+    for (size_t i = 0; i < dataString.length(); i++)
+    {
+        if (!std::isdigit(dataString[i]) && strchr("+-.eE", dataString[i]) == nullptr)
+        {
+            return 0;
+        }
+    }
+
+    parseData = strtod(dataString.c_str(), &parseEnd);
+
+    if (parseEnd != dataString.c_str() + dataString.length() || !std::isfinite(parseData))
+    {
+        return 0;
+    }
+
+    if (status != nullptr) (*status) = true;
+
+    return parseData;
+}
@@ -1,4 +1,7 @@
 #include "fpga_control.h"
+#include "metrics_registry.h"
+#include "trace_recorder.h"
+#include "adc_time.h"
 
 #define __DIRECTION_IS_READ__(DIR) \
 (DIR == "R" || DIR == "READ" || DIR == "RD")
@@ -6,7 +9,43 @@
 #define __DIRECTION_IS_WRITE__(DIR) \
 (DIR == "W" || DIR == "WRITE" || DIR == "WR")
 
-void FreeAll(int fpga_fd, int file_fd, char **allocated);
+/* --------------------------------------------------------------------------------------------------------------- */
+/* ---------------------------------------------------- Metrics -------------------------------------------------- */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+/* Created at startup (static initialization): an idle /metrics exports them as 0 */
+
+static const vuprs::MetricsIOSeries FPGAControl__RegisterReadMetrics("vuprs_register", "AXI-Lite register accesses", {{"direction", "read"}});
+static const vuprs::MetricsIOSeries FPGAControl__RegisterWriteMetrics("vuprs_register", "AXI-Lite register accesses", {{"direction", "write"}});
+static const vuprs::MetricsIOSeries FPGAControl__DMA_C2H_Metrics("vuprs_dma", "AXI-Full DMA transfers", {{"direction", "c2h"}});
+static const vuprs::MetricsIOSeries FPGAControl__DMA_H2C_Metrics("vuprs_dma", "AXI-Full DMA transfers", {{"direction", "h2c"}});
+
+/**
+ * @brief Time an access through the transport, count it (a throwing access counts as failed) & trace it.
+ * @param traceName span name (string literal), the value of the span is byteSize.
+ */
+template <typename Access>
+static bool FPGAControl__CountIO(const vuprs::MetricsIOSeries &series, const char *traceName, const uint64_t &byteSize, const Access &access)
+{
+    VUPRS_TRACE_SPAN_VALUE(traceName, byteSize);
+
+    const int64_t start_ns = vuprs::HostMonotonic_ns();
+    bool ioStatus = false;
+
+    try
+    {
+        ioStatus = access();
+    }
+    catch (...)
+    {
+        series.Count(byteSize, false, vuprs::HostMonotonic_ns() - start_ns);
+        throw;
+    }
+
+    series.Count(byteSize, ioStatus, vuprs::HostMonotonic_ns() - start_ns);
+
+    return ioStatus;
+}
 
 /* --------------------------------------------------------------------------------------------------------------- */
 /* --------------------------------------------- FPGA Controller ------------------------------------------------- */
@@ -19,7 +58,10 @@ vuprs::FPGAController::FPGAController()
 
 vuprs::FPGAController::FPGAController(const std::string &configJsonFilename)
 {
-    this->fpgaConfigManager.LoadFPGAConfigFromJson(configJsonFilename);
+    if (this->fpgaConfigManager.LoadFPGAConfigFromJson(configJsonFilename))
+    {
+        this->ConfigureTransport();
+    }
 }
 
 vuprs::FPGAController::~FPGAController()
@@ -32,12 +74,37 @@ bool vuprs::FPGAController::LoadFPGAConfig(const vuprs::FPGAConfigManager &newFP
     if (newFPGAConfig.ConfigDown())
     {
         this->fpgaConfigManager = newFPGAConfig;
+        this->ConfigureTransport();
         return true;
     }
 
     return false;
 }
 
+void vuprs::FPGAController::ConfigureTransport()
+{
+    const std::string &transportName = this->fpgaConfigManager.fpgaConfig.xdmaDriverConfig.transport;
+
+    /* Reloading a config of the same transport keeps it (state of the simulated card) */
+
+    if (this->transport == nullptr || transportName != this->transport->Name())
+    {
+        this->transport = vuprs::CreateFPGATransport(transportName);
+    }
+
+    this->transport->Configure(this->fpgaConfigManager.fpgaConfig);
+}
+
+const vuprs::FPGAConfigManager &vuprs::FPGAController::GetFPGAConfig() const
+{
+    return this->fpgaConfigManager;
+}
+
+std::string vuprs::FPGAController::TransportName() const
+{
+    return this->transport == nullptr ? std::string() : std::string(this->transport->Name());
+}
+
 /* ------------------------------------------- Read/Write to value ----------------------------------------------- */
 
 uint64_t vuprs::FPGAController::AXILite_GetRegisterOffset(const int &registerSelection, bool *status)
@@ -183,7 +250,7 @@ bool vuprs::FPGAController::AXILite_FPGARegisterIO(
     {
         throw std::runtime_error("Invalid register selection: " + std::to_string(registerSelection));
     }
-    if (!this->fpgaConfigManager.ConfigDown())
+    if (!this->fpgaConfigManager.ConfigDown() || this->transport == nullptr)
     {
         throw std::runtime_error("Config not complete.");
     }
@@ -206,11 +273,8 @@ bool vuprs::FPGAController::AXILite_FPGARegisterIO(
 
     /* ------------------------- Security Check End -------------------------- */
 
-    int fpga_fd = -1, writeReadStatus = -1;
     bool registerCalculateStatus = false;
-    void* mmapBase;
     uint64_t registerTargetOffset = 0;
-    ssize_t currentOffset = -1;
     
     /* Calculate register address */
 
@@ -228,103 +292,39 @@ bool vuprs::FPGAController::AXILite_FPGARegisterIO(
         registerTargetOffset = base + offset;
     }
 
-    /* Open device file (AXI-Lite) */
-
-#ifdef _WIN32
-
-    fpga_fd = open((this->fpgaConfigManager.fpgaConfig.xdmaDriverConfig.deviceFilename_xdma_user).c_str(), O_RDWR | O_BINARY);
-
-#else
-
-    fpga_fd = open((this->fpgaConfigManager.fpgaConfig.xdmaDriverConfig.deviceFilename_xdma_user).c_str(), O_RDWR | O_SYNC);
-
-#endif
-
-    /* Check if device file is open */
-
-    if (fpga_fd < 0)
+    if (registerTargetOffset + sizeof(uint32_t) > __XDMA_AXI_LITE_MMAP_SIZE__)
     {
-        throw std::runtime_error("Cannot open device file: " + this->fpgaConfigManager.fpgaConfig.xdmaDriverConfig.deviceFilename_xdma_user);
+        throw std::runtime_error("AXI-Lite address out of range: " + std::to_string(registerTargetOffset));
     }
 
-    if (!use_mmap)
-    {
-
-        /* Seek to offset relative to AXI-Lite base address in FPGA */
-
-        currentOffset = lseek(fpga_fd, registerTargetOffset, SEEK_SET);
-
-        if (static_cast<uint64_t>(currentOffset) != registerTargetOffset || currentOffset < 0 || currentOffset == (off_t) - 1)
-        {
-            close(fpga_fd);  /* close file */
-            throw std::runtime_error("Seek error.");
-        }
-
-        /* Write data to register */
+    /* Read/Write through the transport (XDMA device file or simulated card) */
 
-        if (__DIRECTION_IS_WRITE__(direction))
-        {
-            writeReadStatus = write(fpga_fd, &w_value, sizeof(uint32_t));  /* All registers are 32 bit */
-        }
-        else if (__DIRECTION_IS_READ__(direction))
-        {
-            if (r_value != nullptr)
-            {
-                writeReadStatus = read(fpga_fd, r_value, sizeof(uint32_t));  /* All registers are 32 bit */
-            }
-        }
-    }
-    else
+    if (__DIRECTION_IS_WRITE__(direction))
     {
-    
-#ifndef _WIN32
-    
-        /* Generate Memory Map */
-
-        void *map_base = mmap(0, __XDMA_AXI_LITE_MMAP_SIZE__, PROT_READ | PROT_WRITE, MAP_SHARED, fpga_fd, 0);
-
-        if (map_base != MAP_FAILED) 
+        return FPGAControl__CountIO(FPGAControl__RegisterWriteMetrics, "register.write", sizeof(uint32_t), [&]()
         {
-            /* Address convert */
-
-            volatile uint32_t *reg_addr = (volatile uint32_t *)((uint8_t *)map_base + registerTargetOffset);
-
-            if (__DIRECTION_IS_READ__(direction)) 
-            {
-                *r_value = *reg_addr;
-            }
-            else 
-            {
-                *reg_addr = w_value;
-            }
-            
-            munmap(map_base, __XDMA_AXI_LITE_MMAP_SIZE__);
-            writeReadStatus = 1;
-        }
-        else
-        {
-            writeReadStatus = -1;
-        }
-
-#endif
-
+            return this->transport->AXILiteWrite(registerTargetOffset, w_value, use_mmap);
+        });
     }
 
-    /* Close */
-
-    if (close(fpga_fd) < 0)
+    if (r_value == nullptr)
     {
-        throw std::runtime_error("Cannot close device file: " + this->fpgaConfigManager.fpgaConfig.xdmaDriverConfig.deviceFilename_xdma_control);
+        return false;
     }
 
-    return writeReadStatus >= 0;
+    return FPGAControl__CountIO(FPGAControl__RegisterReadMetrics, "register.read", sizeof(uint32_t), [&]()
+    {
+        return this->transport->AXILiteRead(registerTargetOffset, r_value, use_mmap);
+    });
 }
 
-bool vuprs::FPGAController::AXIFull_BufferIO(const vuprs::DMATransferConfig &transferConfig, vuprs::AlignedBufferDMA *buffer)
+/**
+ * @brief Config, direction, size, DDR range & DMA channel of a transfer, checked before any buffer is touched.
+ * @throw std::runtime_error, when the transfer is invalid.
+ */
+void vuprs::FPGAController::AXIFull_CheckTransfer(const vuprs::DMATransferConfig &transferConfig)
 {
-    /* ------------------------ Security Check Start ------------------------- */
-
-    if (!this->fpgaConfigManager.ConfigDown())  /* detect at first */
+    if (!this->fpgaConfigManager.ConfigDown() || this->transport == nullptr)  /* detect at first */
     {
         throw std::runtime_error("Config not complete.");
     }
@@ -344,18 +344,7 @@ bool vuprs::FPGAController::AXIFull_BufferIO(const vuprs::DMATransferConfig &tra
         throw std::runtime_error("Read Domain of the DDR overflow.");
     }
 
-    if (buffer == nullptr)
-    {
-        throw std::runtime_error("*Buffer is nullptr.");
-    }
-
-    /* ------------------------- Security Check End -------------------------- */
-
-    int fpga_fd = -1, writeReadStatus = -1, writeReadBytes = 0;
-    uint64_t componentOffset = 0;
-    ssize_t currentOffset = -1;
-    
-    /* Open device file (AXI-Full DMA) */
+    /* Check DMA channel */
 
     if (transferConfig.transferDirectionSelection == DMA_TRANSFER_DIRECTION__FPGA_TO_HOST)
     {
@@ -367,25 +356,6 @@ bool vuprs::FPGAController::AXIFull_BufferIO(const vuprs::DMATransferConfig &tra
                 std::to_string(transferConfig.transferDmaChannel)
             );
         }
-
-        /* Open */
-
-#ifdef _WIN32
-
-        fpga_fd = open((this->fpgaConfigManager.fpgaConfig.xdmaDriverConfig.deviceFilename_xdma_c2h[transferConfig.transferDmaChannel]).c_str(), O_RDWR | O_BINARY);
-
-#else
-
-        fpga_fd = open((this->fpgaConfigManager.fpgaConfig.xdmaDriverConfig.deviceFilename_xdma_c2h[transferConfig.transferDmaChannel]).c_str(), O_RDWR | O_SYNC);
-
-#endif
-
-        /* Check if device file & input/output file is open */
-
-        if (fpga_fd < 0)
-        {
-            throw std::runtime_error("Cannot open device file: " + this->fpgaConfigManager.fpgaConfig.xdmaDriverConfig.deviceFilename_xdma_c2h[transferConfig.transferDmaChannel]);
-        }
     }
 
     else if (transferConfig.transferDirectionSelection == DMA_TRANSFER_DIRECTION__HOST_TO_FPGA)
@@ -398,87 +368,89 @@ bool vuprs::FPGAController::AXIFull_BufferIO(const vuprs::DMATransferConfig &tra
                 std::to_string(transferConfig.transferDmaChannel)
             );
         }
-
-#ifdef _WIN32
-
-        fpga_fd = open((this->fpgaConfigManager.fpgaConfig.xdmaDriverConfig.deviceFilename_xdma_h2c[transferConfig.transferDmaChannel]).c_str(), O_RDWR | O_BINARY);
-    
-#else
-
-        fpga_fd = open((this->fpgaConfigManager.fpgaConfig.xdmaDriverConfig.deviceFilename_xdma_h2c[transferConfig.transferDmaChannel]).c_str(), O_RDWR | O_SYNC);
-
-#endif
-
-        /* Check if device file & input/output file is open */
-
-        if (fpga_fd < 0)
-        {
-            throw std::runtime_error("Cannot open device file: " + this->fpgaConfigManager.fpgaConfig.xdmaDriverConfig.deviceFilename_xdma_h2c[transferConfig.transferDmaChannel]);
-        }
     }
+}
 
-    /* --- Seek --- */
-
-    /* Seek to offset relative to AXI-Full base address in FPGA */
-
-    componentOffset = this->fpgaConfigManager.fpgaConfig.fpgaAddress.busAddress.addrBusBaseAXIFull__DDR + transferConfig.ddrOffset;
-    currentOffset = lseek(fpga_fd, componentOffset, SEEK_SET);
+bool vuprs::FPGAController::AXIFull_BufferIO(const vuprs::DMATransferConfig &transferConfig, vuprs::AlignedBufferDMA *buffer)
+{
+    /* ------------------------ Security Check Start ------------------------- */
 
-    if (static_cast<uint64_t>(currentOffset) != componentOffset || 
-        currentOffset < 0 || 
-        currentOffset == (off_t) - 1)
+    if (buffer == nullptr)
     {
-        close(fpga_fd);
-        throw std::runtime_error("Seek error.");
+        throw std::runtime_error("*Buffer is nullptr.");
     }
 
-    /* --- Read --- */
+    this->AXIFull_CheckTransfer(transferConfig);  /* Before the buffer is (re)allocated */
+
+    /* ------------------------- Security Check End -------------------------- */
 
-    /* Read FPGA data to buffer (READ mode) */
+    /* Read FPGA data to buffer (READ mode), buffer is configured here */
 
     if (transferConfig.transferDirectionSelection == DMA_TRANSFER_DIRECTION__FPGA_TO_HOST)
     {
         if (!buffer->malloc(transferConfig.transferByteSize))
         {
-            close(fpga_fd);
             throw std::runtime_error("Cannot malloc buffer.");
         }
-
-        writeReadBytes = read(fpga_fd, buffer->data(), transferConfig.transferByteSize);
-
-        if (static_cast<uint64_t>(writeReadBytes) != transferConfig.transferByteSize)
-        {
-            close(fpga_fd);
-            return false;
-        }
     }
 
-    /* --- Write --- */
-
-    /* Write buffer data to FPGA (WRITE mode) */
+    /* Write buffer data to FPGA (WRITE mode), data must be written in advance */
 
     else if (transferConfig.transferDirectionSelection == DMA_TRANSFER_DIRECTION__HOST_TO_FPGA)
     {
         if (!buffer->is_allocated())
         {
-            close(fpga_fd);
             throw std::runtime_error("Buffer not allocated.");
         }
-
-        writeReadBytes = write(fpga_fd, buffer->data(), transferConfig.transferByteSize);
-
-        if (static_cast<uint64_t>(writeReadBytes) != transferConfig.transferByteSize)
+        if (transferConfig.transferByteSize > buffer->size())
         {
-            close(fpga_fd);
-            return false;
+            throw std::runtime_error("Write bytes exceed buffer size.");
         }
     }
 
-    /* Free all */
+    return this->AXIFull_PointerIO(transferConfig, buffer->data());
+}
+
+bool vuprs::FPGAController::AXIFull_PointerIO(const vuprs::DMATransferConfig &transferConfig, void *alignedData)
+{
+    /* ------------------------ Security Check Start ------------------------- */
+
+    this->AXIFull_CheckTransfer(transferConfig);
+
+    if (alignedData == nullptr)
+    {
+        throw std::runtime_error("*Data is nullptr.");
+    }
+
+    if (reinterpret_cast<uintptr_t>(alignedData) % __XDMA_DMA_ALIGNMENT_BYTES__ != 0)
+    {
+        throw std::runtime_error("*Data is not aligned to " + std::to_string(__XDMA_DMA_ALIGNMENT_BYTES__) + " bytes.");
+    }
+
+    /* ------------------------- Security Check End -------------------------- */
 
-    close(fpga_fd);
+    uint64_t componentOffset = 0;
 
-    return true;
+    /* Offset relative to AXI-Full base address in FPGA */
+
+    componentOffset = this->fpgaConfigManager.fpgaConfig.fpgaAddress.busAddress.addrBusBaseAXIFull__DDR + transferConfig.ddrOffset;
+
+    /* Read FPGA data to memory (READ mode) */
+
+    if (transferConfig.transferDirectionSelection == DMA_TRANSFER_DIRECTION__FPGA_TO_HOST)
+    {
+        return FPGAControl__CountIO(FPGAControl__DMA_C2H_Metrics, "dma.c2h", transferConfig.transferByteSize, [&]()
+        {
+            return this->transport->AXIFullRead(transferConfig.transferDmaChannel, componentOffset, alignedData, transferConfig.transferByteSize);
+        });
+    }
+
+    /* Write memory data to FPGA (WRITE mode) */
+
+    return FPGAControl__CountIO(FPGAControl__DMA_H2C_Metrics, "dma.h2c", transferConfig.transferByteSize, [&]()
+    {
+        return this->transport->AXIFullWrite(transferConfig.transferDmaChannel, componentOffset, alignedData, transferConfig.transferByteSize);
+    });
 }
 
 /* --------------------------------------------------------------------------------------------------------------- */
@@ -520,3 +492,8 @@ bool vuprs::FPGAController::AXIFull_IO(const vuprs::DMATransferConfig &transferC
 {
     return this->AXIFull_BufferIO(transferConfig, buffer);
 }
+
+bool vuprs::FPGAController::AXIFull_IO(const vuprs::DMATransferConfig &transferConfig, void *alignedData)
+{
+    return this->AXIFull_PointerIO(transferConfig, alignedData);
+}
@@ -1,114 +1,727 @@
 #include "fpga_data_parse.h"
+#include "adc_frame_sync.h"
+#include "adc_frame_crc.h"
+#include "adc_channel_scaling.h"
+#include "metrics_registry.h"
+#include "trace_recorder.h"
+
+#include <thread>
+#include <algorithm>
 
 vuprs::CRC8List globalCRCList(CRC8_POLYNOMIAL_CDMA2000);
 
-bool vuprs::BufferData2ADCChannels(const vuprs::AlignedBufferDMA *buffer, std::vector<std::vector<double>> *result, const vuprs::FPGAhardwareConfigADC &adcFeatures)
+/* --------------------------------------------------------------------------------------------------------------- */
+/* ----------------------------------------------- Frame Layout -------------------------------------------------- */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+vuprs::FPGAhardwareConfigFrame vuprs::DefaultFrameFeatures()
 {
-    /* ------------------------ Security Check Start ------------------------- */
+    vuprs::FPGAhardwareConfigFrame frameFeatures;
 
-    if (buffer->is_allocated() || buffer->size() == 0)
+    frameFeatures.channels = ADC_CHANNELS;
+    frameFeatures.dataWidth_bits = ADC_DATAWIDTH;
+    frameFeatures.header = ADC_DATA_HEADER;
+    frameFeatures.tailer = ADC_DATA_TAILER;
+    frameFeatures.storageOrder = {
+        ADC_CHANNEL__A_1, ADC_CHANNEL__A_2, ADC_CHANNEL__A_3, ADC_CHANNEL__A_4,
+        ADC_CHANNEL__A_5, ADC_CHANNEL__A_6, ADC_CHANNEL__A_7, ADC_CHANNEL__A_8,
+        ADC_CHANNEL__B_1, ADC_CHANNEL__B_2, ADC_CHANNEL__B_3, ADC_CHANNEL__B_4,
+        ADC_CHANNEL__B_5, ADC_CHANNEL__B_6, ADC_CHANNEL__B_7, ADC_CHANNEL__B_8
+    };
+    frameFeatures.configdown = true;
+
+    return frameFeatures;
+}
+
+void vuprs::CheckFrameFeatures(const vuprs::FPGAhardwareConfigFrame &frameFeatures)
+{
+    std::vector<bool> wordUsed;
+
+    if (frameFeatures.channels == 0 || frameFeatures.channels > ADC_FRAME_MAX_CHANNELS)
     {
-        throw std::runtime_error("Buffer is empty, convert disabled");
+        throw std::runtime_error("Invalid frame channels: " + std::to_string(frameFeatures.channels) +
+                                 " (1 ~ " + std::to_string(ADC_FRAME_MAX_CHANNELS) + ")");
+    }
+    if (!IS_ADC_FRAME_DATAWIDTH(frameFeatures.dataWidth_bits))
+    {
+        throw std::runtime_error("Invalid frame data width: " + std::to_string(frameFeatures.dataWidth_bits) + " (16 or 24 bits)");
+    }
+    if (frameFeatures.header > 0xFFFFFFFFULL || frameFeatures.tailer > 0xFFFFFFFFULL || frameFeatures.header == frameFeatures.tailer)
+    {
+        throw std::runtime_error("Frame header & tailer must be different 32-bit words");
+    }
+    if (frameFeatures.storageOrder.size() != frameFeatures.channels)
+    {
+        throw std::runtime_error("Frame storage order needs " + std::to_string(frameFeatures.channels) + " elements, found " +
+                                 std::to_string(frameFeatures.storageOrder.size()));
     }
 
-    if (!adcFeatures.configdown)
+    wordUsed.resize(frameFeatures.channels, false);
+
+    for (uint64_t c = 0; c < frameFeatures.channels; c++)
     {
-        throw std::runtime_error("Do not find ADC features, convert disabled");
+        uint64_t position = frameFeatures.storageOrder[c];
+
+        if (position >= frameFeatures.channels || wordUsed[position])
+        {
+            throw std::runtime_error("Frame storage order is not a permutation of 0 ~ " + std::to_string(frameFeatures.channels - 1) +
+                                     " (channel " + std::to_string(c) + ")");
+        }
+        wordUsed[position] = true;
     }
+}
 
-    /* ------------------------- Security Check End -------------------------- */
+uint32_t vuprs::EncodeADCDataWord(const int32_t &value, const uint64_t &dataWidth_bits)
+{
+    if (dataWidth_bits == 16)
+    {
+        uint32_t code = static_cast<uint16_t>(value);
 
-    /* Convert to uint32_t vector */
+        return (code << 16) |
+               (static_cast<uint32_t>(globalCRCList.CRCValue(static_cast<uint8_t>(code >> 8))) << 8) |
+               static_cast<uint32_t>(globalCRCList.CRCValue(static_cast<uint8_t>(code)));
+    }
 
-    std::vector<uint32_t> originData;
-    std::vector<vuprs::ADCFrame> adcFrames;
-    vuprs::ADCFrame oneADCFrame;
-    uint64_t wordsElements = 0, dataHeaderPointer = 0, dataTailerPointer = 0, adcFrameElements = 0;
-    int16_t signedValue = 0;
+    uint32_t code = static_cast<uint32_t>(value) & 0x00FFFFFFU;
+    uint8_t crc = globalCRCList.CRCValue(static_cast<uint8_t>(code >> 16));
 
-    const std::vector<uint64_t> CHANNEL_MAPPING = {
-        ADC_CHANNEL__A_1, ADC_CHANNEL__A_2, ADC_CHANNEL__A_3, ADC_CHANNEL__A_4,
-        ADC_CHANNEL__A_5, ADC_CHANNEL__A_6, ADC_CHANNEL__A_7, ADC_CHANNEL__A_8,
-        ADC_CHANNEL__B_1, ADC_CHANNEL__B_2, ADC_CHANNEL__B_3, ADC_CHANNEL__B_4,
-        ADC_CHANNEL__B_5, ADC_CHANNEL__B_6, ADC_CHANNEL__B_7, ADC_CHANNEL__B_8
-    };
+    crc = globalCRCList.CRCValue(crc ^ static_cast<uint8_t>(code >> 8));
+    crc = globalCRCList.CRCValue(crc ^ static_cast<uint8_t>(code));
 
-    const double LSB_VALUE = pow(2, ADC_DATAWIDTH) / 2.0;
+    return (code << 8) | crc;
+}
 
-    result->clear();
-    result->resize(ADC_CHANNELS);
+/**
+ * Frame features in the form used by the decode kernels
+ */
+
+typedef struct FPGADataParse__Layout
+{
+    uint64_t channels;
+    uint64_t dataWidth;
+    uint64_t storageOrder[ADC_FRAME_MAX_CHANNELS];
+    bool identityOrder;  /* storageOrder[c] == c, pass masks need no reorder */
+    vuprs::ADCFrameSyncLayout syncLayout;
+};
+
+static FPGADataParse__Layout FPGADataParse__CompileLayout(const vuprs::FPGAhardwareConfigFrame &frameFeatures)
+{
+    FPGADataParse__Layout layout;
+
+    vuprs::CheckFrameFeatures(frameFeatures);
 
-    originData = buffer->to_vector<uint32_t>();
+    layout.channels = frameFeatures.channels;
+    layout.dataWidth = frameFeatures.dataWidth_bits;
+    layout.identityOrder = true;
 
-    if (originData.size() == 0)
+    for (uint64_t c = 0; c < layout.channels; c++)
     {
-        return false;
+        layout.storageOrder[c] = frameFeatures.storageOrder[c];
+        layout.identityOrder = layout.identityOrder && (layout.storageOrder[c] == c);
     }
 
-    wordsElements = originData.size();
-    adcFrames.reserve(wordsElements / (ADC_FRAME_WORD_LENGTH) + 1);
+    layout.syncLayout.header = static_cast<uint32_t>(frameFeatures.header);
+    layout.syncLayout.tailer = static_cast<uint32_t>(frameFeatures.tailer);
+    layout.syncLayout.frameWords = layout.channels + 2;
 
-    /* Check frame, find the process data */
+    return layout;
+}
 
-    dataHeaderPointer = 0;
-    dataTailerPointer = 0;
+static const FPGADataParse__Layout &FPGADataParse__DefaultLayout()
+{
+    static const FPGADataParse__Layout layout = FPGADataParse__CompileLayout(vuprs::DefaultFrameFeatures());
+    return layout;
+}
 
-    while (dataHeaderPointer < wordsElements)
+/* --------------------------------------------------------------------------------------------------------------- */
+/* -------------------------------------------------- Decode ----------------------------------------------------- */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Kernels are templates of <channels, data width>, CHANNELS = 0 takes the channel count of the layout.
+ * Common layouts are instantiated with constants, the compiler unrolls the channel loops.
+ */
+
+template <uint32_t WIDTH>
+static inline int32_t FPGADataParse__Value(const uint32_t &word)
+{
+    return (WIDTH == 16) ? static_cast<int32_t>(static_cast<int16_t>(word >> 16)) : (static_cast<int32_t>(word) >> 8);
+}
+
+template <uint32_t WIDTH>
+static inline bool FPGADataParse__CheckWordCRC(const uint32_t &word)
+{
+    if (WIDTH == 16)
     {
-        if (originData[dataHeaderPointer] == ADC_DATA_HEADER)  /* Find header */
+        return globalCRCList.CRCValue(static_cast<uint8_t>(word >> 24)) == static_cast<uint8_t>(word >> 8) &&
+               globalCRCList.CRCValue(static_cast<uint8_t>(word >> 16)) == static_cast<uint8_t>(word);
+    }
+
+    /* CRC of value[23:16], value[15:8], value[7:0] (no init/xorout: chained table lookups) */
+
+    uint8_t crc = globalCRCList.CRCValue(static_cast<uint8_t>(word >> 24));
+    crc = globalCRCList.CRCValue(crc ^ static_cast<uint8_t>(word >> 16));
+    crc = globalCRCList.CRCValue(crc ^ static_cast<uint8_t>(word >> 8));
+
+    return crc == static_cast<uint8_t>(word);
+}
+
+/**
+ * @brief Pass mask in storage order (bit n = data word n), 16-bit words are checked 16 at once (CheckADCFrameCRC()).
+ */
+template <uint32_t CHANNELS, uint32_t WIDTH>
+static inline uint64_t FPGADataParse__CheckCRC(const uint32_t *dataWords, const uint64_t &layoutChannels)
+{
+    const uint64_t channels = (CHANNELS != 0) ? CHANNELS : layoutChannels;
+    uint64_t passMask = 0, w = 0;
+
+    if (WIDTH == 16)
+    {
+        for (; w + ADC_CHANNELS <= channels; w += ADC_CHANNELS)
         {
-            dataTailerPointer = dataHeaderPointer + ADC_FRAME_WORD_LENGTH - 1;
-            if (dataTailerPointer < wordsElements)
-            {
-                if (originData[dataTailerPointer] == ADC_DATA_TAILER)
-                {
-                    /* Push data */
-                    for (uint64_t i = 0; i < (ADC_FRAME_WORD_LENGTH - 2); i++)
-                    {
-                        oneADCFrame.UpdateData(i, originData[dataHeaderPointer + i]);
-                    }
-                    adcFrames.push_back(oneADCFrame);
-                }
-            }
-        
-            /* Update pointer */
-            
-            dataHeaderPointer = dataTailerPointer + 1;
-            if (dataHeaderPointer >= wordsElements) break;
+            passMask |= static_cast<uint64_t>(vuprs::CheckADCFrameCRC(dataWords + w)) << w;
         }
-        else
+    }
+    for (; w < channels; w++)
+    {
+        passMask |= static_cast<uint64_t>(FPGADataParse__CheckWordCRC<WIDTH>(dataWords[w])) << w;
+    }
+
+    return passMask;
+}
+
+/**
+ * @brief Storage order mask (bit n = data word n) to channel order mask (bit c = result channel c).
+ */
+static inline uint64_t FPGADataParse__ChannelOrderMask(const uint64_t &storageMask, const FPGADataParse__Layout &layout)
+{
+    uint64_t channelMask = 0;
+
+    if (layout.identityOrder)
+    {
+        return storageMask;
+    }
+
+    for (uint64_t j = 0; j < layout.channels; j++)
+    {
+        channelMask |= ((storageMask >> layout.storageOrder[j]) & 1ULL) << j;
+    }
+
+    return channelMask;
+}
+
+static vuprs::MetricsCounter &FPGADataParse__Frames = vuprs::Metrics().Counter("vuprs_parse_frames_total", "ADC frames decoded.");
+static vuprs::MetricsCounter &FPGADataParse__CRCFailedSamples = vuprs::Metrics().Counter("vuprs_parse_crc_failed_samples_total", "Samples whose data word failed the CRC.");
+
+/**
+ * @brief Count decoded frames & CRC failed samples (once per range, not per frame).
+ */
+static void FPGADataParse__CountFrames(const uint64_t &frames, const uint64_t &crcFailedSamples)
+{
+    FPGADataParse__Frames.Add(frames);
+    FPGADataParse__CRCFailedSamples.Add(crcFailedSamples);
+}
+
+/**
+ * @brief Check CRC & write frames [0, frameCount) of a range to samples [outputOffset, ...).
+ */
+template <uint32_t CHANNELS, uint32_t WIDTH, typename T, typename Mask, typename Convert>
+static void FPGADataParse__DecodeRange(const uint32_t *originData, const uint64_t *frameOffsets, const uint64_t &frameCount,
+                                       const FPGADataParse__Layout &layout, T * const *channels, Mask *crcPassMasks,
+                                       const uint64_t &outputOffset, const Convert &convert)
+{
+    const uint64_t channelCount = (CHANNELS != 0) ? CHANNELS : layout.channels;
+    const uint64_t allPassMask = (layout.channels >= 64) ? ~0ULL : ((1ULL << layout.channels) - 1);
+    uint64_t storageMask = 0, crcFailedSamples = 0;
+
+    VUPRS_TRACE_SPAN_VALUE("parse.decode", frameCount);
+
+    for (uint64_t f = 0; f < frameCount; f++)
+    {
+        const uint32_t *dataWords = originData + frameOffsets[f] + 1;
+        const uint64_t i = outputOffset + f;
+
+        storageMask = FPGADataParse__CheckCRC<CHANNELS, WIDTH>(dataWords, layout.channels);
+
+        if (storageMask != allPassMask)
+        {
+            crcFailedSamples += __builtin_popcountll(~storageMask & allPassMask);  /* Rare, off the fast path */
+        }
+
+        for (uint64_t j = 0; j < channelCount; j++)
+        {
+            channels[j][i] = convert(FPGADataParse__Value<WIDTH>(dataWords[layout.storageOrder[j]]),
+                                     ((storageMask >> layout.storageOrder[j]) & 1ULL) != 0);
+        }
+        if (crcPassMasks != nullptr)
         {
-            dataHeaderPointer++;
-            if (dataHeaderPointer >= wordsElements) break;
+            crcPassMasks[i] = static_cast<Mask>(FPGADataParse__ChannelOrderMask(storageMask, layout));
         }
     }
 
-    if (adcFrames.size() == 0)
+    FPGADataParse__CountFrames(frameCount, crcFailedSamples);
+}
+
+template <typename T, typename Mask, typename Convert>
+static void FPGADataParse__DecodeRangeDispatch(const uint32_t *originData, const uint64_t *frameOffsets, const uint64_t &frameCount,
+                                               const FPGADataParse__Layout &layout, T * const *channels, Mask *crcPassMasks,
+                                               const uint64_t &outputOffset, const Convert &convert)
+{
+    if (layout.dataWidth == 16)
+    {
+        switch (layout.channels)
+        {
+            case 16: FPGADataParse__DecodeRange<16, 16>(originData, frameOffsets, frameCount, layout, channels, crcPassMasks, outputOffset, convert); break;
+            case 32: FPGADataParse__DecodeRange<32, 16>(originData, frameOffsets, frameCount, layout, channels, crcPassMasks, outputOffset, convert); break;
+            default: FPGADataParse__DecodeRange<0, 16>(originData, frameOffsets, frameCount, layout, channels, crcPassMasks, outputOffset, convert); break;
+        }
+    }
+    else
+    {
+        switch (layout.channels)
+        {
+            case 16: FPGADataParse__DecodeRange<16, 24>(originData, frameOffsets, frameCount, layout, channels, crcPassMasks, outputOffset, convert); break;
+            case 32: FPGADataParse__DecodeRange<32, 24>(originData, frameOffsets, frameCount, layout, channels, crcPassMasks, outputOffset, convert); break;
+            default: FPGADataParse__DecodeRange<0, 24>(originData, frameOffsets, frameCount, layout, channels, crcPassMasks, outputOffset, convert); break;
+        }
+    }
+}
+
+/**
+ * @brief Word view of the buffer (no copy).
+ */
+static const uint32_t *FPGADataParse__BufferWords(const vuprs::AlignedBufferDMA *buffer, uint64_t *wordsElements)
+{
+    if (buffer == nullptr || !buffer->is_allocated() || buffer->size() == 0)
+    {
+        throw std::runtime_error("Buffer is empty, convert disabled");
+    }
+
+    *wordsElements = buffer->size() / sizeof(uint32_t);
+    return buffer->as<uint32_t>();
+}
+
+/**
+ * @brief Locate frames, check CRC & write every channel with <convert>(value, crcPass).
+ * @param crcPassMasks channel order pass mask of every frame (optional).
+ * @param threadCount 1 = this thread only, see LocateADCFramesParallel().
+ */
+template <typename T, typename Mask, typename Convert>
+static bool FPGADataParse__Decode(const uint32_t *originData, const uint64_t &wordsElements, const FPGADataParse__Layout &layout,
+                                  vuprs::ADCChannelBuffer<T> *result, std::vector<Mask> *crcPassMasks, const uint32_t &threadCount,
+                                  const Convert &convert, uint64_t *stopPosition = nullptr)
+{
+    /* ------------------------ Security Check Start ------------------------- */
+
+    if (originData == nullptr && wordsElements != 0)
+    {
+        throw std::runtime_error("*Words is nullptr.");
+    }
+
+    if (result == nullptr)
+    {
+        throw std::runtime_error("*Result is nullptr.");
+    }
+
+    /* ------------------------- Security Check End -------------------------- */
+
+    uint64_t adcFrameElements = 0, stop = 0;
+    T *channels[ADC_FRAME_MAX_CHANNELS];
+    Mask *crcPassMasksData = nullptr;
+    std::vector<std::thread> threads;
+
+    /* Scratch of this thread, capacity is kept between calls */
+
+    thread_local std::vector<std::vector<uint64_t>> rangeFrameOffsets;
+    thread_local std::vector<uint64_t> rangeOutputOffsets;
+
+    result->set_channels(layout.channels);
+    result->clear();
+
+    if (crcPassMasks != nullptr)
+    {
+        crcPassMasks->clear();
+    }
+
+    if (stopPosition != nullptr)
+    {
+        *stopPosition = 0;
+    }
+
+    if (wordsElements == 0)
     {
         return false;
     }
 
-    /* Calculate voltage */
+    /* Check frame, find the process data (one list per range) */
 
-    adcFrameElements = adcFrames.size();
+    if (threadCount == 1)
+    {
+        VUPRS_TRACE_SPAN_VALUE("parse.locate", wordsElements);
 
-    for (uint64_t i = 0; i < adcFrameElements; i++)
+        rangeFrameOffsets.resize(1);
+        rangeFrameOffsets[0].clear();
+        rangeFrameOffsets[0].reserve(wordsElements / layout.syncLayout.frameWords + 1);
+        stop = vuprs::LocateADCFrames(originData, wordsElements, &rangeFrameOffsets[0], layout.syncLayout);
+    }
+    else
+    {
+        VUPRS_TRACE_SPAN_VALUE("parse.locate", wordsElements);
+        stop = vuprs::LocateADCFramesParallel(originData, wordsElements, threadCount, &rangeFrameOffsets, layout.syncLayout);
+    }
+
+    if (stopPosition != nullptr)
+    {
+        *stopPosition = stop;
+    }
+
+    /* Output offset of every range (prefix sum) */
+
+    rangeOutputOffsets.resize(rangeFrameOffsets.size());
+
+    for (uint64_t k = 0; k < rangeFrameOffsets.size(); k++)
+    {
+        rangeOutputOffsets[k] = adcFrameElements;
+        adcFrameElements += rangeFrameOffsets[k].size();
+    }
+
+    if (adcFrameElements == 0)
+    {
+        return false;
+    }
+
+    /* Write samples, channel-major, every range into its own part of the result */
+
+    result->resize(adcFrameElements);
+
+    for (uint64_t j = 0; j < layout.channels; j++)
     {
-        (*result)[i].resize(adcFrameElements);  /* Resize each channel */
+        channels[j] = result->channel(j);
+    }
 
-        for (uint64_t j = 0; j < ADC_CHANNELS; j++)
+    if (crcPassMasks != nullptr)
+    {
+        crcPassMasks->resize(adcFrameElements);
+        crcPassMasksData = crcPassMasks->data();
+    }
+
+    if (rangeFrameOffsets.size() == 1)
+    {
+        FPGADataParse__DecodeRangeDispatch(originData, rangeFrameOffsets[0].data(), rangeFrameOffsets[0].size(),
+                                           layout, channels, crcPassMasksData, 0, convert);
+        return true;
+    }
+
+    for (uint64_t k = 0; k < rangeFrameOffsets.size(); k++)
+    {
+        const std::vector<uint64_t> &frameOffsets = rangeFrameOffsets[k];
+        const uint64_t outputOffset = rangeOutputOffsets[k];
+
+        threads.emplace_back([&, outputOffset]()
         {
-            if (adcFrames[i].CheckCRC(CHANNEL_MAPPING[j]))
-            {
-                signedValue = static_cast<int16_t>(adcFrames[i].GetChannelValue(CHANNEL_MAPPING[j]));
-                (*result)[j][i] = static_cast<double>(signedValue) * adcFeatures.adcVoltageRangeRadius / LSB_VALUE;
-            }
-            else
-            {
-                (*result)[j][i] = adcFeatures.adcVoltageRangeRadius;
-            }
+            FPGADataParse__DecodeRangeDispatch(originData, frameOffsets.data(), frameOffsets.size(),
+                                               layout, channels, crcPassMasksData, outputOffset, convert);
+        });
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    return true;
+}
+
+/**
+ * @brief Volts of the ADC codes: code * radius / 2^(width-1), radius when the CRC is broken.
+ */
+static bool FPGADataParse__DecodeVoltage(const uint32_t *originData, const uint64_t &wordsElements, const FPGADataParse__Layout &layout,
+                                         vuprs::ADCChannelBuffer<double> *result, const vuprs::FPGAhardwareConfigADC &adcFeatures,
+                                         const uint32_t &threadCount, uint64_t *stopPosition = nullptr)
+{
+    /* ------------------------ Security Check Start ------------------------- */
+
+    if (!adcFeatures.configdown)
+    {
+        throw std::runtime_error("Do not find ADC features, convert disabled");
+    }
+
+    /* ------------------------- Security Check End -------------------------- */
+
+    const double LSB_VALUE = pow(2, layout.dataWidth) / 2.0;
+    const double VOLTAGE_PER_LSB = adcFeatures.adcVoltageRangeRadius / LSB_VALUE;
+    const double CRC_FAIL_VOLTAGE = adcFeatures.adcVoltageRangeRadius;
+
+    return FPGADataParse__Decode(originData, wordsElements, layout, result, static_cast<std::vector<uint64_t>*>(nullptr), threadCount,
+                                 [VOLTAGE_PER_LSB, CRC_FAIL_VOLTAGE](const int32_t &value, const bool &crcPass)
+    {
+        return crcPass ? static_cast<double>(value) * VOLTAGE_PER_LSB : CRC_FAIL_VOLTAGE;
+    }, stopPosition);
+}
+
+/**
+ * @brief Codes -> physical values of samples [firstSample, ...): per channel multiply-add over the samples (still in
+ *        cache), NaN stays NaN.
+ */
+static void FPGADataParse__Calibrate(vuprs::ADCChannelBuffer<double> *result, const uint64_t &firstSample, const double &voltagePerLSB,
+                                     const vuprs::FPGAhardwareConfigCalibration &calibration)
+{
+    for (uint64_t c = 0; c < result->channels(); c++)
+    {
+        const double scale = voltagePerLSB * calibration.gain[c] * calibration.sensitivity[c];
+        const double offset = calibration.offset_v[c] * calibration.sensitivity[c];
+        double *samples = result->channel(c);
+
+        for (uint64_t i = firstSample; i < result->samples(); i++)
+        {
+            samples[i] = samples[i] * scale + offset;
         }
     }
+}
+
+/**
+ * @brief Physical values of the ADC codes: (code * radius / 2^(width-1) * gain + offset_v) * sensitivity, NaN when the
+ *        CRC is broken (same fold as ADCChannelScalingFromCalibration(), for any frame layout).
+ */
+static bool FPGADataParse__DecodeCalibrated(const uint32_t *originData, const uint64_t &wordsElements, const FPGADataParse__Layout &layout,
+                                            vuprs::ADCChannelBuffer<double> *result, const vuprs::FPGAhardwareConfigADC &adcFeatures,
+                                            const vuprs::FPGAhardwareConfigCalibration &calibration,
+                                            const uint32_t &threadCount, uint64_t *stopPosition = nullptr)
+{
+    /* ------------------------ Security Check Start ------------------------- */
+
+    if (!adcFeatures.configdown)
+    {
+        throw std::runtime_error("Do not find ADC features, convert disabled");
+    }
+    if (!calibration.configdown)
+    {
+        throw std::runtime_error("Do not find calibration, convert disabled");
+    }
+
+    vuprs::CheckCalibration(calibration, layout.channels);
+
+    /* ------------------------- Security Check End -------------------------- */
+
+    const double VOLTAGE_PER_LSB = adcFeatures.adcVoltageRangeRadius / (pow(2, layout.dataWidth) / 2.0);
+    const double CRC_FAIL_VALUE = std::numeric_limits<double>::quiet_NaN();
+
+    bool decoded = FPGADataParse__Decode(originData, wordsElements, layout, result, static_cast<std::vector<uint64_t>*>(nullptr), threadCount,
+                                         [CRC_FAIL_VALUE](const int32_t &value, const bool &crcPass)
+    {
+        return crcPass ? static_cast<double>(value) : CRC_FAIL_VALUE;
+    }, stopPosition);
+
+    if (decoded)
+    {
+        FPGADataParse__Calibrate(result, 0, VOLTAGE_PER_LSB, calibration);
+    }
+
+    return decoded;
+}
+
+/**
+ * @brief Check CRC & append located frames to result (no frame search).
+ */
+template <typename Convert>
+static void FPGADataParse__DecodeFrames(const uint32_t *words, const uint64_t *frameOffsets, const uint64_t &frameCount,
+                                        const FPGADataParse__Layout &layout, vuprs::ADCChannelBuffer<double> *result, const Convert &convert)
+{
+    /* ------------------------ Security Check Start ------------------------- */
+
+    if ((words == nullptr || frameOffsets == nullptr) && frameCount != 0)
+    {
+        throw std::runtime_error("*Words or *FrameOffsets is nullptr.");
+    }
+
+    if (result == nullptr)
+    {
+        throw std::runtime_error("*Result is nullptr.");
+    }
+
+    /* ------------------------- Security Check End -------------------------- */
+
+    const uint64_t outputOffset = (result->channels() == layout.channels) ? result->samples() : 0;
+    double *channels[ADC_FRAME_MAX_CHANNELS];
+
+    result->set_channels(layout.channels);
+    result->resize(outputOffset + frameCount);
+
+    for (uint64_t j = 0; j < layout.channels; j++)
+    {
+        channels[j] = result->channel(j);
+    }
+
+    FPGADataParse__DecodeRangeDispatch(words, frameOffsets, frameCount, layout, channels, static_cast<uint64_t*>(nullptr), outputOffset, convert);
+}
+
+static FPGADataParse__Layout FPGADataParse__CompileFrameFeatures(const vuprs::FPGAhardwareConfigFrame &frameFeatures)
+{
+    if (!frameFeatures.configdown)
+    {
+        throw std::runtime_error("Do not find frame features, convert disabled");
+    }
+
+    return FPGADataParse__CompileLayout(frameFeatures);
+}
+
+/* Default layout (ADC_CHANNELS, ADC_DATAWIDTH, ADC_CHANNEL__xxx) */
+
+bool vuprs::BufferData2ADCChannels(const vuprs::AlignedBufferDMA *buffer, vuprs::ADCChannelBuffer<double> *result, const vuprs::FPGAhardwareConfigADC &adcFeatures,
+                                   const uint32_t &threadCount)
+{
+    uint64_t wordsElements = 0;
+    const uint32_t *originData = FPGADataParse__BufferWords(buffer, &wordsElements);
+
+    return FPGADataParse__DecodeVoltage(originData, wordsElements, FPGADataParse__DefaultLayout(), result, adcFeatures, threadCount);
+}
+
+bool vuprs::BufferData2ADCChannels(const vuprs::AlignedBufferDMA *buffer, vuprs::ADCChannelBuffer<int16_t> *result, std::vector<uint16_t> *crcPassMasks,
+                                   const uint32_t &threadCount)
+{
+    uint64_t wordsElements = 0;
+    const uint32_t *originData = FPGADataParse__BufferWords(buffer, &wordsElements);
+
+    return FPGADataParse__Decode(originData, wordsElements, FPGADataParse__DefaultLayout(), result, crcPassMasks, threadCount, [](const int32_t &value, const bool &)
+    {
+        return static_cast<int16_t>(value);
+    });
+}
+
+bool vuprs::BufferData2ADCChannels(const vuprs::AlignedBufferDMA *buffer, vuprs::ADCChannelBuffer<float> *result, std::vector<uint16_t> *crcPassMasks,
+                                   const uint32_t &threadCount)
+{
+    uint64_t wordsElements = 0;
+    const uint32_t *originData = FPGADataParse__BufferWords(buffer, &wordsElements);
+
+    return FPGADataParse__Decode(originData, wordsElements, FPGADataParse__DefaultLayout(), result, crcPassMasks, threadCount, [](const int32_t &value, const bool &)
+    {
+        return static_cast<float>(value);
+    });
+}
+
+/* Layout of the frame features */
+
+bool vuprs::BufferData2ADCChannels(const vuprs::AlignedBufferDMA *buffer, vuprs::ADCChannelBuffer<double> *result, const vuprs::FPGAhardwareConfigADC &adcFeatures,
+                                   const vuprs::FPGAhardwareConfigFrame &frameFeatures, const uint32_t &threadCount)
+{
+    uint64_t wordsElements = 0;
+    const uint32_t *originData = FPGADataParse__BufferWords(buffer, &wordsElements);
+
+    return FPGADataParse__DecodeVoltage(originData, wordsElements, FPGADataParse__CompileFrameFeatures(frameFeatures), result, adcFeatures, threadCount);
+}
+
+bool vuprs::BufferData2ADCChannels(const vuprs::AlignedBufferDMA *buffer, vuprs::ADCChannelBuffer<int32_t> *result, std::vector<uint64_t> *crcPassMasks,
+                                   const vuprs::FPGAhardwareConfigFrame &frameFeatures, const uint32_t &threadCount)
+{
+    uint64_t wordsElements = 0;
+    const uint32_t *originData = FPGADataParse__BufferWords(buffer, &wordsElements);
+
+    return FPGADataParse__Decode(originData, wordsElements, FPGADataParse__CompileFrameFeatures(frameFeatures), result, crcPassMasks, threadCount,
+                                 [](const int32_t &value, const bool &)
+    {
+        return value;
+    });
+}
+
+bool vuprs::BufferData2ADCChannels(const vuprs::AlignedBufferDMA *buffer, vuprs::ADCChannelBuffer<float> *result, std::vector<uint64_t> *crcPassMasks,
+                                   const vuprs::FPGAhardwareConfigFrame &frameFeatures, const uint32_t &threadCount)
+{
+    uint64_t wordsElements = 0;
+    const uint32_t *originData = FPGADataParse__BufferWords(buffer, &wordsElements);
+
+    return FPGADataParse__Decode(originData, wordsElements, FPGADataParse__CompileFrameFeatures(frameFeatures), result, crcPassMasks, threadCount,
+                                 [](const int32_t &value, const bool &)
+    {
+        return static_cast<float>(value);
+    });
+}
+
+/* Word range (chunks of a stream) */
+
+bool vuprs::WordsData2ADCChannels(const uint32_t *words, const uint64_t &wordCount, vuprs::ADCChannelBuffer<double> *result,
+                                  const vuprs::FPGAhardwareConfigADC &adcFeatures, const vuprs::FPGAhardwareConfigFrame &frameFeatures,
+                                  uint64_t *stopPosition, const uint32_t &threadCount)
+{
+    return FPGADataParse__DecodeVoltage(words, wordCount, FPGADataParse__CompileFrameFeatures(frameFeatures), result, adcFeatures,
+                                        threadCount, stopPosition);
+}
+
+bool vuprs::WordsData2ADCChannels(const uint32_t *words, const uint64_t &wordCount, vuprs::ADCChannelBuffer<double> *result,
+                                  const vuprs::FPGAhardwareConfigADC &adcFeatures, const vuprs::FPGAhardwareConfigFrame &frameFeatures,
+                                  const vuprs::FPGAhardwareConfigCalibration &calibration, uint64_t *stopPosition, const uint32_t &threadCount)
+{
+    return FPGADataParse__DecodeCalibrated(words, wordCount, FPGADataParse__CompileFrameFeatures(frameFeatures), result, adcFeatures,
+                                           calibration, threadCount, stopPosition);
+}
+
+/* Located frames (chunks of ADCStreamParser) */
+
+void vuprs::FramesData2ADCChannels(const uint32_t *words, const uint64_t *frameOffsets, const uint64_t &frameCount,
+                                   vuprs::ADCChannelBuffer<double> *result, const vuprs::FPGAhardwareConfigADC &adcFeatures,
+                                   const vuprs::FPGAhardwareConfigFrame &frameFeatures)
+{
+    if (!adcFeatures.configdown)
+    {
+        throw std::runtime_error("Do not find ADC features, convert disabled");
+    }
+
+    const FPGADataParse__Layout layout = FPGADataParse__CompileFrameFeatures(frameFeatures);
+    const double VOLTAGE_PER_LSB = adcFeatures.adcVoltageRangeRadius / (pow(2, layout.dataWidth) / 2.0);
+    const double CRC_FAIL_VOLTAGE = adcFeatures.adcVoltageRangeRadius;
+
+    FPGADataParse__DecodeFrames(words, frameOffsets, frameCount, layout, result, [VOLTAGE_PER_LSB, CRC_FAIL_VOLTAGE](const int32_t &value, const bool &crcPass)
+    {
+        return crcPass ? static_cast<double>(value) * VOLTAGE_PER_LSB : CRC_FAIL_VOLTAGE;
+    });
+}
+
+void vuprs::FramesData2ADCChannels(const uint32_t *words, const uint64_t *frameOffsets, const uint64_t &frameCount,
+                                   vuprs::ADCChannelBuffer<double> *result, const vuprs::FPGAhardwareConfigADC &adcFeatures,
+                                   const vuprs::FPGAhardwareConfigFrame &frameFeatures, const vuprs::FPGAhardwareConfigCalibration &calibration)
+{
+    if (!adcFeatures.configdown)
+    {
+        throw std::runtime_error("Do not find ADC features, convert disabled");
+    }
+    if (!calibration.configdown)
+    {
+        throw std::runtime_error("Do not find calibration, convert disabled");
+    }
+
+    const FPGADataParse__Layout layout = FPGADataParse__CompileFrameFeatures(frameFeatures);
+    const double VOLTAGE_PER_LSB = adcFeatures.adcVoltageRangeRadius / (pow(2, layout.dataWidth) / 2.0);
+    const double CRC_FAIL_VALUE = std::numeric_limits<double>::quiet_NaN();
+    const uint64_t firstSample = (result != nullptr && result->channels() == layout.channels) ? result->samples() : 0;
+
+    vuprs::CheckCalibration(calibration, layout.channels);
+
+    FPGADataParse__DecodeFrames(words, frameOffsets, frameCount, layout, result, [CRC_FAIL_VALUE](const int32_t &value, const bool &crcPass)
+    {
+        return crcPass ? static_cast<double>(value) : CRC_FAIL_VALUE;
+    });
+
+    FPGADataParse__Calibrate(result, firstSample, VOLTAGE_PER_LSB, calibration);
+}
+
+bool vuprs::BufferData2ADCChannels(const vuprs::AlignedBufferDMA *buffer, std::vector<std::vector<double>> *result, const vuprs::FPGAhardwareConfigADC &adcFeatures)
+{
+    thread_local vuprs::ADCChannelBuffer<double> channelBuffer;
+
+    bool converted = vuprs::BufferData2ADCChannels(buffer, &channelBuffer, adcFeatures);
+
+    result->clear();
+    result->resize(ADC_CHANNELS);
+
+    if (!converted)
+    {
+        return false;
+    }
+
+    for (uint64_t j = 0; j < ADC_CHANNELS; j++)
+    {
+        vuprs::ADCChannelSpan<double> samples = channelBuffer.span(j);
+        (*result)[j].assign(samples.begin(), samples.end());
+    }
 
     return true;
 }
@@ -164,18 +777,10 @@ uint8_t vuprs::CRC8List::CRCValue(const uint8_t &source)
 
 vuprs::ADCFrame::ADCFrame()
 {
-    this->adcData.resize(ADC_FRAME_WORD_LENGTH - 2);
-
-    this->crcDataH.resize(ADC_FRAME_WORD_LENGTH - 2);
-    this->crcDataL.resize(ADC_FRAME_WORD_LENGTH - 2);
-}
-
-vuprs::ADCFrame::~ADCFrame()
-{
-    this->adcData.clear();
+    this->adcData.fill(0);
 
-    this->crcDataH.clear();
-    this->crcDataL.clear();
+    this->crcDataH.fill(0);
+    this->crcDataL.fill(0);
 }
 
 bool vuprs::ADCFrame::CheckCRC(const int &channel)
@@ -215,6 +820,16 @@ void vuprs::ADCFrame::UpdateData(const int &index, const uint32_t &data)
     }
 }
 
+void vuprs::ADCFrame::UpdateFrame(const uint32_t *dataWords)
+{
+    for (uint32_t i = 0; i < ADC_CHANNELS; i++)
+    {
+        this->adcData[i] = (uint16_t)((dataWords[i] & 0xFFFF0000) >> 16);
+        this->crcDataH[i] = (uint8_t)((dataWords[i] & 0x0000FF00) >> 8);
+        this->crcDataL[i] = (uint8_t)((dataWords[i] & 0x000000FF));
+    }
+}
+
 uint16_t vuprs::ADCFrame::GetChannelValue(const int &channel)
 {
     if (IS_ADC_CHANNEL(channel))
@@ -0,0 +1,507 @@
+#include "fpga_dma_sg.h"
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* ------------------------------------------ SG Descriptor Ring ------------------------------------------------- */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+vuprs::SGDescriptorRingS2MM::SGDescriptorRingS2MM()
+{
+    this->ringConfig = vuprs::SGRingConfigS2MM();
+    this->axiDdrBaseAddress = 0;
+    this->harvestIndex = 0;
+    this->releaseIndex = 0;
+    this->hardwareOwned = 0;
+    this->configured = false;
+}
+
+vuprs::SGDescriptorRingS2MM::~SGDescriptorRingS2MM()
+{
+
+}
+
+bool vuprs::SGDescriptorRingS2MM::Configure(const vuprs::SGRingConfigS2MM &config, const uint64_t &axiDdrBaseAddress, const uint64_t &ddrCapacityBytes)
+{
+    uint64_t ringBytes = 0, bufferBytes = 0;
+
+    this->configured = false;
+
+    /* ------------------------ Security Check Start ------------------------- */
+
+    if (config.descriptorCount < 2)
+    {
+        return false;
+    }
+    if (config.descriptorDdrOffset % SG_DESCRIPTOR_BYTES != 0)
+    {
+        return false;
+    }
+    if (config.bufferByteSize == 0 || config.bufferByteSize > SG_DESCRIPTOR_LENGTH_MASK)
+    {
+        return false;
+    }
+
+    ringBytes = static_cast<uint64_t>(config.descriptorCount) * SG_DESCRIPTOR_BYTES;
+    bufferBytes = static_cast<uint64_t>(config.descriptorCount) * config.bufferByteSize;
+
+    if (config.descriptorDdrOffset + ringBytes > ddrCapacityBytes || config.bufferDdrOffset + bufferBytes > ddrCapacityBytes)
+    {
+        return false;
+    }
+
+    /* Descriptors & buffers must not overlap */
+
+    if (config.descriptorDdrOffset < config.bufferDdrOffset + bufferBytes && config.bufferDdrOffset < config.descriptorDdrOffset + ringBytes)
+    {
+        return false;
+    }
+
+    /* ------------------------- Security Check End -------------------------- */
+
+    this->ringConfig = config;
+    this->axiDdrBaseAddress = axiDdrBaseAddress;
+    this->configured = true;
+    this->Reset();
+
+    return true;
+}
+
+void vuprs::SGDescriptorRingS2MM::Reset()
+{
+    this->harvestIndex = 0;
+    this->releaseIndex = 0;
+    this->hardwareOwned = this->configured ? this->ringConfig.descriptorCount : 0;
+}
+
+bool vuprs::SGDescriptorRingS2MM::IsConfigured() const
+{
+    return this->configured;
+}
+
+const vuprs::SGRingConfigS2MM &vuprs::SGDescriptorRingS2MM::GetRingConfig() const
+{
+    return this->ringConfig;
+}
+
+uint64_t vuprs::SGDescriptorRingS2MM::DescriptorDDROffset(const uint32_t &index) const
+{
+    return this->ringConfig.descriptorDdrOffset + static_cast<uint64_t>(index % this->ringConfig.descriptorCount) * SG_DESCRIPTOR_BYTES;
+}
+
+uint64_t vuprs::SGDescriptorRingS2MM::DescriptorAXIAddress(const uint32_t &index) const
+{
+    return this->axiDdrBaseAddress + this->DescriptorDDROffset(index);
+}
+
+uint64_t vuprs::SGDescriptorRingS2MM::BufferDDROffset(const uint32_t &index) const
+{
+    return this->ringConfig.bufferDdrOffset + static_cast<uint64_t>(index % this->ringConfig.descriptorCount) * this->ringConfig.bufferByteSize;
+}
+
+uint64_t vuprs::SGDescriptorRingS2MM::TailDescriptorAXIAddress() const
+{
+    if (this->ringConfig.cyclicMode)
+    {
+        /* Any address outside the chain */
+        return this->axiDdrBaseAddress + this->ringConfig.descriptorDdrOffset + static_cast<uint64_t>(this->ringConfig.descriptorCount) * SG_DESCRIPTOR_BYTES;
+    }
+
+    /* The armed span ends right before the release index */
+
+    return this->DescriptorAXIAddress(this->releaseIndex + this->ringConfig.descriptorCount - 1);
+}
+
+void vuprs::SGDescriptorRingS2MM::BuildDescriptors(const uint32_t &firstIndex, const uint32_t &count, uint32_t *image) const
+{
+    if (!this->configured)
+    {
+        throw std::runtime_error("Descriptor ring not configured.");
+    }
+    if (image == nullptr || firstIndex >= this->ringConfig.descriptorCount || firstIndex + count > this->ringConfig.descriptorCount)
+    {
+        throw std::out_of_range("Invalid descriptor range.");
+    }
+
+    uint64_t nextDescriptor = 0, bufferAddress = 0;
+    uint32_t *descriptor = nullptr;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        descriptor = image + static_cast<uint64_t>(i) * SG_DESCRIPTOR_WORDS;
+        std::memset(descriptor, 0, SG_DESCRIPTOR_BYTES);
+
+        nextDescriptor = this->DescriptorAXIAddress(firstIndex + i + 1);  /* Last descriptor points back to the first */
+        bufferAddress = this->axiDdrBaseAddress + this->BufferDDROffset(firstIndex + i);
+
+        descriptor[SG_DESCRIPTOR__NXTDESC] = static_cast<uint32_t>(nextDescriptor & 0xFFFFFFFFULL);
+        descriptor[SG_DESCRIPTOR__NXTDESC_MSB] = static_cast<uint32_t>(nextDescriptor >> 32);
+        descriptor[SG_DESCRIPTOR__BUFFER_ADDRESS] = static_cast<uint32_t>(bufferAddress & 0xFFFFFFFFULL);
+        descriptor[SG_DESCRIPTOR__BUFFER_ADDRESS_MSB] = static_cast<uint32_t>(bufferAddress >> 32);
+        descriptor[SG_DESCRIPTOR__CONTROL] = static_cast<uint32_t>(this->ringConfig.bufferByteSize) & SG_DESCRIPTOR_LENGTH_MASK;
+        descriptor[SG_DESCRIPTOR__STATUS] = 0;  /* Cmplt cleared: armed */
+    }
+}
+
+void vuprs::SGDescriptorRingS2MM::HarvestWindow(uint32_t *firstIndex, uint32_t *count) const
+{
+    if (firstIndex != nullptr) *firstIndex = this->harvestIndex;
+    if (count != nullptr) *count = this->hardwareOwned;
+}
+
+uint32_t vuprs::SGDescriptorRingS2MM::Harvest(const uint32_t &firstIndex, const uint32_t &count, const uint32_t *image, std::vector<vuprs::SGCompletedBlock> *completed)
+{
+    if (!this->configured || image == nullptr || firstIndex != this->harvestIndex)
+    {
+        return 0;
+    }
+
+    uint32_t harvested = 0, status = 0, index = 0;
+    uint32_t scanCount = std::min(count, this->hardwareOwned);
+    vuprs::SGCompletedBlock block;
+
+    for (uint32_t i = 0; i < scanCount; i++)
+    {
+        status = image[static_cast<uint64_t>(i) * SG_DESCRIPTOR_WORDS + SG_DESCRIPTOR__STATUS];
+
+        if (!(status & SG_DESCRIPTOR_STATUS__CMPLT))
+        {
+            break;  /* Descriptors complete in order */
+        }
+
+        index = (firstIndex + i) % this->ringConfig.descriptorCount;
+
+        block.descriptorIndex = index;
+        block.ddrOffset = this->BufferDDROffset(index);
+        block.transferredBytes = status & SG_DESCRIPTOR_LENGTH_MASK;
+        block.status = status;
+
+        if (completed != nullptr)
+        {
+            completed->push_back(block);
+        }
+        harvested++;
+    }
+
+    this->harvestIndex = (this->harvestIndex + harvested) % this->ringConfig.descriptorCount;
+    this->hardwareOwned -= harvested;
+
+    return harvested;
+}
+
+uint32_t vuprs::SGDescriptorRingS2MM::Release(const uint32_t &count, uint32_t *firstIndex)
+{
+    uint32_t releaseCount = std::min(count, this->PendingRelease());
+
+    if (firstIndex != nullptr)
+    {
+        *firstIndex = this->releaseIndex;
+    }
+    if (!this->configured)
+    {
+        return 0;
+    }
+
+    this->releaseIndex = (this->releaseIndex + releaseCount) % this->ringConfig.descriptorCount;
+    this->hardwareOwned += releaseCount;
+
+    return releaseCount;
+}
+
+uint32_t vuprs::SGDescriptorRingS2MM::PendingRelease() const
+{
+    return this->configured ? this->ringConfig.descriptorCount - this->hardwareOwned : 0;
+}
+
+uint32_t vuprs::SGDescriptorRingS2MM::HardwareOwned() const
+{
+    return this->hardwareOwned;
+}
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* --------------------------------------------- SG Engine (S2MM) ------------------------------------------------ */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+vuprs::SGEngineS2MM::SGEngineS2MM(vuprs::FPGAController *fpgaController, const uint8_t &dmaChannel)
+{
+    if (fpgaController == nullptr)
+    {
+        throw std::runtime_error("*FPGAController is nullptr.");
+    }
+
+    this->fpgaController = fpgaController;
+    this->dmaChannel = dmaChannel;
+    this->running = false;
+}
+
+vuprs::SGEngineS2MM::~SGEngineS2MM()
+{
+    if (this->running)
+    {
+        try
+        {
+            this->Stop();
+        }
+        catch (...)
+        {
+
+        }
+    }
+
+    this->descriptorImage.release();
+}
+
+bool vuprs::SGEngineS2MM::WriteDescriptors(const uint32_t &firstIndex, const uint32_t &count)
+{
+    const uint32_t descriptorCount = this->descriptorRing.GetRingConfig().descriptorCount;
+
+    uint32_t written = 0, segmentFirst = 0, segmentCount = 0;
+    vuprs::DMATransferConfig transferConfig;
+
+    transferConfig.transferDmaChannel = this->dmaChannel;
+    transferConfig.transferDirectionSelection = DMA_TRANSFER_DIRECTION__HOST_TO_FPGA;
+
+    /* At most two segments (ring wraps around) */
+
+    while (written < count)
+    {
+        segmentFirst = (firstIndex + written) % descriptorCount;
+        segmentCount = std::min(count - written, descriptorCount - segmentFirst);
+
+        if (!this->descriptorImage.malloc(static_cast<uint64_t>(segmentCount) * SG_DESCRIPTOR_BYTES))
+        {
+            throw std::runtime_error("Cannot malloc descriptor image.");
+        }
+
+        this->descriptorRing.BuildDescriptors(segmentFirst, segmentCount, this->descriptorImage.as<uint32_t>());
+
+        transferConfig.ddrOffset = this->descriptorRing.DescriptorDDROffset(segmentFirst);
+        transferConfig.transferByteSize = static_cast<uint64_t>(segmentCount) * SG_DESCRIPTOR_BYTES;
+
+        if (!this->fpgaController->AXIFull_IO(transferConfig, &this->descriptorImage))
+        {
+            return false;
+        }
+
+        written += segmentCount;
+    }
+
+    return true;
+}
+
+bool vuprs::SGEngineS2MM::ReadDescriptors(const uint32_t &firstIndex, const uint32_t &count, uint32_t *image)
+{
+    const uint32_t descriptorCount = this->descriptorRing.GetRingConfig().descriptorCount;
+
+    uint32_t readCount = 0, segmentFirst = 0, segmentCount = 0;
+    vuprs::DMATransferConfig transferConfig;
+
+    transferConfig.transferDmaChannel = this->dmaChannel;
+    transferConfig.transferDirectionSelection = DMA_TRANSFER_DIRECTION__FPGA_TO_HOST;
+
+    while (readCount < count)
+    {
+        segmentFirst = (firstIndex + readCount) % descriptorCount;
+        segmentCount = std::min(count - readCount, descriptorCount - segmentFirst);
+
+        transferConfig.ddrOffset = this->descriptorRing.DescriptorDDROffset(segmentFirst);
+        transferConfig.transferByteSize = static_cast<uint64_t>(segmentCount) * SG_DESCRIPTOR_BYTES;
+
+        if (!this->fpgaController->AXIFull_IO(transferConfig, &this->descriptorImage))
+        {
+            return false;
+        }
+
+        std::memcpy(image + static_cast<uint64_t>(readCount) * SG_DESCRIPTOR_WORDS, this->descriptorImage.data(), transferConfig.transferByteSize);
+
+        readCount += segmentCount;
+    }
+
+    return true;
+}
+
+bool vuprs::SGEngineS2MM::WriteAddressRegister(const int &registerLSB, const int &registerMSB, const uint64_t &address)
+{
+    /* MSB first: writing the LSB of TAILDESC triggers descriptor fetching */
+
+    if (!this->fpgaController->AXILite_WriteToFPGARegister(registerMSB, static_cast<uint32_t>(address >> 32)))
+    {
+        return false;
+    }
+
+    return this->fpgaController->AXILite_WriteToFPGARegister(registerLSB, static_cast<uint32_t>(address & 0xFFFFFFFFULL));
+}
+
+bool vuprs::SGEngineS2MM::WaitRegister(const int &registerSelection, const uint32_t &mask, const bool &set)
+{
+    uint32_t value = 0;
+
+    for (uint32_t i = 0; i < SG_REGISTER_POLL_RETRIES; i++)
+    {
+        if (!this->fpgaController->AXILite_ReadFPGARegister(registerSelection, &value))
+        {
+            return false;
+        }
+        if (((value & mask) != 0) == set)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool vuprs::SGEngineS2MM::Start(const vuprs::SGRingConfigS2MM &ringConfig)
+{
+    const vuprs::FPGAConfigManager &configManager = this->fpgaController->GetFPGAConfig();
+
+    if (!configManager.ConfigDown())
+    {
+        throw std::runtime_error("Config not complete.");
+    }
+
+    const vuprs::FPGAbusAddress &busAddress = configManager.fpgaConfig.fpgaAddress.busAddress;
+    uint64_t ddrCapacityBytes = configManager.fpgaConfig.hardwareConfig.hardwareConfigDDR.ddrMemoryCapacity_megabytes * 1024 * 1024;
+    uint32_t controlValue = S2MM_DMACR__RS;
+
+    if (this->running)
+    {
+        this->Stop();
+    }
+
+    if (!this->descriptorRing.Configure(ringConfig, busAddress.addrBusBaseAXIFull + busAddress.addrBusBaseAXIFull__DDR, ddrCapacityBytes))
+    {
+        return false;
+    }
+
+    /* Lay out the whole ring in DDR */
+
+    if (!this->WriteDescriptors(0, ringConfig.descriptorCount))
+    {
+        return false;
+    }
+
+    /* Reset S2MM channel */
+
+    if (!this->fpgaController->AXILite_WriteToFPGARegister(AXI_LITE_REGISTER__DMA__S2MM_DMACR, S2MM_DMACR__RESET) ||
+        !this->WaitRegister(AXI_LITE_REGISTER__DMA__S2MM_DMACR, S2MM_DMACR__RESET, false))
+    {
+        return false;
+    }
+
+    /* Program SG control & current descriptor (channel is halted) */
+
+    if (!this->fpgaController->AXILite_WriteToFPGARegister(AXI_LITE_REGISTER__DMA__SG_CTL, ringConfig.sgControl) ||
+        !this->WriteAddressRegister(AXI_LITE_REGISTER__DMA__S2MM_CURDESC, AXI_LITE_REGISTER__DMA__S2MM_CURDESC_MSB, this->descriptorRing.DescriptorAXIAddress(0)))
+    {
+        return false;
+    }
+
+    /* Run */
+
+    if (ringConfig.cyclicMode)
+    {
+        controlValue |= S2MM_DMACR__CYCLIC_BD_ENABLE;
+    }
+
+    if (!this->fpgaController->AXILite_WriteToFPGARegister(AXI_LITE_REGISTER__DMA__S2MM_DMACR, controlValue) ||
+        !this->WaitRegister(AXI_LITE_REGISTER__DMA__S2MM_DMASR, S2MM_DMASR__HALTED, false))
+    {
+        return false;
+    }
+
+    /* Tail descriptor starts fetching */
+
+    if (!this->WriteAddressRegister(AXI_LITE_REGISTER__DMA__S2MM_TAILDESC, AXI_LITE_REGISTER__DMA__S2MM_TAILDESC_MSB, this->descriptorRing.TailDescriptorAXIAddress()))
+    {
+        return false;
+    }
+
+    this->running = true;
+    return true;
+}
+
+bool vuprs::SGEngineS2MM::Stop()
+{
+    this->running = false;
+
+    if (!this->fpgaController->AXILite_WriteToFPGARegister(AXI_LITE_REGISTER__DMA__S2MM_DMACR, 0))
+    {
+        return false;
+    }
+
+    return this->WaitRegister(AXI_LITE_REGISTER__DMA__S2MM_DMASR, S2MM_DMASR__HALTED, true);
+}
+
+uint32_t vuprs::SGEngineS2MM::Harvest(std::vector<vuprs::SGCompletedBlock> *completed)
+{
+    if (!this->running)
+    {
+        throw std::runtime_error("SG engine is not running.");
+    }
+
+    uint32_t firstIndex = 0, count = 0;
+    std::vector<uint32_t> image;
+
+    this->descriptorRing.HarvestWindow(&firstIndex, &count);
+
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    image.resize(static_cast<uint64_t>(count) * SG_DESCRIPTOR_WORDS);
+
+    if (!this->ReadDescriptors(firstIndex, count, image.data()))
+    {
+        throw std::runtime_error("Cannot read descriptors.");
+    }
+
+    return this->descriptorRing.Harvest(firstIndex, count, image.data(), completed);
+}
+
+bool vuprs::SGEngineS2MM::Release(const uint32_t &count)
+{
+    if (!this->running)
+    {
+        throw std::runtime_error("SG engine is not running.");
+    }
+
+    uint32_t firstIndex = 0, releaseCount = 0;
+
+    releaseCount = this->descriptorRing.Release(count, &firstIndex);
+
+    if (releaseCount == 0)
+    {
+        return count == 0;
+    }
+
+    /* Re-arm (clear Cmplt) */
+
+    if (!this->WriteDescriptors(firstIndex, releaseCount))
+    {
+        return false;
+    }
+
+    /* Cyclic mode never stops at the tail, flow control mode moves the tail forward */
+
+    if (this->descriptorRing.GetRingConfig().cyclicMode)
+    {
+        return true;
+    }
+
+    return this->WriteAddressRegister(AXI_LITE_REGISTER__DMA__S2MM_TAILDESC, AXI_LITE_REGISTER__DMA__S2MM_TAILDESC_MSB, this->descriptorRing.TailDescriptorAXIAddress());
+}
+
+bool vuprs::SGEngineS2MM::ReadStatus(uint32_t *dmasr)
+{
+    return this->fpgaController->AXILite_ReadFPGARegister(AXI_LITE_REGISTER__DMA__S2MM_DMASR, dmasr);
+}
+
+bool vuprs::SGEngineS2MM::IsRunning() const
+{
+    return this->running;
+}
+
+const vuprs::SGDescriptorRingS2MM &vuprs::SGEngineS2MM::GetDescriptorRing() const
+{
+    return this->descriptorRing;
+}
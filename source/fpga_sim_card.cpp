@@ -0,0 +1,733 @@
+#include "fpga_sim_card.h"
+#include "fpga_data_parse.h"
+#include "fpga_dma_sg.h"
+#include "adc_time.h"
+
+/**
+ * @brief Hash of (seed, frame, channel) for the CRC error pattern (splitmix64 finalizer), frames are a pure
+ *        function of their index, so every read of the same frame gives the same words.
+ */
+static inline uint64_t SimulatedFPGACard__Hash(const uint64_t &seed, const uint64_t &frameIndex, const uint64_t &channel)
+{
+    uint64_t x = seed ^ (frameIndex * 0x9E3779B97F4A7C15ULL) ^ ((channel + 1) * 0xD1B54A32D192ED03ULL);
+
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+
+    return x ^ (x >> 31);
+}
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* ---------------------------------------------- Simulated Card ------------------------------------------------- */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+vuprs::SimulatedFPGACard::SimulatedFPGACard()
+{
+    std::fill(this->registerOffset, this->registerOffset + AXI_LITE_REGISTER_COUNT, 0);
+    this->axiLiteSpace.assign(__XDMA_AXI_LITE_MMAP_SIZE__ / sizeof(uint32_t), 0);
+
+    this->ddr = nullptr;
+    this->ddrBytes = 0;
+    this->ddrAXIAddress = 0;
+
+    this->sampling = false;
+    this->ready = false;
+    this->adcError = 0;
+    this->triggerTime_ns = 0;
+    this->samplePeriod_ns = 0;
+    this->captureFrames = 0;
+    this->packetFrames = 0;
+    this->generatedFrames = 0;
+
+    this->frameWords = 0;
+    this->streamBytes = 0;
+    this->frameImageIndex = UINT64_MAX;
+    this->crcErrorThreshold = 0;
+
+    this->dmasr = S2MM_DMASR__HALTED | S2MM_DMASR__SG_INCLD;
+    this->directActive = false;
+    this->directDdrOffset = 0;
+    this->directLength = 0;
+    this->directTransferred = 0;
+    this->sgActive = false;
+    this->currentDescriptor = 0;
+    this->descriptorFilled = 0;
+    this->packetStart = true;
+}
+
+vuprs::SimulatedFPGACard::~SimulatedFPGACard()
+{
+    free(this->ddr);
+    this->ddr = nullptr;
+}
+
+const char *vuprs::SimulatedFPGACard::Name() const
+{
+    return FPGA_TRANSPORT__SIMULATED;
+}
+
+void vuprs::SimulatedFPGACard::Configure(const vuprs::FPGAConfig &fpgaConfig)
+{
+    std::lock_guard<std::mutex> lock(this->cardMutex);
+
+    const vuprs::FPGAbusAddress &busAddress = fpgaConfig.fpgaAddress.busAddress;
+    const vuprs::FPGAregisterAddressADC &adcRegisters = fpgaConfig.fpgaAddress.registerAddressADC;
+    const vuprs::FPGAregisterAddressDMA &dmaRegisters = fpgaConfig.fpgaAddress.registerAddressDMA;
+    const vuprs::FPGAhardwareConfigFrame &frameFeatures = fpgaConfig.hardwareConfig.hardwareConfigFrame;
+
+    uint64_t capacityBytes = fpgaConfig.hardwareConfig.hardwareConfigDDR.ddrMemoryCapacity_megabytes * 1024 * 1024;
+    bool firstConfig = (this->ddr == nullptr);
+    double amplitude = 0;
+
+    /* Register offsets, in the order of AXI_LITE_REGISTER__xxx */
+
+    const uint64_t offsets[AXI_LITE_REGISTER_COUNT] = {
+        busAddress.addrBusBaseAXILite__ADC + adcRegisters.addrRegisterBaseADC__SCI,
+        busAddress.addrBusBaseAXILite__ADC + adcRegisters.addrRegisterBaseADC__SP,
+        busAddress.addrBusBaseAXILite__ADC + adcRegisters.addrRegisterBaseADC__SF,
+        busAddress.addrBusBaseAXILite__ADC + adcRegisters.addrRegisterBaseADC__STR,
+        busAddress.addrBusBaseAXILite__ADC + adcRegisters.addrRegisterBaseADC__NGF,
+        busAddress.addrBusBaseAXILite__ADC + adcRegisters.addrRegisterBaseADC__ERR,
+        busAddress.addrBusBaseAXILite__DMA + dmaRegisters.addrRegisterBaseDMA__S2MM_DMACR,
+        busAddress.addrBusBaseAXILite__DMA + dmaRegisters.addrRegisterBaseDMA__S2MM_DMASR,
+        busAddress.addrBusBaseAXILite__DMA + dmaRegisters.addrRegisterBaseDMA__SG_CTL,
+        busAddress.addrBusBaseAXILite__DMA + dmaRegisters.addrRegisterBaseDMA__S2MM_CURDESC,
+        busAddress.addrBusBaseAXILite__DMA + dmaRegisters.addrRegisterBaseDMA__S2MM_CURDESC_MSB,
+        busAddress.addrBusBaseAXILite__DMA + dmaRegisters.addrRegisterBaseDMA__S2MM_TAILDESC,
+        busAddress.addrBusBaseAXILite__DMA + dmaRegisters.addrRegisterBaseDMA__S2MM_TAILDESC_MSB,
+        busAddress.addrBusBaseAXILite__DMA + dmaRegisters.addrRegisterBaseDMA__S2MM_DA,
+        busAddress.addrBusBaseAXILite__DMA + dmaRegisters.addrRegisterBaseDMA__S2MM_DA_MSB,
+        busAddress.addrBusBaseAXILite__DMA + dmaRegisters.addrRegisterBaseDMA__S2MM_LENGTH
+    };
+
+    /* ------------------------ Security Check Start ------------------------- */
+
+    for (int i = 0; i < AXI_LITE_REGISTER_COUNT; i++)
+    {
+        if (offsets[i] % sizeof(uint32_t) != 0 || offsets[i] + sizeof(uint32_t) > __XDMA_AXI_LITE_MMAP_SIZE__)
+        {
+            throw std::runtime_error("Register " + std::to_string(i) + " is not a 32-bit word of the AXI-Lite space.");
+        }
+        for (int j = 0; j < i; j++)
+        {
+            if (offsets[i] == offsets[j])
+            {
+                throw std::runtime_error("Registers " + std::to_string(j) + " and " + std::to_string(i) + " share one address.");
+            }
+        }
+    }
+
+    if (capacityBytes == 0)
+    {
+        throw std::runtime_error("DDR capacity is 0.");
+    }
+
+    vuprs::CheckFrameFeatures(frameFeatures);
+
+    /* ------------------------- Security Check End -------------------------- */
+
+    std::copy(offsets, offsets + AXI_LITE_REGISTER_COUNT, this->registerOffset);
+
+    /* DDR model, pages are zero & taken from the OS on first touch */
+
+    if (capacityBytes != this->ddrBytes)
+    {
+        free(this->ddr);
+
+        this->ddr = static_cast<uint8_t*>(calloc(capacityBytes, 1));
+        this->ddrBytes = 0;
+
+        if (this->ddr == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+
+        this->ddrBytes = capacityBytes;
+    }
+
+    this->ddrAXIAddress = busAddress.addrBusBaseAXIFull + busAddress.addrBusBaseAXIFull__DDR;
+
+    /* Frame generator */
+
+    this->frameWords = frameFeatures.channels + 2;
+    this->frameImage.assign(this->frameWords, 0);
+    this->frameImageIndex = UINT64_MAX;
+
+    amplitude = 0.5 * (frameFeatures.dataWidth_bits == 16 ? 32767.0 : 8388607.0);
+    this->waveTable.resize(SIM_CARD_WAVE_TABLE_SIZE);
+
+    for (uint32_t i = 0; i < SIM_CARD_WAVE_TABLE_SIZE; i++)
+    {
+        this->waveTable[i] = static_cast<int32_t>(std::lround(amplitude * std::sin(2.0 * M_PI * i / SIM_CARD_WAVE_TABLE_SIZE)));
+    }
+
+    if (fpgaConfig.xdmaDriverConfig.simulation.crcErrorRate >= 1.0)
+    {
+        this->crcErrorThreshold = UINT64_MAX;
+    }
+    else
+    {
+        this->crcErrorThreshold = static_cast<uint64_t>(fpgaConfig.xdmaDriverConfig.simulation.crcErrorRate * 18446744073709551616.0);
+    }
+
+    this->fpgaConfig = fpgaConfig;
+
+    if (firstConfig)
+    {
+        this->ResetS2MM();
+    }
+}
+
+/* ------------------------------------------------ Registers ---------------------------------------------------- */
+
+int vuprs::SimulatedFPGACard::RegisterAt(const uint64_t &offset) const
+{
+    for (int i = 0; i < AXI_LITE_REGISTER_COUNT; i++)
+    {
+        if (this->registerOffset[i] == offset)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+uint32_t &vuprs::SimulatedFPGACard::Register(const int &registerSelection)
+{
+    return this->axiLiteSpace[this->registerOffset[registerSelection] / sizeof(uint32_t)];
+}
+
+uint64_t vuprs::SimulatedFPGACard::AddressRegister(const int &registerLSB, const int &registerMSB)
+{
+    return (static_cast<uint64_t>(this->Register(registerMSB)) << 32) | this->Register(registerLSB);
+}
+
+bool vuprs::SimulatedFPGACard::DDROffset(const uint64_t &axiAddress, const uint64_t &byteSize, uint64_t *ddrOffset) const
+{
+    if (axiAddress < this->ddrAXIAddress || axiAddress - this->ddrAXIAddress > this->ddrBytes ||
+        byteSize > this->ddrBytes - (axiAddress - this->ddrAXIAddress))
+    {
+        return false;
+    }
+
+    *ddrOffset = axiAddress - this->ddrAXIAddress;
+
+    return true;
+}
+
+uint32_t vuprs::SimulatedFPGACard::ReadRegister(const int &registerSelection)
+{
+    switch (registerSelection)
+    {
+        case AXI_LITE_REGISTER__ADC__STR:
+        {
+            return (this->sampling ? ADC_STR__TRIGGER : 0) | (this->ready ? ADC_STR__READY : 0);
+        }
+        case AXI_LITE_REGISTER__ADC__NGF:
+        {
+            return static_cast<uint32_t>(this->generatedFrames);
+        }
+        case AXI_LITE_REGISTER__ADC__ERR:
+        {
+            return this->adcError;
+        }
+        case AXI_LITE_REGISTER__DMA__S2MM_DMASR:
+        {
+            return this->dmasr;
+        }
+        default:
+        {
+            return this->Register(registerSelection);
+        }
+    }
+}
+
+void vuprs::SimulatedFPGACard::WriteRegister(const int &registerSelection, const uint32_t &w_value)
+{
+    const bool running = (this->Register(AXI_LITE_REGISTER__DMA__S2MM_DMACR) & S2MM_DMACR__RS) && !(this->dmasr & S2MM_DMASR__HALTED);
+
+    switch (registerSelection)
+    {
+        case AXI_LITE_REGISTER__ADC__STR:
+        {
+            this->Trigger((w_value & ADC_STR__TRIGGER) != 0);
+            break;
+        }
+        case AXI_LITE_REGISTER__ADC__NGF:
+        case AXI_LITE_REGISTER__ADC__ERR:
+        {
+            break;  /* Read only */
+        }
+        case AXI_LITE_REGISTER__DMA__S2MM_DMACR:
+        {
+            this->WriteDMACR(w_value);
+            break;
+        }
+        case AXI_LITE_REGISTER__DMA__S2MM_DMASR:
+        {
+            this->dmasr &= ~(w_value & S2MM_DMASR__IRQ_MASK);
+            break;
+        }
+        case AXI_LITE_REGISTER__DMA__S2MM_TAILDESC:
+        {
+            /* Writing the LSB of TAILDESC starts fetching at CURDESC (SG mode) */
+
+            this->Register(registerSelection) = w_value;
+
+            if (running && !this->directActive && !this->sgActive)
+            {
+                this->sgActive = true;
+                this->dmasr &= ~S2MM_DMASR__IDLE;
+            }
+            break;
+        }
+        case AXI_LITE_REGISTER__DMA__S2MM_LENGTH:
+        {
+            /* Writing LENGTH starts a transfer (direct mode) */
+
+            this->Register(registerSelection) = w_value;
+
+            if (running && !this->directActive && !this->sgActive)
+            {
+                this->directLength = w_value & SG_DESCRIPTOR_LENGTH_MASK;
+                this->directTransferred = 0;
+
+                if (this->directLength == 0)
+                {
+                    this->HaltS2MM(S2MM_DMASR__DMA_INT_ERR);
+                }
+                else if (!this->DDROffset(this->AddressRegister(AXI_LITE_REGISTER__DMA__S2MM_DA, AXI_LITE_REGISTER__DMA__S2MM_DA_MSB),
+                                          this->directLength, &this->directDdrOffset))
+                {
+                    this->HaltS2MM(S2MM_DMASR__DMA_DEC_ERR);
+                }
+                else
+                {
+                    this->directActive = true;
+                    this->dmasr &= ~S2MM_DMASR__IDLE;
+                }
+            }
+            break;
+        }
+        default:
+        {
+            this->Register(registerSelection) = w_value;
+            break;
+        }
+    }
+}
+
+/* ---------------------------------------------- ADC Generator -------------------------------------------------- */
+
+void vuprs::SimulatedFPGACard::Trigger(const bool &start)
+{
+    const vuprs::FPGAhardwareConfigADC &adcFeatures = this->fpgaConfig.hardwareConfig.hardwareConfigADC;
+
+    if (!start)
+    {
+        /* Stop: the capture ends with the frames generated so far (TLAST on the last one) */
+
+        if (this->sampling)
+        {
+            this->sampling = false;
+            this->ready = true;
+            this->captureFrames = this->generatedFrames;
+        }
+        return;
+    }
+
+    uint32_t sci = this->Register(AXI_LITE_REGISTER__ADC__SCI);
+    double samplePeriod_s = 0;
+
+    if (sci != 0 && adcFeatures.adcSamplingClock_Hz != 0)
+    {
+        samplePeriod_s = vuprs::SamplePeriodFromSCI(sci, adcFeatures);
+    }
+    else if (sci != 0 && adcFeatures.adcMaxSamplingFrequency_Hz != 0)
+    {
+        samplePeriod_s = 1.0 / adcFeatures.adcMaxSamplingFrequency_Hz;  /* Sampling clock unknown */
+    }
+
+    if (!(samplePeriod_s > 0))
+    {
+        return;  /* SCI = 0: ADC does not sample */
+    }
+
+    this->sampling = true;
+    this->ready = false;
+    this->adcError = 0;
+    this->triggerTime_ns = vuprs::HostMonotonic_ns();
+    this->samplePeriod_ns = samplePeriod_s * ADC_TIME_NS_PER_S / (1.0 + this->fpgaConfig.xdmaDriverConfig.simulation.clockDrift_ppm * 1e-6);
+    this->captureFrames = this->Register(AXI_LITE_REGISTER__ADC__SP);
+    this->packetFrames = this->Register(AXI_LITE_REGISTER__ADC__SF);
+    this->generatedFrames = 0;
+    this->streamBytes = 0;
+    this->frameImageIndex = UINT64_MAX;
+}
+
+void vuprs::SimulatedFPGACard::BuildFrame(const uint64_t &frameIndex)
+{
+    if (frameIndex == this->frameImageIndex)
+    {
+        return;
+    }
+
+    const vuprs::FPGAhardwareConfigFrame &frameFeatures = this->fpgaConfig.hardwareConfig.hardwareConfigFrame;
+    uint32_t word = 0;
+
+    this->frameImage[0] = static_cast<uint32_t>(frameFeatures.header);
+    this->frameImage[this->frameWords - 1] = static_cast<uint32_t>(frameFeatures.tailer);
+
+    for (uint64_t c = 0; c < frameFeatures.channels; c++)
+    {
+        word = vuprs::EncodeADCDataWord(this->waveTable[(frameIndex * (c + 1)) % SIM_CARD_WAVE_TABLE_SIZE], frameFeatures.dataWidth_bits);
+
+        if (this->crcErrorThreshold != 0 &&
+            SimulatedFPGACard__Hash(this->fpgaConfig.xdmaDriverConfig.simulation.seed, frameIndex, c) < this->crcErrorThreshold)
+        {
+            word ^= 1U;  /* Broken CRC */
+        }
+
+        this->frameImage[1 + frameFeatures.storageOrder[c]] = word;
+    }
+
+    this->frameImageIndex = frameIndex;
+}
+
+uint64_t vuprs::SimulatedFPGACard::StreamRead(uint8_t *destination, const uint64_t &maxBytes, bool *packetEnd)
+{
+    const uint64_t frameBytes = this->frameWords * sizeof(uint32_t);
+
+    uint64_t packetBoundary = UINT64_MAX, readBytes = 0, copiedBytes = 0, partBytes = 0, frameIndex = 0, frameOffset = 0;
+
+    /* Next TLAST: end of a packet (SF frames) or of the capture (SP frames) */
+
+    if (this->packetFrames != 0)
+    {
+        packetBoundary = (this->streamBytes / (this->packetFrames * frameBytes) + 1) * this->packetFrames * frameBytes;
+    }
+    if (this->captureFrames != 0)
+    {
+        packetBoundary = std::min(packetBoundary, this->captureFrames * frameBytes);
+    }
+
+    readBytes = std::min(std::min(this->generatedFrames * frameBytes - this->streamBytes, maxBytes), packetBoundary - this->streamBytes);
+
+    while (copiedBytes < readBytes)
+    {
+        frameIndex = this->streamBytes / frameBytes;
+        frameOffset = this->streamBytes % frameBytes;
+
+        this->BuildFrame(frameIndex);
+
+        partBytes = std::min(frameBytes - frameOffset, readBytes - copiedBytes);
+        std::memcpy(destination + copiedBytes, reinterpret_cast<const uint8_t*>(this->frameImage.data()) + frameOffset, partBytes);
+
+        copiedBytes += partBytes;
+        this->streamBytes += partBytes;
+    }
+
+    *packetEnd = (readBytes != 0 && this->streamBytes == packetBoundary);
+
+    return readBytes;
+}
+
+/* ------------------------------------------------ AXI DMA S2MM ------------------------------------------------- */
+
+void vuprs::SimulatedFPGACard::ResetS2MM()
+{
+    const int clearedRegisters[] = {
+        AXI_LITE_REGISTER__DMA__S2MM_DMACR,
+        AXI_LITE_REGISTER__DMA__S2MM_CURDESC, AXI_LITE_REGISTER__DMA__S2MM_CURDESC_MSB,
+        AXI_LITE_REGISTER__DMA__S2MM_TAILDESC, AXI_LITE_REGISTER__DMA__S2MM_TAILDESC_MSB,
+        AXI_LITE_REGISTER__DMA__S2MM_DA, AXI_LITE_REGISTER__DMA__S2MM_DA_MSB,
+        AXI_LITE_REGISTER__DMA__S2MM_LENGTH
+    };
+
+    for (const int &registerSelection : clearedRegisters)
+    {
+        this->Register(registerSelection) = 0;
+    }
+
+    this->dmasr = S2MM_DMASR__HALTED | S2MM_DMASR__SG_INCLD;
+    this->directActive = false;
+    this->directTransferred = 0;
+    this->sgActive = false;
+    this->currentDescriptor = 0;
+    this->descriptorFilled = 0;
+    this->packetStart = true;
+}
+
+void vuprs::SimulatedFPGACard::HaltS2MM(const uint32_t &errorBits)
+{
+    this->Register(AXI_LITE_REGISTER__DMA__S2MM_DMACR) &= ~S2MM_DMACR__RS;
+
+    this->dmasr |= S2MM_DMASR__HALTED | errorBits | (errorBits != 0 ? S2MM_DMASR__ERR_IRQ : 0);
+    this->dmasr &= ~S2MM_DMASR__IDLE;
+
+    this->directActive = false;
+    this->sgActive = false;
+}
+
+void vuprs::SimulatedFPGACard::WriteDMACR(const uint32_t &value)
+{
+    if (value & S2MM_DMACR__RESET)
+    {
+        this->ResetS2MM();  /* Reset completes at once, the bit reads 0 */
+        return;
+    }
+
+    this->Register(AXI_LITE_REGISTER__DMA__S2MM_DMACR) = value;
+
+    if (!(value & S2MM_DMACR__RS))
+    {
+        this->HaltS2MM(0);
+        return;
+    }
+
+    /* Halted -> running: fetching starts at CURDESC once TAILDESC is written */
+
+    if (this->dmasr & S2MM_DMASR__HALTED)
+    {
+        this->dmasr &= ~S2MM_DMASR__HALTED;
+        this->dmasr |= S2MM_DMASR__IDLE;
+
+        this->currentDescriptor = this->AddressRegister(AXI_LITE_REGISTER__DMA__S2MM_CURDESC, AXI_LITE_REGISTER__DMA__S2MM_CURDESC_MSB);
+            this->descriptorFilled = 0;
+        this->packetStart = true;
+    }
+}
+
+void vuprs::SimulatedFPGACard::RunDirect()
+{
+    uint64_t readBytes = 0;
+    bool packetEnd = false;
+
+    while (this->directActive)
+    {
+        readBytes = this->StreamRead(this->ddr + this->directDdrOffset + this->directTransferred, this->directLength - this->directTransferred, &packetEnd);
+
+        if (readBytes == 0)
+        {
+            break;
+        }
+
+        this->directTransferred += readBytes;
+
+        /* Buffer full or TLAST: LENGTH reads the received bytes */
+
+        if (this->directTransferred == this->directLength || packetEnd)
+        {
+            this->directActive = false;
+            this->Register(AXI_LITE_REGISTER__DMA__S2MM_LENGTH) = static_cast<uint32_t>(this->directTransferred);
+            this->dmasr |= S2MM_DMASR__IDLE | S2MM_DMASR__IOC_IRQ;
+        }
+    }
+}
+
+void vuprs::SimulatedFPGACard::RunScatterGather()
+{
+    uint64_t descriptorOffset = 0, bufferOffset = 0, bufferAddress = 0, bufferBytes = 0, readBytes = 0;
+    uint32_t *descriptor = nullptr;
+    bool packetEnd = false, cyclicMode = false, tailCompleted = false;
+
+    while (this->sgActive)
+    {
+        cyclicMode = (this->Register(AXI_LITE_REGISTER__DMA__S2MM_DMACR) & S2MM_DMACR__CYCLIC_BD_ENABLE) != 0;
+
+        /* Fetch */
+
+        if (this->currentDescriptor % SG_DESCRIPTOR_BYTES != 0 || !this->DDROffset(this->currentDescriptor, SG_DESCRIPTOR_BYTES, &descriptorOffset))
+        {
+            this->HaltS2MM(S2MM_DMASR__SG_DEC_ERR);
+            break;
+        }
+
+        descriptor = reinterpret_cast<uint32_t*>(this->ddr + descriptorOffset);
+
+        if (!cyclicMode && this->descriptorFilled == 0 && (descriptor[SG_DESCRIPTOR__STATUS] & SG_DESCRIPTOR_STATUS__CMPLT))
+        {
+            this->HaltS2MM(S2MM_DMASR__SG_INT_ERR);  /* Descriptor was not re-armed */
+            break;
+        }
+
+        bufferAddress = (static_cast<uint64_t>(descriptor[SG_DESCRIPTOR__BUFFER_ADDRESS_MSB]) << 32) | descriptor[SG_DESCRIPTOR__BUFFER_ADDRESS];
+        bufferBytes = descriptor[SG_DESCRIPTOR__CONTROL] & SG_DESCRIPTOR_LENGTH_MASK;
+
+        if (bufferBytes == 0)
+        {
+            this->HaltS2MM(S2MM_DMASR__DMA_INT_ERR);
+            break;
+        }
+        if (!this->DDROffset(bufferAddress, bufferBytes, &bufferOffset))
+        {
+            this->HaltS2MM(S2MM_DMASR__DMA_DEC_ERR);
+            break;
+        }
+
+        /* Fill */
+
+        readBytes = this->StreamRead(this->ddr + bufferOffset + this->descriptorFilled, bufferBytes - this->descriptorFilled, &packetEnd);
+
+        if (readBytes == 0)
+        {
+            break;
+        }
+
+        this->descriptorFilled += readBytes;
+
+        if (this->descriptorFilled < bufferBytes && !packetEnd)
+        {
+            continue;
+        }
+
+        /* Complete: status write-back, next descriptor */
+
+        descriptor[SG_DESCRIPTOR__STATUS] = SG_DESCRIPTOR_STATUS__CMPLT | static_cast<uint32_t>(this->descriptorFilled) |
+                                            (this->packetStart ? SG_DESCRIPTOR_STATUS__RXSOF : 0) |
+                                            (packetEnd ? SG_DESCRIPTOR_STATUS__RXEOF : 0);
+
+        tailCompleted = !cyclicMode &&
+                        this->currentDescriptor == this->AddressRegister(AXI_LITE_REGISTER__DMA__S2MM_TAILDESC, AXI_LITE_REGISTER__DMA__S2MM_TAILDESC_MSB);
+
+        this->packetStart = packetEnd;
+        this->descriptorFilled = 0;
+        this->currentDescriptor = (static_cast<uint64_t>(descriptor[SG_DESCRIPTOR__NXTDESC_MSB]) << 32) | descriptor[SG_DESCRIPTOR__NXTDESC];
+
+        this->Register(AXI_LITE_REGISTER__DMA__S2MM_CURDESC) = static_cast<uint32_t>(this->currentDescriptor & 0xFFFFFFFFULL);
+        this->Register(AXI_LITE_REGISTER__DMA__S2MM_CURDESC_MSB) = static_cast<uint32_t>(this->currentDescriptor >> 32);
+        this->dmasr |= S2MM_DMASR__IOC_IRQ;
+
+        if (tailCompleted)
+        {
+            this->sgActive = false;
+            this->dmasr |= S2MM_DMASR__IDLE;
+        }
+    }
+}
+
+/* -------------------------------------------------- Update ----------------------------------------------------- */
+
+void vuprs::SimulatedFPGACard::Update()
+{
+    const uint64_t frameBytes = this->frameWords * sizeof(uint32_t);
+    const uint64_t fifoBytes = static_cast<uint64_t>(SIM_CARD_STREAM_FIFO_FRAMES) * frameBytes;
+
+    uint64_t dueFrames = 0;
+
+    /* Frames due by the host clock */
+
+    if (this->sampling)
+    {
+        dueFrames = static_cast<uint64_t>(std::max<int64_t>(vuprs::HostMonotonic_ns() - this->triggerTime_ns, 0) / this->samplePeriod_ns);
+
+        if (this->captureFrames != 0 && dueFrames >= this->captureFrames)
+        {
+            dueFrames = this->captureFrames;
+            this->sampling = false;
+            this->ready = true;
+        }
+
+        this->generatedFrames = std::max(this->generatedFrames, dueFrames);
+    }
+
+    /* S2MM takes what fits into its buffers */
+
+    this->RunDirect();
+    this->RunScatterGather();
+
+    /* The FIFO keeps the newest frames */
+
+    if (this->generatedFrames * frameBytes - this->streamBytes > fifoBytes)
+    {
+        this->streamBytes = this->generatedFrames * frameBytes - fifoBytes;
+        this->adcError |= ADC_ERR__FIFO_OVERFLOW;
+    }
+}
+
+/* ---------------------------------------------------- Bus ------------------------------------------------------ */
+
+bool vuprs::SimulatedFPGACard::AXILiteRead(const uint64_t &offset, uint32_t *r_value, const bool &)
+{
+    std::lock_guard<std::mutex> lock(this->cardMutex);
+
+    if (this->ddr == nullptr || r_value == nullptr || offset % sizeof(uint32_t) != 0 || offset + sizeof(uint32_t) > __XDMA_AXI_LITE_MMAP_SIZE__)
+    {
+        return false;
+    }
+
+    int registerSelection = this->RegisterAt(offset);
+
+    this->Update();
+
+    *r_value = (registerSelection >= 0) ? this->ReadRegister(registerSelection) : this->axiLiteSpace[offset / sizeof(uint32_t)];
+
+    return true;
+}
+
+bool vuprs::SimulatedFPGACard::AXILiteWrite(const uint64_t &offset, const uint32_t &w_value, const bool &)
+{
+    std::lock_guard<std::mutex> lock(this->cardMutex);
+
+    if (this->ddr == nullptr || offset % sizeof(uint32_t) != 0 || offset + sizeof(uint32_t) > __XDMA_AXI_LITE_MMAP_SIZE__)
+    {
+        return false;
+    }
+
+    int registerSelection = this->RegisterAt(offset);
+
+    this->Update();
+
+    if (registerSelection >= 0)
+    {
+        this->WriteRegister(registerSelection, w_value);
+        this->Update();  /* A started transfer takes the frames already in the FIFO */
+    }
+    else
+    {
+        this->axiLiteSpace[offset / sizeof(uint32_t)] = w_value;
+    }
+
+    return true;
+}
+
+bool vuprs::SimulatedFPGACard::AXIFullRead(const uint8_t &channel, const uint64_t &busOffset, void *data, const uint64_t &byteSize)
+{
+    std::lock_guard<std::mutex> lock(this->cardMutex);
+
+    const uint64_t ddrBusOffset = this->fpgaConfig.fpgaAddress.busAddress.addrBusBaseAXIFull__DDR;
+
+    /* Channels of the XDMA driver config, like the device files of XDMATransport */
+
+    if (this->ddr == nullptr || data == nullptr || channel >= this->fpgaConfig.xdmaDriverConfig.deviceFilename_xdma_c2h.size() ||
+        busOffset < ddrBusOffset || busOffset - ddrBusOffset > this->ddrBytes || byteSize > this->ddrBytes - (busOffset - ddrBusOffset))
+    {
+        return false;
+    }
+
+    this->Update();
+
+    std::memcpy(data, this->ddr + (busOffset - ddrBusOffset), byteSize);
+
+    return true;
+}
+
+bool vuprs::SimulatedFPGACard::AXIFullWrite(const uint8_t &channel, const uint64_t &busOffset, const void *data, const uint64_t &byteSize)
+{
+    std::lock_guard<std::mutex> lock(this->cardMutex);
+
+    const uint64_t ddrBusOffset = this->fpgaConfig.fpgaAddress.busAddress.addrBusBaseAXIFull__DDR;
+
+    if (this->ddr == nullptr || data == nullptr || channel >= this->fpgaConfig.xdmaDriverConfig.deviceFilename_xdma_h2c.size() ||
+        busOffset < ddrBusOffset || busOffset - ddrBusOffset > this->ddrBytes || byteSize > this->ddrBytes - (busOffset - ddrBusOffset))
+    {
+        return false;
+    }
+
+    this->Update();
+
+    std::memcpy(this->ddr + (busOffset - ddrBusOffset), data, byteSize);
+
+    return true;
+}
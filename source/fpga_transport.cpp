@@ -0,0 +1,212 @@
+#include "fpga_transport.h"
+#include "fpga_sim_card.h"
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* ---------------------------------------------- XDMA Transport ------------------------------------------------- */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+vuprs::XDMATransport::XDMATransport()
+{
+    this->driverConfig = vuprs::XDMADriverConfig();
+}
+
+vuprs::XDMATransport::~XDMATransport()
+{
+
+}
+
+const char *vuprs::XDMATransport::Name() const
+{
+    return FPGA_TRANSPORT__XDMA;
+}
+
+void vuprs::XDMATransport::Configure(const vuprs::FPGAConfig &fpgaConfig)
+{
+    this->driverConfig = fpgaConfig.xdmaDriverConfig;
+}
+
+int vuprs::XDMATransport::OpenDeviceFile(const std::string &deviceFilename)
+{
+    int fpga_fd = -1;
+
+#ifdef _WIN32
+
+    fpga_fd = open(deviceFilename.c_str(), O_RDWR | O_BINARY);
+
+#else
+
+    fpga_fd = open(deviceFilename.c_str(), O_RDWR | O_SYNC);
+
+#endif
+
+    /* Check if device file is open */
+
+    if (fpga_fd < 0)
+    {
+        throw std::runtime_error("Cannot open device file: " + deviceFilename);
+    }
+
+    return fpga_fd;
+}
+
+bool vuprs::XDMATransport::AXILiteIO(const bool &write, const uint64_t &offset, const uint32_t &w_value, uint32_t *r_value, const bool &use_mmap)
+{
+    int fpga_fd = -1, writeReadStatus = -1;
+    ssize_t currentOffset = -1;
+
+    /* Open device file (AXI-Lite) */
+
+    fpga_fd = this->OpenDeviceFile(this->driverConfig.deviceFilename_xdma_user);
+
+    if (!use_mmap)
+    {
+
+        /* Seek to offset relative to AXI-Lite base address in FPGA */
+
+        currentOffset = lseek(fpga_fd, offset, SEEK_SET);
+
+        if (static_cast<uint64_t>(currentOffset) != offset || currentOffset < 0 || currentOffset == (off_t) - 1)
+        {
+            close(fpga_fd);  /* close file */
+            throw std::runtime_error("Seek error.");
+        }
+
+        /* Write data to register */
+
+        if (write)
+        {
+            writeReadStatus = ::write(fpga_fd, &w_value, sizeof(uint32_t));  /* All registers are 32 bit */
+        }
+        else if (r_value != nullptr)
+        {
+            writeReadStatus = ::read(fpga_fd, r_value, sizeof(uint32_t));  /* All registers are 32 bit */
+        }
+    }
+    else
+    {
+
+#ifndef _WIN32
+
+        /* Generate Memory Map */
+
+        void *map_base = mmap(0, __XDMA_AXI_LITE_MMAP_SIZE__, PROT_READ | PROT_WRITE, MAP_SHARED, fpga_fd, 0);
+
+        if (map_base != MAP_FAILED)
+        {
+            /* Address convert */
+
+            volatile uint32_t *reg_addr = (volatile uint32_t *)((uint8_t *)map_base + offset);
+
+            if (!write)
+            {
+                *r_value = *reg_addr;
+            }
+            else
+            {
+                *reg_addr = w_value;
+            }
+
+            munmap(map_base, __XDMA_AXI_LITE_MMAP_SIZE__);
+            writeReadStatus = 1;
+        }
+        else
+        {
+            writeReadStatus = -1;
+        }
+
+#endif
+
+    }
+
+    /* Close */
+
+    if (close(fpga_fd) < 0)
+    {
+        throw std::runtime_error("Cannot close device file: " + this->driverConfig.deviceFilename_xdma_user);
+    }
+
+    return writeReadStatus >= 0;
+}
+
+bool vuprs::XDMATransport::AXIFullIO(const std::string &deviceFilename, const bool &write, const uint64_t &busOffset, void *data, const uint64_t &byteSize)
+{
+    int fpga_fd = -1;
+    ssize_t writeReadBytes = 0;
+    ssize_t currentOffset = -1;
+
+    /* Open device file (AXI-Full DMA) */
+
+    fpga_fd = this->OpenDeviceFile(deviceFilename);
+
+    /* Seek to offset relative to AXI-Full base address in FPGA */
+
+    currentOffset = lseek(fpga_fd, busOffset, SEEK_SET);
+
+    if (static_cast<uint64_t>(currentOffset) != busOffset ||
+        currentOffset < 0 ||
+        currentOffset == (off_t) - 1)
+    {
+        close(fpga_fd);
+        throw std::runtime_error("Seek error.");
+    }
+
+    /* Write memory data to FPGA (WRITE mode) / Read FPGA data to memory (READ mode) */
+
+    if (write)
+    {
+        writeReadBytes = ::write(fpga_fd, data, byteSize);
+    }
+    else
+    {
+        writeReadBytes = ::read(fpga_fd, data, byteSize);
+    }
+
+    /* Free all */
+
+    close(fpga_fd);
+
+    if (writeReadBytes < 0 || static_cast<uint64_t>(writeReadBytes) != byteSize)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+bool vuprs::XDMATransport::AXILiteRead(const uint64_t &offset, uint32_t *r_value, const bool &use_mmap)
+{
+    return this->AXILiteIO(false, offset, 0, r_value, use_mmap);
+}
+
+bool vuprs::XDMATransport::AXILiteWrite(const uint64_t &offset, const uint32_t &w_value, const bool &use_mmap)
+{
+    return this->AXILiteIO(true, offset, w_value, nullptr, use_mmap);
+}
+
+bool vuprs::XDMATransport::AXIFullRead(const uint8_t &channel, const uint64_t &busOffset, void *data, const uint64_t &byteSize)
+{
+    return this->AXIFullIO(this->driverConfig.deviceFilename_xdma_c2h.at(channel), false, busOffset, data, byteSize);
+}
+
+bool vuprs::XDMATransport::AXIFullWrite(const uint8_t &channel, const uint64_t &busOffset, const void *data, const uint64_t &byteSize)
+{
+    return this->AXIFullIO(this->driverConfig.deviceFilename_xdma_h2c.at(channel), true, busOffset, const_cast<void*>(data), byteSize);
+}
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* ------------------------------------------------- Factory ----------------------------------------------------- */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+std::shared_ptr<vuprs::FPGATransport> vuprs::CreateFPGATransport(const std::string &transport)
+{
+    if (transport == FPGA_TRANSPORT__XDMA)
+    {
+        return std::make_shared<vuprs::XDMATransport>();
+    }
+    if (transport == FPGA_TRANSPORT__SIMULATED)
+    {
+        return std::make_shared<vuprs::SimulatedFPGACard>();
+    }
+
+    throw std::runtime_error("Unknown FPGA transport: " + transport);
+}
@@ -0,0 +1,597 @@
+#include "metrics_registry.h"
+
+#include <cerrno>
+#include <cmath>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* ------------------------------------------------- Metric Types ------------------------------------------------ */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+static inline uint64_t Metrics__Bits(const double &value)
+{
+    uint64_t bits = 0;
+
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static inline double Metrics__Double(const uint64_t &bits)
+{
+    double value = 0;
+
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Add to a double stored as bits (CAS, uncontended on a sharded word).
+ */
+static inline void Metrics__AddDouble(std::atomic<uint64_t> *word, const double &delta)
+{
+    uint64_t expected = word->load(std::memory_order_relaxed);
+
+    while (!word->compare_exchange_weak(expected, Metrics__Bits(Metrics__Double(expected) + delta), std::memory_order_relaxed))
+    {
+    }
+}
+
+vuprs::MetricsCounter::MetricsCounter()
+{
+    for (Shard &shard : this->shards)
+    {
+        shard.value.store(0, std::memory_order_relaxed);
+    }
+}
+
+uint64_t vuprs::MetricsCounter::Value() const
+{
+    uint64_t value = 0;
+
+    for (const Shard &shard : this->shards)
+    {
+        value += shard.value.load(std::memory_order_relaxed);
+    }
+
+    return value;
+}
+
+vuprs::MetricsGauge::MetricsGauge()
+{
+    this->valueBits.store(Metrics__Bits(0), std::memory_order_relaxed);
+}
+
+void vuprs::MetricsGauge::Set(const double &value)
+{
+    this->valueBits.store(Metrics__Bits(value), std::memory_order_relaxed);
+}
+
+void vuprs::MetricsGauge::Add(const double &delta)
+{
+    Metrics__AddDouble(&this->valueBits, delta);
+}
+
+double vuprs::MetricsGauge::Value() const
+{
+    return Metrics__Double(this->valueBits.load(std::memory_order_relaxed));
+}
+
+vuprs::MetricsHistogram::MetricsHistogram(const std::vector<double> &upperBounds)
+{
+    /* ------------------------ Security Check Start ------------------------- */
+
+    if (upperBounds.empty())
+    {
+        throw std::runtime_error("Histogram has no bucket.");
+    }
+    for (uint64_t b = 1; b < upperBounds.size(); b++)
+    {
+        if (!(upperBounds[b] > upperBounds[b - 1]))
+        {
+            throw std::runtime_error("Histogram buckets must be ascending.");
+        }
+    }
+
+    /* ------------------------- Security Check End -------------------------- */
+
+    const uint64_t wordsPerLine = METRICS_CACHE_LINE_BYTES / sizeof(uint64_t);
+
+    this->upperBounds = upperBounds;
+    this->shardStride = (upperBounds.size() + 2 + wordsPerLine - 1) / wordsPerLine * wordsPerLine;
+    this->words.reset(new std::atomic<uint64_t>[this->shardStride * METRICS_SHARDS]);
+
+    for (uint64_t w = 0; w < this->shardStride * METRICS_SHARDS; w++)
+    {
+        this->words[w].store(0, std::memory_order_relaxed);
+    }
+    for (uint64_t s = 0; s < METRICS_SHARDS; s++)
+    {
+        this->words[s * this->shardStride + upperBounds.size() + 1].store(Metrics__Bits(0), std::memory_order_relaxed);
+    }
+}
+
+void vuprs::MetricsHistogram::Observe(const double &value)
+{
+    std::atomic<uint64_t> *shard = this->words.get() + vuprs::MetricsShardIndex() * this->shardStride;
+    const uint64_t bucket = std::lower_bound(this->upperBounds.begin(), this->upperBounds.end(), value) - this->upperBounds.begin();
+
+    shard[bucket].fetch_add(1, std::memory_order_relaxed);
+    Metrics__AddDouble(shard + this->upperBounds.size() + 1, value);
+}
+
+void vuprs::MetricsHistogram::Snapshot(std::vector<uint64_t> *bucketCounts, double *sum) const
+{
+    if (bucketCounts == nullptr || sum == nullptr)
+    {
+        throw std::runtime_error("*BucketCounts or *Sum is nullptr.");
+    }
+
+    const std::atomic<uint64_t> *shard = nullptr;
+
+    bucketCounts->assign(this->upperBounds.size() + 1, 0);
+    *sum = 0;
+
+    for (uint64_t s = 0; s < METRICS_SHARDS; s++)
+    {
+        shard = this->words.get() + s * this->shardStride;
+
+        for (uint64_t b = 0; b <= this->upperBounds.size(); b++)
+        {
+            (*bucketCounts)[b] += shard[b].load(std::memory_order_relaxed);
+        }
+        *sum += Metrics__Double(shard[this->upperBounds.size() + 1].load(std::memory_order_relaxed));
+    }
+}
+
+const std::vector<double> &vuprs::MetricsHistogram::UpperBounds() const
+{
+    return this->upperBounds;
+}
+
+std::vector<double> vuprs::MetricsLatencyBuckets()
+{
+    return {1e-6, 2.5e-6, 5e-6, 10e-6, 25e-6, 50e-6, 100e-6, 250e-6, 500e-6, 1e-3, 2.5e-3, 5e-3, 10e-3, 25e-3, 50e-3, 100e-3, 250e-3, 500e-3, 1, 2.5, 5, 10};
+}
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* --------------------------------------------------- Registry -------------------------------------------------- */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief [a-zA-Z_:][a-zA-Z0-9_:]* (metric), [a-zA-Z_][a-zA-Z0-9_]* (label).
+ */
+static bool Metrics__ValidName(const std::string &name, const bool &label)
+{
+    if (name.empty() || (label && name.compare(0, 2, "__") == 0))
+    {
+        return false;
+    }
+
+    for (uint64_t i = 0; i < name.size(); i++)
+    {
+        const char c = name[i];
+
+        if (!(isalpha(static_cast<unsigned char>(c)) || c == '_' || (c == ':' && !label) || (i > 0 && isdigit(static_cast<unsigned char>(c)))))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static std::string Metrics__Escape(const std::string &text, const bool &quoted)
+{
+    std::string escaped;
+
+    for (const char &c : text)
+    {
+        if (c == '\\')
+        {
+            escaped += "\\\\";
+        }
+        else if (c == '\n')
+        {
+            escaped += "\\n";
+        }
+        else if (c == '"' && quoted)
+        {
+            escaped += "\\\"";
+        }
+        else
+        {
+            escaped += c;
+        }
+    }
+
+    return escaped;
+}
+
+static std::string Metrics__Number(const double &value)
+{
+    char text[32];
+
+    if (std::isnan(value))
+    {
+        return "NaN";
+    }
+    if (std::isinf(value))
+    {
+        return value > 0 ? "+Inf" : "-Inf";
+    }
+
+    snprintf(text, sizeof(text), "%.15g", value);
+    return text;
+}
+
+/**
+ * @brief {a="x",b="y"} of the labels (+ one extra label, e.g. le), empty without labels.
+ */
+static std::string Metrics__LabelText(const vuprs::MetricsLabels &labels, const std::string &extraName = "", const std::string &extraValue = "")
+{
+    std::string text;
+
+    for (const std::pair<std::string, std::string> &label : labels)
+    {
+        text += (text.empty() ? "{" : ",") + label.first + "=\"" + Metrics__Escape(label.second, true) + "\"";
+    }
+    if (!extraName.empty())
+    {
+        text += (text.empty() ? "{" : ",") + extraName + "=\"" + extraValue + "\"";
+    }
+
+    return text.empty() ? text : text + "}";
+}
+
+void *vuprs::MetricsRegistry::Find(const std::string &name, const std::string &help, const int &type,
+                                   const vuprs::MetricsLabels &labels, const std::vector<double> &upperBounds)
+{
+    /* ------------------------ Security Check Start ------------------------- */
+
+    if (!Metrics__ValidName(name, false))
+    {
+        throw std::runtime_error("Invalid metric name: " + name);
+    }
+    for (const std::pair<std::string, std::string> &label : labels)
+    {
+        if (!Metrics__ValidName(label.first, true) || (type == METRICS_TYPE__HISTOGRAM && label.first == "le"))
+        {
+            throw std::runtime_error("Invalid label name of " + name + ": " + label.first);
+        }
+    }
+
+    /* ------------------------- Security Check End -------------------------- */
+
+    std::lock_guard<std::mutex> lock(this->registryMutex);
+    std::map<std::string, MetricsFamily>::iterator family = this->families.find(name);
+    std::shared_ptr<void> metric;
+
+    if (family == this->families.end())
+    {
+        family = this->families.emplace(name, MetricsFamily{type, help, upperBounds, {}}).first;
+    }
+    else if (family->second.type != type || family->second.upperBounds != upperBounds)
+    {
+        throw std::runtime_error("Metric is registered with another type or other buckets: " + name);
+    }
+
+    for (const std::pair<vuprs::MetricsLabels, std::shared_ptr<void>> &series : family->second.series)
+    {
+        if (series.first == labels)
+        {
+            return series.second.get();
+        }
+    }
+
+    switch (type)
+    {
+        case METRICS_TYPE__COUNTER: metric = std::make_shared<vuprs::MetricsCounter>(); break;
+        case METRICS_TYPE__GAUGE: metric = std::make_shared<vuprs::MetricsGauge>(); break;
+        default: metric = std::make_shared<vuprs::MetricsHistogram>(upperBounds); break;
+    }
+
+    family->second.series.emplace_back(labels, metric);
+
+    return metric.get();
+}
+
+vuprs::MetricsCounter &vuprs::MetricsRegistry::Counter(const std::string &name, const std::string &help, const vuprs::MetricsLabels &labels)
+{
+    return *static_cast<vuprs::MetricsCounter*>(this->Find(name, help, METRICS_TYPE__COUNTER, labels, {}));
+}
+
+vuprs::MetricsGauge &vuprs::MetricsRegistry::Gauge(const std::string &name, const std::string &help, const vuprs::MetricsLabels &labels)
+{
+    return *static_cast<vuprs::MetricsGauge*>(this->Find(name, help, METRICS_TYPE__GAUGE, labels, {}));
+}
+
+vuprs::MetricsHistogram &vuprs::MetricsRegistry::Histogram(const std::string &name, const std::string &help, const std::vector<double> &upperBounds,
+                                                           const vuprs::MetricsLabels &labels)
+{
+    return *static_cast<vuprs::MetricsHistogram*>(this->Find(name, help, METRICS_TYPE__HISTOGRAM, labels, upperBounds));
+}
+
+std::string vuprs::MetricsRegistry::Exposition() const
+{
+    static const char *TYPE_NAMES[] = {"counter", "gauge", "histogram"};
+
+    std::lock_guard<std::mutex> lock(this->registryMutex);
+    std::string text;
+    std::vector<uint64_t> bucketCounts;
+    uint64_t cumulative = 0;
+    double sum = 0;
+
+    for (const std::pair<const std::string, MetricsFamily> &family : this->families)
+    {
+        const std::string &name = family.first;
+
+        text += "# HELP " + name + " " + Metrics__Escape(family.second.help, false) + "\n";
+        text += "# TYPE " + name + " " + TYPE_NAMES[family.second.type] + "\n";
+
+        for (const std::pair<vuprs::MetricsLabels, std::shared_ptr<void>> &series : family.second.series)
+        {
+            if (family.second.type == METRICS_TYPE__COUNTER)
+            {
+                text += name + Metrics__LabelText(series.first) + " " +
+                        std::to_string(static_cast<const vuprs::MetricsCounter*>(series.second.get())->Value()) + "\n";
+            }
+            else if (family.second.type == METRICS_TYPE__GAUGE)
+            {
+                text += name + Metrics__LabelText(series.first) + " " +
+                        Metrics__Number(static_cast<const vuprs::MetricsGauge*>(series.second.get())->Value()) + "\n";
+            }
+            else
+            {
+                static_cast<const vuprs::MetricsHistogram*>(series.second.get())->Snapshot(&bucketCounts, &sum);
+                cumulative = 0;
+
+                for (uint64_t b = 0; b < bucketCounts.size(); b++)
+                {
+                    cumulative += bucketCounts[b];
+                    text += name + "_bucket" +
+                            Metrics__LabelText(series.first, "le", b < family.second.upperBounds.size() ? Metrics__Number(family.second.upperBounds[b]) : "+Inf") +
+                            " " + std::to_string(cumulative) + "\n";
+                }
+
+                text += name + "_sum" + Metrics__LabelText(series.first) + " " + Metrics__Number(sum) + "\n";
+                text += name + "_count" + Metrics__LabelText(series.first) + " " + std::to_string(cumulative) + "\n";
+            }
+        }
+    }
+
+    return text;
+}
+
+vuprs::MetricsRegistry &vuprs::Metrics()
+{
+    static vuprs::MetricsRegistry registry;
+
+    return registry;
+}
+
+vuprs::MetricsIOSeries::MetricsIOSeries(const std::string &prefix, const std::string &operation, const vuprs::MetricsLabels &labels,
+                                        vuprs::MetricsRegistry &registry)
+{
+    this->operations = &registry.Counter(prefix + "_operations_total", "Count of " + operation + ".", labels);
+    this->bytes = &registry.Counter(prefix + "_bytes_total", "Bytes of successful " + operation + ".", labels);
+    this->failures = &registry.Counter(prefix + "_failures_total", "Failed " + operation + ".", labels);
+    this->seconds = &registry.Histogram(prefix + "_seconds", "Duration of " + operation + ".", vuprs::MetricsLatencyBuckets(), labels);
+}
+
+void vuprs::MetricsIOSeries::Count(const uint64_t &byteSize, const bool &success, const int64_t &duration_ns) const
+{
+    this->operations->Add();
+    this->seconds->Observe(duration_ns * 1e-9);
+
+    if (success)
+    {
+        this->bytes->Add(byteSize);
+    }
+    else
+    {
+        this->failures->Add();
+    }
+}
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* -------------------------------------------------- HTTP Server ------------------------------------------------ */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief Send all bytes (no SIGPIPE when the client is gone).
+ */
+static bool Metrics__SendAll(const int &socket_fd, const std::string &data)
+{
+    uint64_t sentBytes = 0;
+    ssize_t sendBytes = 0;
+
+    while (sentBytes < data.size())
+    {
+        sendBytes = send(socket_fd, data.data() + sentBytes, data.size() - sentBytes, MSG_NOSIGNAL);
+
+        if (sendBytes < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (sendBytes <= 0)
+        {
+            return false;
+        }
+
+        sentBytes += sendBytes;
+    }
+
+    return true;
+}
+
+vuprs::MetricsHTTPServer::MetricsHTTPServer(const vuprs::MetricsRegistry *registry)
+{
+    if (registry == nullptr)
+    {
+        throw std::runtime_error("*Registry is nullptr.");
+    }
+
+    this->registry = registry;
+    this->listen_fd = -1;
+    this->stopRequested = false;
+}
+
+vuprs::MetricsHTTPServer::~MetricsHTTPServer()
+{
+    this->Stop();
+}
+
+bool vuprs::MetricsHTTPServer::Start(const uint16_t &port)
+{
+    struct sockaddr_in address;
+    int reuseAddress = 1;
+
+    this->Stop();
+
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+
+    if (inet_pton(AF_INET, METRICS_HTTP_ADDRESS, &address.sin_addr) != 1)
+    {
+        return false;
+    }
+
+    this->listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    if (this->listen_fd < 0)
+    {
+        return false;
+    }
+
+    setsockopt(this->listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuseAddress, sizeof(reuseAddress));
+
+    if (bind(this->listen_fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) < 0 || listen(this->listen_fd, 8) < 0)
+    {
+        close(this->listen_fd);
+        this->listen_fd = -1;
+        return false;
+    }
+
+    this->stopRequested = false;
+    this->serverThread = std::thread(&vuprs::MetricsHTTPServer::Serve, this);
+
+    return true;
+}
+
+void vuprs::MetricsHTTPServer::Stop()
+{
+    this->stopRequested = true;
+
+    if (this->serverThread.joinable())
+    {
+        this->serverThread.join();
+    }
+    if (this->listen_fd >= 0)
+    {
+        close(this->listen_fd);
+        this->listen_fd = -1;
+    }
+}
+
+void vuprs::MetricsHTTPServer::Serve()
+{
+    struct pollfd listenPoll = {this->listen_fd, POLLIN, 0};
+    struct timeval timeout = {METRICS_HTTP_TIMEOUT_MS / 1000, (METRICS_HTTP_TIMEOUT_MS % 1000) * 1000};
+    int client_fd = -1;
+
+    while (!this->stopRequested)
+    {
+        /* Wake up every METRICS_HTTP_POLL_MS to see Stop() */
+
+        if (poll(&listenPoll, 1, METRICS_HTTP_POLL_MS) <= 0 || (listenPoll.revents & POLLIN) == 0)
+        {
+            continue;
+        }
+
+        client_fd = accept4(this->listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+
+        if (client_fd < 0)
+        {
+            continue;
+        }
+
+        /* A stalled client cannot block the server longer than the timeout */
+
+        setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(client_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        this->Respond(client_fd);
+        close(client_fd);
+    }
+}
+
+void vuprs::MetricsHTTPServer::Respond(const int &client_fd)
+{
+    char buffer[METRICS_HTTP_MAX_REQUEST_BYTES];
+    std::string request, method, path, status = "200 OK", body;
+    uint64_t methodEnd = 0, pathEnd = 0;
+    ssize_t receiveBytes = 0;
+
+    /* Request line & headers (body ignored) */
+
+    while (request.find("\r\n\r\n") == std::string::npos && request.find("\n\n") == std::string::npos &&
+           request.size() < METRICS_HTTP_MAX_REQUEST_BYTES)
+    {
+        receiveBytes = recv(client_fd, buffer, sizeof(buffer), 0);
+
+        if (receiveBytes < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (receiveBytes <= 0)
+        {
+            break;
+        }
+
+        request.append(buffer, receiveBytes);
+    }
+
+    methodEnd = request.find(' ');
+    pathEnd = methodEnd == std::string::npos ? std::string::npos : request.find_first_of(" ?\r\n", methodEnd + 1);
+
+    if (pathEnd == std::string::npos)
+    {
+        status = "400 Bad Request";
+        body = "Bad request.\n";
+    }
+    else
+    {
+        method = request.substr(0, methodEnd);
+        path = request.substr(methodEnd + 1, pathEnd - methodEnd - 1);
+
+        if (method != "GET" && method != "HEAD")
+        {
+            status = "405 Method Not Allowed";
+            body = "Only GET is supported.\n";
+        }
+        else if (path != METRICS_HTTP_PATH && path != "/")
+        {
+            status = "404 Not Found";
+            body = "Metrics are at " METRICS_HTTP_PATH ".\n";
+        }
+        else
+        {
+            body = this->registry->Exposition();
+        }
+    }
+
+    Metrics__SendAll(client_fd, "HTTP/1.0 " + status + "\r\n"
+                                "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                                "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                                "Connection: close\r\n\r\n" + (method == "HEAD" ? std::string() : body));
+}
@@ -0,0 +1,333 @@
+#include "trace_recorder.h"
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <csignal>
+#include <chrono>
+
+#include <unistd.h>
+#include <sys/syscall.h>
+
+std::atomic<bool> vuprs::traceEnabled(false);
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* -------------------------------------------------- Trace Rings ------------------------------------------------ */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+static_assert((TRACE_RING_EVENTS & (TRACE_RING_EVENTS - 1)) == 0, "TRACE_RING_EVENTS must be a power of 2.");
+
+/**
+ * @brief Slot of a ring, sequence = 2 * (event index + 1) when complete, odd while the owner writes it (seqlock).
+ */
+typedef struct TraceRecorder__Event
+{
+    std::atomic<uint64_t> sequence;
+    uint64_t begin_ticks;
+    uint64_t end_ticks;
+    uint64_t value;
+    const char *name;
+    uint64_t threadId;  /* Rings outlive their threads */
+};
+
+/**
+ * @brief Ring of one thread, written by its owner only, read by DumpTrace(). Rings of finished threads are
+ *        kept (their spans stay in the dump) and handed to the next new thread, so memory follows the peak
+ *        number of traced threads, not the number of threads ever started.
+ */
+typedef struct TraceRecorder__Ring
+{
+    TraceRecorder__Event events[TRACE_RING_EVENTS];
+    std::atomic<uint64_t> head;  /* Events ever written */
+    uint64_t threadId;
+};
+
+static std::mutex TraceRecorder__RingsMutex;
+static std::vector<std::unique_ptr<TraceRecorder__Ring>> TraceRecorder__Rings;
+static std::vector<TraceRecorder__Ring*> TraceRecorder__FreeRings;
+
+static uint64_t TraceRecorder__ReferenceTicks = 0;  /* Taken by EnableTrace() */
+static int64_t TraceRecorder__Reference_ns = 0;
+
+/**
+ * @brief Owner of the ring of a thread, returns it to the free list when the thread exits.
+ */
+class TraceRecorder__RingOwner
+{
+    public:
+
+        TraceRecorder__Ring *ring = nullptr;
+
+        ~TraceRecorder__RingOwner()
+        {
+            if (this->ring != nullptr)
+            {
+                std::lock_guard<std::mutex> lock(TraceRecorder__RingsMutex);
+                TraceRecorder__FreeRings.push_back(this->ring);
+            }
+        }
+};
+
+static TraceRecorder__Ring *TraceRecorder__ThreadRing()
+{
+    thread_local TraceRecorder__RingOwner owner;
+
+    if (owner.ring == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(TraceRecorder__RingsMutex);
+
+        if (!TraceRecorder__FreeRings.empty())
+        {
+            owner.ring = TraceRecorder__FreeRings.back();
+            TraceRecorder__FreeRings.pop_back();
+        }
+        else
+        {
+            TraceRecorder__Rings.emplace_back(new TraceRecorder__Ring());
+            owner.ring = TraceRecorder__Rings.back().get();
+            owner.ring->head.store(0, std::memory_order_relaxed);
+
+            for (TraceRecorder__Event &event : owner.ring->events)
+            {
+                event.sequence.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        owner.ring->threadId = static_cast<uint64_t>(syscall(SYS_gettid));
+    }
+
+    return owner.ring;
+}
+
+void vuprs::RecordTraceSpan(const char *name, const uint64_t &begin_ticks, const uint64_t &end_ticks, const uint64_t &value)
+{
+    TraceRecorder__Ring *ring = TraceRecorder__ThreadRing();
+    const uint64_t index = ring->head.load(std::memory_order_relaxed);
+    TraceRecorder__Event &event = ring->events[index & (TRACE_RING_EVENTS - 1)];
+
+    event.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    event.begin_ticks = begin_ticks;
+    event.end_ticks = end_ticks;
+    event.value = value;
+    event.name = name;
+    event.threadId = ring->threadId;
+
+    event.sequence.store(2 * index + 2, std::memory_order_release);
+    ring->head.store(index + 1, std::memory_order_release);
+}
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* --------------------------------------------------- Time Base ------------------------------------------------- */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+static int64_t TraceRecorder__Monotonic_ns()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * @brief ns per tick: CNTFRQ_EL0 on ARM, measured against CLOCK_MONOTONIC since EnableTrace() on x86.
+ */
+static double TraceRecorder__NanosecondsPerTick()
+{
+
+#if defined(__aarch64__)
+
+    uint64_t frequency_Hz = 0;
+
+    asm volatile("mrs %0, cntfrq_el0" : "=r"(frequency_Hz));
+    return frequency_Hz > 0 ? 1e9 / frequency_Hz : 1.0;
+
+#elif defined(__x86_64__) || defined(__i386__)
+
+    int64_t elapsed_ns = TraceRecorder__Monotonic_ns() - TraceRecorder__Reference_ns;
+    uint64_t elapsedTicks = 0;
+
+    /* A dump right after the start: wait for a usable calibration interval */
+
+    if (elapsed_ns < 10000000LL)
+    {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(10000000LL - elapsed_ns));
+    }
+
+    elapsed_ns = TraceRecorder__Monotonic_ns() - TraceRecorder__Reference_ns;
+    elapsedTicks = vuprs::TraceTicks() - TraceRecorder__ReferenceTicks;
+
+    return elapsedTicks > 0 ? static_cast<double>(elapsed_ns) / elapsedTicks : 1.0;
+
+#else
+
+    return 1.0;
+
+#endif
+
+}
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* ---------------------------------------------------- Control -------------------------------------------------- */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+void vuprs::EnableTrace(const bool &enable)
+{
+    std::lock_guard<std::mutex> lock(TraceRecorder__RingsMutex);
+
+    if (enable && !vuprs::traceEnabled.load(std::memory_order_relaxed))
+    {
+        /* Spans of an earlier recording are dropped (events before the head are invalidated) */
+
+        for (std::unique_ptr<TraceRecorder__Ring> &ring : TraceRecorder__Rings)
+        {
+            for (TraceRecorder__Event &event : ring->events)
+            {
+                event.sequence.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        TraceRecorder__Reference_ns = TraceRecorder__Monotonic_ns();
+        TraceRecorder__ReferenceTicks = vuprs::TraceTicks();
+    }
+
+    vuprs::traceEnabled.store(enable, std::memory_order_relaxed);
+}
+
+static void TraceRecorder__WriteEscaped(FILE *file, const char *text)
+{
+    for (; *text != '\0'; text++)
+    {
+        if (*text == '"' || *text == '\\')
+        {
+            fputc('\\', file);
+        }
+        fputc(*text, file);
+    }
+}
+
+bool vuprs::DumpTrace(const std::string &traceFilename)
+{
+    if (traceFilename.empty())
+    {
+        throw std::runtime_error("Empty filename.");
+    }
+
+    const double NS_PER_TICK = TraceRecorder__NanosecondsPerTick();
+    const char *category = nullptr;
+    FILE *traceFile = fopen(traceFilename.c_str(), "w");
+    TraceRecorder__Event event;
+    uint64_t head = 0, first = 0, sequence = 0;
+    uint64_t events = 0;
+    double begin_us = 0, duration_us = 0;
+    bool writeSuccess = false;
+
+    if (traceFile == nullptr)
+    {
+        return false;
+    }
+
+    fprintf(traceFile, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+    fprintf(traceFile, "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": %d, \"tid\": 0, \"args\": {\"name\": \"vuprs\"}}", static_cast<int>(getpid()));
+
+    {
+        /* Rings are not handed to other threads while they are read */
+
+        std::lock_guard<std::mutex> lock(TraceRecorder__RingsMutex);
+
+        for (std::unique_ptr<TraceRecorder__Ring> &ring : TraceRecorder__Rings)
+        {
+            head = ring->head.load(std::memory_order_acquire);
+            first = head > TRACE_RING_EVENTS ? head - TRACE_RING_EVENTS : 0;
+
+            for (uint64_t i = first; i < head; i++)
+            {
+                const TraceRecorder__Event &slot = ring->events[i & (TRACE_RING_EVENTS - 1)];
+
+                /* Seqlock read: skip a slot rewritten by its owner meanwhile, or cleared by EnableTrace() */
+
+                sequence = slot.sequence.load(std::memory_order_acquire);
+                event.begin_ticks = slot.begin_ticks;
+                event.end_ticks = slot.end_ticks;
+                event.value = slot.value;
+                event.name = slot.name;
+                event.threadId = slot.threadId;
+                std::atomic_thread_fence(std::memory_order_acquire);
+
+                if (sequence != 2 * i + 2 || slot.sequence.load(std::memory_order_relaxed) != sequence)
+                {
+                    continue;
+                }
+
+                begin_us = (static_cast<double>(event.begin_ticks) - static_cast<double>(TraceRecorder__ReferenceTicks)) * NS_PER_TICK * 1e-3;
+                duration_us = event.end_ticks > event.begin_ticks ? (event.end_ticks - event.begin_ticks) * NS_PER_TICK * 1e-3 : 0;
+                category = strchr(event.name, '.');
+
+                fprintf(traceFile, ",\n{\"name\": \"");
+                TraceRecorder__WriteEscaped(traceFile, event.name);
+                fprintf(traceFile, "\", \"cat\": \"%.*s\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, \"pid\": %d, \"tid\": %lu, \"args\": {\"value\": %lu}}",
+                        category != nullptr ? static_cast<int>(category - event.name) : static_cast<int>(strlen(event.name)), event.name,
+                        begin_us, duration_us, static_cast<int>(getpid()), static_cast<unsigned long>(event.threadId),
+                        static_cast<unsigned long>(event.value));
+                events++;
+            }
+        }
+    }
+
+    fprintf(traceFile, "\n], \"otherData\": {\"ns-per-tick\": %.6f, \"spans\": %lu}}\n", NS_PER_TICK, static_cast<unsigned long>(events));
+
+    writeSuccess = !ferror(traceFile);
+    writeSuccess = (fclose(traceFile) == 0) && writeSuccess;
+
+    return writeSuccess;
+}
+
+/* --------------------------------------------------------------------------------------------------------------- */
+/* ------------------------------------------------- Signal Dump ------------------------------------------------- */
+/* --------------------------------------------------------------------------------------------------------------- */
+
+static volatile sig_atomic_t TraceRecorder__DumpRequested = 0;
+
+static void TraceRecorder__SignalHandler(int)
+{
+    TraceRecorder__DumpRequested = 1;  /* Dumped by the watcher, fopen/fprintf are not async-signal-safe */
+}
+
+bool vuprs::InstallTraceDumpSignal(const int &signalNumber, const std::string &traceFilename)
+{
+    static std::atomic<bool> installed(false);
+
+    if (traceFilename.empty())
+    {
+        throw std::runtime_error("Empty filename.");
+    }
+    if (installed.exchange(true))
+    {
+        return false;
+    }
+
+    if (signal(signalNumber, TraceRecorder__SignalHandler) == SIG_ERR)
+    {
+        installed = false;
+        return false;
+    }
+
+    /* Watcher (detached, lives as long as the process) */
+
+    std::thread([traceFilename]()
+    {
+        while (true)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(TRACE_SIGNAL_POLL_MS));
+
+            if (TraceRecorder__DumpRequested)
+            {
+                TraceRecorder__DumpRequested = 0;
+                vuprs::DumpTrace(traceFilename);
+            }
+        }
+    }).detach();
+
+    return true;
+}